@@ -0,0 +1,90 @@
+// flat_map against std::unordered_map at millions of entries.
+//
+// build/<n> inserts n random keys into an empty map, times are per map. find_hit and
+// find_miss look up random present and absent keys, times are per lookup. Maps with
+// non_negative keys use the niche layout, without control bytes.
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "tsl/containers/flat_map.hpp"
+#include "tsl/profiling/bench.hpp"
+#include "tsl/types/non_negative.hpp"
+
+namespace {
+
+template<typename K>
+K make_key(std::uint64_t v) {
+    if constexpr (std::is_same_v<K, std::string>)
+        return "key:" + std::to_string(v);
+    else if constexpr (tsl::ContractType<K>)
+        return K(tsl::unchecked, static_cast<typename K::type>(v >> 2));
+    else
+        return static_cast<K>(v);
+}
+
+template<typename Map>
+void map_benchmarks(tsl::bench::runner& r, std::string const& name, std::size_t n) {
+    using key_type = typename Map::key_type;
+
+    // Present keys are even, absent keys odd.
+    std::mt19937_64 rng(n);
+    std::vector<key_type> present;
+    std::vector<key_type> absent;
+    present.reserve(n);
+    absent.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        std::uint64_t v = rng() & ~std::uint64_t(7);
+        present.push_back(make_key<key_type>(v));
+        absent.push_back(make_key<key_type>(v | 4));
+    }
+
+    std::string suffix = "/" + std::to_string(n);
+    r.run(name + "/build" + suffix, [&] {
+        Map map;
+        for (auto const& k : present)
+            map.emplace(k, 1);
+        tsl::bench::do_not_optimize(map);
+    });
+
+    Map map;
+    for (auto const& k : present)
+        map.emplace(k, 1);
+    std::shuffle(present.begin(), present.end(), rng);
+
+    r.run(name + "/find_hit" + suffix, [&](std::uint64_t iterations) {
+        std::size_t i = 0;
+        for (std::uint64_t it = 0; it < iterations; ++it) {
+            tsl::bench::do_not_optimize(map.find(present[i]));
+            if (++i == present.size())
+                i = 0;
+        }
+    });
+    r.run(name + "/find_miss" + suffix, [&](std::uint64_t iterations) {
+        std::size_t i = 0;
+        for (std::uint64_t it = 0; it < iterations; ++it) {
+            tsl::bench::do_not_optimize(map.find(absent[i]));
+            if (++i == absent.size())
+                i = 0;
+        }
+    });
+}
+
+}
+
+int main(int argc, char** argv) {
+    tsl::bench::runner r(argc, argv);
+    for (std::size_t n : {std::size_t(1) << 20, std::size_t(1) << 22}) {
+        map_benchmarks<tsl::flat_map<std::uint64_t, int>>(r, "flat_map<u64>", n);
+        map_benchmarks<std::unordered_map<std::uint64_t, int>>(r, "unordered_map<u64>", n);
+        map_benchmarks<tsl::flat_map<tsl::non_negative<long>, int>>(r, "flat_map<non_negative>", n);
+        map_benchmarks<std::unordered_map<tsl::non_negative<long>, int, tsl::hash<tsl::non_negative<long>>>>(
+            r, "unordered_map<non_negative>", n);
+    }
+    std::size_t n = std::size_t(1) << 20;
+    map_benchmarks<tsl::flat_map<std::string, int>>(r, "flat_map<string>", n);
+    map_benchmarks<std::unordered_map<std::string, int>>(r, "unordered_map<string>", n);
+    return r.finish();
+}
@@ -0,0 +1,39 @@
+// The costs tsl::bench itself adds to a measurement, as a baseline for the others.
+//
+// clobber_memory() shows the per-iteration floor of the loop, steady_clock::now() the
+// cost of one timer read, and summarize() the post-processing of a run. An empty body
+// isn't measured: the compiler removes the loop altogether.
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "tsl/profiling/bench.hpp"
+
+int main(int argc, char** argv) {
+    tsl::bench::runner r(argc, argv);
+
+    r.run("clobber_memory", [] {
+        tsl::bench::clobber_memory();
+    });
+
+    std::uint64_t x = 1;
+    r.run("do_not_optimize", [&] {
+        tsl::bench::do_not_optimize(x);
+    });
+
+    r.run("steady_clock/now", [] {
+        tsl::bench::do_not_optimize(std::chrono::steady_clock::now());
+    });
+
+    std::mt19937_64 rng(42);
+    std::vector<double> source(1000);
+    for (double& t : source)
+        t = static_cast<double>(rng() % 1000);
+    std::vector<double> times;
+    r.run("summarize/1000", [&] {
+        times = source;
+        tsl::bench::do_not_optimize(tsl::bench::summarize("x", 1, times));
+    });
+
+    return r.finish();
+}
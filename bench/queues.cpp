@@ -0,0 +1,191 @@
+// Throughput and latency of the bounded queues, against a mutex-protected std::queue.
+//
+// throughput/<queue>/<P>p<C>c moves items from P producer threads to C consumer
+// threads; times are per item. latency/<queue> bounces one item between two threads
+// through a pair of queues; times are per round trip, two hand-offs.
+//
+// Threads are started for every sample, which adds tens of microseconds to samples
+// of several milliseconds. Non-blocking queues retry with a yield, so results stay
+// meaningful with fewer cores than threads.
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+#include "tsl/concurrency/blocking_queue.hpp"
+#include "tsl/concurrency/mpmc_queue.hpp"
+#include "tsl/concurrency/spsc_queue.hpp"
+#include "tsl/maybe.hpp"
+#include "tsl/profiling/bench.hpp"
+
+namespace {
+
+constexpr std::size_t capacity = 1024;
+
+// The baseline the queues replace.
+template<typename T>
+class mutex_queue {
+public:
+    using value_type = T;
+
+    explicit mutex_queue(std::size_t capacity) : capacity_(capacity) { }
+
+    bool try_push(T value) {
+        std::lock_guard lock(mutex_);
+        if (queue_.size() == capacity_)
+            return false;
+        queue_.push(std::move(value));
+        return true;
+    }
+
+    tsl::maybe<T> try_pop() {
+        std::lock_guard lock(mutex_);
+        if (queue_.empty())
+            return {};
+        tsl::maybe<T> value(std::in_place, std::move(queue_.front()));
+        queue_.pop();
+        return value;
+    }
+
+private:
+    std::mutex mutex_;
+    std::queue<T> queue_;
+    std::size_t capacity_;
+};
+
+template<typename Q>
+constexpr bool is_blocking = requires(Q& q) { q.pop(); };
+
+template<typename Q>
+void push(Q& q, std::uint64_t value) {
+    if constexpr (is_blocking<Q>) {
+        q.push(value);
+    } else {
+        while (!q.try_push(value))
+            std::this_thread::yield();
+    }
+}
+
+template<typename Q>
+std::uint64_t pop(Q& q) {
+    if constexpr (is_blocking<Q>) {
+        return q.pop();
+    } else {
+        for (;;) {
+            if (auto m = q.try_pop())
+                return *m;
+            std::this_thread::yield();
+        }
+    }
+}
+
+// How many of `n` items part `i` of `parts` handles.
+std::uint64_t share(std::uint64_t n, std::size_t parts, std::size_t i) {
+    return n / parts + (i < n % parts ? 1 : 0);
+}
+
+template<typename Q>
+void throughput(tsl::bench::runner& r, std::string const& name, std::size_t producers, std::size_t consumers) {
+    r.run("throughput/" + name + "/" + std::to_string(producers) + "p" + std::to_string(consumers) + "c",
+          [&](std::uint64_t iterations) {
+        Q q(capacity);
+        std::vector<std::thread> threads;
+        std::atomic<std::uint64_t> sum {0};
+        for (std::size_t i = 0; i < consumers; ++i) {
+            threads.emplace_back([&, count = share(iterations, consumers, i)] {
+                std::uint64_t s = 0;
+                for (std::uint64_t k = 0; k < count; ++k)
+                    s += pop(q);
+                sum.fetch_add(s, std::memory_order_relaxed);
+            });
+        }
+        for (std::size_t i = 0; i < producers; ++i) {
+            threads.emplace_back([&, count = share(iterations, producers, i)] {
+                for (std::uint64_t k = 0; k < count; ++k)
+                    push(q, k);
+            });
+        }
+        for (auto& t : threads)
+            t.join();
+        tsl::bench::do_not_optimize(sum);
+    });
+}
+
+// One producer and one consumer moving items in batches of 32.
+template<typename Q>
+void batch_throughput(tsl::bench::runner& r, std::string const& name) {
+    r.run("throughput/" + name + "/batch32/1p1c", [&](std::uint64_t iterations) {
+        Q q(capacity);
+        std::thread consumer([&] {
+            std::uint64_t buffer[32];
+            std::uint64_t s = 0;
+            for (std::uint64_t done = 0; done < iterations;) {
+                std::size_t n = q.try_pop_batch(buffer, 32);
+                if (n == 0)
+                    std::this_thread::yield();
+                for (std::size_t k = 0; k < n; ++k)
+                    s += buffer[k];
+                done += n;
+            }
+            tsl::bench::do_not_optimize(s);
+        });
+        std::uint64_t items[32] = {};
+        for (std::uint64_t done = 0; done < iterations;) {
+            std::uint64_t want = std::min<std::uint64_t>(32, iterations - done);
+            std::size_t n = q.try_push_batch(items, items + want);
+            if (n == 0)
+                std::this_thread::yield();
+            done += n;
+        }
+        consumer.join();
+    });
+}
+
+template<typename Q>
+void latency(tsl::bench::runner& r, std::string const& name) {
+    r.run("latency/" + name, [&](std::uint64_t iterations) {
+        Q ping(capacity);
+        Q pong(capacity);
+        std::thread echo([&] {
+            for (std::uint64_t i = 0; i < iterations; ++i)
+                push(pong, pop(ping));
+        });
+        for (std::uint64_t i = 0; i < iterations; ++i) {
+            push(ping, i);
+            tsl::bench::do_not_optimize(pop(pong));
+        }
+        echo.join();
+    });
+}
+
+}
+
+int main(int argc, char** argv) {
+    tsl::bench::options opts;
+    opts.pin = false;
+    tsl::bench::runner r(argc, argv, opts);
+
+    using item = std::uint64_t;
+    throughput<tsl::spsc_queue<item>>(r, "spsc", 1, 1);
+    throughput<tsl::blocking_spsc_queue<item>>(r, "blocking_spsc", 1, 1);
+    batch_throughput<tsl::spsc_queue<item>>(r, "spsc");
+    batch_throughput<tsl::mpmc_queue<item>>(r, "mpmc");
+
+    for (std::size_t producers : {1, 2, 4}) {
+        for (std::size_t consumers : {1, 2, 4}) {
+            throughput<tsl::mpmc_queue<item>>(r, "mpmc", producers, consumers);
+            throughput<tsl::blocking_mpmc_queue<item>>(r, "blocking_mpmc", producers, consumers);
+            throughput<mutex_queue<item>>(r, "mutex_queue", producers, consumers);
+        }
+    }
+
+    latency<tsl::spsc_queue<item>>(r, "spsc");
+    latency<tsl::mpmc_queue<item>>(r, "mpmc");
+    latency<tsl::blocking_spsc_queue<item>>(r, "blocking_spsc");
+    latency<mutex_queue<item>>(r, "mutex_queue");
+
+    return r.finish();
+}
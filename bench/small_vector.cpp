@@ -0,0 +1,39 @@
+// small_vector against std::vector on the per-request list pattern: push a few
+// elements, iterate once, drop the list. Sizes up to 8 stay inline in
+// small_vector<T, 8>; 16 and 64 spill to the heap and show the cost of growth.
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "tsl/containers/small_vector.hpp"
+#include "tsl/profiling/bench.hpp"
+
+namespace {
+
+struct entry {
+    std::uint64_t id;
+    std::uint64_t value;
+};
+
+template<typename Vector>
+void push_then_iterate(tsl::bench::runner& r, std::string const& name, std::size_t n) {
+    r.run(name + "/" + std::to_string(n), [n] {
+        Vector v;
+        for (std::size_t i = 0; i < n; ++i)
+            v.push_back(typename Vector::value_type{i, i * 3});
+        std::uint64_t sum = 0;
+        for (auto const& e : v)
+            sum += e.id ^ e.value;
+        tsl::bench::do_not_optimize(sum);
+    });
+}
+
+}
+
+int main(int argc, char** argv) {
+    tsl::bench::runner r(argc, argv);
+    for (std::size_t n : {1, 2, 4, 8, 16, 64}) {
+        push_then_iterate<tsl::small_vector<entry, 8>>(r, "small_vector<entry,8>", n);
+        push_then_iterate<std::vector<entry>>(r, "vector<entry>", n);
+    }
+    return r.finish();
+}
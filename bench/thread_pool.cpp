@@ -0,0 +1,95 @@
+// Scalability of thread_pool on fine-grained tasks.
+//
+// An iteration runs 16384 tasks of about 1us through parallel_for, with a grain of
+// one task, on pools of 1, 2, 4, ... workers up to the hardware concurrency. Near-linear
+// scaling divides the time by the number of workers; the time per task and the speedup
+// over one worker are printed at the end.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "tsl/concurrency/parallel.hpp"
+#include "tsl/concurrency/thread_pool.hpp"
+#include "tsl/profiling/bench.hpp"
+
+namespace {
+
+constexpr std::size_t tasks_per_iteration = 1 << 14;
+
+std::uint64_t spin(std::uint64_t rounds, std::uint64_t seed) {
+    std::uint64_t x = seed;
+    for (std::uint64_t i = 0; i < rounds; ++i) {
+        x = x * 6364136223846793005ull + 1442695040888963407ull;
+        tsl::bench::do_not_optimize(x);
+    }
+    return x;
+}
+
+// Rounds of `spin` taking about `target`.
+std::uint64_t calibrate(std::chrono::nanoseconds target) {
+    std::uint64_t rounds = 1 << 16;
+    auto start = std::chrono::steady_clock::now();
+    tsl::bench::do_not_optimize(spin(rounds, 1));
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    auto ns = std::max<std::int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(), 1);
+    return std::max<std::uint64_t>(rounds * static_cast<std::uint64_t>(target.count()) / static_cast<std::uint64_t>(ns), 1);
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::uint64_t rounds = calibrate(std::chrono::microseconds(1));
+
+    std::vector<std::size_t> counts;
+    std::size_t hw = std::max(std::thread::hardware_concurrency(), 1u);
+    for (std::size_t n = 1; n < hw; n *= 2)
+        counts.push_back(n);
+    counts.push_back(hw);
+
+    // Created before the runner pins the main thread, so workers don't inherit its affinity.
+    std::vector<std::unique_ptr<tsl::thread_pool>> pools;
+    for (std::size_t n : counts)
+        pools.push_back(std::make_unique<tsl::thread_pool>(tsl::thread_pool_options{.threads = n}));
+
+    tsl::bench::runner r(argc, argv);
+    for (auto& pool : pools) {
+        std::string suffix = "/threads:" + std::to_string(pool->size());
+        r.run("parallel_for/1us" + suffix, [&] {
+            tsl::parallel_for(*pool, 0, tasks_per_iteration, [&](std::size_t t) {
+                tsl::bench::do_not_optimize(spin(rounds, t));
+            }, 1);
+        });
+        r.run("parallel_reduce/1us" + suffix, [&] {
+            std::uint64_t sum = tsl::parallel_reduce(*pool, 0, tasks_per_iteration, std::uint64_t(0),
+                [&](std::size_t t) { return spin(rounds, t); },
+                [](std::uint64_t a, std::uint64_t b) { return a ^ b; }, 1);
+            tsl::bench::do_not_optimize(sum);
+        });
+        r.run("submit/empty" + suffix, [&](std::uint64_t iterations) {
+            std::atomic<std::uint64_t> done {0};
+            for (std::uint64_t i = 0; i < iterations; ++i)
+                pool->submit([&done] { done.fetch_add(1, std::memory_order_relaxed); });
+            while (done.load(std::memory_order_acquire) != iterations)
+                std::this_thread::yield();
+        });
+    }
+    int status = r.finish();
+
+    std::printf("\n%-40s %12s %9s\n", "benchmark", "ns per task", "speedup");
+    for (auto const& base : r.results()) {
+        if (!base.name.ends_with("/threads:1") || base.name.starts_with("submit"))
+            continue;
+        std::string prefix = base.name.substr(0, base.name.size() - 1);
+        for (auto const& res : r.results()) {
+            if (res.name.starts_with(prefix) && res.median > 0)
+                std::printf("%-40s %12.1f %8.2fx\n", res.name.c_str(),
+                            res.median / tasks_per_iteration, base.median / res.median);
+        }
+    }
+    return status;
+}
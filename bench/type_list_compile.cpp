@@ -0,0 +1,76 @@
+// Compile-time stress of the type_list algorithms, measured by type_list_compile.py.
+//
+// Looks up every element of a TSL_TYPE_LIST_SIZE-element list by index and by type.
+// With TSL_TYPE_LIST_RECURSIVE the lookups recurse over head and tail, the way
+// type_list was written before the algorithms expanded packs; otherwise they use
+// tsl's algorithms. Only the frontend's time and memory matter: the TU has nothing
+// to run.
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include "tsl/type_traits.hpp"
+
+#ifndef TSL_TYPE_LIST_SIZE
+#define TSL_TYPE_LIST_SIZE 200
+#endif
+
+namespace {
+
+template<std::size_t I>
+struct element { };
+
+template<typename Is>
+struct make_list;
+
+template<std::size_t... Is>
+struct make_list<std::index_sequence<Is...>> {
+    using type = tsl::type_list<element<Is>...>;
+};
+
+using list = typename make_list<std::make_index_sequence<TSL_TYPE_LIST_SIZE>>::type;
+
+#ifdef TSL_TYPE_LIST_RECURSIVE
+template<std::size_t I, typename List>
+struct at : at<I - 1, typename List::tail> { };
+
+template<typename List>
+struct at<0, List> {
+    using type = typename List::head;
+};
+
+template<typename T, typename List>
+struct index_of;
+
+template<typename T>
+struct index_of<T, tsl::type_list<>> : std::integral_constant<std::size_t, tsl::type_list_npos> { };
+
+template<typename T, typename... Ts>
+struct index_of<T, tsl::type_list<T, Ts...>> : std::integral_constant<std::size_t, 0> { };
+
+template<typename T, typename U, typename... Ts>
+struct index_of<T, tsl::type_list<U, Ts...>>
+    : std::integral_constant<std::size_t, index_of<T, tsl::type_list<Ts...>>::value == tsl::type_list_npos
+                                              ? tsl::type_list_npos
+                                              : index_of<T, tsl::type_list<Ts...>>::value + 1> { };
+
+template<std::size_t I>
+using at_t = typename at<I, list>::type;
+
+template<typename T>
+inline constexpr std::size_t index_of_v = index_of<T, list>::value;
+#else
+template<std::size_t I>
+using at_t = tsl::type_list_at_t<I, list>;
+
+template<typename T>
+inline constexpr std::size_t index_of_v = tsl::type_list_index_of_v<T, list>;
+#endif
+
+template<std::size_t... Is>
+constexpr bool check(std::index_sequence<Is...>) {
+    return ((std::is_same_v<at_t<Is>, element<Is>> && index_of_v<element<Is>> == Is) && ...);
+}
+
+static_assert(check(std::make_index_sequence<TSL_TYPE_LIST_SIZE>()));
+
+}
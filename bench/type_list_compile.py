@@ -0,0 +1,57 @@
+#!/usr/bin/env python3
+"""Frontend time and peak memory of type_list_compile.cpp, recursive against pack-based.
+
+    bench/type_list_compile.py [--cxx c++] [--sizes 50,100,200]
+
+Each configuration is compiled with -fsyntax-only; the peak memory is the compiler's
+maximum resident set size.
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+import time
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SOURCE = os.path.join(ROOT, "bench", "type_list_compile.cpp")
+
+
+def measure(cxx, size, recursive):
+    cmd = [cxx, "-std=c++20", "-fsyntax-only", "-I", os.path.join(ROOT, "include"),
+           f"-DTSL_TYPE_LIST_SIZE={size}", SOURCE]
+    if recursive:
+        # The recursion is as deep as the list.
+        cmd += ["-DTSL_TYPE_LIST_RECURSIVE", f"-ftemplate-depth={size + 1024}"]
+    start = time.monotonic()
+    proc = subprocess.Popen(cmd)
+    # wait4 reports the usage of this compiler alone.
+    _, status, usage = os.wait4(proc.pid, 0)
+    elapsed = time.monotonic() - start
+    # ru_maxrss is in kilobytes on Linux and in bytes on macOS.
+    peak_kb = usage.ru_maxrss // 1024 if sys.platform == "darwin" else usage.ru_maxrss
+    return os.waitstatus_to_exitcode(status), elapsed, peak_kb
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--cxx", default=os.environ.get("CXX", "c++"))
+    parser.add_argument("--sizes", default="50,100,200")
+    args = parser.parse_args()
+
+    print(f"{'size':>6} {'form':<10} {'time s':>8} {'peak MB':>9}")
+    failed = False
+    for size in (int(s) for s in args.sizes.split(",")):
+        for recursive in (True, False):
+            status, elapsed, peak = measure(args.cxx, size, recursive)
+            form = "recursive" if recursive else "pack"
+            if status != 0:
+                print(f"{size:>6} {form:<10} {'failed':>8}")
+                failed = True
+                continue
+            print(f"{size:>6} {form:<10} {elapsed:>8.2f} {peak / 1024:>9.1f}")
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
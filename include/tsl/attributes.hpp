@@ -21,4 +21,36 @@
 #define TSL_ATTR_LIFETIMEBOUND
 #endif
 
+// Keeps slow paths out of line, so the fast path stays small enough to be inlined.
+#if TSL_HAS_ATTRIBUTE(noinline)
+#define TSL_ATTR_NOINLINE __attribute__((noinline))
+#elif defined(_MSC_VER)
+#define TSL_ATTR_NOINLINE __declspec(noinline)
+#else
+#define TSL_ATTR_NOINLINE
+#endif
+
+// TSL_TARGET("avx2,bmi2")
+//
+// Compiles a function for the given instruction set extensions, whatever the flags
+// of the translation unit. It must only be called on CPUs that support them, see
+// tsl/util/cpu_features.hpp.
+#if TSL_HAS_ATTRIBUTE(target)
+#define TSL_TARGET(features) __attribute__((target(features)))
+#define TSL_HAS_TARGET 1
+#else
+#define TSL_TARGET(features)
+#define TSL_HAS_TARGET 0
+#endif
+
+// TSL_TARGET_CLONES("avx2", "default")
+//
+// Compiles a function once per target and lets the loader pick one, through an ifunc.
+// Falls back to a single default version where unsupported.
+#if TSL_HAS_ATTRIBUTE(target_clones) && defined(__ELF__)
+#define TSL_TARGET_CLONES(...) __attribute__((target_clones(__VA_ARGS__)))
+#else
+#define TSL_TARGET_CLONES(...)
+#endif
+
 #endif // _TSL_ATTRIBUTES_HPP
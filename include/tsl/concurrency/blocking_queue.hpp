@@ -0,0 +1,132 @@
+// Blocking wrapper for tsl::spsc_queue and tsl::mpmc_queue.
+// Waiting threads park on `std::atomic::wait` (a futex on Linux). Each side keeps
+// a count of waiters, so the non-blocking path never makes a system call.
+#ifndef _TSL_CONCURRENCY_BLOCKING_QUEUE_HPP
+#define _TSL_CONCURRENCY_BLOCKING_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include "tsl/concurrency/mpmc_queue.hpp"
+#include "tsl/concurrency/spsc_queue.hpp"
+#include "tsl/internal/cache_line.hpp"
+#include "tsl/maybe.hpp"
+
+namespace tsl {
+
+template<typename Queue>
+class blocking_queue {
+public:
+    using value_type = typename Queue::value_type;
+    using T = value_type;
+
+    explicit blocking_queue(std::size_t capacity) : queue_(capacity) { }
+
+    // Blocks while the queue is full.
+    template<typename... Args>
+    void emplace(Args&&... args) {
+        // Arguments are only consumed by a successful `try_emplace()`.
+        while (!queue_.try_emplace(std::forward<Args>(args)...))
+            wait(space_, [&] { return queue_.size() < queue_.capacity(); });
+        notify(items_);
+    }
+
+    template<typename U = T>
+    void push(U&& value) {
+        emplace(std::forward<U>(value));
+    }
+
+    // Blocks while the queue is empty.
+    [[nodiscard]] T pop() {
+        for (;;) {
+            maybe<T> m = queue_.try_pop();
+            if (m) {
+                notify(space_);
+                return *std::move(m);
+            }
+            wait(items_, [&] { return !queue_.empty(); });
+        }
+    }
+
+    template<typename... Args>
+    [[nodiscard]] bool try_emplace(Args&&... args) {
+        if (!queue_.try_emplace(std::forward<Args>(args)...))
+            return false;
+        notify(items_);
+        return true;
+    }
+
+    template<typename U = T>
+    [[nodiscard]] bool try_push(U&& value) {
+        return try_emplace(std::forward<U>(value));
+    }
+
+    [[nodiscard]] maybe<T> try_pop() {
+        maybe<T> m = queue_.try_pop();
+        if (m)
+            notify(space_);
+        return m;
+    }
+
+    template<typename It, typename S>
+    std::size_t try_push_batch(It first, S last) {
+        std::size_t n = queue_.try_push_batch(std::move(first), std::move(last));
+        if (n != 0)
+            notify(items_);
+        return n;
+    }
+
+    template<typename Out>
+    std::size_t try_pop_batch(Out out, std::size_t max) {
+        std::size_t n = queue_.try_pop_batch(std::move(out), max);
+        if (n != 0)
+            notify(space_);
+        return n;
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept { return queue_.size(); }
+    [[nodiscard]] bool empty() const noexcept { return queue_.empty(); }
+    [[nodiscard]] std::size_t capacity() const noexcept { return queue_.capacity(); }
+
+private:
+    struct alignas(internal::cache_line_size) event {
+        std::atomic<std::uint32_t> epoch {0};
+        std::atomic<std::uint32_t> waiters {0};
+    };
+
+    // Registering as a waiter and checking the condition are ordered with the
+    // notifier's update and waiter check by seq_cst fences, so either the waiter
+    // sees the condition or the notifier sees the waiter.
+    template<typename Ready>
+    static void wait(event& e, Ready&& ready) {
+        std::uint32_t epoch = e.epoch.load(std::memory_order_acquire);
+        e.waiters.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!ready())
+            e.epoch.wait(epoch, std::memory_order_acquire);
+        e.waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    static void notify(event& e) noexcept {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (e.waiters.load(std::memory_order_relaxed) == 0)
+            return;
+        e.epoch.fetch_add(1, std::memory_order_release);
+        e.epoch.notify_all();
+    }
+
+    Queue queue_;
+    event items_;
+    event space_;
+};
+
+template<typename T>
+using blocking_spsc_queue = blocking_queue<spsc_queue<T>>;
+
+template<typename T>
+using blocking_mpmc_queue = blocking_queue<mpmc_queue<T>>;
+
+}
+
+#endif // _TSL_CONCURRENCY_BLOCKING_QUEUE_HPP
@@ -0,0 +1,226 @@
+// A bounded, lock-free, multi-producer multi-consumer queue.
+// Dmitry Vyukov's algorithm: every cell carries a sequence number telling whether
+// it's ready to be written or read for the current lap, so producers and consumers
+// only contend on their own index.
+//
+// A claimed cell can't be given back, so elements are constructed and moved out of
+// cells only with operations that don't throw.
+#ifndef _TSL_CONCURRENCY_MPMC_QUEUE_HPP
+#define _TSL_CONCURRENCY_MPMC_QUEUE_HPP
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "tsl/internal/cache_line.hpp"
+#include "tsl/maybe.hpp"
+
+namespace tsl {
+
+template<typename T>
+class mpmc_queue {
+    static_assert(std::is_nothrow_move_constructible_v<T>, "popping moves from claimed cells");
+
+public:
+    using value_type = T;
+
+    // The capacity is rounded up to a power of two, and is at least two.
+    explicit mpmc_queue(std::size_t capacity)
+        : capacity_(std::bit_ceil(capacity < 2 ? std::size_t(2) : capacity)),
+          mask_(capacity_ - 1),
+          cells_(new cell[capacity_])
+    {
+        for (std::size_t i = 0; i < capacity_; ++i)
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    mpmc_queue(mpmc_queue const&) = delete;
+    mpmc_queue& operator=(mpmc_queue const&) = delete;
+
+    ~mpmc_queue() {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            std::size_t head = dequeue_pos_.load(std::memory_order_relaxed);
+            std::size_t tail = enqueue_pos_.load(std::memory_order_relaxed);
+            for (; head != tail; ++head)
+                std::destroy_at(value(cells_[head & mask_]));
+        }
+    }
+
+    // `args` are not used if the queue is full.
+    template<typename... Args>
+    [[nodiscard]] bool try_emplace(Args&&... args) noexcept
+        requires(std::is_nothrow_constructible_v<T, Args...>)
+    {
+        std::size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        cell* c;
+        for (;;) {
+            c = &cells_[pos & mask_];
+            std::size_t seq = c->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        std::construct_at(value(*c), std::forward<Args>(args)...);
+        c->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // `value` is only moved from if it was pushed.
+    template<typename U = T>
+    [[nodiscard]] bool try_push(U&& value) noexcept
+        requires(std::is_nothrow_constructible_v<T, U&&>)
+    {
+        return try_emplace(std::forward<U>(value));
+    }
+
+    // Claims as many consecutive free cells as there are elements in
+    // [first, last) with a single CAS, then moves the elements into them.
+    // Returns how many were pushed.
+    template<std::forward_iterator It, std::sentinel_for<It> S>
+        requires(std::is_nothrow_constructible_v<T, std::iter_rvalue_reference_t<It>>)
+    std::size_t try_push_batch(It first, S last) {
+        if (first == last)
+            return 0;
+
+        std::size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        std::size_t n;
+        for (;;) {
+            n = 0;
+            for (It it = first; it != last && n < capacity_; ++it, ++n) {
+                std::size_t seq = cells_[(pos + n) & mask_].sequence.load(std::memory_order_acquire);
+                if (seq != pos + n)
+                    break;
+            }
+            if (n == 0) {
+                std::size_t seq = cells_[pos & mask_].sequence.load(std::memory_order_acquire);
+                if (static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos) < 0)
+                    return 0;
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (enqueue_pos_.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed))
+                break;
+        }
+
+        for (std::size_t i = 0; i < n; ++i, ++first) {
+            cell& c = cells_[(pos + i) & mask_];
+            std::construct_at(value(c), std::ranges::iter_move(first));
+            c.sequence.store(pos + i + 1, std::memory_order_release);
+        }
+        return n;
+    }
+
+    // Returns an empty maybe if the queue is empty.
+    [[nodiscard]] maybe<T> try_pop() noexcept {
+        std::size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        cell* c;
+        for (;;) {
+            c = &cells_[pos & mask_];
+            std::size_t seq = c->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return {};
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        T* p = value(*c);
+        maybe<T> result(std::in_place, std::move(*p));
+        std::destroy_at(p);
+        c->sequence.store(pos + capacity_, std::memory_order_release);
+        return result;
+    }
+
+    // Claims up to `max` consecutive full cells with a single CAS and moves
+    // their elements to `out`. Returns how many were popped.
+    template<std::weakly_incrementable Out>
+    std::size_t try_pop_batch(Out out, std::size_t max)
+        requires(std::indirectly_writable<Out, T&&> && requires(Out& o, T&& v) {
+            { *o = std::move(v) } noexcept;
+            { ++o } noexcept;
+        })
+    {
+        if (max == 0)
+            return 0;
+
+        std::size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        std::size_t n;
+        for (;;) {
+            n = 0;
+            for (; n < max && n < capacity_; ++n) {
+                std::size_t seq = cells_[(pos + n) & mask_].sequence.load(std::memory_order_acquire);
+                if (seq != pos + n + 1)
+                    break;
+            }
+            if (n == 0) {
+                std::size_t seq = cells_[pos & mask_].sequence.load(std::memory_order_acquire);
+                if (static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1) < 0)
+                    return 0;
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (dequeue_pos_.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed))
+                break;
+        }
+
+        for (std::size_t i = 0; i < n; ++i, ++out) {
+            cell& c = cells_[(pos + i) & mask_];
+            T* p = value(c);
+            *out = std::move(*p);
+            std::destroy_at(p);
+            c.sequence.store(pos + i + capacity_, std::memory_order_release);
+        }
+        return n;
+    }
+
+    // Approximations when called concurrently.
+    [[nodiscard]] std::size_t size() const noexcept {
+        std::size_t head = dequeue_pos_.load(std::memory_order_acquire);
+        std::size_t tail = enqueue_pos_.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    [[nodiscard]] std::size_t capacity() const noexcept {
+        return capacity_;
+    }
+
+private:
+    struct cell {
+        std::atomic<std::size_t> sequence;
+        internal_maybe::Storage<T> storage;
+    };
+
+    static T* value(cell& c) noexcept {
+        return std::addressof(c.storage.value_);
+    }
+
+    std::size_t capacity_;
+    std::size_t mask_;
+    std::unique_ptr<cell[]> cells_;
+
+    alignas(internal::cache_line_size) std::atomic<std::size_t> enqueue_pos_ {0};
+    alignas(internal::cache_line_size) std::atomic<std::size_t> dequeue_pos_ {0};
+};
+
+}
+
+#endif // _TSL_CONCURRENCY_MPMC_QUEUE_HPP
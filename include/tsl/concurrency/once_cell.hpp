@@ -0,0 +1,181 @@
+// Thread-safe one-time initialization.
+//
+//     constinit tsl::lazy<std::vector<rule>> rules([] { return load_rules(); });
+//     for (rule const& r : *rules) ...       // built on first use
+//
+//     constinit tsl::once_cell<config> cfg;
+//     config const& c = cfg.get_or_init([] { return parse_config(); });
+//     tsl::maybe<config const&> maybe_c = cfg.get();
+//
+// Both have constexpr constructors, so they can be constinit at namespace scope and
+// are never subject to the static initialization order. Once initialized, an access
+// is one acquire load and a branch.
+//
+// Concurrent initializers wait for the first one. If it throws, the cell stays empty
+// and one of the waiting callers runs its own initializer.
+#ifndef _TSL_CONCURRENCY_ONCE_CELL_HPP
+#define _TSL_CONCURRENCY_ONCE_CELL_HPP
+
+#include <atomic>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "tsl/attributes.hpp"
+#include "tsl/config.hpp"
+#include "tsl/macros.hpp"
+#include "tsl/maybe.hpp"
+
+namespace tsl {
+
+template<typename T>
+class once_cell {
+    enum state : std::uint8_t {
+        empty,
+        running,
+        // Set when a caller is waiting on a running initializer.
+        running_waited,
+        ready,
+    };
+
+public:
+    using value_type = T;
+
+    constexpr once_cell() noexcept = default;
+
+    once_cell(once_cell const&) = delete;
+    once_cell& operator=(once_cell const&) = delete;
+
+    ~once_cell() {
+        if (state_.load(std::memory_order_relaxed) == ready)
+            std::destroy_at(&storage_.value_);
+    }
+
+    [[nodiscard]] bool has_value() const noexcept {
+        return state_.load(std::memory_order_acquire) == ready;
+    }
+
+    [[nodiscard]] maybe<T&> get() noexcept {
+        if (!has_value())
+            return {};
+        return storage_.value_;
+    }
+
+    [[nodiscard]] maybe<T const&> get() const noexcept {
+        if (!has_value())
+            return {};
+        return storage_.value_;
+    }
+
+    // The value, initialized with `f()` if this is the first call.
+    template<typename F>
+        requires(std::convertible_to<std::invoke_result_t<F&>, T>)
+    T& get_or_init(F&& f) {
+        if (TSL_EXPECT_TRUE(state_.load(std::memory_order_acquire) == ready))
+            return storage_.value_;
+        initialize([&f](void* p) { std::construct_at(static_cast<T*>(p), std::invoke(f)); });
+        return storage_.value_;
+    }
+
+    // Stores `args` if the cell is empty. Returns whether it was stored; if another
+    // caller is initializing the cell, waits for it first.
+    template<typename... Args>
+        requires(std::constructible_from<T, Args...>)
+    bool set(Args&&... args) {
+        bool stored = false;
+        if (state_.load(std::memory_order_acquire) != ready) {
+            initialize([&](void* p) {
+                std::construct_at(static_cast<T*>(p), std::forward<Args>(args)...);
+                stored = true;
+            });
+        }
+        return stored;
+    }
+
+private:
+    template<typename Init>
+    TSL_ATTR_NOINLINE void initialize(Init&& init) {
+        std::uint8_t s = state_.load(std::memory_order_acquire);
+        for (;;) {
+            if (s == ready)
+                return;
+            if (s == empty) {
+                if (state_.compare_exchange_weak(s, running, std::memory_order_acquire))
+                    break;
+                continue;
+            }
+            // Another caller is running, announce the wait and sleep until it's done.
+            if (s == running && !state_.compare_exchange_weak(s, running_waited, std::memory_order_relaxed))
+                continue;
+            state_.wait(running_waited, std::memory_order_acquire);
+            s = state_.load(std::memory_order_acquire);
+        }
+
+#if TSL_HAS_EXCEPTIONS
+        try {
+            init(static_cast<void*>(&storage_.value_));
+        } catch (...) {
+            finish(empty);
+            throw;
+        }
+#else
+        init(static_cast<void*>(&storage_.value_));
+#endif
+        finish(ready);
+    }
+
+    void finish(state next) noexcept {
+        if (state_.exchange(next, std::memory_order_release) == running_waited)
+            state_.notify_all();
+    }
+
+    internal_maybe::Storage<T> storage_;
+    std::atomic<std::uint8_t> state_ {empty};
+};
+
+// lazy
+//
+// A value built by `init()` on first access.
+template<typename T, typename F = T (*)()>
+class lazy {
+public:
+    using value_type = T;
+
+    constexpr explicit lazy(F init) noexcept(std::is_nothrow_move_constructible_v<F>)
+        : init_(std::move(init)) { }
+
+    lazy(lazy const&) = delete;
+    lazy& operator=(lazy const&) = delete;
+
+    [[nodiscard]] T& get() {
+        return cell_.get_or_init(init_);
+    }
+
+    [[nodiscard]] T const& get() const {
+        return cell_.get_or_init(init_);
+    }
+
+    T& operator*() { return get(); }
+    T const& operator*() const { return get(); }
+    T* operator->() { return std::addressof(get()); }
+    T const* operator->() const { return std::addressof(get()); }
+
+    // Whether the value was built, without building it.
+    [[nodiscard]] bool is_initialized() const noexcept {
+        return cell_.has_value();
+    }
+
+private:
+    // Initialization is not an observable modification.
+    mutable once_cell<T> cell_;
+    [[no_unique_address]] F init_;
+};
+
+template<typename F>
+lazy(F) -> lazy<std::remove_cvref_t<std::invoke_result_t<F&>>, F>;
+
+}
+
+#endif // _TSL_CONCURRENCY_ONCE_CELL_HPP
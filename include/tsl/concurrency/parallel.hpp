@@ -0,0 +1,169 @@
+// Parallel loops on top of tsl::thread_pool.
+// Ranges are split recursively, the right half is pushed to the worker's deque so
+// idle workers steal large chunks while the owner keeps working on the left half.
+#ifndef _TSL_CONCURRENCY_PARALLEL_HPP
+#define _TSL_CONCURRENCY_PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <exception>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "tsl/concurrency/thread_pool.hpp"
+#include "tsl/config.hpp"
+
+namespace tsl {
+
+namespace internal_parallel {
+
+template<typename F>
+struct loop_state {
+    loop_state(thread_pool& p, F& b, std::size_t g, std::size_t n)
+        : pool(p), body(b), grain(g), pending(n) { }
+
+    thread_pool& pool;
+    F& body;
+    std::size_t grain;
+    std::atomic<std::size_t> pending;
+#if TSL_HAS_EXCEPTIONS
+    std::atomic<bool> failed {false};
+    std::exception_ptr error;
+#endif
+};
+
+template<typename F>
+struct range_task : internal_thread_pool::task {
+    range_task(loop_state<F>& s, std::size_t f, std::size_t l)
+        : task{&range_task::run}, state(&s), first(f), last(l) { }
+
+    static void run(internal_thread_pool::task* t) {
+        auto* self = static_cast<range_task*>(t);
+        execute(*self->state, self->first, self->last);
+        delete self;
+    }
+
+    static void execute(loop_state<F>& state, std::size_t first, std::size_t last) {
+        while (last - first > state.grain) {
+            std::size_t mid = first + (last - first) / 2;
+            state.pool.submit_task(new range_task(state, mid, last));
+            last = mid;
+        }
+
+#if TSL_HAS_EXCEPTIONS
+        try {
+            if (!state.failed.load(std::memory_order_relaxed))
+                state.body(first, last);
+        } catch (...) {
+            if (!state.failed.exchange(true, std::memory_order_relaxed))
+                state.error = std::current_exception();
+        }
+#else
+        state.body(first, last);
+#endif
+
+        // `state` may be destroyed as soon as `pending` reaches zero, so the
+        // completion is notified through the pool.
+        thread_pool& pool = state.pool;
+        if (state.pending.fetch_sub(last - first, std::memory_order_acq_rel) == last - first)
+            pool.notify_completion();
+    }
+
+    loop_state<F>* state;
+    std::size_t first;
+    std::size_t last;
+};
+
+inline std::size_t default_grain(thread_pool const& pool, std::size_t n) {
+    // Around eight chunks per worker, enough for stealing to balance the load.
+    std::size_t chunks = pool.size() * 8;
+    return n / chunks > 0 ? n / chunks : 1;
+}
+
+}
+
+// parallel_for_range
+//
+// Calls `body(first, last)` for disjoint subranges covering [first, last),
+// each at most `grain` elements long. Blocks until every call returned.
+// If `grain` is zero, it's chosen from the number of workers.
+// If a call throws, the remaining subranges are skipped and the first exception is rethrown.
+template<typename F>
+void parallel_for_range(thread_pool& pool, std::size_t first, std::size_t last,
+                        F&& body, std::size_t grain = 0)
+    requires(std::invocable<F&, std::size_t, std::size_t>)
+{
+    if (first >= last)
+        return;
+    if (grain == 0)
+        grain = internal_parallel::default_grain(pool, last - first);
+
+    using body_type = std::remove_reference_t<F>;
+    internal_parallel::loop_state<body_type> state(pool, body, grain, last - first);
+    using task_type = internal_parallel::range_task<body_type>;
+
+    if (thread_pool::current() == &pool)
+        task_type::execute(state, first, last);
+    else
+        pool.submit_task(new task_type(state, first, last));
+
+    pool.wait_for([&] { return state.pending.load(std::memory_order_acquire) == 0; });
+
+#if TSL_HAS_EXCEPTIONS
+    if (state.error)
+        std::rethrow_exception(state.error);
+#endif
+}
+
+// parallel_for
+//
+// Calls `body(i)` for every i in [first, last).
+template<typename F>
+void parallel_for(thread_pool& pool, std::size_t first, std::size_t last,
+                  F&& body, std::size_t grain = 0)
+    requires(std::invocable<F&, std::size_t>)
+{
+    parallel_for_range(pool, first, last, [&body](std::size_t b, std::size_t e) {
+        for (std::size_t i = b; i < e; ++i)
+            body(i);
+    }, grain);
+}
+
+// parallel_reduce
+//
+// Returns `init` combined with `map(i)` for every i in [first, last), using `reduce`.
+// Chunk results are combined in index order, so `reduce` only needs to be associative.
+template<typename T, typename Map, typename Reduce>
+T parallel_reduce(thread_pool& pool, std::size_t first, std::size_t last, T init,
+                  Map&& map, Reduce&& reduce, std::size_t grain = 0)
+    requires(std::invocable<Map&, std::size_t>
+          && std::invocable<Reduce&, T, std::invoke_result_t<Map&, std::size_t>>)
+{
+    if (first >= last)
+        return init;
+    if (grain == 0)
+        grain = internal_parallel::default_grain(pool, last - first);
+
+    std::size_t chunks = (last - first + grain - 1) / grain;
+    std::vector<T> partial(chunks, init);
+
+    parallel_for(pool, 0, chunks, [&](std::size_t c) {
+        std::size_t b = first + c * grain;
+        std::size_t e = std::min(last, b + grain);
+        T acc = map(b);
+        for (std::size_t i = b + 1; i < e; ++i)
+            acc = reduce(std::move(acc), map(i));
+        partial[c] = std::move(acc);
+    }, 1);
+
+    T result = std::move(init);
+    for (T& p : partial)
+        result = reduce(std::move(result), std::move(p));
+    return result;
+}
+
+}
+
+#endif // _TSL_CONCURRENCY_PARALLEL_HPP
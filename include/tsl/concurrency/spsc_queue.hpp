@@ -0,0 +1,167 @@
+// A bounded, wait-free, single-producer single-consumer queue.
+// Head and tail live in separate cache lines, and each side keeps a cached copy
+// of the other side's index, so the shared lines are only touched when the
+// cached value says the queue looks full (or empty).
+#ifndef _TSL_CONCURRENCY_SPSC_QUEUE_HPP
+#define _TSL_CONCURRENCY_SPSC_QUEUE_HPP
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "tsl/internal/cache_line.hpp"
+#include "tsl/maybe.hpp"
+
+namespace tsl {
+
+template<typename T>
+class spsc_queue {
+public:
+    using value_type = T;
+
+    // The capacity is rounded up to a power of two.
+    explicit spsc_queue(std::size_t capacity)
+        : capacity_(std::bit_ceil(capacity < 1 ? std::size_t(1) : capacity)),
+          mask_(capacity_ - 1),
+          slots_(new internal_maybe::Storage<T>[capacity_]) { }
+
+    spsc_queue(spsc_queue const&) = delete;
+    spsc_queue& operator=(spsc_queue const&) = delete;
+
+    ~spsc_queue() {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            std::size_t head = head_.load(std::memory_order_relaxed);
+            std::size_t tail = tail_.load(std::memory_order_relaxed);
+            for (; head != tail; ++head)
+                std::destroy_at(slot(head));
+        }
+    }
+
+    // Producer only. `args` are not used if the queue is full.
+    template<typename... Args>
+    [[nodiscard]] bool try_emplace(Args&&... args)
+        noexcept(std::is_nothrow_constructible_v<T, Args...>)
+        requires(std::constructible_from<T, Args...>)
+    {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ == capacity_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ == capacity_)
+                return false;
+        }
+        std::construct_at(slot(tail), std::forward<Args>(args)...);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Producer only. `value` is only moved from if it was pushed.
+    template<typename U = T>
+    [[nodiscard]] bool try_push(U&& value)
+        noexcept(std::is_nothrow_constructible_v<T, U&&>)
+        requires(std::constructible_from<T, U&&>)
+    {
+        return try_emplace(std::forward<U>(value));
+    }
+
+    // Producer only. Moves as many elements from [first, last) as fit,
+    // publishing them at once. Returns how many were pushed.
+    template<std::input_iterator It, std::sentinel_for<It> S>
+    std::size_t try_push_batch(It first, S last) {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        std::size_t free = capacity_ - (tail - cached_head_);
+        if (free == 0) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            free = capacity_ - (tail - cached_head_);
+        }
+
+        std::size_t n = 0;
+        for (; n < free && first != last; ++n, ++first)
+            std::construct_at(slot(tail + n), std::ranges::iter_move(first));
+
+        if (n != 0)
+            tail_.store(tail + n, std::memory_order_release);
+        return n;
+    }
+
+    // Consumer only. Returns an empty maybe if the queue is empty.
+    [[nodiscard]] maybe<T> try_pop()
+        noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_)
+                return {};
+        }
+
+        T* p = slot(head);
+        maybe<T> result(std::in_place, std::move(*p));
+        std::destroy_at(p);
+        head_.store(head + 1, std::memory_order_release);
+        return result;
+    }
+
+    // Consumer only. Moves up to `max` elements to `out`, releasing their
+    // slots at once. Returns how many were popped.
+    template<std::weakly_incrementable Out>
+    std::size_t try_pop_batch(Out out, std::size_t max)
+        requires(std::indirectly_writable<Out, T&&>)
+    {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        std::size_t available = cached_tail_ - head;
+        if (available == 0) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            available = cached_tail_ - head;
+        }
+
+        std::size_t n = available < max ? available : max;
+        for (std::size_t i = 0; i < n; ++i, ++out) {
+            T* p = slot(head + i);
+            *out = std::move(*p);
+            std::destroy_at(p);
+        }
+
+        if (n != 0)
+            head_.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+    // Approximations when called concurrently with the other side.
+    [[nodiscard]] std::size_t size() const noexcept {
+        std::size_t head = head_.load(std::memory_order_acquire);
+        std::size_t tail = tail_.load(std::memory_order_acquire);
+        return tail - head;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    [[nodiscard]] std::size_t capacity() const noexcept {
+        return capacity_;
+    }
+
+private:
+    T* slot(std::size_t index) const noexcept {
+        return std::addressof(slots_[index & mask_].value_);
+    }
+
+    std::size_t capacity_;
+    std::size_t mask_;
+    std::unique_ptr<internal_maybe::Storage<T>[]> slots_;
+
+    // Consumer side.
+    alignas(internal::cache_line_size) std::atomic<std::size_t> head_ {0};
+    std::size_t cached_tail_ = 0;
+
+    // Producer side.
+    alignas(internal::cache_line_size) std::atomic<std::size_t> tail_ {0};
+    std::size_t cached_head_ = 0;
+};
+
+}
+
+#endif // _TSL_CONCURRENCY_SPSC_QUEUE_HPP
@@ -0,0 +1,156 @@
+// A work-stealing thread pool.
+// Every worker owns a Chase-Lev deque, tasks submitted from a worker go to its own
+// deque and tasks submitted from other threads go to a global injection queue.
+// Idle workers steal from each other and park on an atomic wait when there is no work.
+#ifndef _TSL_CONCURRENCY_THREAD_POOL_HPP
+#define _TSL_CONCURRENCY_THREAD_POOL_HPP
+
+#include <atomic>
+#include <concepts>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "tsl/internal/cache_line.hpp"
+
+namespace tsl {
+
+class thread_pool;
+
+namespace internal_thread_pool {
+
+// Base of heap allocated tasks. A function pointer is used instead of a virtual
+// function, the task is responsible for deleting itself.
+struct task {
+    void (*invoke)(task*);
+};
+
+template<typename F>
+struct callable_task : task {
+    template<typename U>
+    explicit callable_task(U&& f)
+        : task{&callable_task::run}, f_(std::forward<U>(f)) { }
+
+    static void run(task* t) {
+        std::unique_ptr<callable_task> self(static_cast<callable_task*>(t));
+        self->f_();
+    }
+
+    F f_;
+};
+
+struct worker;
+
+}
+
+struct thread_pool_options {
+    // Number of workers. Zero means `std::thread::hardware_concurrency()`.
+    std::size_t threads = 0;
+
+    // Pin every worker to a single CPU, from the CPUs the process is allowed to run on.
+    bool pin_threads = false;
+
+    // Place workers node by node and steal from workers of the same NUMA node first.
+    // Implies `pin_threads`. Ignored where the topology can't be read.
+    bool numa_aware = false;
+};
+
+class thread_pool {
+public:
+    thread_pool();
+    explicit thread_pool(thread_pool_options const& options);
+
+    thread_pool(thread_pool const&) = delete;
+    thread_pool& operator=(thread_pool const&) = delete;
+
+    // Runs every pending task and joins the workers.
+    ~thread_pool();
+
+    // Schedules `f()` to run in one of the workers. Exceptions escaping `f` terminate the program.
+    template<typename F>
+    void submit(F&& f)
+        requires(std::invocable<std::decay_t<F>&>)
+    {
+        submit_task(new internal_thread_pool::callable_task<std::decay_t<F>>(std::forward<F>(f)));
+    }
+
+    // Schedules the coroutine to be resumed in one of the workers. It doesn't allocate.
+    void submit(std::coroutine_handle<> handle);
+
+    // Schedules an already allocated task, used by the parallel algorithms.
+    void submit_task(internal_thread_pool::task* t);
+
+    class schedule_awaiter {
+    public:
+        explicit schedule_awaiter(thread_pool& pool) noexcept : pool_(pool) { }
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) { pool_.submit(handle); }
+        void await_resume() const noexcept { }
+
+    private:
+        thread_pool& pool_;
+    };
+
+    // `co_await pool.schedule()` moves the current coroutine to a worker of the pool.
+    [[nodiscard]] schedule_awaiter schedule() noexcept {
+        return schedule_awaiter(*this);
+    }
+
+    // Runs a single pending task in the calling thread, returns false if none was found.
+    // Used to help the pool while waiting for a result.
+    bool try_run_one();
+
+    [[nodiscard]] std::size_t size() const noexcept {
+        return workers_.size();
+    }
+
+    // The pool the calling thread is a worker of, or nullptr.
+    [[nodiscard]] static thread_pool* current() noexcept;
+
+    // Completion notifications, see `wait_for()`.
+    void notify_completion() noexcept;
+
+    // Blocks until `done()` returns true, running pending tasks meanwhile.
+    // `done()` must become true before a call to `notify_completion()`.
+    template<typename Pred>
+    void wait_for(Pred&& done) {
+        bool helping = current() == this;
+        for (;;) {
+            std::uint32_t epoch = completions_.load(std::memory_order_acquire);
+            if (done())
+                return;
+            if (helping && try_run_one())
+                continue;
+            completions_.wait(epoch, std::memory_order_acquire);
+        }
+    }
+
+private:
+    void push(std::uintptr_t item);
+    void wake_one() noexcept;
+    std::uintptr_t pop_injection(internal_thread_pool::worker* w);
+    std::uintptr_t find_work(internal_thread_pool::worker& w);
+    std::uintptr_t steal(internal_thread_pool::worker* w);
+    void worker_loop(internal_thread_pool::worker& w);
+
+    std::vector<std::unique_ptr<internal_thread_pool::worker>> workers_;
+
+    std::mutex injection_mutex_;
+    std::deque<std::uintptr_t> injection_;
+    std::atomic<std::size_t> injection_size_ {0};
+
+    alignas(internal::cache_line_size) std::atomic<std::uint32_t> epoch_ {0};
+    alignas(internal::cache_line_size) std::atomic<std::uint32_t> sleepers_ {0};
+    alignas(internal::cache_line_size) std::atomic<std::uint32_t> completions_ {0};
+    std::atomic<bool> stopping_ {false};
+};
+
+}
+
+#endif // _TSL_CONCURRENCY_THREAD_POOL_HPP
@@ -0,0 +1,230 @@
+// An open-addressing hash map storing its elements inline, in a single array.
+// See tsl/internal/raw_flat_table.hpp for the layout.
+//
+// Unlike std::unordered_map, pointers and iterators are invalidated by any insertion
+// that grows the table and by erasure.
+#ifndef _TSL_CONTAINERS_FLAT_MAP_HPP
+#define _TSL_CONTAINERS_FLAT_MAP_HPP
+
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "tsl/hash.hpp"
+#include "tsl/internal/raw_flat_table.hpp"
+#include "tsl/macros.hpp"
+#include "tsl/maybe.hpp"
+
+namespace tsl {
+
+template<typename K, typename V,
+         typename Hash = tsl::hash<K>,
+         typename Eq = tsl::equal_to<K>,
+         typename Alloc = std::allocator<std::pair<const K, V>>>
+class flat_map {
+    using table_type = internal_flat::raw_table<internal_flat::map_traits<K, V>, Hash, Eq, Alloc>;
+
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<const K, V>;
+    using size_type = std::size_t;
+    using hasher = Hash;
+    using key_equal = Eq;
+    using allocator_type = Alloc;
+    using iterator = typename table_type::iterator;
+    using const_iterator = typename table_type::const_iterator;
+
+    // True when empty slots are marked with the key's niche instead of control bytes.
+    static constexpr bool uses_niche = table_type::uses_niche;
+
+    flat_map() = default;
+
+    explicit flat_map(size_type bucket_count, Hash const& hash = Hash(),
+                      Eq const& eq = Eq(), Alloc const& alloc = Alloc())
+        : table_(bucket_count, hash, eq, alloc) { }
+
+    flat_map(std::initializer_list<value_type> il, size_type bucket_count = 0)
+        : table_(bucket_count != 0 ? bucket_count : il.size())
+    {
+        insert(il.begin(), il.end());
+    }
+
+    iterator begin() noexcept { return table_.begin(); }
+    iterator end() noexcept { return table_.end(); }
+    const_iterator begin() const noexcept { return table_.begin(); }
+    const_iterator end() const noexcept { return table_.end(); }
+    const_iterator cbegin() const noexcept { return table_.begin(); }
+    const_iterator cend() const noexcept { return table_.end(); }
+
+    [[nodiscard]] bool empty() const noexcept { return table_.empty(); }
+    [[nodiscard]] size_type size() const noexcept { return table_.size(); }
+    [[nodiscard]] size_type capacity() const noexcept { return table_.capacity(); }
+
+    void clear() noexcept { table_.clear(); }
+    void reserve(size_type n) { table_.reserve(n); }
+    void rehash(size_type n) { table_.rehash(n); }
+
+    std::pair<iterator, bool> insert(value_type const& value) {
+        return table_.emplace_key(value.first, value);
+    }
+
+    std::pair<iterator, bool> insert(value_type&& value) {
+        return table_.emplace_key(value.first, std::move(value));
+    }
+
+    template<typename It>
+    void insert(It first, It last) {
+        for (; first != last; ++first)
+            insert(*first);
+    }
+
+    void insert(std::initializer_list<value_type> il) {
+        insert(il.begin(), il.end());
+    }
+
+    // The element is constructed before the lookup, prefer `try_emplace()`.
+    template<typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        value_type value(std::forward<Args>(args)...);
+        return table_.emplace_key(value.first, std::move(value));
+    }
+
+    // Constructs the mapped value from `args` only if `key` is missing.
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(K const& key, Args&&... args) {
+        return table_.emplace_key(key, std::piecewise_construct,
+                                  std::forward_as_tuple(key),
+                                  std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+        return table_.emplace_key(key, std::piecewise_construct,
+                                  std::forward_as_tuple(std::move(key)),
+                                  std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+
+    template<typename M>
+    std::pair<iterator, bool> insert_or_assign(K const& key, M&& value) {
+        auto result = try_emplace(key, std::forward<M>(value));
+        if (!result.second)
+            result.first->second = std::forward<M>(value);
+        return result;
+    }
+
+    V& operator[](K const& key) {
+        return try_emplace(key).first->second;
+    }
+
+    V& operator[](K&& key) {
+        return try_emplace(std::move(key)).first->second;
+    }
+
+    [[nodiscard]] V& at(K const& key) {
+        return at_impl(*this, key);
+    }
+
+    [[nodiscard]] V const& at(K const& key) const {
+        return at_impl(*this, key);
+    }
+
+    // The mapped value, without the iterator: a single pointer, empty when absent.
+    [[nodiscard]] maybe<V&> get(K const& key) { return get_impl(*this, key); }
+    [[nodiscard]] maybe<V const&> get(K const& key) const { return get_impl(*this, key); }
+
+    [[nodiscard]] iterator find(K const& key) { return table_.find(key); }
+    [[nodiscard]] const_iterator find(K const& key) const { return table_.find(key); }
+    [[nodiscard]] bool contains(K const& key) const { return table_.contains(key); }
+    [[nodiscard]] size_type count(K const& key) const { return table_.contains(key) ? 1 : 0; }
+    size_type erase(K const& key) { return table_.erase_key(key); }
+
+    // Heterogeneous lookup, enabled when both Hash and Eq are transparent.
+
+    template<internal_flat::lookup_key<Hash, Eq, K> U>
+    [[nodiscard]] V& at(U const& key) {
+        return at_impl(*this, key);
+    }
+
+    template<internal_flat::lookup_key<Hash, Eq, K> U>
+    [[nodiscard]] V const& at(U const& key) const {
+        return at_impl(*this, key);
+    }
+
+    template<internal_flat::lookup_key<Hash, Eq, K> U>
+    [[nodiscard]] maybe<V&> get(U const& key) { return get_impl(*this, key); }
+
+    template<internal_flat::lookup_key<Hash, Eq, K> U>
+    [[nodiscard]] maybe<V const&> get(U const& key) const { return get_impl(*this, key); }
+
+    template<internal_flat::lookup_key<Hash, Eq, K> U>
+    [[nodiscard]] iterator find(U const& key) { return table_.find(key); }
+
+    template<internal_flat::lookup_key<Hash, Eq, K> U>
+    [[nodiscard]] const_iterator find(U const& key) const { return table_.find(key); }
+
+    template<internal_flat::lookup_key<Hash, Eq, K> U>
+    [[nodiscard]] bool contains(U const& key) const { return table_.contains(key); }
+
+    template<internal_flat::lookup_key<Hash, Eq, K> U>
+    [[nodiscard]] size_type count(U const& key) const { return table_.contains(key) ? 1 : 0; }
+
+    template<internal_flat::lookup_key<Hash, Eq, K> U>
+        requires(!std::is_convertible_v<U const&, const_iterator>)
+    size_type erase(U const& key) { return table_.erase_key(key); }
+
+    // Returns the iterator following `it`. With niche keys, erasing while
+    // iterating may visit an element twice when its cluster wraps around the end,
+    // use erase_if instead.
+    iterator erase(const_iterator it) {
+        return table_.erase(it);
+    }
+
+    iterator erase(iterator it) {
+        return table_.erase(const_iterator(it));
+    }
+
+    void swap(flat_map& other) noexcept {
+        table_.swap(other.table_);
+    }
+
+    friend void swap(flat_map& a, flat_map& b) noexcept {
+        a.swap(b);
+    }
+
+    // Erases the elements for which `pred(element)` is true, like std::erase_if.
+    template<typename Pred>
+    friend size_type erase_if(flat_map& map, Pred pred) {
+        return map.table_.erase_if(pred);
+    }
+
+    hasher hash_function() const { return table_.hash_function(); }
+    key_equal key_eq() const { return table_.key_eq(); }
+    allocator_type get_allocator() const { return table_.get_allocator(); }
+
+private:
+    template<typename Self, typename U>
+    static auto& at_impl(Self& self, U const& key) {
+        auto it = self.find(key);
+        if (it == self.end())
+            TSL_THROW(std::out_of_range("tsl::flat_map::at"));
+        return it->second;
+    }
+
+    template<typename Self, typename U>
+    static auto get_impl(Self& self, U const& key) {
+        auto it = self.find(key);
+        using R = maybe<decltype((it->second))>;
+        if (it == self.end())
+            return R();
+        return R(it->second);
+    }
+
+    table_type table_;
+};
+
+}
+
+#endif // _TSL_CONTAINERS_FLAT_MAP_HPP
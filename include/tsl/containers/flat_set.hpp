@@ -0,0 +1,140 @@
+// An open-addressing hash set storing its elements inline, in a single array.
+// See tsl/internal/raw_flat_table.hpp for the layout.
+//
+// Unlike std::unordered_set, pointers and iterators are invalidated by any insertion
+// that grows the table and by erasure.
+#ifndef _TSL_CONTAINERS_FLAT_SET_HPP
+#define _TSL_CONTAINERS_FLAT_SET_HPP
+
+#include <initializer_list>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "tsl/hash.hpp"
+#include "tsl/internal/raw_flat_table.hpp"
+
+namespace tsl {
+
+template<typename K,
+         typename Hash = tsl::hash<K>,
+         typename Eq = tsl::equal_to<K>,
+         typename Alloc = std::allocator<K>>
+class flat_set {
+    using table_type = internal_flat::raw_table<internal_flat::set_traits<K>, Hash, Eq, Alloc>;
+
+public:
+    using key_type = K;
+    using value_type = K;
+    using size_type = std::size_t;
+    using hasher = Hash;
+    using key_equal = Eq;
+    using allocator_type = Alloc;
+    // Elements can't be modified in place, both iterators are constant.
+    using iterator = typename table_type::const_iterator;
+    using const_iterator = typename table_type::const_iterator;
+
+    // True when empty slots are marked with the key's niche instead of control bytes.
+    static constexpr bool uses_niche = table_type::uses_niche;
+
+    flat_set() = default;
+
+    explicit flat_set(size_type bucket_count, Hash const& hash = Hash(),
+                      Eq const& eq = Eq(), Alloc const& alloc = Alloc())
+        : table_(bucket_count, hash, eq, alloc) { }
+
+    flat_set(std::initializer_list<K> il, size_type bucket_count = 0)
+        : table_(bucket_count != 0 ? bucket_count : il.size())
+    {
+        insert(il.begin(), il.end());
+    }
+
+    const_iterator begin() const noexcept { return table_.begin(); }
+    const_iterator end() const noexcept { return table_.end(); }
+    const_iterator cbegin() const noexcept { return table_.begin(); }
+    const_iterator cend() const noexcept { return table_.end(); }
+
+    [[nodiscard]] bool empty() const noexcept { return table_.empty(); }
+    [[nodiscard]] size_type size() const noexcept { return table_.size(); }
+    [[nodiscard]] size_type capacity() const noexcept { return table_.capacity(); }
+
+    void clear() noexcept { table_.clear(); }
+    void reserve(size_type n) { table_.reserve(n); }
+    void rehash(size_type n) { table_.rehash(n); }
+
+    std::pair<const_iterator, bool> insert(K const& key) {
+        return table_.emplace_key(key, key);
+    }
+
+    std::pair<const_iterator, bool> insert(K&& key) {
+        return table_.emplace_key(key, std::move(key));
+    }
+
+    template<typename It>
+    void insert(It first, It last) {
+        for (; first != last; ++first)
+            insert(*first);
+    }
+
+    void insert(std::initializer_list<K> il) {
+        insert(il.begin(), il.end());
+    }
+
+    template<typename... Args>
+    std::pair<const_iterator, bool> emplace(Args&&... args) {
+        K key(std::forward<Args>(args)...);
+        return table_.emplace_key(key, std::move(key));
+    }
+
+    [[nodiscard]] const_iterator find(K const& key) const { return table_.find(key); }
+    [[nodiscard]] bool contains(K const& key) const { return table_.contains(key); }
+    [[nodiscard]] size_type count(K const& key) const { return table_.contains(key) ? 1 : 0; }
+    size_type erase(K const& key) { return table_.erase_key(key); }
+
+    // Heterogeneous lookup, enabled when both Hash and Eq are transparent.
+
+    template<internal_flat::lookup_key<Hash, Eq, K> U>
+    [[nodiscard]] const_iterator find(U const& key) const { return table_.find(key); }
+
+    template<internal_flat::lookup_key<Hash, Eq, K> U>
+    [[nodiscard]] bool contains(U const& key) const { return table_.contains(key); }
+
+    template<internal_flat::lookup_key<Hash, Eq, K> U>
+    [[nodiscard]] size_type count(U const& key) const { return table_.contains(key) ? 1 : 0; }
+
+    template<internal_flat::lookup_key<Hash, Eq, K> U>
+        requires(!std::is_convertible_v<U const&, const_iterator>)
+    size_type erase(U const& key) { return table_.erase_key(key); }
+
+    // Returns the iterator following `it`. With niche keys, erasing while
+    // iterating may visit an element twice when its cluster wraps around the end,
+    // use erase_if instead.
+    const_iterator erase(const_iterator it) {
+        return table_.erase(it);
+    }
+
+    void swap(flat_set& other) noexcept {
+        table_.swap(other.table_);
+    }
+
+    friend void swap(flat_set& a, flat_set& b) noexcept {
+        a.swap(b);
+    }
+
+    // Erases the keys for which `pred(key)` is true, like std::erase_if.
+    template<typename Pred>
+    friend size_type erase_if(flat_set& set, Pred pred) {
+        auto on_key = [&pred](K const& key) -> bool { return pred(key); };
+        return set.table_.erase_if(on_key);
+    }
+
+    hasher hash_function() const { return table_.hash_function(); }
+    key_equal key_eq() const { return table_.key_eq(); }
+    allocator_type get_allocator() const { return table_.get_allocator(); }
+
+private:
+    table_type table_;
+};
+
+}
+
+#endif // _TSL_CONTAINERS_FLAT_SET_HPP
@@ -0,0 +1,369 @@
+// A chained hash table of objects that carry their own links.
+//
+//     struct by_fd;
+//     struct connection : tsl::hash_hook<by_fd> { int fd; ... };
+//     struct fd_of {
+//         int operator()(connection const& c) const noexcept { return c.fd; }
+//     };
+//
+//     tsl::intrusive_hash_table<connection, fd_of, by_fd> connections(1024);
+//     connections.insert(c);
+//     tsl::maybe<connection&> found = connections.find(fd);
+//     connections.erase(c);
+//
+// The links and the element's hash live in a hash_hook base of the element. Only the
+// bucket array is allocated, by the constructor and by `rehash`: insertion never grows
+// the table, so it never allocates, and the load factor is the caller's to watch.
+// Chains are doubly linked, so an element is removed in O(1) given only a reference
+// to it. Keys are unique and are read with `KeyOf`; they must not change while the
+// element is in the table.
+//
+// Like tsl::intrusive_list, an object can be in one table per hook tag, the table
+// doesn't own its elements, and inserting an element that is already linked, or
+// destroying one that is still linked, fails a hardening assertion.
+#ifndef _TSL_CONTAINERS_INTRUSIVE_HASH_TABLE_HPP
+#define _TSL_CONTAINERS_INTRUSIVE_HASH_TABLE_HPP
+
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "tsl/hash.hpp"
+#include "tsl/internal/raw_flat_table.hpp"
+#include "tsl/macros.hpp"
+#include "tsl/maybe.hpp"
+
+namespace tsl {
+
+namespace internal_intrusive {
+
+struct hash_node {
+    hash_node* next = nullptr;
+    // The link pointing to this node, either a bucket or the previous node's `next`.
+    hash_node** pprev = nullptr;
+    std::size_t hash = 0;
+};
+
+}
+
+template<typename Tag = void>
+class hash_hook : public internal_intrusive::hash_node {
+public:
+    constexpr hash_hook() noexcept = default;
+
+    // Copies are unlinked.
+    constexpr hash_hook(hash_hook const&) noexcept { }
+    constexpr hash_hook& operator=(hash_hook const&) noexcept { return *this; }
+
+    ~hash_hook() {
+        TSL_HARDENING_ASSERT(!is_linked());
+    }
+
+    [[nodiscard]] constexpr bool is_linked() const noexcept {
+        return pprev != nullptr;
+    }
+};
+
+template<typename T, typename KeyOf, typename Tag = void,
+         typename Hash = tsl::hash<std::remove_cvref_t<std::invoke_result_t<KeyOf const&, T const&>>>,
+         typename Eq = tsl::equal_to<std::remove_cvref_t<std::invoke_result_t<KeyOf const&, T const&>>>>
+    requires(std::derived_from<T, hash_hook<Tag>>)
+class intrusive_hash_table {
+    using node = internal_intrusive::hash_node;
+    using hook = hash_hook<Tag>;
+
+public:
+    using key_type = std::remove_cvref_t<std::invoke_result_t<KeyOf const&, T const&>>;
+    using value_type = T;
+    using size_type = std::size_t;
+    using hasher = Hash;
+    using key_equal = Eq;
+
+private:
+    template<bool Const>
+    class basic_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<Const, T const&, T&>;
+        using pointer = std::conditional_t<Const, T const*, T*>;
+
+        basic_iterator() noexcept = default;
+
+        template<bool C = Const>
+            requires(C)
+        basic_iterator(basic_iterator<false> const& other) noexcept
+            : table_(other.table_), bucket_(other.bucket_), node_(other.node_) { }
+
+        reference operator*() const noexcept { return element(node_); }
+        pointer operator->() const noexcept { return &element(node_); }
+
+        basic_iterator& operator++() noexcept {
+            node_ = node_->next;
+            if (node_ == nullptr)
+                next_bucket(bucket_ + 1);
+            return *this;
+        }
+
+        basic_iterator operator++(int) noexcept {
+            basic_iterator it = *this;
+            ++*this;
+            return it;
+        }
+
+        friend bool operator==(basic_iterator const& a, basic_iterator const& b) noexcept {
+            return a.node_ == b.node_;
+        }
+
+    private:
+        friend class intrusive_hash_table;
+        template<bool> friend class basic_iterator;
+
+        basic_iterator(intrusive_hash_table const* table, size_type bucket) noexcept
+            : table_(table)
+        {
+            next_bucket(bucket);
+        }
+
+        void next_bucket(size_type bucket) noexcept {
+            for (; bucket < table_->bucket_count(); ++bucket) {
+                if (table_->buckets_[bucket] != nullptr) {
+                    bucket_ = bucket;
+                    node_ = table_->buckets_[bucket];
+                    return;
+                }
+            }
+            node_ = nullptr;
+        }
+
+        intrusive_hash_table const* table_ = nullptr;
+        size_type bucket_ = 0;
+        node* node_ = nullptr;
+    };
+
+public:
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    // `bucket_count` is rounded up to a power of two.
+    explicit intrusive_hash_table(size_type bucket_count = 64, KeyOf const& key_of = KeyOf(),
+                                  Hash const& hash = Hash(), Eq const& eq = Eq())
+        : key_of_(key_of), hash_(hash), eq_(eq)
+    {
+        allocate(bucket_count);
+    }
+
+    intrusive_hash_table(intrusive_hash_table const&) = delete;
+    intrusive_hash_table& operator=(intrusive_hash_table const&) = delete;
+
+    // Chains keep pointing into the same bucket array, so moving relinks nothing.
+    intrusive_hash_table(intrusive_hash_table&& other) noexcept
+        : buckets_(std::move(other.buckets_)), mask_(other.mask_), size_(other.size_),
+          key_of_(std::move(other.key_of_)), hash_(std::move(other.hash_)), eq_(std::move(other.eq_))
+    {
+        other.mask_ = static_cast<size_type>(-1);
+        other.size_ = 0;
+    }
+
+    intrusive_hash_table& operator=(intrusive_hash_table&& other) noexcept {
+        if (this != &other) {
+            clear();
+            buckets_ = std::move(other.buckets_);
+            mask_ = other.mask_;
+            size_ = other.size_;
+            key_of_ = std::move(other.key_of_);
+            hash_ = std::move(other.hash_);
+            eq_ = std::move(other.eq_);
+            other.mask_ = static_cast<size_type>(-1);
+            other.size_ = 0;
+        }
+        return *this;
+    }
+
+    ~intrusive_hash_table() {
+        clear();
+    }
+
+    iterator begin() noexcept { return iterator(this, 0); }
+    iterator end() noexcept { return iterator(); }
+    const_iterator begin() const noexcept { return const_iterator(this, 0); }
+    const_iterator end() const noexcept { return const_iterator(); }
+
+    [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+    [[nodiscard]] size_type size() const noexcept { return size_; }
+    [[nodiscard]] size_type bucket_count() const noexcept { return mask_ + 1; }
+
+    [[nodiscard]] float load_factor() const noexcept {
+        return bucket_count() != 0 ? static_cast<float>(size_) / static_cast<float>(bucket_count()) : 0.0f;
+    }
+
+    // Links `value` unless an element with an equal key is present. Returns whether
+    // it was linked.
+    bool insert(T& value) noexcept {
+        node* n = static_cast<hook*>(&value);
+        TSL_HARDENING_ASSERT(n->pprev == nullptr);
+        TSL_HARDENING_ASSERT(bucket_count() != 0);
+        auto const& key = key_of_(static_cast<T const&>(value));
+        size_type h = hash_of(key);
+        if (find_node(key, h) != nullptr)
+            return false;
+        link(n, h);
+        ++size_;
+        return true;
+    }
+
+    [[nodiscard]] maybe<T&> find(key_type const& key) noexcept {
+        return to_maybe(find_node(key, hash_of(key)));
+    }
+
+    [[nodiscard]] maybe<T const&> find(key_type const& key) const noexcept {
+        return to_maybe(find_node(key, hash_of(key)));
+    }
+
+    [[nodiscard]] bool contains(key_type const& key) const noexcept {
+        return find_node(key, hash_of(key)) != nullptr;
+    }
+
+    // Heterogeneous lookup, enabled when both Hash and Eq are transparent.
+    template<internal_flat::lookup_key<Hash, Eq, key_type> U>
+    [[nodiscard]] maybe<T&> find(U const& key) noexcept {
+        return to_maybe(find_node(key, hash_of(key)));
+    }
+
+    template<internal_flat::lookup_key<Hash, Eq, key_type> U>
+    [[nodiscard]] maybe<T const&> find(U const& key) const noexcept {
+        return to_maybe(find_node(key, hash_of(key)));
+    }
+
+    template<internal_flat::lookup_key<Hash, Eq, key_type> U>
+    [[nodiscard]] bool contains(U const& key) const noexcept {
+        return find_node(key, hash_of(key)) != nullptr;
+    }
+
+    // Removes `value`, which must be in this table.
+    void erase(T& value) noexcept {
+        node* n = static_cast<hook*>(&value);
+        TSL_HARDENING_ASSERT(n->pprev != nullptr);
+        unlink(n);
+        --size_;
+    }
+
+    // Removes the element with key `key`, and returns it.
+    maybe<T&> erase(key_type const& key) noexcept {
+        return erase_node(find_node(key, hash_of(key)));
+    }
+
+    template<internal_flat::lookup_key<Hash, Eq, key_type> U>
+    maybe<T&> erase(U const& key) noexcept {
+        return erase_node(find_node(key, hash_of(key)));
+    }
+
+    // Unlinks every element.
+    void clear() noexcept {
+        for (size_type i = 0; i < bucket_count(); ++i) {
+            for (node* n = buckets_[i]; n != nullptr;) {
+                node* next = n->next;
+                n->next = nullptr;
+                n->pprev = nullptr;
+                n = next;
+            }
+            buckets_[i] = nullptr;
+        }
+        size_ = 0;
+    }
+
+    // Moves the elements to a new array of `bucket_count` buckets, rounded up to a
+    // power of two. The elements' hashes are stored, so no key is hashed again.
+    // If the allocation throws, the table is unchanged.
+    void rehash(size_type bucket_count) {
+        size_type count = rounded(bucket_count);
+        std::unique_ptr<node*[]> old = std::exchange(buckets_, std::make_unique<node*[]>(count));
+        size_type old_count = std::exchange(mask_, count - 1) + 1;
+        for (size_type i = 0; i < old_count; ++i) {
+            for (node* n = old[i]; n != nullptr;) {
+                node* next = n->next;
+                link(n, n->hash);
+                n = next;
+            }
+        }
+    }
+
+private:
+    static T& element(node* n) noexcept {
+        return static_cast<T&>(*static_cast<hook*>(n));
+    }
+
+    static maybe<T&> to_maybe(node* n) noexcept {
+        if (n == nullptr)
+            return {};
+        return element(n);
+    }
+
+    static size_type rounded(size_type bucket_count) noexcept {
+        return std::bit_ceil(bucket_count < 1 ? size_type(1) : bucket_count);
+    }
+
+    void allocate(size_type bucket_count) {
+        size_type count = rounded(bucket_count);
+        buckets_ = std::make_unique<node*[]>(count);
+        mask_ = count - 1;
+    }
+
+    template<typename U>
+    size_type hash_of(U const& key) const noexcept {
+        return internal_flat::mix(hash_(key));
+    }
+
+    template<typename U>
+    node* find_node(U const& key, size_type h) const noexcept {
+        if (bucket_count() == 0)
+            return nullptr;
+        for (node* n = buckets_[h & mask_]; n != nullptr; n = n->next) {
+            if (n->hash == h && eq_(key_of_(static_cast<T const&>(element(n))), key))
+                return n;
+        }
+        return nullptr;
+    }
+
+    void link(node* n, size_type h) noexcept {
+        node** head = &buckets_[h & mask_];
+        n->hash = h;
+        n->next = *head;
+        n->pprev = head;
+        if (*head != nullptr)
+            (*head)->pprev = &n->next;
+        *head = n;
+    }
+
+    static void unlink(node* n) noexcept {
+        *n->pprev = n->next;
+        if (n->next != nullptr)
+            n->next->pprev = n->pprev;
+        n->next = nullptr;
+        n->pprev = nullptr;
+    }
+
+    maybe<T&> erase_node(node* n) noexcept {
+        if (n == nullptr)
+            return {};
+        unlink(n);
+        --size_;
+        return element(n);
+    }
+
+    std::unique_ptr<node*[]> buckets_;
+    // bucket_count() - 1; all ones, so zero buckets, once moved from.
+    size_type mask_ = 0;
+    size_type size_ = 0;
+    [[no_unique_address]] KeyOf key_of_;
+    [[no_unique_address]] Hash hash_;
+    [[no_unique_address]] Eq eq_;
+};
+
+}
+
+#endif // _TSL_CONTAINERS_INTRUSIVE_HASH_TABLE_HPP
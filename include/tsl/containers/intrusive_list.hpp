@@ -0,0 +1,310 @@
+// A doubly-linked list of objects that carry their own links.
+//
+//     struct by_deadline;
+//     struct by_owner;
+//     struct timer : tsl::list_hook<by_deadline>, tsl::list_hook<by_owner> { ... };
+//
+//     tsl::intrusive_list<timer, by_deadline> pending;
+//     tsl::intrusive_list<timer, by_owner> owned;
+//     pending.push_back(t);
+//     owned.push_back(t);
+//     pending.erase(t);
+//
+// The links live in a list_hook base of the element, so insertion and removal never
+// allocate, and an element is removed in O(1) given only a reference to it. An object
+// can be in one list per hook, and the tag tells its hooks apart.
+//
+// The list doesn't own its elements: they must outlive their membership, and the
+// list unlinks the remaining ones when destroyed. Inserting an element that is
+// already linked, or destroying an element that is still linked, fails a hardening
+// assertion. Copying an element doesn't copy its links.
+#ifndef _TSL_CONTAINERS_INTRUSIVE_LIST_HPP
+#define _TSL_CONTAINERS_INTRUSIVE_LIST_HPP
+
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include "tsl/macros.hpp"
+#include "tsl/maybe.hpp"
+
+namespace tsl {
+
+namespace internal_intrusive {
+
+struct list_node {
+    list_node* next = nullptr;
+    list_node* prev = nullptr;
+};
+
+}
+
+template<typename Tag = void>
+class list_hook : public internal_intrusive::list_node {
+public:
+    constexpr list_hook() noexcept = default;
+
+    // Copies are unlinked.
+    constexpr list_hook(list_hook const&) noexcept { }
+    constexpr list_hook& operator=(list_hook const&) noexcept { return *this; }
+
+    ~list_hook() {
+        TSL_HARDENING_ASSERT(!is_linked());
+    }
+
+    [[nodiscard]] constexpr bool is_linked() const noexcept {
+        return next != nullptr;
+    }
+};
+
+template<typename T, typename Tag = void>
+    requires(std::derived_from<T, list_hook<Tag>>)
+class intrusive_list {
+    using node = internal_intrusive::list_node;
+    using hook = list_hook<Tag>;
+
+    template<bool Const>
+    class basic_iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<Const, T const&, T&>;
+        using pointer = std::conditional_t<Const, T const*, T*>;
+
+        basic_iterator() noexcept = default;
+
+        template<bool C = Const>
+            requires(C)
+        basic_iterator(basic_iterator<false> const& other) noexcept
+            : node_(other.node_) { }
+
+        reference operator*() const noexcept { return element(node_); }
+        pointer operator->() const noexcept { return &element(node_); }
+
+        basic_iterator& operator++() noexcept {
+            node_ = node_->next;
+            return *this;
+        }
+
+        basic_iterator operator++(int) noexcept {
+            basic_iterator it = *this;
+            node_ = node_->next;
+            return it;
+        }
+
+        basic_iterator& operator--() noexcept {
+            node_ = node_->prev;
+            return *this;
+        }
+
+        basic_iterator operator--(int) noexcept {
+            basic_iterator it = *this;
+            node_ = node_->prev;
+            return it;
+        }
+
+        friend bool operator==(basic_iterator const& a, basic_iterator const& b) noexcept {
+            return a.node_ == b.node_;
+        }
+
+    private:
+        friend class intrusive_list;
+        template<bool> friend class basic_iterator;
+
+        explicit basic_iterator(node* n) noexcept : node_(n) { }
+
+        node* node_ = nullptr;
+    };
+
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using reference = T&;
+    using const_reference = T const&;
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    intrusive_list() noexcept {
+        head_.next = head_.prev = &head_;
+    }
+
+    intrusive_list(intrusive_list const&) = delete;
+    intrusive_list& operator=(intrusive_list const&) = delete;
+
+    intrusive_list(intrusive_list&& other) noexcept : intrusive_list() {
+        take(other);
+    }
+
+    intrusive_list& operator=(intrusive_list&& other) noexcept {
+        if (this != &other) {
+            clear();
+            take(other);
+        }
+        return *this;
+    }
+
+    ~intrusive_list() {
+        clear();
+    }
+
+    iterator begin() noexcept { return iterator(head_.next); }
+    iterator end() noexcept { return iterator(&head_); }
+    const_iterator begin() const noexcept { return const_iterator(head_.next); }
+    const_iterator end() const noexcept { return const_iterator(const_cast<node*>(&head_)); }
+
+    [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+    [[nodiscard]] size_type size() const noexcept { return size_; }
+
+    T& front() noexcept {
+        TSL_HARDENING_ASSERT(!empty());
+        return element(head_.next);
+    }
+
+    T const& front() const noexcept {
+        TSL_HARDENING_ASSERT(!empty());
+        return element(head_.next);
+    }
+
+    T& back() noexcept {
+        TSL_HARDENING_ASSERT(!empty());
+        return element(head_.prev);
+    }
+
+    T const& back() const noexcept {
+        TSL_HARDENING_ASSERT(!empty());
+        return element(head_.prev);
+    }
+
+    void push_front(T& value) noexcept {
+        link_before(head_.next, value);
+    }
+
+    void push_back(T& value) noexcept {
+        link_before(&head_, value);
+    }
+
+    // Inserts `value` before `pos`.
+    iterator insert(const_iterator pos, T& value) noexcept {
+        return link_before(pos.node_, value);
+    }
+
+    maybe<T&> pop_front() noexcept {
+        if (empty())
+            return {};
+        T& value = element(head_.next);
+        unlink(head_.next);
+        return value;
+    }
+
+    maybe<T&> pop_back() noexcept {
+        if (empty())
+            return {};
+        T& value = element(head_.prev);
+        unlink(head_.prev);
+        return value;
+    }
+
+    // Removes `value`, which must be in this list.
+    void erase(T& value) noexcept {
+        node* n = static_cast<hook*>(&value);
+        TSL_HARDENING_ASSERT(n->next != nullptr);
+        unlink(n);
+    }
+
+    // Removes the element at `pos` and returns the next one.
+    iterator erase(const_iterator pos) noexcept {
+        node* next = pos.node_->next;
+        unlink(pos.node_);
+        return iterator(next);
+    }
+
+    // Moves `value`, which must be in this list, to the front.
+    void move_to_front(T& value) noexcept {
+        node* n = static_cast<hook*>(&value);
+        TSL_HARDENING_ASSERT(n->next != nullptr);
+        detach(n);
+        attach_before(head_.next, n);
+    }
+
+    // Moves `value`, which must be in this list, to the back.
+    void move_to_back(T& value) noexcept {
+        node* n = static_cast<hook*>(&value);
+        TSL_HARDENING_ASSERT(n->next != nullptr);
+        detach(n);
+        attach_before(&head_, n);
+    }
+
+    // Unlinks every element.
+    void clear() noexcept {
+        for (node* n = head_.next; n != &head_;) {
+            node* next = n->next;
+            n->next = n->prev = nullptr;
+            n = next;
+        }
+        head_.next = head_.prev = &head_;
+        size_ = 0;
+    }
+
+    // An iterator to `value`, which must be in this list.
+    static iterator iterator_to(T& value) noexcept {
+        return iterator(static_cast<hook*>(&value));
+    }
+
+    static const_iterator iterator_to(T const& value) noexcept {
+        return const_iterator(const_cast<hook*>(static_cast<hook const*>(&value)));
+    }
+
+private:
+    static T& element(node* n) noexcept {
+        return static_cast<T&>(*static_cast<hook*>(n));
+    }
+
+    static T const& element(node const* n) noexcept {
+        return static_cast<T const&>(*static_cast<hook const*>(n));
+    }
+
+    iterator link_before(node* pos, T& value) noexcept {
+        node* n = static_cast<hook*>(&value);
+        TSL_HARDENING_ASSERT(n->next == nullptr);
+        attach_before(pos, n);
+        ++size_;
+        return iterator(n);
+    }
+
+    static void attach_before(node* pos, node* n) noexcept {
+        n->next = pos;
+        n->prev = pos->prev;
+        pos->prev->next = n;
+        pos->prev = n;
+    }
+
+    static void detach(node* n) noexcept {
+        n->prev->next = n->next;
+        n->next->prev = n->prev;
+    }
+
+    void unlink(node* n) noexcept {
+        detach(n);
+        n->next = n->prev = nullptr;
+        --size_;
+    }
+
+    void take(intrusive_list& other) noexcept {
+        if (other.empty())
+            return;
+        head_.next = other.head_.next;
+        head_.prev = other.head_.prev;
+        head_.next->prev = head_.prev->next = &head_;
+        size_ = other.size_;
+        other.head_.next = other.head_.prev = &other.head_;
+        other.size_ = 0;
+    }
+
+    node head_;
+    size_type size_ = 0;
+};
+
+}
+
+#endif // _TSL_CONTAINERS_INTRUSIVE_LIST_HPP
@@ -0,0 +1,199 @@
+// A singly-linked stack of objects that carry their own link.
+//
+//     struct job : tsl::stack_hook<> { ... };
+//
+//     tsl::intrusive_stack<job> free_jobs;
+//     free_jobs.push(j);
+//     tsl::maybe<job&> next = free_jobs.pop();
+//
+// One pointer per element and no allocation, for free lists and work stacks. Like
+// tsl::intrusive_list, an object can be in one stack per hook tag, the stack doesn't
+// own its elements, and pushing an element that is already linked, or destroying one
+// that is still linked, fails a hardening assertion.
+#ifndef _TSL_CONTAINERS_INTRUSIVE_STACK_HPP
+#define _TSL_CONTAINERS_INTRUSIVE_STACK_HPP
+
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include "tsl/macros.hpp"
+#include "tsl/maybe.hpp"
+
+namespace tsl {
+
+namespace internal_intrusive {
+
+struct stack_node {
+    stack_node* next = nullptr;
+};
+
+// The link of the bottom element, so that a null link means unlinked.
+inline constinit stack_node stack_bottom;
+
+}
+
+template<typename Tag = void>
+class stack_hook : public internal_intrusive::stack_node {
+public:
+    constexpr stack_hook() noexcept = default;
+
+    // Copies are unlinked.
+    constexpr stack_hook(stack_hook const&) noexcept { }
+    constexpr stack_hook& operator=(stack_hook const&) noexcept { return *this; }
+
+    ~stack_hook() {
+        TSL_HARDENING_ASSERT(!is_linked());
+    }
+
+    [[nodiscard]] constexpr bool is_linked() const noexcept {
+        return next != nullptr;
+    }
+};
+
+template<typename T, typename Tag = void>
+    requires(std::derived_from<T, stack_hook<Tag>>)
+class intrusive_stack {
+    using node = internal_intrusive::stack_node;
+    using hook = stack_hook<Tag>;
+
+    // From the top to the bottom.
+    template<bool Const>
+    class basic_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<Const, T const&, T&>;
+        using pointer = std::conditional_t<Const, T const*, T*>;
+
+        basic_iterator() noexcept = default;
+
+        template<bool C = Const>
+            requires(C)
+        basic_iterator(basic_iterator<false> const& other) noexcept
+            : node_(other.node_) { }
+
+        reference operator*() const noexcept { return element(node_); }
+        pointer operator->() const noexcept { return &element(node_); }
+
+        basic_iterator& operator++() noexcept {
+            node_ = node_->next;
+            return *this;
+        }
+
+        basic_iterator operator++(int) noexcept {
+            basic_iterator it = *this;
+            node_ = node_->next;
+            return it;
+        }
+
+        friend bool operator==(basic_iterator const& a, basic_iterator const& b) noexcept {
+            return a.node_ == b.node_;
+        }
+
+    private:
+        friend class intrusive_stack;
+        template<bool> friend class basic_iterator;
+
+        explicit basic_iterator(node* n) noexcept : node_(n) { }
+
+        node* node_ = &internal_intrusive::stack_bottom;
+    };
+
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using reference = T&;
+    using const_reference = T const&;
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    constexpr intrusive_stack() noexcept = default;
+
+    intrusive_stack(intrusive_stack const&) = delete;
+    intrusive_stack& operator=(intrusive_stack const&) = delete;
+
+    intrusive_stack(intrusive_stack&& other) noexcept
+        : top_(other.top_), size_(other.size_)
+    {
+        other.top_ = &internal_intrusive::stack_bottom;
+        other.size_ = 0;
+    }
+
+    intrusive_stack& operator=(intrusive_stack&& other) noexcept {
+        if (this != &other) {
+            clear();
+            top_ = other.top_;
+            size_ = other.size_;
+            other.top_ = &internal_intrusive::stack_bottom;
+            other.size_ = 0;
+        }
+        return *this;
+    }
+
+    ~intrusive_stack() {
+        clear();
+    }
+
+    iterator begin() noexcept { return iterator(top_); }
+    iterator end() noexcept { return iterator(); }
+    const_iterator begin() const noexcept { return const_iterator(top_); }
+    const_iterator end() const noexcept { return const_iterator(); }
+
+    [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+    [[nodiscard]] size_type size() const noexcept { return size_; }
+
+    maybe<T&> top() noexcept {
+        if (empty())
+            return {};
+        return element(top_);
+    }
+
+    maybe<T const&> top() const noexcept {
+        if (empty())
+            return {};
+        return element(top_);
+    }
+
+    void push(T& value) noexcept {
+        node* n = static_cast<hook*>(&value);
+        TSL_HARDENING_ASSERT(n->next == nullptr);
+        n->next = top_;
+        top_ = n;
+        ++size_;
+    }
+
+    maybe<T&> pop() noexcept {
+        if (empty())
+            return {};
+        node* n = top_;
+        top_ = n->next;
+        n->next = nullptr;
+        --size_;
+        return element(n);
+    }
+
+    // Unlinks every element.
+    void clear() noexcept {
+        for (node* n = top_; n != &internal_intrusive::stack_bottom;) {
+            node* next = n->next;
+            n->next = nullptr;
+            n = next;
+        }
+        top_ = &internal_intrusive::stack_bottom;
+        size_ = 0;
+    }
+
+private:
+    static T& element(node* n) noexcept {
+        return static_cast<T&>(*static_cast<hook*>(n));
+    }
+
+    node* top_ = &internal_intrusive::stack_bottom;
+    size_type size_ = 0;
+};
+
+}
+
+#endif // _TSL_CONTAINERS_INTRUSIVE_STACK_HPP
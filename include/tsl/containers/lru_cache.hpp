@@ -0,0 +1,322 @@
+// A concurrent cache evicting approximately least recently used entries.
+//
+//     tsl::lru_cache<std::string, profile> cache(10000);
+//     tsl::maybe<profile> p = cache.get(name);
+//     profile q = cache.get_or_compute(name, [](std::string const& n) { return load(n); });
+//
+// Keys are spread over shards by hash, each with its own lock. Within a shard,
+// eviction follows the CLOCK algorithm: a hit only sets the entry's reference bit,
+// and the clock hand gives referenced entries a second chance, so hits don't reorder
+// a list. Values are returned by copy, since other threads may evict the entry.
+//
+// The capacity is a total weight, split evenly between the shards. By default every
+// entry weighs 1; pass a `Weigher` returning the size in bytes to bound memory instead.
+//
+// Concurrent `get_or_compute` misses of the same key run `compute` once, the other
+// callers wait for its result.
+#ifndef _TSL_CONTAINERS_LRU_CACHE_HPP
+#define _TSL_CONTAINERS_LRU_CACHE_HPP
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "tsl/containers/flat_map.hpp"
+#include "tsl/defer.hpp"
+#include "tsl/hash.hpp"
+#include "tsl/internal/cache_line.hpp"
+#include "tsl/maybe.hpp"
+
+namespace tsl {
+
+struct lru_unit_weight {
+    template<typename K, typename V>
+    constexpr std::size_t operator()(K const&, V const&) const noexcept {
+        return 1;
+    }
+};
+
+struct lru_cache_stats {
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t evictions = 0;
+    // get_or_compute misses served by a computation already running in another thread.
+    std::uint64_t coalesced = 0;
+};
+
+template<typename K, typename V,
+         typename Hash = tsl::hash<K>,
+         typename Eq = tsl::equal_to<K>,
+         typename Weigher = lru_unit_weight>
+class lru_cache {
+    static_assert(std::copy_constructible<V>, "values are returned by copy");
+
+    struct node {
+        maybe<std::pair<K, V>> item;
+        std::size_t weight = 0;
+        bool referenced = false;
+    };
+
+    struct flight {
+        bool done = false;
+        maybe<V> value;
+    };
+
+    struct alignas(internal::cache_line_size) shard {
+        std::mutex mutex;
+        std::condition_variable computed;
+        flat_map<K, std::uint32_t, Hash, Eq> index;
+        flat_map<K, std::shared_ptr<flight>, Hash, Eq> flights;
+        std::vector<node> nodes;
+        std::vector<std::uint32_t> free;
+        std::size_t hand = 0;
+        std::size_t weight = 0;
+        std::size_t capacity = 0;
+        lru_cache_stats stats;
+    };
+
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using size_type = std::size_t;
+
+    // `shards` is rounded up to a power of two, then lowered until every shard gets a
+    // capacity of 8 or more, so small caches aren't split into shards of one entry.
+    explicit lru_cache(size_type capacity, size_type shards = 16,
+                       Hash const& hash = Hash(), Weigher const& weigher = Weigher())
+        : shard_count_(std::min(std::bit_ceil(shards > 0 ? shards : 1),
+                                std::bit_floor(std::max(capacity / 8, size_type(1))))),
+          shards_(std::make_unique<shard[]>(shard_count_)),
+          hash_(hash), weigher_(weigher)
+    {
+        for (size_type i = 0; i < shard_count_; ++i)
+            shards_[i].capacity = capacity / shard_count_ + (i < capacity % shard_count_);
+    }
+
+    lru_cache(lru_cache const&) = delete;
+    lru_cache& operator=(lru_cache const&) = delete;
+
+    [[nodiscard]] maybe<V> get(K const& key) {
+        shard& s = shard_for(key);
+        std::lock_guard lock(s.mutex);
+        return lookup(s, key);
+    }
+
+    [[nodiscard]] bool contains(K const& key) const {
+        shard& s = shard_for(key);
+        std::lock_guard lock(s.mutex);
+        return s.index.contains(key);
+    }
+
+    // Inserts or replaces the value of `key`, then evicts down to the capacity.
+    // An entry heavier than its shard's capacity is evicted right away.
+    void put(K const& key, V value) {
+        shard& s = shard_for(key);
+        std::lock_guard lock(s.mutex);
+        store(s, key, std::move(value));
+    }
+
+    bool erase(K const& key) {
+        shard& s = shard_for(key);
+        std::lock_guard lock(s.mutex);
+        auto it = s.index.find(key);
+        if (it == s.index.end())
+            return false;
+        std::uint32_t slot = it->second;
+        s.index.erase(it);
+        release(s, slot);
+        return true;
+    }
+
+    // The cached value of `key`, or `compute(key)`, which is then cached.
+    // The shard isn't locked while `compute` runs. If it throws, the exception
+    // propagates and one of the waiting callers, if any, computes the value again.
+    template<typename F>
+        requires(std::convertible_to<std::invoke_result_t<F&, K const&>, V>)
+    V get_or_compute(K const& key, F&& compute) {
+        shard& s = shard_for(key);
+        std::unique_lock lock(s.mutex);
+        std::shared_ptr<flight> f;
+        for (;;) {
+            if (auto v = lookup(s, key); v.has_value())
+                return *std::move(v);
+            auto it = s.flights.find(key);
+            if (it == s.flights.end())
+                break;
+            f = it->second;
+            s.computed.wait(lock, [&] { return f->done; });
+            if (f->value.has_value()) {
+                ++s.stats.coalesced;
+                return *f->value;
+            }
+            // The computation failed, the miss is counted again.
+            --s.stats.misses;
+        }
+
+        f = std::make_shared<flight>();
+        s.flights.try_emplace(key, f);
+        lock.unlock();
+
+        TSL_DEFER {
+            if (!lock.owns_lock())
+                lock.lock();
+            f->done = true;
+            s.flights.erase(key);
+            s.computed.notify_all();
+        };
+
+        V value = std::invoke(compute, key);
+        lock.lock();
+        f->value.emplace(value);
+        store(s, key, value);
+        return value;
+    }
+
+    void clear() {
+        for (size_type i = 0; i < shard_count_; ++i) {
+            shard& s = shards_[i];
+            std::lock_guard lock(s.mutex);
+            s.index.clear();
+            s.nodes.clear();
+            s.free.clear();
+            s.hand = 0;
+            s.weight = 0;
+        }
+    }
+
+    // Number of entries. Shards are locked one at a time, so it's not a snapshot.
+    [[nodiscard]] size_type size() const {
+        return sum([](shard const& s) { return s.index.size(); });
+    }
+
+    // Total weight of the entries.
+    [[nodiscard]] size_type weight() const {
+        return sum([](shard const& s) { return s.weight; });
+    }
+
+    [[nodiscard]] lru_cache_stats stats() const {
+        lru_cache_stats total;
+        for (size_type i = 0; i < shard_count_; ++i) {
+            shard& s = shards_[i];
+            std::lock_guard lock(s.mutex);
+            total.hits += s.stats.hits;
+            total.misses += s.stats.misses;
+            total.evictions += s.stats.evictions;
+            total.coalesced += s.stats.coalesced;
+        }
+        return total;
+    }
+
+private:
+    shard& shard_for(K const& key) const {
+        // The high bits, the flat_map of the shard uses the low ones.
+        std::size_t h = internal_flat::mix(hash_(key));
+        return shards_[(h >> 32) & (shard_count_ - 1)];
+    }
+
+    template<typename F>
+    size_type sum(F f) const {
+        size_type total = 0;
+        for (size_type i = 0; i < shard_count_; ++i) {
+            std::lock_guard lock(shards_[i].mutex);
+            total += f(shards_[i]);
+        }
+        return total;
+    }
+
+    static maybe<V> lookup(shard& s, K const& key) {
+        auto it = s.index.find(key);
+        if (it == s.index.end()) {
+            ++s.stats.misses;
+            return {};
+        }
+        ++s.stats.hits;
+        node& n = s.nodes[it->second];
+        n.referenced = true;
+        return n.item->second;
+    }
+
+    void store(shard& s, K const& key, V value) {
+        std::size_t w = weigher_(key, value);
+        auto it = s.index.find(key);
+        // Too heavy to ever fit, the other entries stay.
+        if (w > s.capacity) {
+            if (it != s.index.end()) {
+                std::uint32_t slot = it->second;
+                s.index.erase(it);
+                release(s, slot);
+            }
+            ++s.stats.evictions;
+            return;
+        }
+        if (it != s.index.end()) {
+            node& n = s.nodes[it->second];
+            s.weight = s.weight - n.weight + w;
+            n.item->second = std::move(value);
+            n.weight = w;
+            n.referenced = true;
+        } else {
+            std::uint32_t slot;
+            if (!s.free.empty()) {
+                slot = s.free.back();
+                s.free.pop_back();
+            } else {
+                slot = static_cast<std::uint32_t>(s.nodes.size());
+                s.nodes.emplace_back();
+            }
+            node& n = s.nodes[slot];
+            n.item.emplace(key, std::move(value));
+            n.weight = w;
+            // Referenced, so that the hand passes over it once: otherwise an entry
+            // inserted right behind the hand would be the next one evicted.
+            n.referenced = true;
+            s.weight += w;
+            s.index.try_emplace(key, slot);
+        }
+        evict(s);
+    }
+
+    // Advances the clock hand until the shard fits, clearing reference bits on the
+    // way. Every entry is evicted after two turns at most.
+    static void evict(shard& s) {
+        while (s.weight > s.capacity) {
+            if (s.hand >= s.nodes.size())
+                s.hand = 0;
+            node& n = s.nodes[s.hand];
+            if (n.item.has_value()) {
+                if (n.referenced) {
+                    n.referenced = false;
+                } else {
+                    s.index.erase(n.item->first);
+                    release(s, static_cast<std::uint32_t>(s.hand));
+                    ++s.stats.evictions;
+                }
+            }
+            ++s.hand;
+        }
+    }
+
+    static void release(shard& s, std::uint32_t slot) {
+        node& n = s.nodes[slot];
+        s.weight -= n.weight;
+        n.item.reset();
+        n.weight = 0;
+        s.free.push_back(slot);
+    }
+
+    size_type shard_count_;
+    std::unique_ptr<shard[]> shards_;
+    [[no_unique_address]] Hash hash_;
+    [[no_unique_address]] Weigher weigher_;
+};
+
+}
+
+#endif // _TSL_CONTAINERS_LRU_CACHE_HPP
@@ -0,0 +1,223 @@
+// An array of non_negative values stored in exactly `Bits` bits each.
+//
+//     tsl::packed_array<20> ids(n);                            // non_negative<int64_t>
+//     tsl::packed_array<20, tsl::maybe<tsl::non_negative<int>>> parents(n);
+//
+// With a maybe value type, the all-ones pattern is reserved for the empty state, so
+// values go up to 2^Bits - 2 and no extra bit is used.
+//
+// Elements are laid out back to back in 64-bit words, with a padding word at the end,
+// so any element is read from two adjacent words without a branch. `unpack` decodes
+// blocks of 64 elements, which span exactly `Bits` words, with shifts known at compile
+// time.
+#ifndef _TSL_CONTAINERS_PACKED_ARRAY_HPP
+#define _TSL_CONTAINERS_PACKED_ARRAY_HPP
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vector>
+#include "tsl/macros.hpp"
+#include "tsl/maybe.hpp"
+#include "tsl/types/non_negative.hpp"
+
+namespace tsl {
+
+namespace internal_packed {
+
+template<typename V>
+struct value_traits;
+
+template<std::signed_integral T>
+struct value_traits<non_negative<T>> {
+    using int_type = T;
+    static constexpr bool nullable = false;
+
+    static constexpr std::uint64_t encode(non_negative<T> const& v) noexcept {
+        return static_cast<std::uint64_t>(v.raw());
+    }
+
+    static constexpr non_negative<T> decode(std::uint64_t bits, std::uint64_t) noexcept {
+        return non_negative<T>(unchecked, static_cast<T>(bits));
+    }
+};
+
+template<internal_types::maybe_non_negative V>
+struct value_traits<V> {
+    using int_type = internal_types::maybe_non_negative_int<V>;
+    static constexpr bool nullable = true;
+
+    static constexpr std::uint64_t encode(V const& v, std::uint64_t mask) noexcept {
+        return v.has_value() ? static_cast<std::uint64_t>(v->raw()) : mask;
+    }
+
+    static constexpr V decode(std::uint64_t bits, std::uint64_t mask) noexcept {
+        if (bits == mask)
+            return {};
+        return non_negative<int_type>(unchecked, static_cast<int_type>(bits));
+    }
+};
+
+}
+
+template<unsigned Bits, typename V = non_negative<std::int64_t>>
+class packed_array {
+    using traits = internal_packed::value_traits<V>;
+    using int_type = typename traits::int_type;
+
+    static_assert(Bits >= 1 && Bits <= static_cast<unsigned>(std::numeric_limits<int_type>::digits),
+                  "Bits must fit the non-negative range of the value type");
+
+    static constexpr std::uint64_t mask = (std::uint64_t(1) << Bits) - 1;
+
+public:
+    using value_type = V;
+    using size_type = std::size_t;
+
+    static constexpr unsigned bits = Bits;
+
+    // Largest storable value.
+    static constexpr std::uint64_t max_value = traits::nullable ? mask - 1 : mask;
+
+    packed_array() : words_(1) { }
+
+    // `n` zeros, or `n` empty values with a maybe value type.
+    explicit packed_array(size_type n) : words_(word_count(n)) {
+        if constexpr (traits::nullable) {
+            for (size_type i = 0; i < n; ++i)
+                store(i, mask);
+        }
+        size_ = n;
+    }
+
+    [[nodiscard]] size_type size() const noexcept { return size_; }
+    [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+    // Bytes used by the elements, including the padding word.
+    [[nodiscard]] size_type memory_size() const noexcept { return words_.size() * sizeof(std::uint64_t); }
+
+    void reserve(size_type n) {
+        words_.reserve(word_count(n));
+    }
+
+    void resize(size_type n) {
+        if (n < size_) {
+            // Elements past the end must read as zero again when the array grows.
+            for (size_type i = n; i < size_; ++i)
+                store(i, 0);
+            size_ = n;
+            words_.resize(word_count(n));
+            return;
+        }
+        words_.resize(word_count(n));
+        size_type old = size_;
+        size_ = n;
+        if constexpr (traits::nullable) {
+            for (size_type i = old; i < n; ++i)
+                store(i, mask);
+        }
+    }
+
+    void clear() noexcept {
+        words_.assign(1, 0);
+        size_ = 0;
+    }
+
+    void push_back(V const& value) {
+        words_.resize(word_count(size_ + 1));
+        ++size_;
+        set(size_ - 1, value);
+    }
+
+    [[nodiscard]] V get(size_type i) const noexcept {
+        TSL_HARDENING_ASSERT(i < size_);
+        return traits::decode(load(i), mask);
+    }
+
+    [[nodiscard]] V operator[](size_type i) const noexcept {
+        return get(i);
+    }
+
+    void set(size_type i, V const& value) noexcept {
+        TSL_HARDENING_ASSERT(i < size_);
+        std::uint64_t bits;
+        if constexpr (traits::nullable)
+            bits = traits::encode(value, mask);
+        else
+            bits = traits::encode(value);
+        TSL_HARDENING_ASSERT(bits <= max_value || (traits::nullable && bits == mask));
+        store(i, bits);
+    }
+
+    // Decodes `out.size()` elements starting at `first`.
+    void unpack(size_type first, std::span<V> out) const noexcept {
+        TSL_HARDENING_ASSERT(first <= size_ && out.size() <= size_ - first);
+        size_type n = out.size();
+        // Element by element up to a block boundary, where elements start at bit 0.
+        size_type head = std::min(n, (64 - first % 64) % 64);
+        size_type blocks = (n - head) / 64;
+        for (size_type i = 0; i < head; ++i)
+            out[i] = traits::decode(load(first + i), mask);
+        V* dst = out.data() + head;
+        std::uint64_t const* src = words_.data() + (first + head) / 64 * Bits;
+        for (size_type b = 0; b < blocks; ++b, dst += 64, src += Bits)
+            unpack_block(src, dst, std::make_index_sequence<64>());
+        for (size_type i = head + blocks * 64; i < n; ++i)
+            out[i] = traits::decode(load(first + i), mask);
+    }
+
+    friend bool operator==(packed_array const& a, packed_array const& b) noexcept {
+        return a.size_ == b.size_ && a.words_ == b.words_;
+    }
+
+private:
+    static constexpr size_type word_count(size_type n) noexcept {
+        return (n * Bits + 63) / 64 + 1;
+    }
+
+    // The second word is shifted in two steps, so a zero offset doesn't shift by 64.
+    std::uint64_t load(size_type i) const noexcept {
+        size_type bit = i * Bits;
+        size_type w = bit / 64;
+        unsigned s = bit % 64;
+        return ((words_[w] >> s) | ((words_[w + 1] << 1) << (63 - s))) & mask;
+    }
+
+    void store(size_type i, std::uint64_t bits) noexcept {
+        size_type bit = i * Bits;
+        size_type w = bit / 64;
+        unsigned s = bit % 64;
+        words_[w] = (words_[w] & ~(mask << s)) | (bits << s);
+        if (s + Bits > 64) {
+            unsigned spill = 64 - s;
+            words_[w + 1] = (words_[w + 1] & ~(mask >> spill)) | (bits >> spill);
+        }
+    }
+
+    template<std::size_t... J>
+    static void unpack_block(std::uint64_t const* words, V* out, std::index_sequence<J...>) noexcept {
+        ((out[J] = traits::decode(block_element<J>(words), mask)), ...);
+    }
+
+    template<std::size_t J>
+    static std::uint64_t block_element(std::uint64_t const* words) noexcept {
+        constexpr std::size_t bit = J * Bits;
+        constexpr std::size_t w = bit / 64;
+        constexpr unsigned s = bit % 64;
+        if constexpr (s + Bits > 64)
+            return ((words[w] >> s) | (words[w + 1] << (64 - s))) & mask;
+        else
+            return (words[w] >> s) & mask;
+    }
+
+    std::vector<std::uint64_t> words_;
+    size_type size_ = 0;
+};
+
+}
+
+#endif // _TSL_CONTAINERS_PACKED_ARRAY_HPP
@@ -0,0 +1,588 @@
+// A vector storing up to `N` elements inside the object itself, and spilling to the
+// allocator beyond that. Short lists cost no allocation at all.
+//
+// Growth relocates the elements with memcpy when T is trivially relocatable
+// (see tsl::is_trivially_relocatable). Stateful allocators such as
+// tsl::arena_allocator are supported, for lists that outgrow the inline buffer.
+//
+// Unlike std::vector, moving a small_vector whose elements are inline moves the
+// elements one by one, and invalidates iterators to them.
+#ifndef _TSL_CONTAINERS_SMALL_VECTOR_HPP
+#define _TSL_CONTAINERS_SMALL_VECTOR_HPP
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "tsl/attributes.hpp"
+#include "tsl/macros.hpp"
+#include "tsl/type_traits.hpp"
+
+namespace tsl {
+
+template<typename T, std::size_t N, typename Alloc = std::allocator<T>>
+class small_vector {
+    static_assert(N > 0, "small_vector needs an inline capacity, use std::vector instead");
+    static_assert(std::is_same_v<typename std::allocator_traits<Alloc>::value_type, T>);
+
+    using alloc_traits = std::allocator_traits<Alloc>;
+
+public:
+    using value_type = T;
+    using allocator_type = Alloc;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T&;
+    using const_reference = T const&;
+    using pointer = T*;
+    using const_pointer = T const*;
+    using iterator = T*;
+    using const_iterator = T const*;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    static constexpr size_type inline_capacity = N;
+
+    small_vector() noexcept(noexcept(Alloc()))
+        requires(std::default_initializable<Alloc>)
+        : small_vector(Alloc()) { }
+
+    explicit small_vector(Alloc const& alloc) noexcept
+        : data_(inline_data()), alloc_(alloc) { }
+
+    // The constructors below delegate to the one above, so the destructor
+    // cleans up if they throw halfway.
+
+    explicit small_vector(size_type n, Alloc const& alloc = Alloc())
+        : small_vector(alloc)
+    {
+        resize(n);
+    }
+
+    small_vector(size_type n, T const& value, Alloc const& alloc = Alloc())
+        : small_vector(alloc)
+    {
+        assign(n, value);
+    }
+
+    template<std::input_iterator It>
+    small_vector(It first, It last, Alloc const& alloc = Alloc())
+        : small_vector(alloc)
+    {
+        append(first, last);
+    }
+
+    small_vector(std::initializer_list<T> il, Alloc const& alloc = Alloc())
+        : small_vector(alloc)
+    {
+        append(il.begin(), il.end());
+    }
+
+    small_vector(small_vector const& other)
+        : small_vector(alloc_traits::select_on_container_copy_construction(other.alloc_))
+    {
+        append(other.begin(), other.end());
+    }
+
+    small_vector(small_vector const& other, Alloc const& alloc)
+        : small_vector(alloc)
+    {
+        append(other.begin(), other.end());
+    }
+
+    small_vector(small_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        : small_vector(other.alloc_)
+    {
+        take(other);
+    }
+
+    small_vector(small_vector&& other, Alloc const& alloc)
+        : small_vector(alloc)
+    {
+        if (same_allocator(other.alloc_)) {
+            take(other);
+        } else {
+            append(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+            other.clear();
+        }
+    }
+
+    ~small_vector() {
+        destroy_range(data_, data_ + size_);
+        release_heap();
+    }
+
+    small_vector& operator=(small_vector const& other) {
+        if (this == &other)
+            return *this;
+        if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+            if (!same_allocator(other.alloc_))
+                reset_to_inline();
+            alloc_ = other.alloc_;
+        }
+        assign(other.begin(), other.end());
+        return *this;
+    }
+
+    small_vector& operator=(small_vector&& other)
+        noexcept(std::is_nothrow_move_constructible_v<T>
+                 && (alloc_traits::propagate_on_container_move_assignment::value
+                     || alloc_traits::is_always_equal::value))
+    {
+        if (this == &other)
+            return *this;
+        if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+            if (!same_allocator(other.alloc_))
+                reset_to_inline();
+            alloc_ = other.alloc_;
+        }
+        if (!other.is_inline() && same_allocator(other.alloc_)) {
+            reset_to_inline();
+            take(other);
+        } else {
+            // Inline elements, or memory that our allocator can't free.
+            assign(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+            other.clear();
+        }
+        return *this;
+    }
+
+    small_vector& operator=(std::initializer_list<T> il) {
+        assign(il.begin(), il.end());
+        return *this;
+    }
+
+    template<std::input_iterator It>
+    void assign(It first, It last) {
+        clear();
+        append(first, last);
+    }
+
+    void assign(size_type n, T const& value) {
+        if (n > capacity_) {
+            // `value` may be one of our elements.
+            T copy(value);
+            clear();
+            grow_to(n);
+            fill_back(n, copy);
+        } else {
+            // Elements are overwritten instead of destroyed, so an alias of `value` stays alive.
+            size_type common = std::min(n, size_);
+            std::fill_n(data_, common, value);
+            if (n > size_)
+                fill_back(n - size_, value);
+            else
+                shrink_back(n);
+        }
+    }
+
+    void assign(std::initializer_list<T> il) {
+        assign(il.begin(), il.end());
+    }
+
+    [[nodiscard]] allocator_type get_allocator() const noexcept { return alloc_; }
+
+    iterator begin() noexcept { return data_; }
+    iterator end() noexcept { return data_ + size_; }
+    const_iterator begin() const noexcept { return data_; }
+    const_iterator end() const noexcept { return data_ + size_; }
+    const_iterator cbegin() const noexcept { return data_; }
+    const_iterator cend() const noexcept { return data_ + size_; }
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+    [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+    [[nodiscard]] size_type size() const noexcept { return size_; }
+    [[nodiscard]] size_type capacity() const noexcept { return capacity_; }
+
+    [[nodiscard]] size_type max_size() const noexcept {
+        return alloc_traits::max_size(alloc_);
+    }
+
+    // Whether the elements live in the inline buffer.
+    [[nodiscard]] bool is_inline() const noexcept {
+        return data_ == inline_data();
+    }
+
+    [[nodiscard]] T* data() noexcept { return data_; }
+    [[nodiscard]] T const* data() const noexcept { return data_; }
+
+    [[nodiscard]] T& operator[](size_type i) noexcept {
+        TSL_HARDENING_ASSERT(i < size_);
+        return data_[i];
+    }
+
+    [[nodiscard]] T const& operator[](size_type i) const noexcept {
+        TSL_HARDENING_ASSERT(i < size_);
+        return data_[i];
+    }
+
+    [[nodiscard]] T& at(size_type i) {
+        if (i >= size_)
+            TSL_THROW(std::out_of_range("tsl::small_vector::at"));
+        return data_[i];
+    }
+
+    [[nodiscard]] T const& at(size_type i) const {
+        if (i >= size_)
+            TSL_THROW(std::out_of_range("tsl::small_vector::at"));
+        return data_[i];
+    }
+
+    [[nodiscard]] T& front() noexcept { return (*this)[0]; }
+    [[nodiscard]] T const& front() const noexcept { return (*this)[0]; }
+    [[nodiscard]] T& back() noexcept { return (*this)[size_ - 1]; }
+    [[nodiscard]] T const& back() const noexcept { return (*this)[size_ - 1]; }
+
+    void reserve(size_type n) {
+        if (n > capacity_)
+            grow_to(n);
+    }
+
+    // Moves the elements back inline when they fit.
+    void shrink_to_fit() {
+        if (is_inline() || size_ == capacity_)
+            return;
+        if (size_ <= N) {
+            T* heap = data_;
+            size_type heap_capacity = capacity_;
+            relocate(heap, size_, inline_data());
+            alloc_traits::deallocate(alloc_, heap, heap_capacity);
+            data_ = inline_data();
+            capacity_ = N;
+        } else {
+            grow_to(size_);
+        }
+    }
+
+    void clear() noexcept {
+        destroy_range(data_, data_ + size_);
+        size_ = 0;
+    }
+
+    template<typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (TSL_EXPECT_TRUE(size_ < capacity_)) {
+            alloc_traits::construct(alloc_, data_ + size_, std::forward<Args>(args)...);
+            return data_[size_++];
+        }
+        return emplace_back_slow(std::forward<Args>(args)...);
+    }
+
+    void push_back(T const& value) {
+        emplace_back(value);
+    }
+
+    void push_back(T&& value) {
+        emplace_back(std::move(value));
+    }
+
+    void pop_back() noexcept {
+        TSL_HARDENING_ASSERT(size_ > 0);
+        --size_;
+        alloc_traits::destroy(alloc_, data_ + size_);
+    }
+
+    // Insertions append at the end and rotate the new elements into place.
+
+    template<typename... Args>
+    iterator emplace(const_iterator pos, Args&&... args) {
+        size_type i = index_of(pos);
+        emplace_back(std::forward<Args>(args)...);
+        std::rotate(data_ + i, data_ + size_ - 1, data_ + size_);
+        return data_ + i;
+    }
+
+    iterator insert(const_iterator pos, T const& value) {
+        return emplace(pos, value);
+    }
+
+    iterator insert(const_iterator pos, T&& value) {
+        return emplace(pos, std::move(value));
+    }
+
+    iterator insert(const_iterator pos, size_type n, T const& value) {
+        size_type i = index_of(pos);
+        size_type old_size = size_;
+        if (size_ + n > capacity_) {
+            T copy(value);
+            grow_to(next_capacity(size_ + n));
+            fill_back(n, copy);
+        } else {
+            fill_back(n, value);
+        }
+        std::rotate(data_ + i, data_ + old_size, data_ + size_);
+        return data_ + i;
+    }
+
+    // The range must not point into this vector.
+    template<std::input_iterator It>
+    iterator insert(const_iterator pos, It first, It last) {
+        size_type i = index_of(pos);
+        size_type old_size = size_;
+        append(first, last);
+        std::rotate(data_ + i, data_ + old_size, data_ + size_);
+        return data_ + i;
+    }
+
+    iterator insert(const_iterator pos, std::initializer_list<T> il) {
+        return insert(pos, il.begin(), il.end());
+    }
+
+    iterator erase(const_iterator pos) {
+        return erase(pos, pos + 1);
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        size_type i = index_of(first);
+        size_type j = index_of(last);
+        TSL_HARDENING_ASSERT(i <= j);
+        if (i != j) {
+            std::move(data_ + j, data_ + size_, data_ + i);
+            shrink_back(size_ - (j - i));
+        }
+        return data_ + i;
+    }
+
+    void resize(size_type n) {
+        if (n <= size_) {
+            shrink_back(n);
+            return;
+        }
+        if (n > capacity_)
+            grow_to(next_capacity(n));
+        while (size_ < n) {
+            alloc_traits::construct(alloc_, data_ + size_);
+            ++size_;
+        }
+    }
+
+    void resize(size_type n, T const& value) {
+        if (n <= size_) {
+            shrink_back(n);
+        } else if (n > capacity_) {
+            T copy(value);
+            grow_to(next_capacity(n));
+            fill_back(n - size_, copy);
+        } else {
+            fill_back(n - size_, value);
+        }
+    }
+
+    void swap(small_vector& other)
+        noexcept(std::is_nothrow_move_constructible_v<T>
+                 && (alloc_traits::propagate_on_container_move_assignment::value
+                     || alloc_traits::is_always_equal::value))
+    {
+        if (!is_inline() && !other.is_inline()
+            && (alloc_traits::propagate_on_container_swap::value || same_allocator(other.alloc_))) {
+            using std::swap;
+            swap(data_, other.data_);
+            swap(size_, other.size_);
+            swap(capacity_, other.capacity_);
+            if constexpr (alloc_traits::propagate_on_container_swap::value)
+                swap(alloc_, other.alloc_);
+            return;
+        }
+        small_vector tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    friend void swap(small_vector& a, small_vector& b) noexcept(noexcept(a.swap(b))) {
+        a.swap(b);
+    }
+
+    template<std::size_t M, typename A>
+    friend bool operator==(small_vector const& a, small_vector<T, M, A> const& b) {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end());
+    }
+
+    template<std::size_t M, typename A>
+    friend auto operator<=>(small_vector const& a, small_vector<T, M, A> const& b)
+        requires(std::three_way_comparable<T>)
+    {
+        return std::lexicographical_compare_three_way(a.begin(), a.end(), b.begin(), b.end());
+    }
+
+private:
+    template<typename, std::size_t, typename> friend class small_vector;
+
+    T* inline_data() noexcept {
+        return reinterpret_cast<T*>(buffer_);
+    }
+
+    T const* inline_data() const noexcept {
+        return reinterpret_cast<T const*>(buffer_);
+    }
+
+    size_type index_of(const_iterator it) const noexcept {
+        TSL_HARDENING_ASSERT(it >= begin() && it <= end());
+        return static_cast<size_type>(it - begin());
+    }
+
+    bool same_allocator(Alloc const& other) const noexcept {
+        if constexpr (alloc_traits::is_always_equal::value)
+            return true;
+        else
+            return alloc_ == other;
+    }
+
+    size_type next_capacity(size_type min) const {
+        if (min > max_size())
+            TSL_THROW(std::length_error("tsl::small_vector"));
+        size_type doubled = capacity_ <= max_size() / 2 ? capacity_ * 2 : max_size();
+        return std::max(doubled, min);
+    }
+
+    void destroy_range(T* first, T* last) noexcept {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for (; first != last; ++first)
+                alloc_traits::destroy(alloc_, first);
+        }
+    }
+
+    void shrink_back(size_type n) noexcept {
+        destroy_range(data_ + n, data_ + size_);
+        size_ = n;
+    }
+
+    void fill_back(size_type n, T const& value) {
+        for (; n > 0; --n) {
+            alloc_traits::construct(alloc_, data_ + size_, value);
+            ++size_;
+        }
+    }
+
+    template<typename It>
+    void append(It first, It last) {
+        if constexpr (std::forward_iterator<It>) {
+            auto n = static_cast<size_type>(std::distance(first, last));
+            if (size_ + n > capacity_)
+                grow_to(next_capacity(size_ + n));
+            for (; first != last; ++first) {
+                alloc_traits::construct(alloc_, data_ + size_, *first);
+                ++size_;
+            }
+        } else {
+            for (; first != last; ++first)
+                emplace_back(*first);
+        }
+    }
+
+    void release_heap() noexcept {
+        if (!is_inline())
+            alloc_traits::deallocate(alloc_, data_, capacity_);
+    }
+
+    // Destroys the elements and frees the heap buffer, if any.
+    void reset_to_inline() noexcept {
+        clear();
+        release_heap();
+        data_ = inline_data();
+        capacity_ = N;
+    }
+
+    // Takes `other`'s elements, stealing its heap buffer if it has one.
+    // The allocators must compare equal.
+    void take(small_vector& other) {
+        if (other.is_inline()) {
+            relocate(other.data_, other.size_, data_);
+        } else {
+            data_ = other.data_;
+            capacity_ = other.capacity_;
+            other.data_ = other.inline_data();
+            other.capacity_ = N;
+        }
+        size_ = std::exchange(other.size_, 0);
+    }
+
+    // Moves `n` elements to uninitialized memory at `to`, and destroys them at `from`.
+    void relocate(T* from, size_type n, T* to) {
+        if constexpr (is_trivially_relocatable_v<T>) {
+            if (n != 0)
+                std::memcpy(static_cast<void*>(to), static_cast<void const*>(from), n * sizeof(T));
+        } else {
+            size_type i = 0;
+#if TSL_HAS_EXCEPTIONS
+            try {
+                for (; i < n; ++i)
+                    alloc_traits::construct(alloc_, to + i, std::move_if_noexcept(from[i]));
+            } catch (...) {
+                destroy_range(to, to + i);
+                throw;
+            }
+#else
+            for (; i < n; ++i)
+                alloc_traits::construct(alloc_, to + i, std::move_if_noexcept(from[i]));
+#endif
+            destroy_range(from, from + n);
+        }
+    }
+
+    // Moves the elements to a heap buffer of `new_capacity`, which must hold them.
+    void grow_to(size_type new_capacity) {
+        T* p = alloc_traits::allocate(alloc_, new_capacity);
+#if TSL_HAS_EXCEPTIONS
+        try {
+            relocate(data_, size_, p);
+        } catch (...) {
+            alloc_traits::deallocate(alloc_, p, new_capacity);
+            throw;
+        }
+#else
+        relocate(data_, size_, p);
+#endif
+        release_heap();
+        data_ = p;
+        capacity_ = new_capacity;
+    }
+
+    // The new element is constructed before relocating the old ones,
+    // since `args` may refer to them.
+    template<typename... Args>
+    TSL_ATTR_NOINLINE T& emplace_back_slow(Args&&... args) {
+        size_type new_capacity = next_capacity(size_ + 1);
+        T* p = alloc_traits::allocate(alloc_, new_capacity);
+#if TSL_HAS_EXCEPTIONS
+        try {
+            alloc_traits::construct(alloc_, p + size_, std::forward<Args>(args)...);
+        } catch (...) {
+            alloc_traits::deallocate(alloc_, p, new_capacity);
+            throw;
+        }
+        try {
+            relocate(data_, size_, p);
+        } catch (...) {
+            alloc_traits::destroy(alloc_, p + size_);
+            alloc_traits::deallocate(alloc_, p, new_capacity);
+            throw;
+        }
+#else
+        alloc_traits::construct(alloc_, p + size_, std::forward<Args>(args)...);
+        relocate(data_, size_, p);
+#endif
+        release_heap();
+        data_ = p;
+        capacity_ = new_capacity;
+        return data_[size_++];
+    }
+
+    T* data_;
+    size_type size_ = 0;
+    size_type capacity_ = N;
+    [[no_unique_address]] Alloc alloc_;
+    alignas(T) std::byte buffer_[N * sizeof(T)];
+};
+
+}
+
+#endif // _TSL_CONTAINERS_SMALL_VECTOR_HPP
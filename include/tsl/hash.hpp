@@ -0,0 +1,95 @@
+// Hash and equality function objects used by tsl containers.
+// String-like types hash the same regardless of their representation, and both
+// function objects are transparent, so a container keyed by std::string can be
+// queried with a std::string_view, a tsl::cstring_ref or a C string.
+#ifndef _TSL_HASH_HPP
+#define _TSL_HASH_HPP
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include "tsl/cstring_ref.hpp"
+#include "tsl/macros.hpp"
+#include "tsl/types/contracts.hpp"
+
+namespace tsl {
+
+namespace internal_hash {
+
+template<typename T>
+concept string_like =
+    std::same_as<T, std::string>
+    || std::same_as<T, std::string_view>
+    || std::same_as<T, cstring_ref>
+    || std::same_as<T, const char*>
+    || std::same_as<T, char*>;
+
+inline std::string_view to_string_view(std::string_view s) noexcept {
+    return s;
+}
+
+inline std::string_view to_string_view(std::string const& s) noexcept {
+    return s;
+}
+
+inline std::string_view to_string_view(cstring_ref s) noexcept {
+    return std::string_view(s.get());
+}
+
+inline std::string_view to_string_view(const char* s) noexcept {
+    return std::string_view(s);
+}
+
+}
+
+template<typename T>
+struct hash : std::hash<T> { };
+
+template<internal_hash::string_like T>
+struct hash<T> {
+    using is_transparent = void;
+
+    std::size_t operator()(std::string_view s) const noexcept {
+        return std::hash<std::string_view>{}(s);
+    }
+
+    std::size_t operator()(std::string const& s) const noexcept {
+        return (*this)(internal_hash::to_string_view(s));
+    }
+
+    std::size_t operator()(cstring_ref s) const noexcept {
+        return (*this)(internal_hash::to_string_view(s));
+    }
+
+    std::size_t operator()(const char* s) const noexcept {
+        return (*this)(internal_hash::to_string_view(s));
+    }
+};
+
+// Contract types hash as their underlying value.
+template<ContractType T>
+struct hash<T> {
+    std::size_t operator()(T const& value) const noexcept {
+        return std::hash<typename T::type>{}(value.raw());
+    }
+};
+
+template<typename T>
+struct equal_to : std::equal_to<T> { };
+
+template<internal_hash::string_like T>
+struct equal_to<T> {
+    using is_transparent = void;
+
+    template<typename A, typename B>
+    bool operator()(A const& a, B const& b) const noexcept
+        TSL_REQUIRES { internal_hash::to_string_view(a); internal_hash::to_string_view(b); }
+    {
+        return internal_hash::to_string_view(a) == internal_hash::to_string_view(b);
+    }
+};
+
+}
+
+#endif // _TSL_HASH_HPP
@@ -0,0 +1,17 @@
+// Internal header. Do not include directly.
+#ifndef _TSL_INTERNAL_CACHE_LINE_HPP
+#define _TSL_INTERNAL_CACHE_LINE_HPP
+
+#include <cstddef>
+
+namespace tsl {
+namespace internal {
+
+// Size used to pad data shared between threads, avoiding false sharing.
+// std::hardware_destructive_interference_size is not used because its value
+// may change between compiler flags, which is an ABI hazard in headers.
+inline constexpr std::size_t cache_line_size = 64;
+
+}}
+
+#endif // _TSL_INTERNAL_CACHE_LINE_HPP
@@ -0,0 +1,127 @@
+// Internal header. Do not include directly.
+//
+// Chase-Lev work-stealing deque, following "Correct and Efficient Work-Stealing
+// for Weak Memory Models" (Lê, Pop, Cohen, Zappa Nardelli, 2013).
+// The owner thread pushes and pops at the bottom, other threads steal from the top.
+#ifndef _TSL_INTERNAL_CHASE_LEV_DEQUE_HPP
+#define _TSL_INTERNAL_CHASE_LEV_DEQUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "tsl/internal/cache_line.hpp"
+
+namespace tsl {
+namespace internal {
+
+// Stores non-zero `std::uintptr_t` values, zero is used as the "no item" result.
+class chase_lev_deque {
+public:
+    explicit chase_lev_deque(std::int64_t capacity = 256)
+        : ring_(new ring(capacity)) { }
+
+    chase_lev_deque(chase_lev_deque const&) = delete;
+    chase_lev_deque& operator=(chase_lev_deque const&) = delete;
+
+    ~chase_lev_deque() {
+        delete ring_.load(std::memory_order_relaxed);
+    }
+
+    // Owner only.
+    void push(std::uintptr_t item) {
+        std::int64_t b = bottom_.load(std::memory_order_relaxed);
+        std::int64_t t = top_.load(std::memory_order_acquire);
+        ring* r = ring_.load(std::memory_order_relaxed);
+        if (b - t > r->capacity - 1)
+            r = grow(r, t, b);
+        r->put(b, item);
+        bottom_.store(b + 1, std::memory_order_release);
+    }
+
+    // Owner only. Returns zero if the deque is empty.
+    std::uintptr_t pop() {
+        std::int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        ring* r = ring_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = top_.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return 0;
+        }
+
+        std::uintptr_t item = r->get(b);
+        if (t == b) {
+            // Last item, race against thieves.
+            if (!top_.compare_exchange_strong(t, t + 1,
+                        std::memory_order_seq_cst, std::memory_order_relaxed))
+                item = 0;
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    // Any thread. Returns zero if the deque is empty or the race was lost.
+    std::uintptr_t steal() {
+        std::int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b)
+            return 0;
+
+        ring* r = ring_.load(std::memory_order_acquire);
+        std::uintptr_t item = r->get(t);
+        if (!top_.compare_exchange_strong(t, t + 1,
+                    std::memory_order_seq_cst, std::memory_order_relaxed))
+            return 0;
+        return item;
+    }
+
+    // Approximation, may be stale by the time it returns.
+    bool empty() const noexcept {
+        std::int64_t b = bottom_.load(std::memory_order_relaxed);
+        std::int64_t t = top_.load(std::memory_order_relaxed);
+        return t >= b;
+    }
+
+private:
+    struct ring {
+        explicit ring(std::int64_t cap)
+            : capacity(cap), mask(cap - 1), items(new std::atomic<std::uintptr_t>[cap]) { }
+
+        std::uintptr_t get(std::int64_t i) const noexcept {
+            return items[i & mask].load(std::memory_order_relaxed);
+        }
+
+        void put(std::int64_t i, std::uintptr_t item) noexcept {
+            items[i & mask].store(item, std::memory_order_relaxed);
+        }
+
+        std::int64_t capacity;
+        std::int64_t mask;
+        std::unique_ptr<std::atomic<std::uintptr_t>[]> items;
+    };
+
+    ring* grow(ring* old, std::int64_t t, std::int64_t b) {
+        ring* r = new ring(old->capacity * 2);
+        for (std::int64_t i = t; i < b; ++i)
+            r->put(i, old->get(i));
+        // Thieves may still be reading the old ring, so it's only freed
+        // together with the deque.
+        retired_.emplace_back(old);
+        ring_.store(r, std::memory_order_release);
+        return r;
+    }
+
+    alignas(cache_line_size) std::atomic<std::int64_t> top_ {0};
+    alignas(cache_line_size) std::atomic<std::int64_t> bottom_ {0};
+    alignas(cache_line_size) std::atomic<ring*> ring_;
+    std::vector<std::unique_ptr<ring>> retired_;
+};
+
+}}
+
+#endif // _TSL_INTERNAL_CHASE_LEV_DEQUE_HPP
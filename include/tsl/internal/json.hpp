@@ -0,0 +1,15 @@
+#ifndef _TSL_INTERNAL_JSON_HPP
+#define _TSL_INTERNAL_JSON_HPP
+
+#include <cstdio>
+#include <string_view>
+
+namespace tsl {
+namespace internal {
+
+// Writes `s` as a quoted JSON string.
+void write_json_string(std::FILE* out, std::string_view s);
+
+}}
+
+#endif // _TSL_INTERNAL_JSON_HPP
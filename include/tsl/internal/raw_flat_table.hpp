@@ -0,0 +1,840 @@
+// Internal header. Do not include directly.
+//
+// Open-addressing hash table behind tsl::flat_map and tsl::flat_set.
+//
+// By default it's a Swiss table: a control byte per slot holds 7 bits of the hash
+// (or marks the slot empty/deleted), and lookups compare a whole group of control
+// bytes at once, with SSE2 or with SWAR on a 64-bit word.
+//
+// Keys with a niche (see tsl/types/niche.hpp) don't need control bytes: an empty slot
+// holds the key's sentinel value. That layout uses linear probing with backward-shift
+// deletion, so there are no tombstones to mark either.
+#ifndef _TSL_INTERNAL_RAW_FLAT_TABLE_HPP
+#define _TSL_INTERNAL_RAW_FLAT_TABLE_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <concepts>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "tsl/config.hpp"
+#include "tsl/macros.hpp"
+#include "tsl/types/niche.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TSL_INTERNAL_FLAT_TABLE_SSE2 1
+#else
+#define TSL_INTERNAL_FLAT_TABLE_SSE2 0
+#endif
+
+namespace tsl {
+namespace internal_flat {
+
+using ctrl_t = std::int8_t;
+
+inline constexpr ctrl_t ctrl_empty = -128;
+inline constexpr ctrl_t ctrl_deleted = -2;
+
+// Iterates over the set bits of a match mask. Each slot takes `1 << Shift` bits.
+template<typename Word, int Shift>
+class bitmask {
+public:
+    explicit bitmask(Word mask) noexcept : mask_(mask) { }
+
+    explicit operator bool() const noexcept {
+        return mask_ != 0;
+    }
+
+    std::size_t lowest() const noexcept {
+        return static_cast<std::size_t>(std::countr_zero(mask_)) >> Shift;
+    }
+
+    bitmask& operator++() noexcept {
+        mask_ &= mask_ - 1;
+        return *this;
+    }
+
+    std::size_t operator*() const noexcept {
+        return lowest();
+    }
+
+    bitmask begin() const noexcept { return *this; }
+    bitmask end() const noexcept { return bitmask(0); }
+
+    friend bool operator!=(bitmask const& a, bitmask const& b) noexcept {
+        return a.mask_ != b.mask_;
+    }
+
+private:
+    Word mask_;
+};
+
+#if TSL_INTERNAL_FLAT_TABLE_SSE2
+struct group {
+    static constexpr std::size_t width = 16;
+
+    explicit group(ctrl_t const* p) noexcept
+        : ctrl(_mm_loadu_si128(reinterpret_cast<__m128i const*>(p))) { }
+
+    bitmask<std::uint32_t, 0> match(ctrl_t h2) const noexcept {
+        return bitmask<std::uint32_t, 0>(static_cast<std::uint32_t>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl))));
+    }
+
+    bitmask<std::uint32_t, 0> match_empty() const noexcept {
+        return match(ctrl_empty);
+    }
+
+    // Empty and deleted are the only negative control bytes.
+    bitmask<std::uint32_t, 0> match_non_full() const noexcept {
+        return bitmask<std::uint32_t, 0>(static_cast<std::uint32_t>(_mm_movemask_epi8(ctrl)));
+    }
+
+    __m128i ctrl;
+};
+#else
+struct group {
+    static constexpr std::size_t width = 8;
+    static constexpr std::uint64_t lsbs = 0x0101010101010101ull;
+    static constexpr std::uint64_t msbs = 0x8080808080808080ull;
+
+    explicit group(ctrl_t const* p) noexcept {
+        std::memcpy(&ctrl, p, sizeof(ctrl));
+        if constexpr (std::endian::native == std::endian::big)
+            ctrl = byteswap(ctrl);
+    }
+
+    // May report false positives when a byte borrows from the previous one,
+    // that's fine since every match is confirmed by comparing keys.
+    bitmask<std::uint64_t, 3> match(ctrl_t h2) const noexcept {
+        std::uint64_t x = ctrl ^ (lsbs * static_cast<std::uint8_t>(h2));
+        return bitmask<std::uint64_t, 3>((x - lsbs) & ~x & msbs);
+    }
+
+    bitmask<std::uint64_t, 3> match_empty() const noexcept {
+        // Empty is 0b10000000 and deleted is 0b11111110, only empty has bit 1 clear.
+        return bitmask<std::uint64_t, 3>(ctrl & ~(ctrl << 6) & msbs);
+    }
+
+    bitmask<std::uint64_t, 3> match_non_full() const noexcept {
+        return bitmask<std::uint64_t, 3>(ctrl & msbs);
+    }
+
+    static std::uint64_t byteswap(std::uint64_t v) noexcept {
+        std::uint64_t r = 0;
+        for (int i = 0; i < 8; ++i, v >>= 8)
+            r = (r << 8) | (v & 0xff);
+        return r;
+    }
+
+    std::uint64_t ctrl;
+};
+#endif
+
+// Spreads the entropy of weak hashes (such as std::hash for integers, which is
+// the identity) over every bit, since both ends of the hash are used.
+inline std::size_t mix(std::size_t h) noexcept {
+#if defined(__SIZEOF_INT128__)
+    if constexpr (sizeof(std::size_t) == 8) {
+        // __extension__ keeps -Wpedantic quiet in every includer.
+        __extension__ typedef unsigned __int128 u128;
+        auto m = static_cast<u128>(h) * 0x9e3779b97f4a7c15ull;
+        return static_cast<std::size_t>(m) ^ static_cast<std::size_t>(m >> 64);
+    }
+#endif
+    // murmur3's finalizer.
+    std::uint64_t x = h;
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    return static_cast<std::size_t>(x);
+}
+
+template<typename K>
+struct set_traits {
+    using key_type = K;
+    using value_type = K;
+
+    static K const& key(value_type const& v) noexcept { return v; }
+};
+
+template<typename K, typename V>
+struct map_traits {
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<const K, V>;
+
+    static K const& key(value_type const& v) noexcept { return v.first; }
+};
+
+// Heterogeneous lookup is enabled when both function objects opt in.
+template<typename Hash, typename Eq>
+concept transparent = requires {
+    typename Hash::is_transparent;
+    typename Eq::is_transparent;
+};
+
+// Types other than the key accepted by lookup functions.
+template<typename U, typename Hash, typename Eq, typename K>
+concept lookup_key = transparent<Hash, Eq> && !std::same_as<U, K>;
+
+template<typename Traits, typename Hash, typename Eq, typename Alloc>
+class raw_table {
+public:
+    using key_type = typename Traits::key_type;
+    using value_type = typename Traits::value_type;
+    using size_type = std::size_t;
+    using hasher = Hash;
+    using key_equal = Eq;
+    using allocator_type = Alloc;
+
+    // Niche keys are used in the slot itself to mark it empty.
+    static constexpr bool uses_niche = niche_traits<key_type>::available;
+
+private:
+    using niche = niche_traits<key_type>;
+    using alloc_traits = std::allocator_traits<Alloc>;
+    using slot_alloc = typename alloc_traits::template rebind_alloc<value_type>;
+    using slot_traits = std::allocator_traits<slot_alloc>;
+    using ctrl_alloc = typename alloc_traits::template rebind_alloc<ctrl_t>;
+    using ctrl_traits = std::allocator_traits<ctrl_alloc>;
+
+    static_assert(!uses_niche || (std::is_trivially_copyable_v<key_type>
+                               && std::is_trivially_destructible_v<key_type>),
+                  "niche keys must be trivially copyable");
+
+    // Smallest capacity, keeps a whole group inside the table.
+    static constexpr size_type min_capacity = uses_niche ? 8 : group::width;
+
+public:
+    template<bool Const>
+    class basic_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = typename Traits::value_type;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<Const, value_type const&, value_type&>;
+        using pointer = std::conditional_t<Const, value_type const*, value_type*>;
+
+        basic_iterator() noexcept = default;
+
+        template<bool C = Const>
+            requires(C)
+        basic_iterator(basic_iterator<false> const& other) noexcept
+            : table_(other.table_), index_(other.index_) { }
+
+        reference operator*() const noexcept {
+            return table_->slots_[index_];
+        }
+
+        pointer operator->() const noexcept {
+            return std::addressof(table_->slots_[index_]);
+        }
+
+        basic_iterator& operator++() noexcept {
+            index_ = table_->next_full(index_ + 1);
+            return *this;
+        }
+
+        basic_iterator operator++(int) noexcept {
+            basic_iterator it = *this;
+            ++*this;
+            return it;
+        }
+
+        friend bool operator==(basic_iterator const& a, basic_iterator const& b) noexcept {
+            return a.index_ == b.index_;
+        }
+
+    private:
+        friend class raw_table;
+        template<bool> friend class basic_iterator;
+
+        basic_iterator(raw_table const* table, size_type index) noexcept
+            : table_(table), index_(index) { }
+
+        raw_table const* table_ = nullptr;
+        size_type index_ = 0;
+    };
+
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    raw_table() = default;
+
+    explicit raw_table(size_type bucket_count, Hash const& hash = Hash(),
+                       Eq const& eq = Eq(), Alloc const& alloc = Alloc())
+        : hash_(hash), eq_(eq), alloc_(alloc)
+    {
+        if (bucket_count != 0)
+            resize(capacity_for(bucket_count));
+    }
+
+    raw_table(raw_table const& other)
+        : hash_(other.hash_), eq_(other.eq_),
+          alloc_(alloc_traits::select_on_container_copy_construction(other.alloc_))
+    {
+        copy_from(other);
+    }
+
+    raw_table(raw_table&& other) noexcept
+        : hash_(std::move(other.hash_)), eq_(std::move(other.eq_)), alloc_(std::move(other.alloc_)),
+          ctrl_(std::exchange(other.ctrl_, nullptr)),
+          slots_(std::exchange(other.slots_, nullptr)),
+          capacity_(std::exchange(other.capacity_, 0)),
+          size_(std::exchange(other.size_, 0)),
+          growth_left_(std::exchange(other.growth_left_, 0)) { }
+
+    raw_table& operator=(raw_table const& other) {
+        if (this != &other) {
+            destroy_all();
+            hash_ = other.hash_;
+            eq_ = other.eq_;
+            if constexpr (alloc_traits::propagate_on_container_copy_assignment::value)
+                alloc_ = other.alloc_;
+            copy_from(other);
+        }
+        return *this;
+    }
+
+    raw_table& operator=(raw_table&& other)
+        noexcept(alloc_traits::propagate_on_container_move_assignment::value
+                 || alloc_traits::is_always_equal::value)
+    {
+        if (this == &other)
+            return *this;
+        destroy_all();
+        hash_ = std::move(other.hash_);
+        eq_ = std::move(other.eq_);
+        if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+            alloc_ = std::move(other.alloc_);
+        } else if (!(alloc_ == other.alloc_)) {
+            // The storage can't change hands, so the elements are moved one by one.
+            copy_from(std::move(other));
+            other.destroy_all();
+            return *this;
+        }
+        ctrl_ = std::exchange(other.ctrl_, nullptr);
+        slots_ = std::exchange(other.slots_, nullptr);
+        capacity_ = std::exchange(other.capacity_, 0);
+        size_ = std::exchange(other.size_, 0);
+        growth_left_ = std::exchange(other.growth_left_, 0);
+        return *this;
+    }
+
+    ~raw_table() {
+        destroy_all();
+    }
+
+    iterator begin() noexcept { return iterator(this, next_full(0)); }
+    iterator end() noexcept { return iterator(this, capacity_); }
+    const_iterator begin() const noexcept { return const_iterator(this, next_full(0)); }
+    const_iterator end() const noexcept { return const_iterator(this, capacity_); }
+
+    [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+    [[nodiscard]] size_type size() const noexcept { return size_; }
+    [[nodiscard]] size_type capacity() const noexcept { return capacity_; }
+
+    hasher hash_function() const { return hash_; }
+    key_equal key_eq() const { return eq_; }
+    allocator_type get_allocator() const { return alloc_; }
+
+    void clear() noexcept {
+        for (size_type i = 0; i < capacity_; ++i) {
+            if (is_full(i))
+                erase_slot_contents(i);
+        }
+        if (capacity_ != 0)
+            reset_ctrl();
+        size_ = 0;
+        growth_left_ = max_load(capacity_);
+    }
+
+    // Makes room for `n` elements without rehashing.
+    void reserve(size_type n) {
+        if (n > size_ + growth_left_)
+            resize(capacity_for(n));
+    }
+
+    void rehash(size_type n) {
+        if (n == 0 && size_ == 0) {
+            destroy_all();
+            return;
+        }
+        size_type cap = capacity_for(std::max(n, size_));
+        if (cap != capacity_)
+            resize(cap);
+    }
+
+    template<typename K>
+    [[nodiscard]] iterator find(K const& key) {
+        return iterator(this, find_index(key));
+    }
+
+    template<typename K>
+    [[nodiscard]] const_iterator find(K const& key) const {
+        return const_iterator(this, find_index(key));
+    }
+
+    template<typename K>
+    [[nodiscard]] bool contains(K const& key) const {
+        return find_index(key) != capacity_;
+    }
+
+    // Finds `key`, or constructs a new element with `args` if it's missing.
+    // `args` are not used if the key is found.
+    template<typename K, typename... Args>
+    std::pair<iterator, bool> emplace_key(K const& key, Args&&... args) {
+        auto [index, inserted] = find_or_prepare_insert(key);
+        if (inserted) {
+#if TSL_HAS_EXCEPTIONS
+            try {
+                construct_slot(index, std::forward<Args>(args)...);
+            } catch (...) {
+                abandon_slot(index);
+                throw;
+            }
+#else
+            construct_slot(index, std::forward<Args>(args)...);
+#endif
+        }
+        return {iterator(this, index), inserted};
+    }
+
+    template<typename K>
+    size_type erase_key(K const& key) {
+        size_type index = find_index(key);
+        if (index == capacity_)
+            return 0;
+        erase_index(index);
+        return 1;
+    }
+
+    // Returns the iterator following `it`.
+    iterator erase(const_iterator it) {
+        size_type index = it.index_;
+        erase_index(index);
+        // Backward-shift deletion may have moved a later element into `index`.
+        if constexpr (uses_niche) {
+            if (is_full(index))
+                return iterator(this, index);
+        }
+        return iterator(this, next_full(index + 1));
+    }
+
+    // Erases the elements matching `pred`, which sees each element once. Returns how
+    // many were erased.
+    template<typename Pred>
+    size_type erase_if(Pred& pred) {
+        size_type erased = 0;
+        if constexpr (uses_niche) {
+            if (size_ == 0)
+                return 0;
+            // Walking from an empty slot, no cluster wraps around the end of the walk,
+            // so backward shifts only move elements not visited yet, into the current
+            // slot or after it. The load factor leaves an empty slot.
+            size_type mask = capacity_ - 1;
+            size_type start = 0;
+            while (is_full(start))
+                ++start;
+            for (size_type n = 1; n <= capacity_; ++n) {
+                size_type i = (start + n) & mask;
+                while (is_full(i) && pred(slots_[i])) {
+                    erase_index(i);
+                    ++erased;
+                }
+            }
+        } else {
+            for (size_type i = 0; i < capacity_; ++i) {
+                if (is_full(i) && pred(slots_[i])) {
+                    erase_index(i);
+                    ++erased;
+                }
+            }
+        }
+        return erased;
+    }
+
+    void swap(raw_table& other) noexcept {
+        using std::swap;
+        swap(hash_, other.hash_);
+        swap(eq_, other.eq_);
+        if constexpr (alloc_traits::propagate_on_container_swap::value)
+            swap(alloc_, other.alloc_);
+        swap(ctrl_, other.ctrl_);
+        swap(slots_, other.slots_);
+        swap(capacity_, other.capacity_);
+        swap(size_, other.size_);
+        swap(growth_left_, other.growth_left_);
+    }
+
+private:
+    static size_type max_load(size_type capacity) noexcept {
+        // 7/8 with control bytes, 3/4 for linear probing.
+        return uses_niche ? capacity - capacity / 4 : capacity - capacity / 8;
+    }
+
+    static size_type capacity_for(size_type n) noexcept {
+        size_type cap = min_capacity;
+        while (max_load(cap) < n)
+            cap *= 2;
+        return cap;
+    }
+
+    template<typename K>
+    std::size_t hash_of(K const& key) const {
+        return mix(hash_(key));
+    }
+
+    key_type const& key_at(size_type i) const noexcept {
+        // The key is the first member of the slot both while it's empty
+        // (only the key is alive) and while it holds a value.
+        return *std::launder(reinterpret_cast<key_type const*>(slots_ + i));
+    }
+
+    bool is_full(size_type i) const noexcept {
+        if constexpr (uses_niche)
+            return !niche::is_empty(key_at(i));
+        else
+            return ctrl_[i] >= 0;
+    }
+
+    size_type next_full(size_type i) const noexcept {
+        while (i < capacity_ && !is_full(i))
+            ++i;
+        return i;
+    }
+
+    void set_ctrl(size_type i, ctrl_t c) noexcept {
+        ctrl_[i] = c;
+        // The first group is mirrored after the end, so unaligned group
+        // loads near the end see the beginning of the table.
+        if (i < group::width)
+            ctrl_[capacity_ + i] = c;
+    }
+
+    void reset_ctrl() noexcept {
+        if constexpr (uses_niche) {
+            for (size_type i = 0; i < capacity_; ++i)
+                std::construct_at(reinterpret_cast<key_type*>(slots_ + i), niche::make_empty());
+        } else {
+            std::memset(ctrl_, static_cast<unsigned char>(ctrl_empty), capacity_ + group::width);
+        }
+    }
+
+    template<typename K>
+    size_type find_index(K const& key) const {
+        if (capacity_ == 0)
+            return capacity_;
+
+        std::size_t h = hash_of(key);
+        size_type mask = capacity_ - 1;
+
+        if constexpr (uses_niche) {
+            for (size_type i = h & mask; ; i = (i + 1) & mask) {
+                key_type const& k = key_at(i);
+                if (niche::is_empty(k))
+                    return capacity_;
+                if (eq_(k, key))
+                    return i;
+            }
+        } else {
+            auto h2 = static_cast<ctrl_t>(h & 0x7f);
+            size_type offset = (h >> 7) & mask;
+            for (size_type step = 0; ; ) {
+                group g(ctrl_ + offset);
+                for (size_type bit : g.match(h2)) {
+                    size_type i = (offset + bit) & mask;
+                    if (TSL_EXPECT_TRUE(eq_(Traits::key(slots_[i]), key)))
+                        return i;
+                }
+                if (g.match_empty())
+                    return capacity_;
+                step += group::width;
+                offset = (offset + step) & mask;
+            }
+        }
+    }
+
+    // First empty or deleted slot in the probe sequence of `h`.
+    size_type find_non_full(std::size_t h) const noexcept {
+        size_type mask = capacity_ - 1;
+        if constexpr (uses_niche) {
+            size_type i = h & mask;
+            while (is_full(i))
+                i = (i + 1) & mask;
+            return i;
+        } else {
+            size_type offset = (h >> 7) & mask;
+            for (size_type step = 0; ; ) {
+                group g(ctrl_ + offset);
+                if (auto m = g.match_non_full())
+                    return (offset + m.lowest()) & mask;
+                step += group::width;
+                offset = (offset + step) & mask;
+            }
+        }
+    }
+
+    template<typename K>
+    std::pair<size_type, bool> find_or_prepare_insert(K const& key) {
+        size_type found = find_index(key);
+        if (found != capacity_)
+            return {found, false};
+
+        if constexpr (uses_niche && std::same_as<K, key_type>)
+            TSL_HARDENING_ASSERT(!niche::is_empty(key));
+
+        std::size_t h = hash_of(key);
+        if (capacity_ == 0) {
+            resize(min_capacity);
+        }
+
+        size_type index = find_non_full(h);
+        if constexpr (uses_niche) {
+            if (growth_left_ == 0) {
+                resize(capacity_ * 2);
+                index = find_non_full(h);
+            }
+            std::destroy_at(reinterpret_cast<key_type*>(slots_ + index));
+        } else {
+            if (growth_left_ == 0 && ctrl_[index] != ctrl_deleted) {
+                // Mostly tombstones: rehashing at the same size is enough.
+                resize(size_ * 2 < max_load(capacity_) ? capacity_ : capacity_ * 2);
+                index = find_non_full(h);
+            }
+            if (ctrl_[index] == ctrl_empty)
+                --growth_left_;
+            set_ctrl(index, static_cast<ctrl_t>(h & 0x7f));
+        }
+
+        if constexpr (uses_niche)
+            --growth_left_;
+        ++size_;
+        return {index, true};
+    }
+
+    // Undoes `find_or_prepare_insert()` when constructing the value failed.
+    void abandon_slot(size_type index) noexcept {
+        --size_;
+        if constexpr (uses_niche) {
+            ++growth_left_;
+            std::construct_at(reinterpret_cast<key_type*>(slots_ + index), niche::make_empty());
+        } else {
+            set_ctrl(index, ctrl_deleted);
+        }
+    }
+
+    template<typename... Args>
+    void construct_slot(size_type index, Args&&... args) {
+        slot_alloc a(alloc_);
+        slot_traits::construct(a, slots_ + index, std::forward<Args>(args)...);
+    }
+
+    void erase_slot_contents(size_type index) noexcept {
+        slot_alloc a(alloc_);
+        slot_traits::destroy(a, slots_ + index);
+        if constexpr (uses_niche)
+            std::construct_at(reinterpret_cast<key_type*>(slots_ + index), niche::make_empty());
+    }
+
+    void erase_index(size_type index) noexcept {
+        erase_slot_contents(index);
+        --size_;
+
+        if constexpr (uses_niche) {
+            ++growth_left_;
+            // Backward-shift: move later elements of the cluster into the hole,
+            // unless their home slot lies cyclically in (hole, j].
+            size_type mask = capacity_ - 1;
+            size_type hole = index;
+            for (size_type j = (hole + 1) & mask; is_full(j); j = (j + 1) & mask) {
+                size_type home = hash_of(key_at(j)) & mask;
+                bool stays = hole <= j ? (hole < home && home <= j)
+                                       : (hole < home || home <= j);
+                if (stays)
+                    continue;
+                std::destroy_at(reinterpret_cast<key_type*>(slots_ + hole));
+                relocate(slots_ + j, slots_ + hole);
+                std::construct_at(reinterpret_cast<key_type*>(slots_ + j), niche::make_empty());
+                hole = j;
+            }
+        } else {
+            // A slot can become empty again if no probe sequence went past it
+            // while it was full, which is the case when its group has an empty slot.
+            size_type mask = capacity_ - 1;
+            size_type before = (index - group::width) & mask;
+            auto empty_after = group(ctrl_ + index).match_empty();
+            auto empty_before = group(ctrl_ + before).match_empty();
+            bool was_never_full = empty_before && empty_after
+                && static_cast<size_type>(trailing_non_empty(empty_after)
+                                          + leading_non_empty(empty_before)) < group::width;
+            if (was_never_full) {
+                set_ctrl(index, ctrl_empty);
+                ++growth_left_;
+            } else {
+                set_ctrl(index, ctrl_deleted);
+            }
+        }
+    }
+
+    template<typename Mask>
+    static size_type trailing_non_empty(Mask m) noexcept {
+        return m.lowest();
+    }
+
+    // Number of non-empty slots at the end of the group before `index`.
+    template<typename Mask>
+    static size_type leading_non_empty(Mask m) noexcept {
+        size_type last = 0;
+        for (size_type bit : m)
+            last = bit;
+        return group::width - 1 - last;
+    }
+
+    void relocate(value_type* from, value_type* to) {
+        slot_alloc a(alloc_);
+        slot_traits::construct(a, to, std::move(*from));
+        slot_traits::destroy(a, from);
+    }
+
+    void resize(size_type new_capacity) {
+        ctrl_t* old_ctrl = ctrl_;
+        value_type* old_slots = slots_;
+        size_type old_capacity = capacity_;
+
+        allocate(new_capacity);
+
+        for (size_type i = 0; i < old_capacity; ++i) {
+            bool full;
+            if constexpr (uses_niche)
+                full = !niche::is_empty(*std::launder(reinterpret_cast<key_type const*>(old_slots + i)));
+            else
+                full = old_ctrl[i] >= 0;
+            if (!full)
+                continue;
+
+            std::size_t h = hash_of(Traits::key(old_slots[i]));
+            size_type index = find_non_full(h);
+            if constexpr (uses_niche)
+                std::destroy_at(reinterpret_cast<key_type*>(slots_ + index));
+            else
+                set_ctrl(index, static_cast<ctrl_t>(h & 0x7f));
+            relocate(old_slots + i, slots_ + index);
+        }
+        growth_left_ = max_load(capacity_) - size_;
+
+        deallocate(old_ctrl, old_slots, old_capacity);
+    }
+
+    void allocate(size_type capacity) {
+        slot_alloc sa(alloc_);
+        value_type* slots = slot_traits::allocate(sa, capacity);
+        ctrl_t* ctrl = nullptr;
+        if constexpr (!uses_niche) {
+#if TSL_HAS_EXCEPTIONS
+            try {
+                ctrl_alloc ca(alloc_);
+                ctrl = ctrl_traits::allocate(ca, capacity + group::width);
+            } catch (...) {
+                slot_traits::deallocate(sa, slots, capacity);
+                throw;
+            }
+#else
+            ctrl_alloc ca(alloc_);
+            ctrl = ctrl_traits::allocate(ca, capacity + group::width);
+#endif
+        }
+        ctrl_ = ctrl;
+        slots_ = slots;
+        capacity_ = capacity;
+        reset_ctrl();
+    }
+
+    void deallocate(ctrl_t* ctrl, value_type* slots, size_type capacity) noexcept {
+        if (capacity == 0)
+            return;
+        slot_alloc sa(alloc_);
+        slot_traits::deallocate(sa, slots, capacity);
+        if constexpr (!uses_niche) {
+            ctrl_alloc ca(alloc_);
+            ctrl_traits::deallocate(ca, ctrl, capacity + group::width);
+        }
+    }
+
+    void destroy_all() noexcept {
+        if constexpr (!std::is_trivially_destructible_v<value_type>) {
+            slot_alloc a(alloc_);
+            for (size_type i = 0; i < capacity_; ++i) {
+                if (is_full(i))
+                    slot_traits::destroy(a, slots_ + i);
+            }
+        }
+        deallocate(ctrl_, slots_, capacity_);
+        ctrl_ = nullptr;
+        slots_ = nullptr;
+        capacity_ = 0;
+        size_ = 0;
+        growth_left_ = 0;
+    }
+
+    template<typename Other, typename V>
+    static decltype(auto) element_from(V& v) noexcept {
+        if constexpr (std::is_lvalue_reference_v<Other>)
+            return static_cast<V const&>(v);
+        else
+            return std::move(v);
+    }
+
+    // Copies the elements of `other`, or moves them if it's an rvalue.
+    template<typename Other>
+    void copy_from(Other&& other) {
+        if (other.size_ == 0)
+            return;
+        resize(capacity_for(other.size_));
+        for (auto& v : other) {
+            std::size_t h = hash_of(Traits::key(v));
+            size_type index = find_non_full(h);
+            if constexpr (uses_niche) {
+                std::destroy_at(reinterpret_cast<key_type*>(slots_ + index));
+#if TSL_HAS_EXCEPTIONS
+                try {
+                    construct_slot(index, element_from<Other>(v));
+                } catch (...) {
+                    std::construct_at(reinterpret_cast<key_type*>(slots_ + index), niche::make_empty());
+                    throw;
+                }
+#else
+                construct_slot(index, element_from<Other>(v));
+#endif
+            } else {
+                // The slot is marked full only once it holds a value.
+                construct_slot(index, element_from<Other>(v));
+                set_ctrl(index, static_cast<ctrl_t>(h & 0x7f));
+            }
+            ++size_;
+            --growth_left_;
+        }
+    }
+
+    [[no_unique_address]] Hash hash_;
+    [[no_unique_address]] Eq eq_;
+    [[no_unique_address]] Alloc alloc_;
+
+    ctrl_t* ctrl_ = nullptr;
+    value_type* slots_ = nullptr;
+    size_type capacity_ = 0;
+    size_type size_ = 0;
+    size_type growth_left_ = 0;
+};
+
+}}
+
+#endif // _TSL_INTERNAL_RAW_FLAT_TABLE_HPP
@@ -2,6 +2,7 @@
 #define _TSL_MAYBE_HPP
 
 #include <exception>
+#include <functional>
 #include <initializer_list>
 #include <memory>
 #include <type_traits>
@@ -38,6 +39,12 @@ union Storage {
     constexpr Storage(Args&&... args):
         value_(std::forward<Args>(args)...) { }
 
+    // Declared so copies and moves of Storage don't pick the variadic constructor.
+    constexpr Storage(Storage const&) = default;
+    constexpr Storage(Storage&&) = default;
+    constexpr Storage& operator=(Storage const&) = default;
+    constexpr Storage& operator=(Storage&&) = default;
+
     constexpr ~Storage() = default;
 
     // User-defined destructors are required for non-trivially destructible types.
@@ -65,6 +72,11 @@ concept assigns_from =
     || std::assignable_from<T&, U&&>
     || std::assignable_from<T&, U const&&>;
 
+// What transform(f) holds when `f` returns a U: lvalue references are kept, rvalue
+// references are moved into a value.
+template<typename U>
+using transform_value = std::conditional_t<std::is_rvalue_reference_v<U>, std::remove_cvref_t<U>, U>;
+
 }
 
 template<typename T>
@@ -116,6 +128,43 @@ struct maybe_backend_default_t {
 template<typename T>
 using maybe_backend_default = typename maybe_backend_default_t<T>::type;
 
+// Backend for references, the empty state is a null pointer.
+template<typename T>
+class maybe_backend_reference {
+public:
+    using value_type = T&;
+    static constexpr bool allow_unchecked_value = false;
+
+    constexpr maybe_backend_reference() noexcept = default;
+
+    constexpr explicit maybe_backend_reference(T& ref) noexcept:
+        ptr_(std::addressof(ref)) { }
+
+    constexpr void construct(T& ref) noexcept {
+        ptr_ = std::addressof(ref);
+    }
+
+    constexpr bool has_value() const noexcept {
+        return ptr_ != nullptr;
+    }
+
+    constexpr T& get() const noexcept {
+        return *ptr_;
+    }
+
+    constexpr void destruct() noexcept {
+        ptr_ = nullptr;
+    }
+
+private:
+    T* ptr_ = nullptr;
+};
+
+template<typename T>
+struct maybe_backend_default_t<T&> {
+    using type = maybe_backend_reference<T>;
+};
+
 template<typename BackendType>
 class maybe_base {
 public:
@@ -438,12 +487,68 @@ public:
             return static_cast<T>(std::forward<U>(default_value));
     }
 
+    // `f(value)`, which must return a maybe, or an empty one.
+    template<typename F>
+    constexpr auto and_then(F&& f) & { return and_then_impl(*this, std::forward<F>(f)); }
+    template<typename F>
+    constexpr auto and_then(F&& f) const& { return and_then_impl(*this, std::forward<F>(f)); }
+    template<typename F>
+    constexpr auto and_then(F&& f) && { return and_then_impl(std::move(*this), std::forward<F>(f)); }
+
+    // maybe holding `f(value)`, or an empty one. `f` may return a reference.
+    template<typename F>
+    constexpr auto transform(F&& f) & { return transform_impl(*this, std::forward<F>(f)); }
+    template<typename F>
+    constexpr auto transform(F&& f) const& { return transform_impl(*this, std::forward<F>(f)); }
+    template<typename F>
+    constexpr auto transform(F&& f) && { return transform_impl(std::move(*this), std::forward<F>(f)); }
+
+    // This maybe if it has a value, `f()` otherwise.
+    template<typename F>
+    constexpr maybe_base or_else(F&& f) const&
+        requires(std::copy_constructible<T>)
+    {
+        if (this->has_value())
+            return *this;
+        else
+            return std::invoke(std::forward<F>(f));
+    }
+
+    template<typename F>
+    constexpr maybe_base or_else(F&& f) &&
+        requires(std::move_constructible<T>)
+    {
+        if (this->has_value())
+            return std::move(*this);
+        else
+            return std::invoke(std::forward<F>(f));
+    }
+
     constexpr void reset() noexcept {
         if (this->has_value())
             destruct();
     }
 
 private:
+    template<typename Self, typename F>
+    static constexpr auto and_then_impl(Self&& self, F&& f) {
+        using R = std::remove_cvref_t<std::invoke_result_t<F, decltype(*std::forward<Self>(self))>>;
+        if (self.has_value())
+            return std::invoke(std::forward<F>(f), *std::forward<Self>(self));
+        else
+            return R();
+    }
+
+    template<typename Self, typename F>
+    static constexpr auto transform_impl(Self&& self, F&& f) {
+        using U = std::invoke_result_t<F, decltype(*std::forward<Self>(self))>;
+        using R = maybe_base<maybe_backend_default<internal_maybe::transform_value<U>>>;
+        if (self.has_value())
+            return R(std::invoke(std::forward<F>(f), *std::forward<Self>(self)));
+        else
+            return R();
+    }
+
     // TODO: Allow custom implementation of copy_construct in the backend
     constexpr void copy_construct(T const& rhs) {
         backend_.construct(rhs);
@@ -461,6 +566,146 @@ private:
     BackendType backend_;
 };
 
+// maybe<T&>
+//
+// An optional reference: a single pointer, null when empty, so it is trivially
+// copyable and passed in registers. Assignment rebinds the reference instead of
+// assigning through it, and it never binds to a temporary.
+template<typename T>
+class maybe_base<maybe_backend_reference<T>> {
+    using backend_type = maybe_backend_reference<T>;
+
+public:
+    using value_type = T&;
+    static constexpr bool allow_unchecked_value = false;
+
+    constexpr maybe_base() noexcept = default;
+
+    template<typename U>
+    constexpr maybe_base(U& ref) noexcept
+        requires(std::convertible_to<U*, T*>)
+        : backend_(ref) { }
+
+    template<typename U>
+    constexpr maybe_base(U const&& ref)
+        requires(std::convertible_to<U*, T*>) = delete;
+
+    // maybe<Derived&> to maybe<Base&>, maybe<T&> to maybe<T const&>.
+    template<typename U>
+    constexpr maybe_base(maybe_base<maybe_backend_reference<U>> const& rhs) noexcept
+        requires(std::convertible_to<U*, T*> && !std::same_as<U, T>)
+    {
+        if (rhs.has_value())
+            backend_.construct(*rhs);
+    }
+
+    constexpr maybe_base(maybe_base const&) noexcept = default;
+    constexpr maybe_base& operator=(maybe_base const&) noexcept = default;
+
+    // Rebinds.
+    template<typename U>
+    constexpr maybe_base& operator=(U& ref) noexcept
+        requires(std::convertible_to<U*, T*>)
+    {
+        backend_.construct(ref);
+        return *this;
+    }
+
+    template<typename U>
+    constexpr maybe_base& operator=(U const&& ref)
+        requires(std::convertible_to<U*, T*>) = delete;
+
+    template<typename U>
+    constexpr T& emplace(U& ref) noexcept
+        requires(std::convertible_to<U*, T*>)
+    {
+        backend_.construct(ref);
+        return backend_.get();
+    }
+
+    constexpr void swap(maybe_base& rhs) noexcept {
+        std::swap(backend_, rhs.backend_);
+    }
+
+    friend constexpr void swap(maybe_base& lhs, maybe_base& rhs) noexcept {
+        lhs.swap(rhs);
+    }
+
+    constexpr T* operator->() const {
+        TSL_HARDENING_ASSERT(this->has_value());
+        return std::addressof(backend_.get());
+    }
+
+    constexpr T& operator*() const {
+        TSL_HARDENING_ASSERT(this->has_value());
+        return backend_.get();
+    }
+
+    constexpr explicit operator bool() const noexcept {
+        return this->has_value();
+    }
+
+    constexpr bool has_value() const noexcept {
+        return backend_.has_value();
+    }
+
+    constexpr T& value() const {
+        if (!this->has_value())
+            TSL_THROW(bad_maybe_access());
+
+        return backend_.get();
+    }
+
+    // A copy of the referred value, or `default_value`.
+    template<typename U>
+    constexpr std::remove_cv_t<T> value_or(U&& default_value) const
+        requires(std::convertible_to<U&&, std::remove_cv_t<T>>
+              && std::copy_constructible<std::remove_cv_t<T>>)
+    {
+        if (this->has_value())
+            return backend_.get();
+        else
+            return static_cast<std::remove_cv_t<T>>(std::forward<U>(default_value));
+    }
+
+    // `f(value)`, which must return a maybe, or an empty one.
+    template<typename F>
+    constexpr auto and_then(F&& f) const {
+        using R = std::remove_cvref_t<std::invoke_result_t<F, T&>>;
+        if (this->has_value())
+            return std::invoke(std::forward<F>(f), backend_.get());
+        else
+            return R();
+    }
+
+    // maybe holding `f(value)`, or an empty one. `f` may return a reference.
+    template<typename F>
+    constexpr auto transform(F&& f) const {
+        using U = std::invoke_result_t<F, T&>;
+        using R = maybe_base<maybe_backend_default<internal_maybe::transform_value<U>>>;
+        if (this->has_value())
+            return R(std::invoke(std::forward<F>(f), backend_.get()));
+        else
+            return R();
+    }
+
+    // This maybe if it has a value, `f()` otherwise.
+    template<typename F>
+    constexpr maybe_base or_else(F&& f) const {
+        if (this->has_value())
+            return *this;
+        else
+            return std::invoke(std::forward<F>(f));
+    }
+
+    constexpr void reset() noexcept {
+        backend_.destruct();
+    }
+
+private:
+    backend_type backend_;
+};
+
 template<typename BT>
 using maybe_base_underlying = typename maybe_base<maybe_backend_default<BT>>::value_type;
 
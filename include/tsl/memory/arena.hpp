@@ -0,0 +1,223 @@
+// A monotonic (bump-pointer) allocator.
+// Memory is taken from chunks that grow geometrically and is only given back all at
+// once, by rewinding to a marker or resetting the arena. Chunks are kept for reuse
+// after a rewind, so a per-request arena stops calling malloc after warming up.
+//
+// Destructors of objects living in the arena are never called.
+#ifndef _TSL_MEMORY_ARENA_HPP
+#define _TSL_MEMORY_ARENA_HPP
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include "tsl/attributes.hpp"
+#include "tsl/concepts.hpp"
+#include "tsl/macros.hpp"
+
+namespace tsl {
+
+class arena {
+    struct chunk_header;
+
+public:
+    // Position in the arena, see `mark()` and `rewind()`.
+    class marker {
+    public:
+        marker() = delete;
+
+    private:
+        friend class arena;
+        chunk_header* chunk_;
+        std::byte* ptr_;
+
+        marker(chunk_header* c, std::byte* p) noexcept : chunk_(c), ptr_(p) { }
+    };
+
+    arena() noexcept = default;
+
+    // The first chunk will have at least `first_chunk_size` bytes.
+    explicit arena(std::size_t first_chunk_size) noexcept;
+
+    // Allocates from `initial` until it's exhausted, before touching the heap.
+    // The buffer must outlive the arena.
+    explicit arena(std::span<std::byte> initial TSL_ATTR_LIFETIMEBOUND,
+                   std::size_t next_chunk_size = 0) noexcept;
+
+    arena(arena const&) = delete;
+    arena& operator=(arena const&) = delete;
+
+    ~arena();
+
+    // Returns `bytes` bytes aligned to `align`, which must be a power of two.
+    // Throws std::bad_alloc if the system allocator fails.
+    [[nodiscard]] void* allocate(std::size_t bytes,
+                                 std::size_t align = alignof(std::max_align_t)) {
+        TSL_ASSERT(std::has_single_bit(align));
+        auto p = reinterpret_cast<std::uintptr_t>(ptr_);
+        auto aligned = (p + align - 1) & ~(align - 1);
+        auto end = reinterpret_cast<std::uintptr_t>(end_);
+        // Not `aligned + bytes <= end`, which wraps around for huge requests.
+        if (TSL_EXPECT_TRUE(aligned >= p && aligned <= end && bytes <= end - aligned)) {
+            ptr_ = reinterpret_cast<std::byte*>(aligned + bytes);
+            return reinterpret_cast<void*>(aligned);
+        }
+        return allocate_slow(bytes, align);
+    }
+
+    // Uninitialized storage for `n` objects of type T.
+    template<typename T>
+    [[nodiscard]] T* allocate_array(std::size_t n) {
+        if (n > SIZE_MAX / sizeof(T))
+            TSL_THROW(std::bad_array_new_length());
+        return static_cast<T*>(allocate(n * sizeof(T), alignof(T)));
+    }
+
+    // Creates an object in the arena. Since its destructor will never be
+    // called, T must be trivially destructible.
+    template<trivially_destructible T, typename... Args>
+    [[nodiscard]] T* create(Args&&... args)
+        requires(std::constructible_from<T, Args...>)
+    {
+        return std::construct_at(static_cast<T*>(allocate(sizeof(T), alignof(T))),
+                                 std::forward<Args>(args)...);
+    }
+
+    // Current position. Everything allocated after it is freed by `rewind()`.
+    [[nodiscard]] marker mark() const noexcept {
+        return marker(current_, ptr_);
+    }
+
+    void rewind(marker m) noexcept;
+
+    // Rewinds to the beginning, keeping the chunks for reuse.
+    void reset() noexcept;
+
+    // Rewinds to the beginning and frees every chunk.
+    void release() noexcept;
+
+    // Bytes reserved from the system allocator, including unused chunks.
+    [[nodiscard]] std::size_t reserved() const noexcept;
+
+private:
+    void* allocate_slow(std::size_t bytes, std::size_t align);
+    void free_chunks(chunk_header* first) noexcept;
+
+    // Heap chunks, in allocation order. Chunks after `current_` are spares
+    // left by a rewind. `current_` is null while using the initial buffer.
+    chunk_header* head_ = nullptr;
+    chunk_header* current_ = nullptr;
+
+    std::byte* ptr_ = nullptr;
+    std::byte* end_ = nullptr;
+
+    std::byte* initial_begin_ = nullptr;
+    std::byte* initial_end_ = nullptr;
+
+    std::size_t next_chunk_size_ = 4096;
+};
+
+// arena_scope
+//
+// Rewinds the arena to the position it had at construction when destroyed.
+class arena_scope {
+public:
+    explicit arena_scope(arena& a TSL_ATTR_LIFETIMEBOUND) noexcept
+        : arena_(a), marker_(a.mark()) { }
+
+    arena_scope(arena_scope const&) = delete;
+    arena_scope& operator=(arena_scope const&) = delete;
+
+    ~arena_scope() {
+        arena_.rewind(marker_);
+    }
+
+private:
+    arena& arena_;
+    arena::marker marker_;
+};
+
+// inline_arena
+//
+// An arena whose first `N` bytes live inside the object itself.
+template<std::size_t N>
+class inline_arena : public arena {
+public:
+    inline_arena() noexcept
+        : arena(std::span<std::byte>(buffer_, N)) { }
+
+    explicit inline_arena(std::size_t next_chunk_size) noexcept
+        : arena(std::span<std::byte>(buffer_, N), next_chunk_size) { }
+
+private:
+    alignas(std::max_align_t) std::byte buffer_[N];
+};
+
+// arena_resource
+//
+// Adapts an arena to std::pmr, so std::pmr containers and strings can live in it.
+// Deallocation is a no-op.
+class arena_resource : public std::pmr::memory_resource {
+public:
+    explicit arena_resource(arena& a TSL_ATTR_LIFETIMEBOUND) noexcept : arena_(a) { }
+
+    [[nodiscard]] arena& get_arena() const noexcept {
+        return arena_;
+    }
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t align) override {
+        return arena_.allocate(bytes != 0 ? bytes : 1, align);
+    }
+
+    void do_deallocate(void*, std::size_t, std::size_t) override { }
+
+    bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override {
+        auto* r = dynamic_cast<arena_resource const*>(&other);
+        return r != nullptr && &r->arena_ == &arena_;
+    }
+
+    arena& arena_;
+};
+
+// arena_allocator
+//
+// A standard allocator drawing from an arena, for containers that take an allocator
+// type instead of a memory resource. Deallocation is a no-op.
+template<typename T>
+class arena_allocator {
+public:
+    using value_type = T;
+
+    explicit arena_allocator(arena& a TSL_ATTR_LIFETIMEBOUND) noexcept : arena_(&a) { }
+
+    template<typename U>
+    arena_allocator(arena_allocator<U> const& other) noexcept : arena_(&other.get_arena()) { }
+
+    [[nodiscard]] T* allocate(std::size_t n) {
+        return arena_->allocate_array<T>(n);
+    }
+
+    void deallocate(T*, std::size_t) noexcept { }
+
+    [[nodiscard]] arena& get_arena() const noexcept {
+        return *arena_;
+    }
+
+    template<typename U>
+    friend bool operator==(arena_allocator const& lhs, arena_allocator<U> const& rhs) noexcept {
+        return &lhs.get_arena() == &rhs.get_arena();
+    }
+
+private:
+    arena* arena_;
+};
+
+}
+
+#endif // _TSL_MEMORY_ARENA_HPP
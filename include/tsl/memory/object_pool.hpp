@@ -0,0 +1,296 @@
+// A slab allocator for objects of a single type.
+// Objects live in fixed-size slabs that are never returned to the system while the
+// pool exists, so pointers are stable and churn doesn't fragment the global heap.
+// Free slots are linked through their own unconstructed storage.
+//
+// Slabs are aligned to their size and start with a header holding their index,
+// so both pointer -> handle and handle -> pointer conversions are O(1).
+#ifndef _TSL_MEMORY_OBJECT_POOL_HPP
+#define _TSL_MEMORY_OBJECT_POOL_HPP
+
+#include <atomic>
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "tsl/attributes.hpp"
+#include "tsl/macros.hpp"
+#include "tsl/maybe.hpp"
+
+namespace tsl {
+
+template<typename T, std::size_t SlotsPerSlab = 64>
+class object_pool {
+    union slot {
+        slot() noexcept : next(nullptr) { }
+        ~slot() { }
+
+        slot* next;
+        internal_maybe::Storage<T> storage;
+    };
+
+    struct slab_header {
+        std::uint32_t index;
+    };
+
+    static constexpr std::size_t header_size =
+        (sizeof(slab_header) + alignof(slot) - 1) / alignof(slot) * alignof(slot);
+
+public:
+    static_assert(SlotsPerSlab > 0);
+
+    static constexpr std::size_t slab_bytes =
+        std::bit_ceil(header_size + SlotsPerSlab * sizeof(slot));
+
+    // At least `SlotsPerSlab`, rounding the slab up to a power of two leaves room for more.
+    static constexpr std::size_t slots_per_slab = (slab_bytes - header_size) / sizeof(slot);
+
+    // A 32-bit index identifying an object of the pool, valid until it's destroyed.
+    class handle {
+    public:
+        constexpr handle() noexcept : index_(UINT32_MAX) { }
+
+        [[nodiscard]] constexpr std::uint32_t index() const noexcept {
+            return index_;
+        }
+
+        friend constexpr auto operator<=>(handle, handle) = default;
+
+    private:
+        friend class object_pool;
+        constexpr explicit handle(std::uint32_t index) noexcept : index_(index) { }
+
+        std::uint32_t index_;
+    };
+
+    // A per-thread cache of free slots, to be used by a single thread at a time.
+    // Slots are taken from and returned to the shared pool in batches, so the
+    // pool's lock is taken once every `batch` operations at most.
+    class cache {
+    public:
+        explicit cache(object_pool& pool TSL_ATTR_LIFETIMEBOUND, std::size_t batch = 32) noexcept
+            : pool_(pool), batch_(batch > 0 ? batch : 1) { }
+
+        cache(cache const&) = delete;
+        cache& operator=(cache const&) = delete;
+
+        ~cache() {
+            if (free_ != nullptr)
+                pool_.release_list(free_, count_);
+        }
+
+        template<typename... Args>
+        [[nodiscard]] T* create(Args&&... args)
+            requires(std::constructible_from<T, Args...>)
+        {
+            if (free_ == nullptr)
+                count_ = pool_.acquire_list(free_, batch_);
+            slot* s = free_;
+            free_ = s->next;
+            --count_;
+            return pool_.construct(s, std::forward<Args>(args)...);
+        }
+
+        template<typename... Args>
+        [[nodiscard]] handle create_handle(Args&&... args)
+            requires(std::constructible_from<T, Args...>)
+        {
+            return pool_.handle_of(create(std::forward<Args>(args)...));
+        }
+
+        void destroy(T* p) noexcept {
+            std::destroy_at(TSL_ASSERT_NONNULL(p));
+            slot* s = slot_of(p);
+            s->next = free_;
+            free_ = s;
+
+            // Keeps one batch locally, so alternating create/destroy at the
+            // boundary doesn't hit the shared pool every time.
+            if (++count_ >= 2 * batch_) {
+                slot* rest = free_;
+                for (std::size_t i = 1; i < batch_; ++i)
+                    rest = rest->next;
+                slot* returned = rest->next;
+                rest->next = nullptr;
+                pool_.release_list(returned, count_ - batch_);
+                count_ = batch_;
+            }
+        }
+
+        void destroy(handle h) noexcept {
+            destroy(std::addressof(pool_.get(h)));
+        }
+
+    private:
+        object_pool& pool_;
+        std::size_t batch_;
+        slot* free_ = nullptr;
+        std::size_t count_ = 0;
+    };
+
+    object_pool() = default;
+
+    object_pool(object_pool const&) = delete;
+    object_pool& operator=(object_pool const&) = delete;
+
+    // Objects still alive are not destroyed, only their memory is released.
+    ~object_pool() {
+        std::uint32_t n = slab_count_.load(std::memory_order_relaxed);
+        slab_header** dir = directory_.load(std::memory_order_relaxed);
+        for (std::uint32_t i = 0; i < n; ++i)
+            ::operator delete(dir[i], std::align_val_t(slab_bytes));
+    }
+
+    template<typename... Args>
+    [[nodiscard]] T* create(Args&&... args)
+        requires(std::constructible_from<T, Args...>)
+    {
+        slot* s;
+        acquire_list(s, 1);
+        return construct(s, std::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+    [[nodiscard]] handle create_handle(Args&&... args)
+        requires(std::constructible_from<T, Args...>)
+    {
+        return handle_of(create(std::forward<Args>(args)...));
+    }
+
+    void destroy(T* p) noexcept {
+        std::destroy_at(TSL_ASSERT_NONNULL(p));
+        slot* s = slot_of(p);
+        s->next = nullptr;
+        release_list(s, 1);
+    }
+
+    void destroy(handle h) noexcept {
+        destroy(std::addressof(get(h)));
+    }
+
+    // `h` must refer to a live object.
+    [[nodiscard]] T& get(handle h) const noexcept {
+        std::uint32_t slab = h.index_ / slots_per_slab;
+        TSL_HARDENING_ASSERT(slab < slab_count_.load(std::memory_order_relaxed));
+        slab_header* header = directory_.load(std::memory_order_acquire)[slab];
+        return slot_at(header, h.index_ % slots_per_slab)->storage.value_;
+    }
+
+    // `p` must point to an object created by this pool.
+    [[nodiscard]] handle handle_of(T const* p) const noexcept {
+        auto address = reinterpret_cast<std::uintptr_t>(TSL_ASSERT_NONNULL(p));
+        auto* header = reinterpret_cast<slab_header*>(address & ~(slab_bytes - 1));
+        auto offset = (address - reinterpret_cast<std::uintptr_t>(slot_at(header, 0))) / sizeof(slot);
+        return handle(static_cast<std::uint32_t>(header->index * slots_per_slab + offset));
+    }
+
+    // Number of slots in every slab, either free or in use.
+    [[nodiscard]] std::size_t capacity() const noexcept {
+        return slab_count_.load(std::memory_order_relaxed) * slots_per_slab;
+    }
+
+private:
+    template<typename... Args>
+    T* construct(slot* s, Args&&... args) {
+        T* p = std::addressof(s->storage.value_);
+#if TSL_HAS_EXCEPTIONS
+        try {
+            std::construct_at(p, std::forward<Args>(args)...);
+        } catch (...) {
+            s->next = nullptr;
+            release_list(s, 1);
+            throw;
+        }
+#else
+        std::construct_at(p, std::forward<Args>(args)...);
+#endif
+        return p;
+    }
+
+    static slot* slot_at(slab_header* header, std::size_t i) noexcept {
+        return reinterpret_cast<slot*>(reinterpret_cast<std::byte*>(header) + header_size) + i;
+    }
+
+    static slot* slot_of(T* p) noexcept {
+        // Every member of a union, and of the nested Storage union, shares its address.
+        return reinterpret_cast<slot*>(p);
+    }
+
+    // Takes up to `n` (at least one) free slots, linked through `next`. Returns how many.
+    std::size_t acquire_list(slot*& list, std::size_t n) {
+        std::lock_guard lock(mutex_);
+        if (free_ == nullptr)
+            add_slab();
+
+        list = free_;
+        slot* last = free_;
+        std::size_t taken = 1;
+        while (taken < n && last->next != nullptr) {
+            last = last->next;
+            ++taken;
+        }
+        free_ = last->next;
+        last->next = nullptr;
+        return taken;
+    }
+
+    // Returns a null-terminated list of `n` free slots.
+    void release_list(slot* list, std::size_t n) noexcept {
+        slot* last = list;
+        for (std::size_t i = 1; i < n; ++i)
+            last = last->next;
+
+        std::lock_guard lock(mutex_);
+        last->next = free_;
+        free_ = list;
+    }
+
+    // Called with the lock held.
+    void add_slab() {
+        std::uint32_t n = slab_count_.load(std::memory_order_relaxed);
+        if (n == directory_capacity_)
+            grow_directory();
+
+        void* memory = ::operator new(slab_bytes, std::align_val_t(slab_bytes));
+        auto* header = ::new (memory) slab_header{n};
+        for (std::size_t i = slots_per_slab; i-- > 0; ) {
+            slot* s = ::new (static_cast<void*>(slot_at(header, i))) slot();
+            s->next = free_;
+            free_ = s;
+        }
+
+        directory_.load(std::memory_order_relaxed)[n] = header;
+        slab_count_.store(n + 1, std::memory_order_release);
+    }
+
+    void grow_directory() {
+        std::size_t capacity = directory_capacity_ != 0 ? directory_capacity_ * 2 : 8;
+        auto grown = std::make_unique<slab_header*[]>(capacity);
+        slab_header** old = directory_.load(std::memory_order_relaxed);
+        for (std::size_t i = 0; i < directory_capacity_; ++i)
+            grown[i] = old[i];
+
+        // Readers of `get()` may still use the old directory.
+        directory_.store(grown.get(), std::memory_order_release);
+        directories_.push_back(std::move(grown));
+        directory_capacity_ = capacity;
+    }
+
+    std::mutex mutex_;
+    slot* free_ = nullptr;
+
+    std::atomic<slab_header**> directory_ {nullptr};
+    std::atomic<std::uint32_t> slab_count_ {0};
+    std::size_t directory_capacity_ = 0;
+    std::vector<std::unique_ptr<slab_header*[]>> directories_;
+};
+
+}
+
+#endif // _TSL_MEMORY_OBJECT_POOL_HPP
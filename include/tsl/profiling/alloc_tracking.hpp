@@ -0,0 +1,149 @@
+// Heap allocation tracking, to check that hot paths don't allocate.
+//
+//     void on_packet(packet const& p) {
+//         TSL_ASSERT_NO_ALLOC();
+//         ...
+//     }
+//
+//     void load_config() {
+//         TSL_ALLOC_PROFILE_SCOPE("load_config");
+//         ...
+//     }
+//     tsl::alloc::write_profile(stderr);
+//
+// Built with the TSL_ALLOC_TRACKING CMake option, tsl replaces operator new and
+// delete, and with glibc also malloc, calloc, realloc, free and the aligned variants.
+// Every allocation increments counters of the calling thread, which costs a few
+// thread-local increments and a branch. Without the option, the macros expand to
+// nothing and the counters stay at zero.
+//
+// An allocation inside a TSL_ASSERT_NO_ALLOC scope aborts, or is reported on stderr
+// and counted, depending on `set_violation_action`. An allocation inside
+// TSL_ALLOC_PROFILE_SCOPE scopes is counted under the innermost one.
+//
+// With sanitizers, which replace malloc themselves, only operator new and delete
+// are tracked.
+#ifndef _TSL_PROFILING_ALLOC_TRACKING_HPP
+#define _TSL_PROFILING_ALLOC_TRACKING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "tsl/defer.hpp"
+#include "tsl/literal_string.hpp"
+
+#ifndef TSL_ALLOC_TRACKING
+#define TSL_ALLOC_TRACKING 0
+#endif
+
+namespace tsl {
+
+namespace internal_alloc {
+
+// Counters of a named profile scope, shared by every thread.
+struct tag {
+    char const* name;
+    std::atomic<std::uint64_t> allocations {0};
+    std::atomic<std::uint64_t> bytes {0};
+    std::atomic<bool> registered {false};
+    tag* next = nullptr;
+};
+
+template<literal_string Name>
+inline constexpr literal_string name_storage = Name;
+
+template<literal_string Name>
+inline tag tag_storage {name_storage<Name>.data};
+
+}
+
+namespace alloc {
+
+// Allocations made by the calling thread since it started.
+struct counters {
+    std::uint64_t allocations = 0;
+    std::uint64_t deallocations = 0;
+    std::uint64_t bytes = 0;
+};
+
+enum class violation_action {
+    abort,
+    log,
+};
+
+struct profile_entry {
+    char const* name;
+    std::uint64_t allocations;
+    std::uint64_t bytes;
+};
+
+// Whether tsl was built with allocation tracking.
+inline constexpr bool enabled = TSL_ALLOC_TRACKING;
+
+[[nodiscard]] counters thread_counters() noexcept;
+
+// What happens on an allocation inside a TSL_ASSERT_NO_ALLOC scope. Defaults to abort.
+void set_violation_action(violation_action action) noexcept;
+
+// Allocations made inside TSL_ASSERT_NO_ALLOC scopes, with the log action.
+[[nodiscard]] std::uint64_t violations() noexcept;
+
+// Counters of every profile scope entered so far.
+[[nodiscard]] std::vector<profile_entry> profile();
+
+// Resets the counters of every profile scope.
+void reset_profile() noexcept;
+
+// Writes the profile as a table.
+void write_profile(std::FILE* out);
+
+// Forbids allocations in the calling thread while it exists. Scopes nest.
+class no_alloc_scope {
+public:
+    no_alloc_scope() noexcept;
+    ~no_alloc_scope();
+
+    no_alloc_scope(no_alloc_scope const&) = delete;
+    no_alloc_scope& operator=(no_alloc_scope const&) = delete;
+};
+
+// Counts the calling thread's allocations under `t` while it exists.
+class profile_scope {
+public:
+    explicit profile_scope(internal_alloc::tag& t) noexcept;
+    ~profile_scope();
+
+    profile_scope(profile_scope const&) = delete;
+    profile_scope& operator=(profile_scope const&) = delete;
+
+private:
+    internal_alloc::tag* previous_;
+};
+
+}}
+
+#if TSL_ALLOC_TRACKING
+
+// TSL_ASSERT_NO_ALLOC
+//
+// Forbids heap allocations in the calling thread until the end of the scope.
+#define TSL_ASSERT_NO_ALLOC() \
+    const ::tsl::alloc::no_alloc_scope TSL_INTERNAL_DEFER_CONCAT(_tsl_no_alloc__, __LINE__)
+
+// TSL_ALLOC_PROFILE_SCOPE
+//
+// Counts the allocations until the end of the scope under `name`, a string literal.
+#define TSL_ALLOC_PROFILE_SCOPE(name) \
+    const ::tsl::alloc::profile_scope TSL_INTERNAL_DEFER_CONCAT(_tsl_alloc_profile__, __LINE__)( \
+        ::tsl::internal_alloc::tag_storage<::tsl::literal_string(name)>)
+
+#else
+
+#define TSL_ASSERT_NO_ALLOC() static_cast<void>(0)
+#define TSL_ALLOC_PROFILE_SCOPE(name) static_cast<void>(0)
+
+#endif
+
+#endif // _TSL_PROFILING_ALLOC_TRACKING_HPP
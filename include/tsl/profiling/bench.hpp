@@ -0,0 +1,176 @@
+// Statistical microbenchmarks.
+//
+//     int main(int argc, char** argv) {
+//         tsl::bench::runner r(argc, argv);
+//         r.run("flat_map/find", [&] {
+//             tsl::bench::do_not_optimize(map.find(key));
+//         });
+//         return r.finish();
+//     }
+//
+// The iteration count of a sample is calibrated until a sample lasts at least
+// `min_sample_time`, then `samples` samples are timed. Results report the median and
+// the median absolute deviation, which unlike the mean and the standard deviation
+// aren't moved by a few preempted samples, percentiles, and the number of outliers
+// beyond Tukey's fences.
+//
+// A benchmark body either takes no arguments and is called once per iteration, or
+// takes the iteration count and runs the loop itself.
+//
+// Command line: --filter=<substring>, --json=<path>, --cpu=<n>, --pin=<0|1>,
+// --samples=<n>, --min-time-ms=<n>. CMake targets are added with tsl_add_benchmark().
+#ifndef _TSL_PROFILING_BENCH_HPP
+#define _TSL_PROFILING_BENCH_HPP
+
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "tsl/cstring_ref.hpp"
+#include "tsl/maybe.hpp"
+
+namespace tsl {
+
+namespace internal_bench {
+
+// Out of line, so the compiler must assume it reads the pointee.
+void escape(void const* p) noexcept;
+
+}
+
+namespace bench {
+
+// Forces `value` to be computed, and to be assumed read, without generating code.
+template<typename T>
+inline void do_not_optimize(T const& value) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    internal_bench::escape(&value);
+#endif
+}
+
+// Also makes the compiler assume `value` was modified, so it is reloaded.
+template<typename T>
+inline void do_not_optimize(T& value) noexcept {
+#if defined(__clang__)
+    asm volatile("" : "+r,m"(value) : : "memory");
+#elif defined(__GNUC__)
+    asm volatile("" : "+m,r"(value) : : "memory");
+#else
+    internal_bench::escape(&value);
+#endif
+}
+
+// Forces pending writes to memory to be performed, as seen by the compiler.
+inline void clobber_memory() noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : : "memory");
+#else
+    internal_bench::escape(nullptr);
+#endif
+}
+
+struct options {
+    // Timed samples per benchmark, after calibration.
+    std::size_t samples = 25;
+
+    // Iterations per sample are doubled until a sample lasts this long.
+    std::chrono::nanoseconds min_sample_time = std::chrono::milliseconds(5);
+
+    // CPU to pin the thread to. Empty pins to the CPU the runner started on.
+    maybe<int> cpu;
+    // Threads started by a benchmark inherit the pinning, so multithreaded
+    // benchmarks turn it off.
+    bool pin = true;
+
+    // Only benchmarks whose name contains this run.
+    std::string filter;
+
+    // Written by `finish()` when not empty.
+    std::string json_path;
+};
+
+// Times per iteration, in nanoseconds.
+struct result {
+    std::string name;
+    std::uint64_t iterations = 0; // per sample
+    std::size_t samples = 0;
+
+    double median = 0;
+    double mad = 0;
+    double mean = 0;
+    double min = 0;
+    double max = 0;
+    double p5 = 0;
+    double p25 = 0;
+    double p75 = 0;
+    double p95 = 0;
+    double p99 = 0;
+
+    // Samples beyond Tukey's fences, 1.5 interquartile ranges out of the quartiles.
+    std::size_t outliers = 0;
+};
+
+// Computes the statistics of per-iteration times. Reorders `times`.
+result summarize(std::string name, std::uint64_t iterations, std::span<double> times);
+
+class runner {
+public:
+    explicit runner(options opts = options());
+
+    // Reads options from the command line, see above, over `defaults`.
+    runner(int argc, char** argv, options defaults = options());
+
+    runner(runner const&) = delete;
+    runner& operator=(runner const&) = delete;
+
+    template<typename F>
+        requires(std::invocable<F&> || std::invocable<F&, std::uint64_t>)
+    void run(std::string_view name, F&& body) {
+        run_impl(name, &measure<std::remove_reference_t<F>>, &body);
+    }
+
+    [[nodiscard]] std::span<result const> results() const noexcept { return results_; }
+
+    // Prints a table to `out`, writes the JSON file if requested.
+    // Returns an exit status for main.
+    int finish(std::FILE* out = stdout);
+
+private:
+    // Nanoseconds taken by `iterations` iterations.
+    template<typename F>
+    static std::int64_t measure(void* body, std::uint64_t iterations) {
+        F& f = *static_cast<F*>(body);
+        auto start = std::chrono::steady_clock::now();
+        if constexpr (std::invocable<F&, std::uint64_t>) {
+            f(iterations);
+        } else {
+            for (std::uint64_t i = 0; i < iterations; ++i)
+                f();
+        }
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    }
+
+    void run_impl(std::string_view name, std::int64_t (*measure)(void*, std::uint64_t), void* body);
+    void prepare();
+
+    options opts_;
+    std::vector<result> results_;
+    bool prepared_ = false;
+    bool failed_ = false;
+};
+
+// Writes results as JSON, for regression tracking. Returns false if writing failed.
+bool write_json(std::FILE* out, std::span<result const> results);
+bool write_json(cstring_ref path, std::span<result const> results);
+
+}}
+
+#endif // _TSL_PROFILING_BENCH_HPP
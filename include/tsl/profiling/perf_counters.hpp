@@ -0,0 +1,165 @@
+// Hardware performance counters of the calling thread, through perf_event_open.
+//
+//     tsl::perf_counters counters; // cycles, instructions, cache-misses, branch-misses
+//
+//     void hot() {
+//         auto scope = counters.scope();
+//         ...
+//         if (auto s = scope.stop(); s.has_value())
+//             report(s->ipc(), s->get(tsl::perf_event::cache_misses()));
+//     }
+//
+// The events are opened once as a single group, so they are scheduled on the PMU
+// together. When the kernel allows it, reads use rdpmc on the mapped counter pages
+// instead of a syscall, which makes per-function scopes cheap enough for production.
+//
+// Counters are often unavailable: containers usually block perf_event_open, VMs may
+// have no PMU, and perf_event_paranoid may forbid it. Then `available()` is false and
+// every read returns an empty maybe, callers need no other fallback.
+//
+// A group counts the thread that created it, and must only be read by that thread.
+#ifndef _TSL_PROFILING_PERF_COUNTERS_HPP
+#define _TSL_PROFILING_PERF_COUNTERS_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <span>
+#include "tsl/maybe.hpp"
+
+namespace tsl {
+
+// An event as (type, config) of perf_event_attr.
+struct perf_event {
+    std::uint32_t type;
+    std::uint64_t config;
+
+    static constexpr perf_event cycles() noexcept { return {0, 0}; }
+    static constexpr perf_event instructions() noexcept { return {0, 1}; }
+    static constexpr perf_event cache_references() noexcept { return {0, 2}; }
+    static constexpr perf_event cache_misses() noexcept { return {0, 3}; }
+    static constexpr perf_event branch_instructions() noexcept { return {0, 4}; }
+    static constexpr perf_event branch_misses() noexcept { return {0, 5}; }
+
+    // A model-specific event, encoded as for `perf stat -e rNNN`.
+    static constexpr perf_event raw(std::uint64_t config) noexcept { return {4, config}; }
+
+    friend constexpr bool operator==(perf_event, perf_event) = default;
+};
+
+inline constexpr std::size_t perf_max_events = 8;
+
+// Counts of a group, in the order its events were given.
+struct perf_sample {
+    std::array<perf_event, perf_max_events> events {};
+    std::array<std::uint64_t, perf_max_events> values {};
+    std::size_t count = 0;
+
+    // Whether the group shared the PMU with other events. The counts then only cover
+    // the time the group was scheduled.
+    bool multiplexed = false;
+
+    [[nodiscard]] constexpr std::uint64_t operator[](std::size_t i) const noexcept {
+        return values[i];
+    }
+
+    [[nodiscard]] constexpr maybe<std::uint64_t> get(perf_event e) const noexcept {
+        for (std::size_t i = 0; i < count; ++i) {
+            if (events[i] == e)
+                return values[i];
+        }
+        return {};
+    }
+
+    // Instructions per cycle, if both were counted.
+    [[nodiscard]] constexpr maybe<double> ipc() const noexcept {
+        auto cycles = get(perf_event::cycles());
+        auto instructions = get(perf_event::instructions());
+        if (!cycles.has_value() || !instructions.has_value() || *cycles == 0)
+            return {};
+        return static_cast<double>(*instructions) / static_cast<double>(*cycles);
+    }
+
+    // Difference with an earlier sample of the same group.
+    [[nodiscard]] constexpr perf_sample operator-(perf_sample const& earlier) const noexcept {
+        perf_sample r = *this;
+        for (std::size_t i = 0; i < count; ++i)
+            r.values[i] = values[i] - earlier.values[i];
+        r.multiplexed = multiplexed || earlier.multiplexed;
+        return r;
+    }
+};
+
+class perf_counters {
+public:
+    class scope_type;
+
+    // Opens cycles, instructions, cache-misses and branch-misses.
+    perf_counters() noexcept;
+
+    // Opens `events`, the first one leads the group. At most perf_max_events.
+    explicit perf_counters(std::span<perf_event const> events) noexcept;
+    perf_counters(std::initializer_list<perf_event> events) noexcept
+        : perf_counters(std::span<perf_event const>(events.begin(), events.size())) { }
+
+    perf_counters(perf_counters const&) = delete;
+    perf_counters& operator=(perf_counters const&) = delete;
+
+    perf_counters(perf_counters&& rhs) noexcept;
+    perf_counters& operator=(perf_counters&& rhs) noexcept;
+
+    ~perf_counters();
+
+    // Whether the group could be opened.
+    [[nodiscard]] bool available() const noexcept { return count_ != 0; }
+
+    // Whether reads avoid the syscall.
+    [[nodiscard]] bool uses_rdpmc() const noexcept;
+
+    // Counts since the group was opened.
+    [[nodiscard]] maybe<perf_sample> read() const noexcept;
+
+    // Starts measuring a scope, see scope_type.
+    [[nodiscard]] scope_type scope() const noexcept;
+
+private:
+    void close() noexcept;
+
+    maybe<perf_sample> read_rdpmc() const noexcept;
+    maybe<perf_sample> read_syscall() const noexcept;
+
+    std::array<perf_event, perf_max_events> events_ {};
+    std::array<int, perf_max_events> fds_ {};
+    // Mapped perf_event_mmap_page of every event, or null.
+    std::array<void*, perf_max_events> pages_ {};
+    std::size_t count_ = 0;
+};
+
+// Reads the group on construction, `stop()` returns the counts since then.
+class perf_counters::scope_type {
+public:
+    explicit scope_type(perf_counters const& counters) noexcept
+        : counters_(&counters), start_(counters.read()) { }
+
+    [[nodiscard]] maybe<perf_sample> stop() const noexcept {
+        if (!start_.has_value())
+            return {};
+        auto end = counters_->read();
+        if (!end.has_value())
+            return {};
+        return *end - *start_;
+    }
+
+private:
+    perf_counters const* counters_;
+    maybe<perf_sample> start_;
+};
+
+inline perf_counters::scope_type perf_counters::scope() const noexcept {
+    return scope_type(*this);
+}
+
+}
+
+#endif // _TSL_PROFILING_PERF_COUNTERS_HPP
@@ -0,0 +1,168 @@
+// Scoped tracing, exported as Chrome trace JSON (also read by Perfetto).
+//
+//     void handle(request const& r) {
+//         TSL_TRACE_SCOPE("handle");
+//         TSL_TRACE_COUNTER("queue_depth", queue.size());
+//         ...
+//     }
+//
+// Names are template arguments: an event stores the address of the name's static
+// storage, nothing is hashed or copied. Every thread writes its events, a timestamp
+// read from the TSC (or the vDSO clock) and the name, to its own single-producer ring
+// buffer. Buffers are drained on demand or by a background thread, events that
+// don't fit in a full buffer are dropped and counted.
+//
+// While tracing is stopped, a scope costs one predictable branch on entry and one
+// on exit, so it can stay in production builds. Defining TSL_DISABLE_TRACING removes
+// it entirely.
+#ifndef _TSL_PROFILING_TRACE_HPP
+#define _TSL_PROFILING_TRACE_HPP
+
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <type_traits>
+#include "tsl/cstring_ref.hpp"
+#include "tsl/defer.hpp"
+#include "tsl/literal_string.hpp"
+#include "tsl/macros.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TSL_INTERNAL_TRACE_TSC 1
+#else
+#define TSL_INTERNAL_TRACE_TSC 0
+#endif
+
+namespace tsl {
+
+namespace trace {
+
+struct options {
+    // Capacity of every thread's buffer, in events. Rounded up to a power of two.
+    std::size_t buffer_events = std::size_t(1) << 16;
+
+    // Period of the background thread that drains the buffers.
+    // Zero drains only on `drain()` and `stop()`.
+    std::chrono::milliseconds drain_period {0};
+};
+
+// Starts recording. Events recorded before a previous `stop()` are kept.
+void start(options const& opts = options());
+
+// Stops recording and drains every buffer.
+void stop();
+
+[[nodiscard]] bool enabled() noexcept;
+
+// Moves the events of every thread's buffer to the collected events.
+void drain();
+
+// Discards the collected events.
+void clear();
+
+// Names the calling thread in exported traces.
+void set_thread_name(cstring_ref name);
+
+// Events dropped because a buffer was full, or couldn't be allocated.
+[[nodiscard]] std::uint64_t dropped() noexcept;
+
+// Drains, then writes every collected event as Chrome trace JSON.
+// Returns false if writing failed.
+bool write_chrome_json(std::FILE* out);
+bool write_chrome_json(cstring_ref path);
+
+}
+
+namespace internal_trace {
+
+enum class event_kind : std::uint32_t {
+    complete,
+    counter,
+    counter_double,
+};
+
+struct event {
+    std::uint64_t start;
+    // Duration in ticks of complete events, value of counters.
+    std::uint64_t payload;
+    char const* name;
+    event_kind kind;
+};
+
+extern std::atomic<bool> enabled;
+
+// Every distinct name is stored once, its address identifies it.
+template<literal_string Name>
+inline constexpr literal_string name_storage = Name;
+
+inline std::uint64_t now() noexcept {
+#if TSL_INTERNAL_TRACE_TSC
+    return __rdtsc();
+#else
+    return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+void record(event const& e) noexcept;
+
+// Zero when tracing is stopped, so the scope end knows there is nothing to record.
+inline std::uint64_t scope_begin() noexcept {
+    if (TSL_EXPECT_FALSE(enabled.load(std::memory_order_relaxed)))
+        return now() | 1;
+    return 0;
+}
+
+template<literal_string Name>
+inline void scope_end(std::uint64_t start) noexcept {
+    if (TSL_EXPECT_FALSE(start != 0))
+        record(event{start, now() - start, name_storage<Name>.data, event_kind::complete});
+}
+
+template<literal_string Name, typename T>
+inline void counter(T value) noexcept {
+    static_assert(std::is_arithmetic_v<T>, "counters must be numbers");
+    if (TSL_EXPECT_FALSE(enabled.load(std::memory_order_relaxed))) {
+        if constexpr (std::is_floating_point_v<T>) {
+            auto payload = std::bit_cast<std::uint64_t>(static_cast<double>(value));
+            record(event{now(), payload, name_storage<Name>.data, event_kind::counter_double});
+        } else {
+            auto payload = static_cast<std::uint64_t>(static_cast<std::int64_t>(value));
+            record(event{now(), payload, name_storage<Name>.data, event_kind::counter});
+        }
+    }
+}
+
+}}
+
+#ifndef TSL_DISABLE_TRACING
+
+// TSL_TRACE_SCOPE
+//
+// Records the time from this point to the end of the scope, under `name`,
+// which must be a string literal.
+#define TSL_TRACE_SCOPE(name) \
+    const ::std::uint64_t TSL_INTERNAL_DEFER_CONCAT(_tsl_trace__, __LINE__) = \
+        ::tsl::internal_trace::scope_begin(); \
+    TSL_DEFER { \
+        ::tsl::internal_trace::scope_end<::tsl::literal_string(name)>( \
+            TSL_INTERNAL_DEFER_CONCAT(_tsl_trace__, __LINE__)); \
+    }
+
+// TSL_TRACE_COUNTER
+//
+// Records the current value of the counter `name`, which must be a string literal.
+#define TSL_TRACE_COUNTER(name, value) \
+    ::tsl::internal_trace::counter<::tsl::literal_string(name)>(value)
+
+#else
+
+#define TSL_TRACE_SCOPE(name) static_cast<void>(0)
+#define TSL_TRACE_COUNTER(name, value) static_cast<void>(0)
+
+#endif
+
+#endif // _TSL_PROFILING_TRACE_HPP
@@ -0,0 +1,415 @@
+// Range adaptors for ranges of maybe.
+//
+//     for (user& u : users | tsl::views::engaged) ...
+//
+//     auto ids = lines | tsl::views::transform_maybe([](std::string_view s) {
+//         return tsl::parse_non_negative<long>(s);
+//     });
+//
+//     std::vector<long> v = parsed | tsl::actions::collect_engaged;
+//
+// `engaged` skips the empty elements and yields their values: references for lvalue
+// maybes, values for prvalues. `transform_maybe` calls the function once per element
+// and yields the engaged results, a filter and a transform in one pass. Every element
+// of the base is dereferenced and tested once, dereferencing doesn't check it again.
+//
+// `collect_engaged` moves the values out of rvalue containers.
+//
+// Both are views and compose with std::ranges: `r | std::views::take(10) | engaged`.
+#ifndef _TSL_RANGES_HPP
+#define _TSL_RANGES_HPP
+
+#include <concepts>
+#include <functional>
+#include <iterator>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "tsl/macros.hpp"
+#include "tsl/maybe.hpp"
+
+namespace tsl {
+
+namespace internal_ranges {
+
+template<typename T>
+struct is_maybe : std::false_type { };
+
+template<typename B>
+struct is_maybe<maybe_base<B>> : std::true_type { };
+
+template<typename T>
+concept maybe_like = is_maybe<std::remove_cvref_t<T>>::value;
+
+// Values of rvalue maybes are returned by value, so they don't dangle.
+template<typename M>
+using value_reference_t = std::conditional_t<
+    std::is_rvalue_reference_v<decltype(*std::declval<M>())>,
+    std::remove_cvref_t<decltype(*std::declval<M>())>,
+    decltype(*std::declval<M>())>;
+
+template<typename M>
+constexpr value_reference_t<M> unchecked_deref(M&& m) {
+    TSL_ASSUME(m.has_value());
+    return *std::forward<M>(m);
+}
+
+template<typename V>
+using iterator_concept_t = std::conditional_t<
+    std::ranges::forward_range<V>, std::forward_iterator_tag, std::input_iterator_tag>;
+
+// `r | fn` for an adaptor `fn` taking the range only.
+template<typename F>
+struct pipe {
+    F fn;
+
+    template<std::ranges::viewable_range R>
+        requires(std::invocable<F const&, R>)
+    friend constexpr auto operator|(R&& r, pipe const& p) {
+        return std::invoke(p.fn, std::forward<R>(r));
+    }
+};
+
+template<typename F>
+pipe(F) -> pipe<F>;
+
+// A cache emptied, rather than copied, when its view is copied or moved: what it
+// holds may point into the view's base.
+template<typename T>
+class non_propagating_cache : public maybe<T> {
+public:
+    non_propagating_cache() = default;
+
+    constexpr non_propagating_cache(non_propagating_cache const&) noexcept { }
+
+    constexpr non_propagating_cache(non_propagating_cache&& other) noexcept {
+        other.reset();
+    }
+
+    constexpr non_propagating_cache& operator=(non_propagating_cache const& other) noexcept {
+        if (this != &other)
+            this->reset();
+        return *this;
+    }
+
+    constexpr non_propagating_cache& operator=(non_propagating_cache&& other) noexcept {
+        this->reset();
+        other.reset();
+        return *this;
+    }
+};
+
+}
+
+template<std::ranges::view V>
+    requires(std::ranges::input_range<V> && internal_ranges::maybe_like<std::ranges::range_reference_t<V>>)
+class engaged_view : public std::ranges::view_interface<engaged_view<V>> {
+    using base_iterator = std::ranges::iterator_t<V>;
+    using base_sentinel = std::ranges::sentinel_t<V>;
+    using base_reference = std::ranges::range_reference_t<V>;
+
+    // Dereferencing a base yielding prvalues may compute the maybe again, so the
+    // engaged one is kept.
+    static constexpr bool caches_value = !std::is_reference_v<base_reference>;
+
+    struct position {
+        base_iterator current {};
+        [[no_unique_address]] std::conditional_t<caches_value, maybe<base_reference>, char> value {};
+    };
+
+    class iterator {
+    public:
+        using iterator_concept = internal_ranges::iterator_concept_t<V>;
+        using reference = internal_ranges::value_reference_t<base_reference>;
+        using value_type = std::remove_cvref_t<reference>;
+        using difference_type = std::ranges::range_difference_t<V>;
+
+        iterator() = default;
+
+        constexpr iterator(engaged_view& parent, position pos)
+            : parent_(&parent), pos_(std::move(pos)) { }
+
+        constexpr reference operator*() const {
+            if constexpr (caches_value) {
+                TSL_ASSUME(pos_.value.has_value());
+                return internal_ranges::unchecked_deref(*pos_.value);
+            } else {
+                return internal_ranges::unchecked_deref(*pos_.current);
+            }
+        }
+
+        constexpr iterator& operator++() {
+            ++pos_.current;
+            pos_ = parent_->skip_empty(std::move(pos_.current));
+            return *this;
+        }
+
+        constexpr void operator++(int) {
+            ++*this;
+        }
+
+        constexpr iterator operator++(int) requires std::ranges::forward_range<V> {
+            iterator copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        friend constexpr bool operator==(iterator const& a, iterator const& b)
+            requires std::equality_comparable<base_iterator>
+        {
+            return a.pos_.current == b.pos_.current;
+        }
+
+        friend constexpr bool operator==(iterator const& a, std::default_sentinel_t) {
+            return a.at_end();
+        }
+
+    private:
+        constexpr bool at_end() const {
+            return pos_.current == std::ranges::end(parent_->base_);
+        }
+
+        engaged_view* parent_ = nullptr;
+        position pos_ {};
+    };
+
+public:
+    engaged_view() requires std::default_initializable<V> = default;
+
+    constexpr explicit engaged_view(V base) : base_(std::move(base)) { }
+
+    constexpr V base() const& requires std::copy_constructible<V> { return base_; }
+    constexpr V base() && { return std::move(base_); }
+
+    constexpr iterator begin() {
+        if constexpr (std::ranges::forward_range<V>) {
+            // Cached, so repeated calls don't skip the leading empties again.
+            if (!begin_.has_value())
+                begin_.emplace(skip_empty(std::ranges::begin(base_)));
+            return iterator(*this, *begin_);
+        } else {
+            return iterator(*this, skip_empty(std::ranges::begin(base_)));
+        }
+    }
+
+    constexpr auto end() {
+        if constexpr (std::ranges::common_range<V>)
+            return iterator(*this, position{std::ranges::end(base_)});
+        else
+            return std::default_sentinel;
+    }
+
+private:
+    // The first engaged element from `it`. Every element is dereferenced once.
+    constexpr position skip_empty(base_iterator it) {
+        base_sentinel last = std::ranges::end(base_);
+        position pos {std::move(it)};
+        for (; pos.current != last; ++pos.current) {
+            if constexpr (caches_value) {
+                pos.value.emplace(*pos.current);
+                if (pos.value->has_value())
+                    return pos;
+            } else {
+                auto&& m = *pos.current;
+                if (m.has_value())
+                    return pos;
+            }
+        }
+        if constexpr (caches_value)
+            pos.value.reset();
+        return pos;
+    }
+
+    V base_ = V();
+    [[no_unique_address]] std::conditional_t<std::ranges::forward_range<V>,
+                                                 internal_ranges::non_propagating_cache<position>, char> begin_ {};
+};
+
+template<typename R>
+engaged_view(R&&) -> engaged_view<std::views::all_t<R>>;
+
+template<std::ranges::view V, std::move_constructible F>
+    requires(std::ranges::input_range<V> && std::is_object_v<F>
+          && std::regular_invocable<F const&, std::ranges::range_reference_t<V>>
+          && internal_ranges::maybe_like<std::invoke_result_t<F const&, std::ranges::range_reference_t<V>>>)
+class transform_maybe_view : public std::ranges::view_interface<transform_maybe_view<V, F>> {
+    using base_iterator = std::ranges::iterator_t<V>;
+    using base_sentinel = std::ranges::sentinel_t<V>;
+    using result_type = std::invoke_result_t<F const&, std::ranges::range_reference_t<V>>;
+
+    // Every step stores the engaged result, dereferencing only unwraps it.
+    class iterator {
+    public:
+        using iterator_concept = internal_ranges::iterator_concept_t<V>;
+        // Values are copied out of the stored result, which dies with the iterator.
+        using reference = internal_ranges::value_reference_t<result_type&&>;
+        using value_type = std::remove_cvref_t<reference>;
+        using difference_type = std::ranges::range_difference_t<V>;
+
+        iterator() = default;
+
+        constexpr iterator(transform_maybe_view& parent, base_iterator current)
+            : parent_(&parent), current_(std::move(current))
+        {
+            satisfy();
+        }
+
+        constexpr reference operator*() const {
+            TSL_ASSUME(result_->has_value());
+            return static_cast<reference>(**result_);
+        }
+
+        constexpr iterator& operator++() {
+            ++current_;
+            satisfy();
+            return *this;
+        }
+
+        constexpr void operator++(int) {
+            ++*this;
+        }
+
+        constexpr iterator operator++(int) requires std::ranges::forward_range<V> {
+            iterator copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        friend constexpr bool operator==(iterator const& a, iterator const& b)
+            requires std::equality_comparable<base_iterator>
+        {
+            return a.current_ == b.current_;
+        }
+
+        friend constexpr bool operator==(iterator const& a, std::default_sentinel_t) {
+            return a.at_end();
+        }
+
+    private:
+        constexpr bool at_end() const {
+            return current_ == std::ranges::end(parent_->base_);
+        }
+
+        constexpr void satisfy() {
+            base_sentinel last = std::ranges::end(parent_->base_);
+            for (; current_ != last; ++current_) {
+                result_.emplace(std::invoke(*parent_->fn_, *current_));
+                if (result_->has_value())
+                    return;
+            }
+            result_.reset();
+        }
+
+        transform_maybe_view* parent_ = nullptr;
+        base_iterator current_ {};
+        maybe<result_type> result_;
+    };
+
+public:
+    transform_maybe_view() requires(std::default_initializable<V> && std::default_initializable<F>) = default;
+
+    constexpr transform_maybe_view(V base, F fn) : base_(std::move(base)), fn_(std::move(fn)) { }
+
+    constexpr V base() const& requires std::copy_constructible<V> { return base_; }
+    constexpr V base() && { return std::move(base_); }
+
+    constexpr iterator begin() {
+        return iterator(*this, std::ranges::begin(base_));
+    }
+
+    constexpr auto end() {
+        if constexpr (std::ranges::common_range<V>)
+            return iterator(*this, std::ranges::end(base_));
+        else
+            return std::default_sentinel;
+    }
+
+private:
+    V base_ = V();
+    maybe<F> fn_;
+};
+
+template<typename R, typename F>
+transform_maybe_view(R&&, F) -> transform_maybe_view<std::views::all_t<R>, F>;
+
+namespace internal_ranges {
+
+struct engaged_fn {
+    template<std::ranges::viewable_range R>
+        requires requires(R&& r) { engaged_view(std::forward<R>(r)); }
+    constexpr auto operator()(R&& r) const {
+        return engaged_view(std::forward<R>(r));
+    }
+
+    template<std::ranges::viewable_range R>
+        requires requires(R&& r) { engaged_view(std::forward<R>(r)); }
+    friend constexpr auto operator|(R&& r, engaged_fn const& self) {
+        return self(std::forward<R>(r));
+    }
+};
+
+struct transform_maybe_fn {
+    template<std::ranges::viewable_range R, typename F>
+        requires requires(R&& r, F&& f) { transform_maybe_view(std::forward<R>(r), std::forward<F>(f)); }
+    constexpr auto operator()(R&& r, F&& f) const {
+        return transform_maybe_view(std::forward<R>(r), std::forward<F>(f));
+    }
+
+    template<typename F>
+    constexpr auto operator()(F&& f) const {
+        return pipe{[f = std::forward<F>(f)]<typename R>(R&& r) {
+            return transform_maybe_view(std::forward<R>(r), f);
+        }};
+    }
+};
+
+struct collect_engaged_fn {
+    template<std::ranges::input_range R>
+        requires maybe_like<std::ranges::range_reference_t<R>>
+    constexpr auto operator()(R&& r) const {
+        using reference = value_reference_t<std::ranges::range_reference_t<R>>;
+        std::vector<std::remove_cvref_t<reference>> out;
+        if constexpr (std::ranges::sized_range<R>)
+            out.reserve(std::ranges::size(r));
+        // The elements of an rvalue container are its own, so they're moved from.
+        constexpr bool move = !std::is_lvalue_reference_v<R> && !std::ranges::view<std::remove_cvref_t<R>>;
+        for (auto it = std::ranges::begin(r), last = std::ranges::end(r); it != last; ++it) {
+            auto&& m = [&]() -> decltype(auto) {
+                if constexpr (move)
+                    return std::ranges::iter_move(it);
+                else
+                    return *it;
+            }();
+            if (m.has_value())
+                out.push_back(unchecked_deref(std::forward<decltype(m)>(m)));
+        }
+        return out;
+    }
+
+    template<std::ranges::input_range R>
+        requires maybe_like<std::ranges::range_reference_t<R>>
+    friend constexpr auto operator|(R&& r, collect_engaged_fn const& self) {
+        return self(std::forward<R>(r));
+    }
+};
+
+}
+
+namespace views {
+
+inline constexpr internal_ranges::engaged_fn engaged;
+inline constexpr internal_ranges::transform_maybe_fn transform_maybe;
+
+}
+
+namespace actions {
+
+// The values of the engaged elements, in a std::vector.
+inline constexpr internal_ranges::collect_engaged_fn collect_engaged;
+
+}
+
+}
+
+#endif // _TSL_RANGES_HPP
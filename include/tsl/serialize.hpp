@@ -0,0 +1,770 @@
+// Compact binary serialization of tsl vocabulary types.
+//
+//     std::vector<std::byte> bytes = tsl::serialize(msg);
+//     tsl::maybe<message> m = tsl::deserialize<message>(bytes);
+//
+//     // Strings and arrays of plain values point into `bytes` instead of being copied.
+//     tsl::maybe<std::string_view> name = tsl::deserialize_view<std::string>(bytes);
+//
+// Wire format, little endian:
+//   - arithmetic types, enums and types opted in with serialize_as_bytes: their bytes.
+//   - other aggregates and std::array: their members in order. Aggregates have up to
+//     16 members, and neither base classes nor array members.
+//   - non_negative: unsigned LEB128 varint.
+//   - other contract types: their underlying value, checked on read.
+//   - maybe<T>: T's niche encoding if it has one, with no presence byte (the breach
+//     value marks the empty state, so maybe<non_negative> is a varint of value + 1, or
+//     0), otherwise a presence byte followed by T.
+//   - strings and literal_string: varint length, then the characters.
+//   - containers: varint size, then the elements. Arrays of values written as bytes,
+//     other than bool, are padded to their alignment from the start of the message, so
+//     views can point at them directly if the buffer is aligned, as mapped and heap
+//     buffers are.
+//
+// Reads validate the input and return an empty maybe for truncated or invalid data.
+//
+// Other types are supported by specializing tsl::serializer<T> with
+//     static void write(writer&, T const&);
+//     static maybe<T> read(reader&);
+// and, optionally, a `view_type` with `static maybe<view_type> view(reader&)`.
+#ifndef _TSL_SERIALIZE_HPP
+#define _TSL_SERIALIZE_HPP
+
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "tsl/attributes.hpp"
+#include "tsl/literal_string.hpp"
+#include "tsl/maybe.hpp"
+#include "tsl/types/contracts.hpp"
+#include "tsl/types/non_negative.hpp"
+
+namespace tsl {
+
+template<typename T>
+struct serializer;
+
+// serialize_as_bytes
+//
+// Opts a trivially copyable type into being written as its bytes and read back without
+// validation, instead of member by member. Every byte pattern must then be a valid
+// value: no padding, no bools, no contract types.
+template<typename T>
+struct serialize_as_bytes : std::false_type { };
+
+class reader;
+
+class writer {
+public:
+    // Appends to `out`. Alignment is relative to the size of `out` on construction.
+    explicit writer(std::vector<std::byte>& out TSL_ATTR_LIFETIMEBOUND)
+        : out_(&out), base_(out.size()) { }
+
+    void bytes(void const* data, std::size_t n) {
+        auto const* p = static_cast<std::byte const*>(data);
+        out_->insert(out_->end(), p, p + n);
+    }
+
+    void varint(std::uint64_t v) {
+        std::byte buf[10];
+        std::size_t n = 0;
+        while (v >= 0x80) {
+            buf[n++] = static_cast<std::byte>(v | 0x80);
+            v >>= 7;
+        }
+        buf[n++] = static_cast<std::byte>(v);
+        bytes(buf, n);
+    }
+
+    // Pads with zeros to a multiple of `alignment`.
+    void align(std::size_t alignment) {
+        std::size_t pad = (alignment - size() % alignment) % alignment;
+        out_->resize(out_->size() + pad);
+    }
+
+    template<typename T>
+    void write(T const& value) {
+        serializer<T>::write(*this, value);
+    }
+
+    // Bytes written.
+    [[nodiscard]] std::size_t size() const noexcept {
+        return out_->size() - base_;
+    }
+
+private:
+    std::vector<std::byte>* out_;
+    std::size_t base_;
+};
+
+namespace internal_serialize {
+
+template<typename T>
+concept has_view = requires(reader& r) {
+    typename serializer<T>::view_type;
+    { serializer<T>::view(r) } -> std::same_as<maybe<typename serializer<T>::view_type>>;
+};
+
+template<typename T>
+struct view_type {
+    using type = T;
+};
+
+template<has_view T>
+struct view_type<T> {
+    using type = typename serializer<T>::view_type;
+};
+
+}
+
+template<typename T>
+using view_t = typename internal_serialize::view_type<T>::type;
+
+class reader {
+public:
+    explicit reader(std::span<std::byte const> in TSL_ATTR_LIFETIMEBOUND) noexcept
+        : begin_(in.data()), pos_(in.data()), end_(in.data() + in.size()) { }
+
+    // The next `n` bytes, in place.
+    [[nodiscard]] maybe<std::span<std::byte const>> take(std::size_t n) noexcept {
+        if (n > remaining())
+            return {};
+        std::span<std::byte const> s(pos_, n);
+        pos_ += n;
+        return s;
+    }
+
+    [[nodiscard]] bool bytes(void* out, std::size_t n) noexcept {
+        if (n > remaining())
+            return false;
+        std::memcpy(out, pos_, n);
+        pos_ += n;
+        return true;
+    }
+
+    [[nodiscard]] maybe<std::uint64_t> varint() noexcept {
+        std::uint64_t v = 0;
+        for (unsigned shift = 0; shift < 64 && pos_ != end_; shift += 7) {
+            auto b = static_cast<std::uint64_t>(*pos_++);
+            // The tenth byte only has one bit left.
+            if (shift == 63 && b > 1)
+                return {};
+            v |= (b & 0x7f) << shift;
+            if ((b & 0x80) == 0)
+                return v;
+        }
+        return {};
+    }
+
+    // Skips the padding written by writer::align.
+    [[nodiscard]] bool align(std::size_t alignment) noexcept {
+        auto offset = static_cast<std::size_t>(pos_ - begin_);
+        return take((alignment - offset % alignment) % alignment).has_value();
+    }
+
+    template<typename T>
+    [[nodiscard]] maybe<T> read() {
+        return serializer<T>::read(*this);
+    }
+
+    // Like read, but strings and arrays of plain values point into the input.
+    template<typename T>
+    [[nodiscard]] maybe<view_t<T>> view() {
+        if constexpr (internal_serialize::has_view<T>)
+            return serializer<T>::view(*this);
+        else
+            return serializer<T>::read(*this);
+    }
+
+    [[nodiscard]] std::size_t remaining() const noexcept {
+        return static_cast<std::size_t>(end_ - pos_);
+    }
+
+private:
+    std::byte const* begin_;
+    std::byte const* pos_;
+    std::byte const* end_;
+};
+
+namespace internal_serialize {
+
+// Types written as their bytes.
+template<typename T>
+concept raw = std::is_arithmetic_v<T> || std::is_enum_v<T> || serialize_as_bytes<T>::value;
+
+// Raw types read without validation.
+template<typename T>
+concept plain = raw<T> && !std::same_as<T, bool>;
+
+// Converts to any member type, to count the members of an aggregate.
+struct any_member {
+    template<typename U>
+    operator U&() const&& noexcept;
+};
+
+inline constexpr std::size_t max_members = 16;
+
+template<typename T, std::size_t... Is>
+constexpr bool initializable_from(std::index_sequence<Is...>) {
+    return requires { T{(static_cast<void>(Is), any_member())...}; };
+}
+
+// The most initializers T accepts, up to max_members + 1.
+template<typename T>
+constexpr std::size_t member_count() {
+    std::size_t n = 0;
+    [&]<std::size_t... Ns>(std::index_sequence<Ns...>) {
+        ((n = initializable_from<T>(std::make_index_sequence<Ns>()) ? Ns : n), ...);
+    }(std::make_index_sequence<max_members + 2>());
+    return n;
+}
+
+// Aggregates written member by member. Tuple-like ones, such as std::array, have a
+// serializer of their own.
+template<typename T>
+concept member_wise = std::is_aggregate_v<T> && !std::is_array_v<T> && !raw<T>
+    && !requires { std::tuple_size<T>::value; }
+    && member_count<T>() <= max_members;
+
+// References to the members of `value`.
+template<typename T>
+constexpr auto tie_members(T& value) noexcept {
+    constexpr std::size_t n = member_count<std::remove_const_t<T>>();
+    if constexpr (n == 0) {
+        return std::tie();
+    } else if constexpr (n == 1) {
+        auto& [a] = value;
+        return std::tie(a);
+    } else if constexpr (n == 2) {
+        auto& [a, b] = value;
+        return std::tie(a, b);
+    } else if constexpr (n == 3) {
+        auto& [a, b, c] = value;
+        return std::tie(a, b, c);
+    } else if constexpr (n == 4) {
+        auto& [a, b, c, d] = value;
+        return std::tie(a, b, c, d);
+    } else if constexpr (n == 5) {
+        auto& [a, b, c, d, e] = value;
+        return std::tie(a, b, c, d, e);
+    } else if constexpr (n == 6) {
+        auto& [a, b, c, d, e, f] = value;
+        return std::tie(a, b, c, d, e, f);
+    } else if constexpr (n == 7) {
+        auto& [a, b, c, d, e, f, g] = value;
+        return std::tie(a, b, c, d, e, f, g);
+    } else if constexpr (n == 8) {
+        auto& [a, b, c, d, e, f, g, h] = value;
+        return std::tie(a, b, c, d, e, f, g, h);
+    } else if constexpr (n == 9) {
+        auto& [a, b, c, d, e, f, g, h, i] = value;
+        return std::tie(a, b, c, d, e, f, g, h, i);
+    } else if constexpr (n == 10) {
+        auto& [a, b, c, d, e, f, g, h, i, j] = value;
+        return std::tie(a, b, c, d, e, f, g, h, i, j);
+    } else if constexpr (n == 11) {
+        auto& [a, b, c, d, e, f, g, h, i, j, k] = value;
+        return std::tie(a, b, c, d, e, f, g, h, i, j, k);
+    } else if constexpr (n == 12) {
+        auto& [a, b, c, d, e, f, g, h, i, j, k, l] = value;
+        return std::tie(a, b, c, d, e, f, g, h, i, j, k, l);
+    } else if constexpr (n == 13) {
+        auto& [a, b, c, d, e, f, g, h, i, j, k, l, m] = value;
+        return std::tie(a, b, c, d, e, f, g, h, i, j, k, l, m);
+    } else if constexpr (n == 14) {
+        auto& [a, b, c, d, e, f, g, h, i, j, k, l, m, o] = value;
+        return std::tie(a, b, c, d, e, f, g, h, i, j, k, l, m, o);
+    } else if constexpr (n == 15) {
+        auto& [a, b, c, d, e, f, g, h, i, j, k, l, m, o, p] = value;
+        return std::tie(a, b, c, d, e, f, g, h, i, j, k, l, m, o, p);
+    } else {
+        static_assert(n == 16);
+        auto& [a, b, c, d, e, f, g, h, i, j, k, l, m, o, p, q] = value;
+        return std::tie(a, b, c, d, e, f, g, h, i, j, k, l, m, o, p, q);
+    }
+}
+
+template<typename T>
+using member_types = decltype(tie_members(std::declval<T&>()));
+
+// Types whose maybe uses their niche instead of a presence byte.
+template<typename T>
+concept niche_encoded = requires(writer& w, reader& r, T const* p) {
+    serializer<T>::write_maybe(w, p);
+    { serializer<T>::read_maybe(r) } -> std::same_as<maybe<maybe<T>>>;
+};
+
+template<typename C>
+concept sequence = std::ranges::sized_range<C> && std::default_initializable<C>
+    && requires(C& c, typename C::value_type v) { c.push_back(std::move(v)); };
+
+template<typename C>
+concept associative = std::ranges::sized_range<C> && std::default_initializable<C>
+    && requires(C& c, typename C::value_type v) {
+        typename C::key_type;
+        c.insert(std::move(v));
+    };
+
+// Sequences stored as one block of bytes.
+template<typename C>
+concept raw_sequence = sequence<C> && std::ranges::contiguous_range<C>
+    && plain<typename C::value_type>
+    && requires(C& c, std::size_t n) { c.resize(n); };
+
+template<typename C>
+struct element {
+    using type = typename C::value_type;
+};
+
+// Map entries are read with a mutable key, then inserted.
+template<typename C>
+    requires requires { typename C::mapped_type; }
+struct element<C> {
+    using type = std::pair<typename C::key_type, typename C::mapped_type>;
+};
+
+// Every element takes at least one byte, so a size larger than the remaining input
+// is invalid and would otherwise be an unbounded reserve.
+inline maybe<std::size_t> read_size(reader& r, std::size_t element_size = 1) noexcept {
+    auto n = r.varint();
+    if (!n.has_value() || *n > r.remaining() / element_size)
+        return {};
+    return static_cast<std::size_t>(*n);
+}
+
+}
+
+template<typename T>
+    requires internal_serialize::raw<T>
+struct serializer<T> {
+    static_assert(std::endian::native == std::endian::little,
+                  "the wire format is little endian");
+
+    static_assert(!serialize_as_bytes<T>::value
+                  || (std::is_trivially_copyable_v<T> && std::has_unique_object_representations_v<T>),
+                  "types serialized as bytes must be trivially copyable, without padding");
+
+    static void write(writer& w, T const& value) {
+        w.bytes(std::addressof(value), sizeof(T));
+    }
+
+    static maybe<T> read(reader& r) {
+        std::byte buf[sizeof(T)];
+        if (!r.bytes(buf, sizeof(T)))
+            return {};
+        if constexpr (std::same_as<T, bool>) {
+            if (static_cast<unsigned char>(buf[0]) > 1)
+                return {};
+        }
+        return std::bit_cast<T>(buf);
+    }
+};
+
+template<typename T>
+    requires internal_serialize::member_wise<T>
+struct serializer<T> {
+    static void write(writer& w, T const& value) {
+        std::apply([&](auto const&... members) { (w.write(members), ...); },
+                   internal_serialize::tie_members(value));
+    }
+
+    static maybe<T> read(reader& r) {
+        return read_members(r, std::make_index_sequence<std::tuple_size_v<members>>());
+    }
+
+private:
+    using members = internal_serialize::member_types<T>;
+
+    template<std::size_t I>
+    using member = std::remove_cvref_t<std::tuple_element_t<I, members>>;
+
+    // Reads in order, stopping at the first invalid member.
+    template<std::size_t... Is>
+    static maybe<T> read_members(reader& r, std::index_sequence<Is...>) {
+        std::tuple<maybe<member<Is>>...> values;
+        bool ok = ((std::get<Is>(values) = r.read<member<Is>>()).has_value() && ...);
+        if (!ok)
+            return {};
+        return T{std::move(*std::get<Is>(values))...};
+    }
+};
+
+template<typename T, std::size_t N>
+struct serializer<std::array<T, N>> {
+    static void write(writer& w, std::array<T, N> const& a) {
+        if constexpr (internal_serialize::plain<T>) {
+            w.bytes(a.data(), sizeof(T) * N);
+        } else {
+            for (T const& v : a)
+                w.write(v);
+        }
+    }
+
+    static maybe<std::array<T, N>> read(reader& r) {
+        if constexpr (internal_serialize::plain<T>) {
+            // An empty array still takes a byte.
+            std::byte buf[sizeof(std::array<T, N>)] = {};
+            if (!r.bytes(buf, sizeof(T) * N))
+                return {};
+            return std::bit_cast<std::array<T, N>>(buf);
+        } else {
+            return read_elements(r, std::make_index_sequence<N>());
+        }
+    }
+
+private:
+    template<std::size_t... Is>
+    static maybe<std::array<T, N>> read_elements(reader& r, std::index_sequence<Is...>) {
+        std::array<maybe<T>, N> values;
+        for (auto& v : values) {
+            v = r.read<T>();
+            if (!v.has_value())
+                return {};
+        }
+        return std::array<T, N>{std::move(*values[Is])...};
+    }
+};
+
+template<ContractType T>
+struct serializer<T> {
+    using type = typename T::type;
+
+    static void write(writer& w, T const& value) {
+        w.write(value.raw());
+    }
+
+    static maybe<T> read(reader& r) {
+        auto v = r.read<type>();
+        if (!v.has_value())
+            return {};
+        T value(unchecked, std::move(*v));
+        if (!value.is_valid())
+            return {};
+        return value;
+    }
+
+    static void write_maybe(writer& w, T const* value) {
+        if (value != nullptr)
+            w.write(value->raw());
+        else
+            w.write(T(contract_breach).raw());
+    }
+
+    static maybe<maybe<T>> read_maybe(reader& r) {
+        auto v = r.read<type>();
+        if (!v.has_value())
+            return {};
+        T value(unchecked, std::move(*v));
+        if (!value.is_valid())
+            return maybe<maybe<T>>(maybe<T>());
+        return maybe<maybe<T>>(std::in_place, std::move(value));
+    }
+};
+
+template<std::signed_integral T>
+struct serializer<internal_types::non_negative_impl<T>> {
+    using value_type = internal_types::non_negative_impl<T>;
+    using U = std::make_unsigned_t<T>;
+
+    static void write(writer& w, value_type const& value) {
+        w.varint(static_cast<U>(value.raw()));
+    }
+
+    static maybe<value_type> read(reader& r) {
+        auto v = r.varint();
+        if (!v.has_value() || *v > static_cast<U>(std::numeric_limits<T>::max()))
+            return {};
+        return value_type(unchecked, static_cast<T>(*v));
+    }
+
+    // Shifted by one, zero is the empty state.
+    static void write_maybe(writer& w, value_type const* value) {
+        w.varint(value != nullptr ? std::uint64_t(static_cast<U>(value->raw())) + 1 : 0);
+    }
+
+    static maybe<maybe<value_type>> read_maybe(reader& r) {
+        auto v = r.varint();
+        if (!v.has_value() || *v > std::uint64_t(static_cast<U>(std::numeric_limits<T>::max())) + 1)
+            return {};
+        if (*v == 0)
+            return maybe<maybe<value_type>>(maybe<value_type>());
+        return maybe<maybe<value_type>>(std::in_place, value_type(unchecked, static_cast<T>(*v - 1)));
+    }
+};
+
+template<typename Backend>
+struct serializer<maybe_base<Backend>> {
+    using value_type = maybe_base<Backend>;
+    using T = typename value_type::value_type;
+
+    static void write(writer& w, value_type const& m) {
+        if constexpr (internal_serialize::niche_encoded<T>) {
+            serializer<T>::write_maybe(w, m.has_value() ? std::addressof(*m) : nullptr);
+        } else {
+            w.write(m.has_value());
+            if (m.has_value())
+                w.write(*m);
+        }
+    }
+
+    static maybe<value_type> read(reader& r) {
+        if constexpr (internal_serialize::niche_encoded<T>) {
+            auto v = serializer<T>::read_maybe(r);
+            if (!v.has_value())
+                return {};
+            if (!v->has_value())
+                return maybe<value_type>(value_type());
+            return maybe<value_type>(std::in_place, std::move(**v));
+        } else {
+            return read_as<value_type, T>(r, [](reader& r) { return r.read<T>(); });
+        }
+    }
+
+    using view_type = maybe<view_t<T>>;
+
+    static maybe<view_type> view(reader& r)
+        requires internal_serialize::has_view<T>
+    {
+        return read_as<view_type, view_t<T>>(r, [](reader& r) { return r.view<T>(); });
+    }
+
+private:
+    template<typename M, typename V, typename F>
+    static maybe<M> read_as(reader& r, F read_value) {
+        auto present = r.read<bool>();
+        if (!present.has_value())
+            return {};
+        if (!*present)
+            return maybe<M>(M());
+        auto v = read_value(r);
+        if (!v.has_value())
+            return {};
+        return maybe<M>(std::in_place, std::move(*v));
+    }
+};
+
+template<std::size_t N>
+struct serializer<literal_string<N>> {
+    static void write(writer& w, literal_string<N> const& s) {
+        std::size_t len = 0;
+        while (len < N && s.data[len] != '\0')
+            ++len;
+        w.varint(len);
+        w.bytes(s.data, len);
+    }
+
+    static maybe<literal_string<N>> read(reader& r) {
+        auto len = r.varint();
+        if (!len.has_value() || *len >= N)
+            return {};
+        auto chars = r.take(static_cast<std::size_t>(*len));
+        if (!chars.has_value())
+            return {};
+        return literal_string<N>(reinterpret_cast<char const*>(chars->data()), chars->size());
+    }
+};
+
+template<>
+struct serializer<std::string_view> {
+    using view_type = std::string_view;
+
+    static void write(writer& w, std::string_view s) {
+        w.varint(s.size());
+        w.bytes(s.data(), s.size());
+    }
+
+    static maybe<std::string_view> view(reader& r) {
+        auto len = r.varint();
+        if (!len.has_value())
+            return {};
+        auto chars = r.take(static_cast<std::size_t>(*len));
+        if (!chars.has_value())
+            return {};
+        return std::string_view(reinterpret_cast<char const*>(chars->data()), chars->size());
+    }
+
+    static maybe<std::string_view> read(reader& r) {
+        return view(r);
+    }
+};
+
+template<>
+struct serializer<std::string> {
+    using view_type = std::string_view;
+
+    static void write(writer& w, std::string const& s) {
+        serializer<std::string_view>::write(w, s);
+    }
+
+    static maybe<std::string_view> view(reader& r) {
+        return serializer<std::string_view>::view(r);
+    }
+
+    static maybe<std::string> read(reader& r) {
+        auto s = view(r);
+        if (!s.has_value())
+            return {};
+        return std::string(*s);
+    }
+};
+
+template<typename A, typename B>
+struct serializer<std::pair<A, B>> {
+    static void write(writer& w, std::pair<A, B> const& p) {
+        w.write(p.first);
+        w.write(p.second);
+    }
+
+    static maybe<std::pair<A, B>> read(reader& r) {
+        auto a = r.read<std::remove_const_t<A>>();
+        if (!a.has_value())
+            return {};
+        auto b = r.read<B>();
+        if (!b.has_value())
+            return {};
+        return std::pair<A, B>(std::move(*a), std::move(*b));
+    }
+};
+
+// std::vector, tsl::small_vector and other containers with push_back.
+template<typename C>
+    requires internal_serialize::sequence<C>
+struct serializer<C> {
+    using T = typename C::value_type;
+
+    static void write(writer& w, C const& c) {
+        w.varint(std::ranges::size(c));
+        if constexpr (internal_serialize::raw_sequence<C>) {
+            w.align(alignof(T));
+            w.bytes(std::ranges::data(c), std::ranges::size(c) * sizeof(T));
+        } else {
+            for (auto const& v : c)
+                w.write(v);
+        }
+    }
+
+    static maybe<C> read(reader& r) {
+        if constexpr (internal_serialize::raw_sequence<C>) {
+            auto block = read_block(r);
+            if (!block.has_value())
+                return {};
+            C c;
+            c.resize(block->size() / sizeof(T));
+            std::memcpy(std::ranges::data(c), block->data(), block->size());
+            return c;
+        } else {
+            auto n = internal_serialize::read_size(r);
+            if (!n.has_value())
+                return {};
+            C c;
+            if constexpr (requires { c.reserve(*n); })
+                c.reserve(*n);
+            for (std::size_t i = 0; i < *n; ++i) {
+                auto v = r.read<T>();
+                if (!v.has_value())
+                    return {};
+                c.push_back(std::move(*v));
+            }
+            return c;
+        }
+    }
+
+    using view_type = std::span<T const>;
+
+    // The input must be aligned to alignof(T).
+    static maybe<view_type> view(reader& r)
+        requires internal_serialize::raw_sequence<C>
+    {
+        auto block = read_block(r);
+        if (!block.has_value()
+         || reinterpret_cast<std::uintptr_t>(block->data()) % alignof(T) != 0)
+            return {};
+        return view_type(reinterpret_cast<T const*>(block->data()), block->size() / sizeof(T));
+    }
+
+private:
+    static maybe<std::span<std::byte const>> read_block(reader& r) {
+        auto n = internal_serialize::read_size(r, sizeof(T));
+        if (!n.has_value() || !r.align(alignof(T)))
+            return {};
+        return r.take(*n * sizeof(T));
+    }
+};
+
+// tsl::flat_map, tsl::flat_set and other containers with insert(value).
+template<typename C>
+    requires (internal_serialize::associative<C> && !internal_serialize::sequence<C>)
+struct serializer<C> {
+    using element = typename internal_serialize::element<C>::type;
+
+    static void write(writer& w, C const& c) {
+        w.varint(std::ranges::size(c));
+        for (auto const& v : c)
+            w.write(v);
+    }
+
+    static maybe<C> read(reader& r) {
+        auto n = internal_serialize::read_size(r);
+        if (!n.has_value())
+            return {};
+        C c;
+        if constexpr (requires { c.reserve(*n); })
+            c.reserve(*n);
+        for (std::size_t i = 0; i < *n; ++i) {
+            auto v = r.read<element>();
+            if (!v.has_value())
+                return {};
+            c.insert(std::move(*v));
+        }
+        return c;
+    }
+};
+
+template<typename T>
+inline void serialize(T const& value, std::vector<std::byte>& out) {
+    writer w(out);
+    w.write(value);
+}
+
+template<typename T>
+[[nodiscard]] inline std::vector<std::byte> serialize(T const& value) {
+    std::vector<std::byte> out;
+    serialize(value, out);
+    return out;
+}
+
+// Reads a T that must span the whole input.
+template<typename T>
+[[nodiscard]] inline maybe<T> deserialize(std::span<std::byte const> in) {
+    reader r(in);
+    auto v = r.read<T>();
+    if (r.remaining() != 0)
+        return {};
+    return v;
+}
+
+// Like deserialize, but the result may point into `in`.
+template<typename T>
+[[nodiscard]] inline maybe<view_t<T>> deserialize_view(std::span<std::byte const> in TSL_ATTR_LIFETIMEBOUND) {
+    reader r(in);
+    auto v = r.view<T>();
+    if (r.remaining() != 0)
+        return {};
+    return v;
+}
+
+}
+
+#endif // _TSL_SERIALIZE_HPP
@@ -1,19 +1,210 @@
 #ifndef _TSL_TYPE_TRAITS_HPP
 #define _TSL_TYPE_TRAITS_HPP
 
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include "tsl/macros.hpp"
+
 namespace tsl {
 
+// type_list
+//
+// A list of types, and algorithms over it. The algorithms are written with pack
+// expansions and folds instead of recursion, so their instantiation depth doesn't
+// grow with the length of the list.
+template<typename... Ts>
+struct type_list;
+
+inline constexpr std::size_t type_list_npos = static_cast<std::size_t>(-1);
+
+namespace internal_type_list {
+
+template<typename... Ts>
+struct head_tail { };
+
 template<typename T, typename... U>
-struct type_list {
+struct head_tail<T, U...> {
     using head = T;
     using tail = type_list<U...>;
 };
 
-template<typename T>
-struct type_list<T> {
-    using head = T;
+#if TSL_HAS_BUILTIN(__type_pack_element)
+template<std::size_t I, typename... Ts>
+using at = __type_pack_element<I, Ts...>;
+#else
+// Every element is a distinct base, overload resolution picks the one at I.
+template<std::size_t I, typename T>
+struct indexed {
+    using type = T;
+};
+
+template<typename Is, typename... Ts>
+struct indexer;
+
+template<std::size_t... Is, typename... Ts>
+struct indexer<std::index_sequence<Is...>, Ts...> : indexed<Is, Ts>... { };
+
+template<std::size_t I, typename T>
+indexed<I, T> select(indexed<I, T>);
+
+template<std::size_t I, typename... Ts>
+using at = typename decltype(select<I>(indexer<std::index_sequence_for<Ts...>, Ts...>{}))::type;
+#endif
+
+// Index of the first `true`, or type_list_npos.
+template<std::size_t N>
+constexpr std::size_t first_true(const bool (&matches)[N]) {
+    for (std::size_t i = 0; i + 1 < N; ++i) {
+        if (matches[i])
+            return i;
+    }
+    return type_list_npos;
+}
+
+// The trailing `false` avoids zero-sized arrays.
+template<typename T, typename... Ts>
+inline constexpr std::size_t index_of = first_true({std::is_same_v<T, Ts>..., false});
+
+// Concatenation is a fold over this operator, instead of a recursion over the lists.
+template<typename... Ts, typename... Us>
+type_list<Ts..., Us...> operator+(type_list<Ts...>, type_list<Us...>);
+
+template<typename... Lists>
+using concat = decltype((type_list<>() + ... + Lists()));
+
+template<typename List, typename Is>
+struct unique;
+
+template<typename... Ts, std::size_t... Is>
+struct unique<type_list<Ts...>, std::index_sequence<Is...>> {
+    using type = concat<std::conditional_t<index_of<Ts, Ts...> == Is,
+                                           type_list<Ts>, type_list<>>...>;
+};
+
+}
+
+template<typename... Ts>
+struct type_list : internal_type_list::head_tail<Ts...> {
+    static constexpr std::size_t size = sizeof...(Ts);
 };
 
+template<typename List>
+inline constexpr std::size_t type_list_size_v = List::size;
+
+// Type at index I.
+template<std::size_t I, typename List>
+struct type_list_at;
+
+template<std::size_t I, typename... Ts>
+struct type_list_at<I, type_list<Ts...>> {
+    static_assert(I < sizeof...(Ts), "type_list index out of range");
+    using type = internal_type_list::at<I, Ts...>;
+};
+
+template<std::size_t I, typename List>
+using type_list_at_t = typename type_list_at<I, List>::type;
+
+// Index of the first T, or type_list_npos.
+template<typename T, typename List>
+struct type_list_index_of;
+
+template<typename T, typename... Ts>
+struct type_list_index_of<T, type_list<Ts...>>
+    : std::integral_constant<std::size_t, internal_type_list::index_of<T, Ts...>> { };
+
+template<typename T, typename List>
+inline constexpr std::size_t type_list_index_of_v = type_list_index_of<T, List>::value;
+
+template<typename T, typename List>
+struct type_list_count;
+
+template<typename T, typename... Ts>
+struct type_list_count<T, type_list<Ts...>>
+    : std::integral_constant<std::size_t, (std::size_t(0) + ... + std::size_t(std::is_same_v<T, Ts>))> { };
+
+template<typename T, typename List>
+inline constexpr std::size_t type_list_count_v = type_list_count<T, List>::value;
+
+template<typename T, typename List>
+struct type_list_contains;
+
+template<typename T, typename... Ts>
+struct type_list_contains<T, type_list<Ts...>>
+    : std::bool_constant<(std::is_same_v<T, Ts> || ...)> { };
+
+template<typename T, typename List>
+inline constexpr bool type_list_contains_v = type_list_contains<T, List>::value;
+
+template<typename... Lists>
+struct type_list_concat {
+    using type = internal_type_list::concat<Lists...>;
+};
+
+template<typename... Lists>
+using type_list_concat_t = typename type_list_concat<Lists...>::type;
+
+// Keeps the types for which `Pred<T>::value` is true.
+template<template<typename> class Pred, typename List>
+struct type_list_filter;
+
+template<template<typename> class Pred, typename... Ts>
+struct type_list_filter<Pred, type_list<Ts...>> {
+    using type = internal_type_list::concat<
+        std::conditional_t<Pred<Ts>::value, type_list<Ts>, type_list<>>...>;
+};
+
+template<template<typename> class Pred, typename List>
+using type_list_filter_t = typename type_list_filter<Pred, List>::type;
+
+// Replaces every T by `F<T>`. F is usually an alias template, like std::add_pointer_t.
+template<template<typename> class F, typename List>
+struct type_list_transform;
+
+template<template<typename> class F, typename... Ts>
+struct type_list_transform<F, type_list<Ts...>> {
+    using type = type_list<F<Ts>...>;
+};
+
+template<template<typename> class F, typename List>
+using type_list_transform_t = typename type_list_transform<F, List>::type;
+
+// Removes repeated types, keeping the first occurrence.
+template<typename List>
+struct type_list_unique;
+
+template<typename... Ts>
+struct type_list_unique<type_list<Ts...>>
+    : internal_type_list::unique<type_list<Ts...>, std::index_sequence_for<Ts...>> { };
+
+template<typename List>
+using type_list_unique_t = typename type_list_unique<List>::type;
+
+// Instantiates `Template<Ts...>` with the types of the list.
+template<template<typename...> class Template, typename List>
+struct type_list_apply;
+
+template<template<typename...> class Template, typename... Ts>
+struct type_list_apply<Template, type_list<Ts...>> {
+    using type = Template<Ts...>;
+};
+
+template<template<typename...> class Template, typename List>
+using type_list_apply_t = typename type_list_apply<Template, List>::type;
+
+// is_trivially_relocatable
+//
+// Whether moving a T to a new address and destroying the source can be done by
+// copying its bytes. Containers use it to grow with memcpy.
+//
+// True for trivially copyable types. Specialize it for types that don't point into
+// themselves, such as most handles to heap memory.
+template<typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> { };
+
+template<typename T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
 }
 
 #endif // _TSL_TYPE_TRAITS_HPP
@@ -0,0 +1,39 @@
+// Niches: values of a type that never represent a real object, and can be used by
+// containers to mark an empty slot without extra storage. It's the same trick
+// tsl::maybe uses for contract types.
+#ifndef _TSL_TYPES_NICHE_HPP
+#define _TSL_TYPES_NICHE_HPP
+
+#include "tsl/types/contracts.hpp"
+
+namespace tsl {
+
+// niche_traits
+//
+// Specialize it for types with a sentinel value. Specializations must define
+// `available = true`, `make_empty()` returning the sentinel and `is_empty(value)`.
+// Contract types use their breach value.
+template<typename T>
+struct niche_traits {
+    static constexpr bool available = false;
+};
+
+template<ContractType T>
+struct niche_traits<T> {
+    static constexpr bool available = true;
+
+    static constexpr T make_empty() noexcept {
+        return T(contract_breach);
+    }
+
+    static constexpr bool is_empty(T const& value) noexcept {
+        return !value.is_valid();
+    }
+};
+
+template<typename T>
+concept has_niche = niche_traits<T>::available;
+
+}
+
+#endif // _TSL_TYPES_NICHE_HPP
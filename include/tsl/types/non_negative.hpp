@@ -1,8 +1,14 @@
 #ifndef _TSL_TYPES_NON_NEGATIVE_HPP
 #define _TSL_TYPES_NON_NEGATIVE_HPP
 
+#include <cstddef>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <type_traits>
 #include "tsl/types/contracts.hpp"
 #include "tsl/macros.hpp"
+#include "tsl/maybe.hpp"
 
 namespace tsl {
 
@@ -68,6 +74,113 @@ private:
 template<std::signed_integral T> requires ContractType<internal_types::non_negative_impl<T>>
 using non_negative = internal_types::non_negative_impl<T>;
 
+namespace internal_types {
+
+// The T of a maybe<non_negative<T>>. maybe<> picks its backend through a trait, so
+// maybe<non_negative<T>> doesn't deduce T; specialize on maybe_non_negative instead.
+template<typename M>
+struct maybe_non_negative_traits { };
+
+template<std::signed_integral T>
+struct maybe_non_negative_traits<maybe_base<maybe_backend_contract<non_negative_impl<T>>>> {
+    using int_type = T;
+};
+
+template<typename M>
+concept maybe_non_negative = requires { typename maybe_non_negative_traits<M>::int_type; };
+
+template<maybe_non_negative M>
+using maybe_non_negative_int = typename maybe_non_negative_traits<M>::int_type;
+
+static_assert(maybe_non_negative<maybe<non_negative<int>>>);
+static_assert(!maybe_non_negative<maybe<int>> && !maybe_non_negative<non_negative<int>>);
+
+}
+
+// Bulk validation
+//
+// Checking arrays element by element through the constructor defeats vectorization.
+// These check a whole block with an OR of its elements, whose sign bit is set if any
+// element is negative, and only look for the index inside a failing block.
+
+namespace internal_types {
+
+template<std::signed_integral T>
+constexpr maybe<std::size_t> find_negative(T const* values, std::size_t n) noexcept {
+    constexpr std::size_t block = 64 / sizeof(T) * 4;
+    std::size_t i = 0;
+    for (; i + block <= n; i += block) {
+        T acc = 0;
+        for (std::size_t j = 0; j < block; ++j)
+            acc |= values[i + j];
+        if (acc < 0)
+            break;
+    }
+    for (; i < n; ++i) {
+        if (values[i] < 0)
+            return i;
+    }
+    return {};
+}
+
+// Arrays of signed integers: std::vector, std::array, std::span and the like.
+template<typename R>
+concept signed_array = std::ranges::contiguous_range<R> && std::ranges::sized_range<R>
+    && std::signed_integral<std::ranges::range_value_t<R>>;
+
+template<signed_array R>
+using non_negative_span = std::span<std::conditional_t<
+    std::is_const_v<std::remove_reference_t<std::ranges::range_reference_t<R>>>,
+    non_negative<std::ranges::range_value_t<R>> const,
+    non_negative<std::ranges::range_value_t<R>>>>;
+
+}
+
+// Index of the first negative element, empty if there is none.
+template<internal_types::signed_array R>
+[[nodiscard]] constexpr maybe<std::size_t> find_negative(R const& values) noexcept {
+    return internal_types::find_negative(std::ranges::data(values), std::ranges::size(values));
+}
+
+// `values` viewed as non_negative, if every element is non-negative. The view is
+// mutable when `values` is.
+//
+// non_negative<T> is a T and nothing else, so the elements are reused in place: with
+// std::start_lifetime_as_array where the library has it, and otherwise through a
+// reinterpret_cast, relying on the layout compatibility asserted below, as compilers
+// guarantee in practice.
+template<internal_types::signed_array R>
+    requires std::ranges::borrowed_range<R>
+[[nodiscard]] inline maybe<internal_types::non_negative_span<R>> validate_non_negative(R&& values) noexcept {
+    using T = std::ranges::range_value_t<R>;
+    using U = typename internal_types::non_negative_span<R>::element_type;
+    static_assert(sizeof(non_negative<T>) == sizeof(T) && alignof(non_negative<T>) == alignof(T)
+                  && std::is_standard_layout_v<non_negative<T>> && std::is_trivially_copyable_v<non_negative<T>>);
+    if (find_negative(values).has_value())
+        return {};
+    auto* data = std::ranges::data(values);
+    std::size_t n = std::ranges::size(values);
+#if defined(__cpp_lib_start_lifetime_as)
+    return internal_types::non_negative_span<R>(std::start_lifetime_as_array<U>(data, n), n);
+#else
+    return internal_types::non_negative_span<R>(reinterpret_cast<U*>(data), n);
+#endif
+}
+
+// Copies `in` to `out`, which must be at least as large. Returns the index of the
+// first negative element, in which case `out` is left unspecified.
+template<internal_types::signed_array R, typename T = std::ranges::range_value_t<R>>
+[[nodiscard]] constexpr maybe<std::size_t> copy_non_negative(R const& in,
+                                                             std::type_identity_t<std::span<non_negative<T>>> out) noexcept {
+    TSL_HARDENING_ASSERT(out.size() >= std::ranges::size(in));
+    if (auto bad = find_negative(in); bad.has_value())
+        return bad;
+    T const* p = std::ranges::data(in);
+    for (std::size_t i = 0; i < std::ranges::size(in); ++i)
+        out[i] = non_negative<T>(unchecked, p[i]);
+    return {};
+}
+
 }
 
 #endif // _TSL_TYPES_NON_NEGATIVE_HPP
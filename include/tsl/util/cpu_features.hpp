@@ -0,0 +1,156 @@
+// Runtime CPU feature detection and function dispatch.
+//
+//     TSL_TARGET("avx2") std::size_t count_avx2(char const* p, std::size_t n);
+//     std::size_t count_scalar(char const* p, std::size_t n);
+//
+//     inline constexpr tsl::dispatcher<std::size_t(char const*, std::size_t),
+//         tsl::kernel<tsl::cpu_feature::avx2, count_avx2>,
+//         tsl::kernel<tsl::cpu_feature::none, count_scalar>> count;
+//
+//     count(p, n); // one indirect call, no feature test
+//
+// Features are read with cpuid and xgetbv once. A feature is only reported if the OS
+// also saves the registers it uses.
+#ifndef _TSL_UTIL_CPU_FEATURES_HPP
+#define _TSL_UTIL_CPU_FEATURES_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include "tsl/attributes.hpp"
+
+namespace tsl {
+
+enum class cpu_feature : std::uint64_t {
+    none = 0,
+
+    // x86
+    sse2 = 1 << 0,
+    sse3 = 1 << 1,
+    ssse3 = 1 << 2,
+    sse4_1 = 1 << 3,
+    sse4_2 = 1 << 4,
+    popcnt = 1 << 5,
+    avx = 1 << 6,
+    avx2 = 1 << 7,
+    bmi1 = 1 << 8,
+    bmi2 = 1 << 9,
+    fma = 1 << 10,
+    lzcnt = 1 << 11,
+    pclmul = 1 << 12,
+    aes = 1 << 13,
+    sha = 1 << 14,
+    avx512f = 1 << 15,
+    avx512bw = 1 << 16,
+    avx512cd = 1 << 17,
+    avx512dq = 1 << 18,
+    avx512vl = 1 << 19,
+    avx512vbmi = 1 << 20,
+    avx512vbmi2 = 1 << 21,
+    avx512vpopcntdq = 1 << 22,
+
+    // Arm
+    neon = std::uint64_t(1) << 32,
+    crc32 = std::uint64_t(1) << 33,
+};
+
+constexpr cpu_feature operator|(cpu_feature a, cpu_feature b) noexcept {
+    return static_cast<cpu_feature>(static_cast<std::uint64_t>(a) | static_cast<std::uint64_t>(b));
+}
+
+class cpu_features {
+public:
+    constexpr cpu_features() noexcept = default;
+    constexpr explicit cpu_features(cpu_feature bits) noexcept : bits_(bits) { }
+
+    // The features of the running CPU, detected on the first call.
+    [[nodiscard]] static cpu_features const& current() noexcept;
+
+    // Whether every feature of `f` is supported.
+    [[nodiscard]] constexpr bool has(cpu_feature f) const noexcept {
+        auto want = static_cast<std::uint64_t>(f);
+        return (static_cast<std::uint64_t>(bits_) & want) == want;
+    }
+
+    [[nodiscard]] constexpr cpu_feature bits() const noexcept {
+        return bits_;
+    }
+
+private:
+    cpu_feature bits_ = cpu_feature::none;
+};
+
+// A dispatcher candidate: `Fn`, usable when the CPU has `Required`.
+template<cpu_feature Required, auto Fn>
+struct kernel {
+    static constexpr cpu_feature required = Required;
+    static constexpr auto function = Fn;
+};
+
+template<typename Signature, typename... Kernels>
+class dispatcher;
+
+namespace internal_cpu {
+
+template<typename... Ts>
+using last_t = typename decltype((std::type_identity<Ts>(), ...))::type;
+
+}
+
+// dispatcher
+//
+// Calls the first kernel the CPU supports, so kernels go from the most to the least
+// demanding, and the last one must require nothing.
+//
+// The choice is made while the program loads, by the dynamic initialization of a
+// static member, and stored in a function pointer. Calls made before that, from other
+// static initializers, go through a trampoline that makes the choice itself.
+template<typename R, typename... Args, typename... Kernels>
+class dispatcher<R(Args...), Kernels...> {
+    static_assert(sizeof...(Kernels) > 0, "a dispatcher needs at least one kernel");
+    static_assert((std::is_convertible_v<decltype(Kernels::function), R (*)(Args...)> && ...),
+                  "kernels must have the dispatcher's signature");
+    static_assert(internal_cpu::last_t<Kernels...>::required == cpu_feature::none,
+                  "the last kernel must run on any CPU");
+
+public:
+    using function_type = R (*)(Args...);
+
+    constexpr dispatcher() noexcept = default;
+
+    R operator()(Args... args) const {
+        static_cast<void>(bound_);
+        return fn_.load(std::memory_order_relaxed)(std::forward<Args>(args)...);
+    }
+
+    // The kernel chosen for this CPU.
+    [[nodiscard]] static function_type resolve() noexcept {
+        return resolve(cpu_features::current());
+    }
+
+    [[nodiscard]] static function_type resolve(cpu_features const& cpu) noexcept {
+        constexpr function_type functions[] = {Kernels::function...};
+        constexpr cpu_feature required[] = {Kernels::required...};
+        for (std::size_t i = 0; i + 1 < sizeof...(Kernels); ++i) {
+            if (cpu.has(required[i]))
+                return functions[i];
+        }
+        return functions[sizeof...(Kernels) - 1];
+    }
+
+private:
+    static R first_call(Args... args) {
+        function_type f = resolve();
+        fn_.store(f, std::memory_order_relaxed);
+        return f(std::forward<Args>(args)...);
+    }
+
+    static inline std::atomic<function_type> fn_ {&first_call};
+    static inline bool const bound_ = (fn_.store(resolve(), std::memory_order_relaxed), true);
+};
+
+}
+
+#endif // _TSL_UTIL_CPU_FEATURES_HPP
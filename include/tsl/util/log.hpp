@@ -0,0 +1,323 @@
+// Asynchronous logging with deferred formatting.
+//
+//     tsl::log::start({.binary_path = "server.tlog"});
+//     TSL_LOG_INFO("accepted {} from {}", fd, peer_name);
+//     TSL_LOG_WARNING("slow query: {} ms, parent {}", ms, maybe_parent);
+//
+// A call site copies its arguments, a timestamp and the address of a static format
+// descriptor to the calling thread's ring buffer, nothing is formatted. A background
+// thread drains the buffers, formats the messages to a text stream and, optionally,
+// appends the raw records to a binary file, which `decode` turns into text later.
+//
+// Formats are string literals with a `{}` per argument (`{{` and `}}` for braces),
+// checked at compile time. Arguments can be integers, floating point numbers, bool,
+// char, strings, enums, non_negative and maybe of any of them. Strings are copied.
+//
+// When a buffer is full, records are dropped and counted, or with `overflow::block`,
+// the call site waits for the background thread.
+//
+// While logging is stopped, or below the minimum level, a call site costs a load and
+// a branch.
+#ifndef _TSL_UTIL_LOG_HPP
+#define _TSL_UTIL_LOG_HPP
+
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include "tsl/cstring_ref.hpp"
+#include "tsl/literal_string.hpp"
+#include "tsl/macros.hpp"
+#include "tsl/maybe.hpp"
+#include "tsl/types/non_negative.hpp"
+
+namespace tsl {
+
+namespace log {
+
+enum class level : std::uint8_t {
+    debug,
+    info,
+    warning,
+    error,
+    off,
+};
+
+enum class overflow : std::uint8_t {
+    drop,
+    block,
+};
+
+struct options {
+    level min_level = level::info;
+
+    // Capacity of every thread's buffer, in bytes. Rounded up to a power of two.
+    std::size_t buffer_bytes = std::size_t(1) << 20;
+
+    overflow on_full = overflow::drop;
+
+    // Period of the background thread.
+    std::chrono::milliseconds drain_period {1};
+
+    // Formatted messages are written here, unless it's null.
+    std::FILE* text = stderr;
+
+    // Raw records are appended to this file, unless it's empty.
+    std::string binary_path;
+};
+
+// Starts the background thread. Returns false if the binary file can't be opened.
+bool start(options const& opts = options());
+
+// Stops logging, drains every buffer and closes the binary file.
+void stop();
+
+// Drains every buffer and flushes the outputs.
+void flush();
+
+void set_min_level(level l) noexcept;
+
+// Records dropped because a buffer was full, or couldn't be allocated.
+[[nodiscard]] std::uint64_t dropped() noexcept;
+
+// Writes the messages of a binary log as text. Returns false if the input is
+// truncated or malformed, after writing the messages before the error.
+bool decode(std::FILE* binary, std::FILE* text);
+bool decode(cstring_ref path, std::FILE* text);
+
+}
+
+namespace internal_log {
+
+// The type of an argument in a record. Maybe types are the underlying type with
+// `maybe_flag`, followed by a byte telling whether it's engaged, or with `niche_flag`
+// for maybe<non_negative>, where -1 is empty.
+enum class arg_type : std::uint8_t {
+    boolean,
+    character,
+    int64,
+    uint64,
+    float64,
+    string,
+
+    niche_flag = 0x40,
+    maybe_flag = 0x80,
+};
+
+constexpr arg_type operator|(arg_type a, arg_type b) noexcept {
+    return static_cast<arg_type>(static_cast<std::uint8_t>(a) | static_cast<std::uint8_t>(b));
+}
+
+struct format_info {
+    char const* format;
+    arg_type const* types;
+    std::uint32_t arg_count;
+    log::level level;
+};
+
+// Precedes the arguments of every record. A null `format` marks the unused end of
+// the buffer, when a record didn't fit before wrapping around.
+struct record_header {
+    format_info const* format;
+    std::uint64_t time;
+    std::uint32_t size;
+};
+
+inline constexpr std::size_t record_alignment = 8;
+
+extern std::atomic<std::uint8_t> min_level;
+
+// Space for a record of `size` bytes in the calling thread's buffer, or null if it
+// was dropped. Must be followed by `end_record` when not null.
+std::byte* begin_record(std::size_t size) noexcept;
+void end_record() noexcept;
+
+inline std::uint64_t now() noexcept {
+    auto t = std::chrono::system_clock::now().time_since_epoch();
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t).count());
+}
+
+template<typename T>
+inline std::byte* put(std::byte* p, T const& v) noexcept {
+    std::memcpy(p, &v, sizeof(T));
+    return p + sizeof(T);
+}
+
+template<typename T>
+struct arg_traits;
+
+template<>
+struct arg_traits<bool> {
+    static constexpr arg_type type = arg_type::boolean;
+    static constexpr std::size_t size(bool) noexcept { return 1; }
+    static std::byte* encode(std::byte* p, bool v) noexcept { return put(p, std::uint8_t(v)); }
+};
+
+template<>
+struct arg_traits<char> {
+    static constexpr arg_type type = arg_type::character;
+    static constexpr std::size_t size(char) noexcept { return 1; }
+    static std::byte* encode(std::byte* p, char v) noexcept { return put(p, v); }
+};
+
+template<typename T>
+    requires(std::signed_integral<T> && !std::same_as<T, char>)
+struct arg_traits<T> {
+    static constexpr arg_type type = arg_type::int64;
+    static constexpr std::size_t size(T) noexcept { return 8; }
+    static std::byte* encode(std::byte* p, T v) noexcept { return put(p, std::int64_t(v)); }
+};
+
+template<typename T>
+    requires(std::unsigned_integral<T> && !std::same_as<T, bool> && !std::same_as<T, char>)
+struct arg_traits<T> {
+    static constexpr arg_type type = arg_type::uint64;
+    static constexpr std::size_t size(T) noexcept { return 8; }
+    static std::byte* encode(std::byte* p, T v) noexcept { return put(p, std::uint64_t(v)); }
+};
+
+template<std::floating_point T>
+struct arg_traits<T> {
+    static constexpr arg_type type = arg_type::float64;
+    static constexpr std::size_t size(T) noexcept { return 8; }
+    static std::byte* encode(std::byte* p, T v) noexcept { return put(p, double(v)); }
+};
+
+template<typename T>
+    requires(std::is_enum_v<T>)
+struct arg_traits<T> : arg_traits<std::underlying_type_t<T>> {
+    using underlying = std::underlying_type_t<T>;
+    using base = arg_traits<underlying>;
+    static constexpr std::size_t size(T v) noexcept { return base::size(static_cast<underlying>(v)); }
+    static std::byte* encode(std::byte* p, T v) noexcept { return base::encode(p, static_cast<underlying>(v)); }
+};
+
+// Length as 32 bits, then the characters.
+struct string_traits {
+    static constexpr arg_type type = arg_type::string;
+    static constexpr std::size_t size(std::string_view s) noexcept { return 4 + s.size(); }
+    static std::byte* encode(std::byte* p, std::string_view s) noexcept {
+        p = put(p, static_cast<std::uint32_t>(s.size()));
+        std::memcpy(p, s.data(), s.size());
+        return p + s.size();
+    }
+};
+
+template<> struct arg_traits<std::string_view> : string_traits { };
+template<> struct arg_traits<std::string> : string_traits { };
+template<> struct arg_traits<char const*> : string_traits { };
+template<> struct arg_traits<char*> : string_traits { };
+
+template<>
+struct arg_traits<cstring_ref> : string_traits {
+    static std::size_t size(cstring_ref s) noexcept { return string_traits::size(s.get()); }
+    static std::byte* encode(std::byte* p, cstring_ref s) noexcept { return string_traits::encode(p, s.get()); }
+};
+
+template<std::signed_integral T>
+struct arg_traits<non_negative<T>> {
+    static constexpr arg_type type = arg_type::int64;
+    static constexpr std::size_t size(non_negative<T> const&) noexcept { return 8; }
+    static std::byte* encode(std::byte* p, non_negative<T> const& v) noexcept { return put(p, std::int64_t(v.raw())); }
+};
+
+template<typename B>
+struct arg_traits<maybe_base<B>> {
+    using value_type = std::remove_cvref_t<decltype(*std::declval<maybe_base<B> const&>())>;
+    using inner = arg_traits<value_type>;
+
+    static constexpr arg_type type = inner::type | arg_type::maybe_flag;
+    static constexpr std::size_t size(maybe_base<B> const& v) noexcept {
+        return 1 + (v.has_value() ? inner::size(*v) : 0);
+    }
+    static std::byte* encode(std::byte* p, maybe_base<B> const& v) noexcept {
+        p = put(p, std::uint8_t(v.has_value()));
+        return v.has_value() ? inner::encode(p, *v) : p;
+    }
+};
+
+// Stored in its own breach value.
+template<typename B>
+    requires internal_types::maybe_non_negative<maybe_base<B>>
+struct arg_traits<maybe_base<B>> {
+    using maybe_type = maybe_base<B>;
+
+    static constexpr arg_type type = arg_type::int64 | arg_type::niche_flag;
+    static constexpr std::size_t size(maybe_type const&) noexcept { return 8; }
+    static std::byte* encode(std::byte* p, maybe_type const& v) noexcept {
+        return put(p, std::int64_t(v.has_value() ? v->raw() : -1));
+    }
+};
+
+template<typename T>
+using traits_of = arg_traits<std::remove_cvref_t<std::decay_t<T>>>;
+
+// Number of `{}` in `format`, or -1 if a brace isn't part of one or of an escape.
+template<std::size_t N>
+constexpr int count_placeholders(literal_string<N> const& format) noexcept {
+    int count = 0;
+    for (std::size_t i = 0; i < N && format.data[i] != '\0'; ++i) {
+        char c = format.data[i];
+        char next = i + 1 < N ? format.data[i + 1] : '\0';
+        if (c == '{' && (next == '}' || next == '{')) {
+            count += next == '}';
+            ++i;
+        } else if (c == '}' && next == '}') {
+            ++i;
+        } else if (c == '{' || c == '}') {
+            return -1;
+        }
+    }
+    return count;
+}
+
+template<literal_string Format>
+inline constexpr literal_string format_storage = Format;
+
+template<typename... Args>
+inline constexpr arg_type arg_types_storage[sizeof...(Args) + 1] = {traits_of<Args>::type..., arg_type::boolean};
+
+// Every call site has its own descriptor, its address identifies it.
+template<log::level Level, literal_string Format, typename... Args>
+inline constexpr format_info format_info_storage {
+    format_storage<Format>.data, arg_types_storage<Args...>, sizeof...(Args), Level,
+};
+
+template<log::level Level, literal_string Format, typename... Args>
+inline void write(Args const&... args) noexcept {
+    static_assert(count_placeholders(Format) == static_cast<int>(sizeof...(Args)),
+                  "the format needs a {} per argument");
+    if (TSL_EXPECT_TRUE(static_cast<std::uint8_t>(Level) < min_level.load(std::memory_order_relaxed)))
+        return;
+
+    std::size_t size = sizeof(record_header) + (std::size_t(0) + ... + traits_of<Args>::size(args));
+    size = (size + record_alignment - 1) & ~(record_alignment - 1);
+    std::byte* p = begin_record(size);
+    if (p == nullptr)
+        return;
+    p = put(p, record_header{&format_info_storage<Level, Format, std::remove_cvref_t<std::decay_t<Args>>...>,
+                             now(), static_cast<std::uint32_t>(size)});
+    ((p = traits_of<Args>::encode(p, args)), ...);
+    end_record();
+}
+
+}}
+
+// TSL_LOG
+//
+// Logs a message at `level`, a tsl::log::level. `format` must be a string literal.
+#define TSL_LOG(level, format, ...) \
+    ::tsl::internal_log::write<(level), ::tsl::literal_string(format)>(__VA_ARGS__)
+
+#define TSL_LOG_DEBUG(format, ...) TSL_LOG(::tsl::log::level::debug, format __VA_OPT__(,) __VA_ARGS__)
+#define TSL_LOG_INFO(format, ...) TSL_LOG(::tsl::log::level::info, format __VA_OPT__(,) __VA_ARGS__)
+#define TSL_LOG_WARNING(format, ...) TSL_LOG(::tsl::log::level::warning, format __VA_OPT__(,) __VA_ARGS__)
+#define TSL_LOG_ERROR(format, ...) TSL_LOG(::tsl::log::level::error, format __VA_OPT__(,) __VA_ARGS__)
+
+#endif // _TSL_UTIL_LOG_HPP
@@ -0,0 +1,234 @@
+// Integer parsing returning maybe.
+//
+//     tsl::maybe<tsl::non_negative<long>> n = tsl::parse_non_negative<long>(field);
+//     tsl::maybe<std::uint32_t> x = tsl::parse_uint<std::uint32_t>(field, 16);
+//
+// The whole input must be digits in base 10 or 16, with no prefix and no whitespace.
+// parse_int also accepts a leading '-'. Values out of range of the result type fail.
+// maybe<non_negative<T>> stores failure in the breach value, with no extra flag.
+//
+// Decimal digits are validated and converted eight at a time in a 64-bit register,
+// and sixteen at a time with SSE4.1 when available.
+#ifndef _TSL_UTIL_PARSE_HPP
+#define _TSL_UTIL_PARSE_HPP
+
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include "tsl/macros.hpp"
+#include "tsl/maybe.hpp"
+#include "tsl/types/non_negative.hpp"
+
+#if defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+
+namespace tsl {
+
+namespace internal_parse {
+
+inline std::uint64_t load8(char const* p) noexcept {
+    std::uint64_t v;
+    std::memcpy(&v, p, 8);
+    if constexpr (std::endian::native == std::endian::big) {
+#if TSL_HAS_BUILTIN(__builtin_bswap64)
+        v = __builtin_bswap64(v);
+#else
+        std::uint64_t r = 0;
+        for (int i = 0; i < 8; ++i, v >>= 8)
+            r = (r << 8) | (v & 0xFF);
+        v = r;
+#endif
+    }
+    return v;
+}
+
+// Whether the eight bytes are all '0'..'9'.
+inline bool is_eight_digits(std::uint64_t v) noexcept {
+    return ((v & 0xF0F0F0F0F0F0F0F0)
+          | (((v + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) == 0x3333333333333333;
+}
+
+// Eight digits, the first one in the lowest byte, to their value. Adjacent digits are
+// combined in pairs, then the pairs and the quads, with multiplications.
+inline std::uint32_t eight_digits(std::uint64_t v) noexcept {
+    constexpr std::uint64_t mask = 0x000000FF000000FF;
+    constexpr std::uint64_t mul1 = 0x000F424000000064; // 100 + (1000000 << 32)
+    constexpr std::uint64_t mul2 = 0x0000271000000001; // 1 + (10000 << 32)
+    v -= 0x3030303030303030;
+    v = (v * 10) + (v >> 8);
+    v = (((v & mask) * mul1) + (((v >> 16) & mask) * mul2)) >> 32;
+    return static_cast<std::uint32_t>(v);
+}
+
+#if defined(__SSE4_1__)
+// Sixteen digits to their value, or false if any isn't a digit.
+inline bool sixteen_digits(char const* p, std::uint64_t& out) noexcept {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p));
+    __m128i digits = _mm_sub_epi8(chunk, _mm_set1_epi8('0'));
+    // Bytes below '0' wrap to large values, so one unsigned comparison checks both ends.
+    __m128i over = _mm_cmpeq_epi8(_mm_max_epu8(digits, _mm_set1_epi8(9)), _mm_set1_epi8(9));
+    if (_mm_movemask_epi8(over) != 0xFFFF)
+        return false;
+    __m128i pairs = _mm_maddubs_epi16(digits, _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1,
+                                                            10, 1, 10, 1, 10, 1, 10, 1));
+    __m128i quads = _mm_madd_epi16(pairs, _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1));
+    __m128i packed = _mm_packus_epi32(quads, quads);
+    __m128i eights = _mm_madd_epi16(packed, _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1));
+    auto hi = static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm_cvtsi128_si32(eights)));
+    auto lo = static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm_extract_epi32(eights, 1)));
+    out = hi * 100000000 + lo;
+    return true;
+}
+#endif
+
+// Digit value in base 16, or 16 for non-digits.
+inline unsigned hex_digit(char c) noexcept {
+    auto u = static_cast<unsigned char>(c);
+    if (u - '0' < 10)
+        return u - '0';
+    u |= 0x20;
+    if (u - 'a' < 6)
+        return u - 'a' + 10;
+    return 16;
+}
+
+// v = v * mul + add, or false on overflow. `mul` isn't zero.
+inline bool mul_add(std::uint64_t& v, std::uint64_t mul, std::uint64_t add) noexcept {
+#if TSL_HAS_BUILTIN(__builtin_mul_overflow) && TSL_HAS_BUILTIN(__builtin_add_overflow)
+    return !__builtin_mul_overflow(v, mul, &v) && !__builtin_add_overflow(v, add, &v);
+#else
+    if (v > (std::numeric_limits<std::uint64_t>::max() - add) / mul)
+        return false;
+    v = v * mul + add;
+    return true;
+#endif
+}
+
+// Magnitude of the digits in `s`, if it doesn't exceed `max`.
+inline maybe<std::uint64_t> parse_magnitude(std::string_view s, int base, std::uint64_t max) noexcept {
+    TSL_HARDENING_ASSERT(base == 10 || base == 16);
+    if (s.empty())
+        return {};
+
+    char const* p = s.data();
+    char const* end = p + s.size();
+    std::uint64_t v = 0;
+
+    if (base == 16) {
+        // Sixteen hex digits fit, skipping leading zeros bounds the loop.
+        while (end - p > 16 && *p == '0')
+            ++p;
+        if (end - p > 16)
+            return {};
+        for (; p != end; ++p) {
+            unsigned d = hex_digit(*p);
+            if (d >= 16)
+                return {};
+            v = (v << 4) | d;
+        }
+        if (v > max)
+            return {};
+        return v;
+    }
+
+#if defined(__SSE4_1__)
+    if (end - p >= 16) {
+        if (!sixteen_digits(p, v))
+            return {};
+        p += 16;
+    }
+#endif
+    while (end - p >= 8) {
+        std::uint64_t chunk = load8(p);
+        if (!is_eight_digits(chunk) || !mul_add(v, 100000000, eight_digits(chunk)))
+            return {};
+        p += 8;
+    }
+    for (; p != end; ++p) {
+        auto d = static_cast<unsigned char>(*p) - unsigned('0');
+        if (d > 9 || !mul_add(v, 10, d))
+            return {};
+    }
+    if (v > max)
+        return {};
+    return v;
+}
+
+}
+
+template<std::unsigned_integral T = std::uint64_t>
+[[nodiscard]] inline maybe<T> parse_uint(std::string_view s, int base = 10) noexcept {
+    auto v = internal_parse::parse_magnitude(s, base, std::numeric_limits<T>::max());
+    if (!v.has_value())
+        return {};
+    return static_cast<T>(*v);
+}
+
+template<std::signed_integral T = std::int64_t>
+[[nodiscard]] inline maybe<T> parse_int(std::string_view s, int base = 10) noexcept {
+    using U = std::make_unsigned_t<T>;
+    bool negative = !s.empty() && s.front() == '-';
+    if (negative)
+        s.remove_prefix(1);
+    // The magnitude of the minimum is one more than the maximum.
+    std::uint64_t max = static_cast<U>(std::numeric_limits<T>::max()) + std::uint64_t(negative);
+    auto v = internal_parse::parse_magnitude(s, base, max);
+    if (!v.has_value())
+        return {};
+    U u = static_cast<U>(*v);
+    return static_cast<T>(negative ? U(0) - u : u);
+}
+
+template<std::signed_integral T = std::int64_t>
+[[nodiscard]] inline maybe<non_negative<T>> parse_non_negative(std::string_view s, int base = 10) noexcept {
+    auto v = internal_parse::parse_magnitude(s, base, static_cast<std::uint64_t>(std::numeric_limits<T>::max()));
+    if (!v.has_value())
+        return {};
+    return non_negative<T>(unchecked, static_cast<T>(*v));
+}
+
+namespace internal_parse {
+
+template<typename T>
+inline maybe<T> parse_one(std::string_view s, int base) noexcept {
+    if constexpr (std::unsigned_integral<T>)
+        return parse_uint<T>(s, base);
+    else if constexpr (std::signed_integral<T>)
+        return parse_int<T>(s, base);
+    else
+        return parse_non_negative<typename T::type>(s, base);
+}
+
+}
+
+// Parses the `delimiter`-separated integers of `in` into `out`. A trailing delimiter
+// is allowed. Returns how many were parsed, or an empty maybe if a field is invalid
+// or `out` is too small.
+template<typename T>
+    requires(std::integral<T> || std::same_as<T, non_negative<typename T::type>>)
+[[nodiscard]] inline maybe<std::size_t> parse_list(std::string_view in, char delimiter,
+                                                   std::span<T> out, int base = 10) noexcept {
+    std::size_t n = 0;
+    while (!in.empty()) {
+        std::size_t end = in.find(delimiter);
+        auto v = internal_parse::parse_one<T>(in.substr(0, end), base);
+        if (!v.has_value() || n == out.size())
+            return {};
+        out[n++] = *v;
+        if (end == std::string_view::npos)
+            break;
+        in.remove_prefix(end + 1);
+    }
+    return n;
+}
+
+}
+
+#endif // _TSL_UTIL_PARSE_HPP
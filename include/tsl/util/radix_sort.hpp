@@ -0,0 +1,247 @@
+// Stable LSD radix sort for non_negative keys.
+//
+//     tsl::radix_sort(offsets);                                  // vector<non_negative<long>>
+//     tsl::radix_sort(pool, offsets);
+//     tsl::radix_sort_by_key(edges, [](edge const& e) { return e.target; });
+//     tsl::radix_sort(parents);                                  // vector<maybe<non_negative<int>>>
+//
+// Keys are sorted as unsigned integers one byte at a time, no sign flip is needed.
+// The histograms of every byte are computed in a single pre-pass, and bytes where all
+// keys agree are skipped, which covers the high bytes that are zero for every key.
+//
+// With a maybe key, empty values sort first: the breach value -1 plus one is zero.
+//
+// Keys and records are sorted in any contiguous array, such as a std::vector, a
+// std::array or a std::span. Sorting needs a scratch buffer as large as the input.
+#ifndef _TSL_UTIL_RADIX_SORT_HPP
+#define _TSL_UTIL_RADIX_SORT_HPP
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "tsl/concurrency/parallel.hpp"
+#include "tsl/concurrency/thread_pool.hpp"
+#include "tsl/maybe.hpp"
+#include "tsl/types/non_negative.hpp"
+
+namespace tsl {
+
+namespace internal_radix {
+
+inline constexpr std::size_t buckets = 256;
+
+// Below this size std::stable_sort is faster than the passes.
+inline constexpr std::size_t small_size = 256;
+
+// Elements per chunk of the parallel passes.
+inline constexpr std::size_t parallel_grain = std::size_t(1) << 16;
+
+using histogram = std::array<std::size_t, buckets>;
+
+template<typename U>
+constexpr unsigned digit(U key, unsigned d) noexcept {
+    return static_cast<unsigned>(key >> (d * 8)) & 0xFF;
+}
+
+// Sort key of a non_negative, or of a maybe of one, as an unsigned integer.
+template<std::signed_integral T>
+constexpr std::make_unsigned_t<T> key_of(non_negative<T> const& v) noexcept {
+    return static_cast<std::make_unsigned_t<T>>(v.raw());
+}
+
+template<internal_types::maybe_non_negative M>
+constexpr std::make_unsigned_t<internal_types::maybe_non_negative_int<M>> key_of(M const& v) noexcept {
+    using U = std::make_unsigned_t<internal_types::maybe_non_negative_int<M>>;
+    return static_cast<U>(static_cast<U>(v.unchecked_value().raw()) + 1);
+}
+
+template<typename R, typename U, typename Key>
+void scatter(R* src, R* dst, std::size_t first, std::size_t last, unsigned d,
+             std::size_t* offsets, Key& key) {
+    for (std::size_t i = first; i < last; ++i) {
+        unsigned b = digit<U>(key(src[i]), d);
+        dst[offsets[b]++] = std::move(src[i]);
+    }
+}
+
+// Scatters `src` into `dst` by digit `d`. Each chunk counts its own digits, then
+// writes to a disjoint slice of every bucket, which keeps the pass stable.
+template<typename R, typename U, typename Key>
+void parallel_pass(thread_pool& pool, R* src, R* dst, std::size_t n, unsigned d, Key& key) {
+    std::size_t chunks = (n + parallel_grain - 1) / parallel_grain;
+    std::vector<histogram> counts(chunks);
+
+    parallel_for(pool, 0, chunks, [&](std::size_t c) {
+        histogram& h = counts[c];
+        h.fill(0);
+        std::size_t last = std::min(n, (c + 1) * parallel_grain);
+        for (std::size_t i = c * parallel_grain; i < last; ++i)
+            ++h[digit<U>(key(src[i]), d)];
+    }, 1);
+
+    std::size_t sum = 0;
+    for (std::size_t b = 0; b < buckets; ++b) {
+        for (histogram& h : counts) {
+            std::size_t count = h[b];
+            h[b] = sum;
+            sum += count;
+        }
+    }
+
+    parallel_for(pool, 0, chunks, [&](std::size_t c) {
+        std::size_t last = std::min(n, (c + 1) * parallel_grain);
+        scatter<R, U>(src, dst, c * parallel_grain, last, d, counts[c].data(), key);
+    }, 1);
+}
+
+// Histograms of every digit, from one read of the keys.
+template<typename R, typename U, typename Key>
+void count_digits(R const* data, std::size_t first, std::size_t last, histogram* h, Key& key) {
+    for (std::size_t i = first; i < last; ++i) {
+        U k = key(data[i]);
+        for (unsigned d = 0; d < sizeof(U); ++d)
+            ++h[d][digit<U>(k, d)];
+    }
+}
+
+template<typename R, typename Key>
+void sort(std::span<R> data, Key key, thread_pool* pool) {
+    using U = std::remove_cvref_t<std::invoke_result_t<Key&, R const&>>;
+    static_assert(std::unsigned_integral<U>);
+    constexpr unsigned digits = sizeof(U);
+
+    std::size_t n = data.size();
+    if (n < small_size) {
+        std::stable_sort(data.begin(), data.end(), [&](R const& a, R const& b) {
+            return key(a) < key(b);
+        });
+        return;
+    }
+
+    std::array<histogram, digits> counts {};
+    if (pool != nullptr && n > parallel_grain) {
+        std::size_t chunks = (n + parallel_grain - 1) / parallel_grain;
+        std::vector<std::array<histogram, digits>> partial(chunks);
+        parallel_for(*pool, 0, chunks, [&](std::size_t c) {
+            partial[c] = {};
+            std::size_t last = std::min(n, (c + 1) * parallel_grain);
+            count_digits<R, U>(data.data(), c * parallel_grain, last, partial[c].data(), key);
+        }, 1);
+        for (auto const& p : partial) {
+            for (unsigned d = 0; d < digits; ++d) {
+                for (std::size_t b = 0; b < buckets; ++b)
+                    counts[d][b] += p[d][b];
+            }
+        }
+    } else {
+        count_digits<R, U>(data.data(), 0, n, counts.data(), key);
+    }
+
+    // A digit shared by every key doesn't change the order.
+    unsigned passes[digits];
+    unsigned pass_count = 0;
+    for (unsigned d = 0; d < digits; ++d) {
+        if (std::find(counts[d].begin(), counts[d].end(), n) == counts[d].end())
+            passes[pass_count++] = d;
+    }
+    if (pass_count == 0)
+        return;
+
+    auto scratch = std::make_unique_for_overwrite<R[]>(n);
+    R* src = data.data();
+    R* dst = scratch.get();
+    for (unsigned p = 0; p < pass_count; ++p) {
+        unsigned d = passes[p];
+        if (pool != nullptr && n > parallel_grain) {
+            parallel_pass<R, U>(*pool, src, dst, n, d, key);
+        } else {
+            histogram offsets;
+            std::size_t sum = 0;
+            for (std::size_t b = 0; b < buckets; ++b) {
+                offsets[b] = sum;
+                sum += counts[d][b];
+            }
+            scatter<R, U>(src, dst, 0, n, d, offsets.data(), key);
+        }
+        std::swap(src, dst);
+    }
+
+    if (src != data.data())
+        std::move(src, src + n, data.data());
+}
+
+template<typename R, typename KeyFn>
+auto record_key(KeyFn& key_fn) {
+    return [&key_fn](R const& r) { return key_of(std::invoke(key_fn, r)); };
+}
+
+}
+
+// Sort keys: non_negative<T> and maybe<non_negative<T>>.
+template<typename K>
+concept radix_sortable = requires(K const& k) {
+    { internal_radix::key_of(k) } -> std::unsigned_integral;
+};
+
+namespace internal_radix {
+
+// Arrays of keys or records sorted in place: std::vector, std::array, std::span and
+// the like.
+template<typename R>
+concept mutable_array = std::ranges::contiguous_range<R> && std::ranges::sized_range<R>
+    && !std::is_const_v<std::remove_reference_t<std::ranges::range_reference_t<R>>>;
+
+template<mutable_array R>
+using span_of = std::span<std::ranges::range_value_t<R>>;
+
+template<typename R, typename KeyFn>
+concept sortable_by_key = mutable_array<R>
+    && std::default_initializable<std::ranges::range_value_t<R>> && std::movable<std::ranges::range_value_t<R>>
+    && radix_sortable<std::remove_cvref_t<std::invoke_result_t<KeyFn&, std::ranges::range_value_t<R> const&>>>;
+
+}
+
+template<internal_radix::mutable_array R>
+    requires radix_sortable<std::ranges::range_value_t<R>>
+void radix_sort(R&& keys) {
+    using K = std::ranges::range_value_t<R>;
+    internal_radix::sort(internal_radix::span_of<R>(keys), [](K const& k) { return internal_radix::key_of(k); },
+                         nullptr);
+}
+
+template<internal_radix::mutable_array R>
+    requires radix_sortable<std::ranges::range_value_t<R>>
+void radix_sort(thread_pool& pool, R&& keys) {
+    using K = std::ranges::range_value_t<R>;
+    internal_radix::sort(internal_radix::span_of<R>(keys), [](K const& k) { return internal_radix::key_of(k); },
+                         &pool);
+}
+
+// Stable sort of `records` by `key_fn(record)`, a non_negative or a maybe of one.
+// Records are moved between the input and a default-initialized scratch buffer.
+template<typename R, typename KeyFn>
+    requires internal_radix::sortable_by_key<R, KeyFn>
+void radix_sort_by_key(R&& records, KeyFn key_fn) {
+    using T = std::ranges::range_value_t<R>;
+    internal_radix::sort(internal_radix::span_of<R>(records), internal_radix::record_key<T>(key_fn), nullptr);
+}
+
+template<typename R, typename KeyFn>
+    requires internal_radix::sortable_by_key<R, KeyFn>
+void radix_sort_by_key(thread_pool& pool, R&& records, KeyFn key_fn) {
+    using T = std::ranges::range_value_t<R>;
+    internal_radix::sort(internal_radix::span_of<R>(records), internal_radix::record_key<T>(key_fn), &pool);
+}
+
+}
+
+#endif // _TSL_UTIL_RADIX_SORT_HPP
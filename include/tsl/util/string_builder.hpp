@@ -0,0 +1,212 @@
+// Builds a string from pieces without copying them.
+//
+//     tsl::string_builder b;
+//     b.append("HTTP/1.1 200 OK\r\nContent-Length: ").append(body.size())
+//      .append("\r\n\r\n").append(body);
+//     ::writev(fd, b.iovecs().data(), static_cast<int>(b.iovecs().size()));
+//     std::string s = b.str();
+//
+// Pieces longer than `inline_threshold` are borrowed: only their address and size
+// are recorded, so they must outlive the builder's output. Shorter pieces, numbers
+// and characters are copied to blocks of an arena, and adjacent copies share a
+// single piece. The total size is kept as pieces are appended, so materializing
+// the string makes one allocation.
+//
+// Pieces are stored as iovec, ready for writev. Note that writev accepts at most
+// IOV_MAX pieces per call. Systems without <sys/uio.h> get a struct of the same
+// layout.
+#ifndef _TSL_UTIL_STRING_BUILDER_HPP
+#define _TSL_UTIL_STRING_BUILDER_HPP
+
+#include <algorithm>
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include "tsl/attributes.hpp"
+#include "tsl/containers/small_vector.hpp"
+#include "tsl/cstring_ref.hpp"
+#include "tsl/literal_string.hpp"
+#include "tsl/macros.hpp"
+#include "tsl/maybe.hpp"
+#include "tsl/memory/arena.hpp"
+
+#if TSL_HAS_INCLUDE(<sys/uio.h>)
+#include <sys/uio.h>
+#define TSL_INTERNAL_HAS_IOVEC 1
+#else
+#define TSL_INTERNAL_HAS_IOVEC 0
+#endif
+
+namespace tsl {
+
+namespace internal_string_builder {
+
+#if TSL_INTERNAL_HAS_IOVEC
+using iovec = ::iovec;
+#else
+struct iovec {
+    void* iov_base;
+    std::size_t iov_len;
+};
+#endif
+
+}
+
+class string_builder {
+public:
+    using iovec = internal_string_builder::iovec;
+
+    // Pieces up to this size are copied instead of borrowed.
+    static constexpr std::size_t inline_threshold = 32;
+
+    // Copies go to an arena owned by the builder.
+    string_builder() noexcept : arena_(&own_arena_) { }
+
+    // Copies go to `a`, which must outlive the builder's output.
+    explicit string_builder(arena& a TSL_ATTR_LIFETIMEBOUND) noexcept : arena_(&a) { }
+
+    string_builder(string_builder const&) = delete;
+    string_builder& operator=(string_builder const&) = delete;
+
+    string_builder& append(std::string_view s) {
+        if (s.size() <= inline_threshold)
+            return append_copy(s);
+        add_piece(const_cast<char*>(s.data()), s.size());
+        return *this;
+    }
+
+    string_builder& append(cstring_ref s) {
+        return append(std::string_view(s.get()));
+    }
+
+    string_builder& append(char const* s) {
+        return append(std::string_view(s));
+    }
+
+    string_builder& append(std::string const& s) {
+        return append(std::string_view(s));
+    }
+
+    // A temporary string would dangle, it's copied.
+    string_builder& append(std::string&& s) {
+        return append_copy(s);
+    }
+
+    template<std::size_t N>
+    string_builder& append(literal_string<N> const& s) {
+        return append(std::string_view(s.data));
+    }
+
+    string_builder& append(char c) {
+        *reserve_copy(1) = c;
+        commit_copy(1);
+        return *this;
+    }
+
+    template<std::integral T>
+        requires(!std::same_as<T, char> && !std::same_as<T, bool>)
+    string_builder& append(T value) {
+        constexpr std::size_t max_digits = 24;
+        char* p = reserve_copy(max_digits);
+        commit_copy(static_cast<std::size_t>(std::to_chars(p, p + max_digits, value).ptr - p));
+        return *this;
+    }
+
+    // Copies `s` regardless of its size.
+    string_builder& append_copy(std::string_view s) {
+        if (s.empty())
+            return *this;
+        std::memcpy(reserve_copy(s.size()), s.data(), s.size());
+        commit_copy(s.size());
+        return *this;
+    }
+
+    template<typename T>
+    string_builder& operator+=(T&& piece) {
+        return append(std::forward<T>(piece));
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept { return size_; }
+    [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+    [[nodiscard]] std::size_t piece_count() const noexcept { return pieces_.size(); }
+
+    [[nodiscard]] std::span<iovec const> iovecs() const noexcept {
+        return std::span<iovec const>(pieces_.data(), pieces_.size());
+    }
+
+    // Copies the string to `out`. Returns its size, or an empty maybe if `out` is
+    // too small, in which case nothing is written.
+    maybe<std::size_t> copy_to(std::span<char> out) const noexcept {
+        if (out.size() < size_)
+            return {};
+        char* p = out.data();
+        for (iovec const& v : pieces_) {
+            std::memcpy(p, v.iov_base, v.iov_len);
+            p += v.iov_len;
+        }
+        return size_;
+    }
+
+    [[nodiscard]] std::string str() const {
+        std::string s(size_, '\0');
+        static_cast<void>(copy_to(s));
+        return s;
+    }
+
+    // Removes every piece. Copies made to the builder's own arena are freed.
+    void clear() noexcept {
+        pieces_.clear();
+        size_ = 0;
+        copy_ptr_ = copy_end_ = nullptr;
+        if (arena_ == &own_arena_)
+            own_arena_.reset();
+    }
+
+private:
+    static constexpr std::size_t copy_block_size = 256;
+
+    void add_piece(char* p, std::size_t n) {
+        pieces_.push_back(iovec{p, n});
+        size_ += n;
+    }
+
+    // Room for `n` bytes in the current copy block.
+    char* reserve_copy(std::size_t n) {
+        if (static_cast<std::size_t>(copy_end_ - copy_ptr_) < n) {
+            std::size_t block = std::max(n, copy_block_size);
+            copy_ptr_ = static_cast<char*>(arena_->allocate(block, 1));
+            copy_end_ = copy_ptr_ + block;
+        }
+        return copy_ptr_;
+    }
+
+    // Extends the last piece when it ends where the copy starts.
+    void commit_copy(std::size_t n) {
+        if (!pieces_.empty()) {
+            iovec& last = pieces_.back();
+            if (static_cast<char*>(last.iov_base) + last.iov_len == copy_ptr_) {
+                last.iov_len += n;
+                size_ += n;
+                copy_ptr_ += n;
+                return;
+            }
+        }
+        add_piece(copy_ptr_, n);
+        copy_ptr_ += n;
+    }
+
+    small_vector<iovec, 16> pieces_;
+    std::size_t size_ = 0;
+    char* copy_ptr_ = nullptr;
+    char* copy_end_ = nullptr;
+    arena* arena_;
+    inline_arena<copy_block_size> own_arena_;
+};
+
+}
+
+#endif // _TSL_UTIL_STRING_BUILDER_HPP
@@ -0,0 +1,680 @@
+// A tagged union, like std::variant, tuned for small messages.
+//
+// - The discriminant is the smallest unsigned integer that fits the alternatives.
+// - A variant of one alternative with a niche (see tsl/types/niche.hpp) and one empty
+//   alternative stores no discriminant at all: the niche marks the empty alternative,
+//   the same trick maybe uses for contract types. A single niche value encodes a
+//   single alternative, so every other variant uses a discriminant.
+// - `visit()` dispatches with one switch, which compilers lower to a jump table or
+//   to a branch chain for few alternatives. Large variants use a table of functions.
+// - When every alternative is nothrow move constructible, there is no valueless
+//   state: assignments that may throw construct a temporary first.
+#ifndef _TSL_VARIANT_HPP
+#define _TSL_VARIANT_HPP
+
+#include <algorithm>
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "tsl/concepts.hpp"
+#include "tsl/macros.hpp"
+#include "tsl/type_traits.hpp"
+#include "tsl/types/niche.hpp"
+
+namespace tsl {
+
+class bad_variant_access : public std::exception {
+public:
+    bad_variant_access() = default;
+    ~bad_variant_access() override = default;
+
+    const char* what() const noexcept override {
+        return "bad variant access";
+    }
+};
+
+inline constexpr std::size_t variant_npos = static_cast<std::size_t>(-1);
+
+template<typename... Ts>
+class variant;
+
+template<typename F, typename V>
+decltype(auto) visit(F&& f, V&& v);
+
+namespace internal_variant {
+
+struct access {
+    template<typename V>
+    static auto& storage(V& v) noexcept {
+        return v.storage_;
+    }
+};
+
+template<std::size_t I, typename... Ts>
+using at = type_list_at_t<I, type_list<Ts...>>;
+
+// Alternatives are named by type only when they appear once.
+template<typename T, typename... Ts>
+inline constexpr std::size_t index_of = type_list_count_v<T, type_list<Ts...>> == 1
+    ? type_list_index_of_v<T, type_list<Ts...>> : variant_npos;
+
+template<typename T>
+struct array_of_one {
+    T value[1];
+};
+
+// One imaginary function F(T_i) per alternative, declared only when U converts to T_i
+// without narrowing.
+template<std::size_t I, typename T, typename U>
+struct candidate {
+    static void select();
+};
+
+template<std::size_t I, typename T, typename U>
+    requires requires { array_of_one<T>{{std::declval<U>()}}; }
+struct candidate<I, T, U> {
+    static std::integral_constant<std::size_t, I> select(T);
+};
+
+template<typename U, typename Is, typename... Ts>
+struct candidates;
+
+template<typename U, std::size_t... Is, typename... Ts>
+struct candidates<U, std::index_sequence<Is...>, Ts...> : candidate<Is, Ts, U>... {
+    using candidate<Is, Ts, U>::select...;
+};
+
+// Alternative built by the converting constructor, chosen like std::variant's: overload
+// resolution over F(T_i) for each alternative. variant_npos when no overload is viable
+// or the call is ambiguous, which includes every repeated alternative.
+template<typename U, typename... Ts>
+constexpr std::size_t select_index() {
+    using set = candidates<U, std::index_sequence_for<Ts...>, Ts...>;
+    if constexpr (requires { set::select(std::declval<U>()); })
+        return decltype(set::select(std::declval<U>()))::value;
+    else
+        return variant_npos;
+}
+
+template<std::size_t Count>
+using index_type =
+    std::conditional_t<Count <= UINT8_MAX, std::uint8_t,
+    std::conditional_t<Count <= UINT16_MAX, std::uint16_t, std::uint32_t>>;
+
+// Alternatives live in a byte buffer, followed by the discriminant.
+template<typename... Ts>
+class tagged_storage {
+public:
+    static constexpr bool may_be_valueless = !(std::is_nothrow_move_constructible_v<Ts> && ...);
+
+    // One more value for the valueless state.
+    using tag_type = index_type<sizeof...(Ts)>;
+
+    std::size_t index() const noexcept {
+        if constexpr (may_be_valueless) {
+            if (tag_ == sizeof...(Ts))
+                return variant_npos;
+        }
+        return tag_;
+    }
+
+    template<std::size_t I>
+    at<I, Ts...>* get() noexcept {
+        return std::launder(reinterpret_cast<at<I, Ts...>*>(buffer_));
+    }
+
+    template<std::size_t I>
+    at<I, Ts...> const* get() const noexcept {
+        return std::launder(reinterpret_cast<at<I, Ts...> const*>(buffer_));
+    }
+
+    template<std::size_t I, typename... Args>
+    void construct(Args&&... args) {
+        std::construct_at(reinterpret_cast<at<I, Ts...>*>(buffer_), std::forward<Args>(args)...);
+        tag_ = static_cast<tag_type>(I);
+    }
+
+    void set_valueless() noexcept {
+        tag_ = static_cast<tag_type>(sizeof...(Ts));
+    }
+
+private:
+    alignas(Ts...) std::byte buffer_[std::max({sizeof(Ts)...})];
+    tag_type tag_;
+};
+
+template<typename T>
+concept niche_carrier = has_niche<T> && std::is_trivially_copyable_v<T>;
+
+template<typename T>
+concept unit_alternative =
+    std::is_empty_v<T> && std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>;
+
+template<typename... Ts>
+inline constexpr bool use_niche = false;
+
+template<typename A, typename B>
+inline constexpr bool use_niche<A, B> =
+    (niche_carrier<A> && unit_alternative<B>) || (niche_carrier<B> && unit_alternative<A>);
+
+// Stores the carrier only. The unit alternative is active while the carrier
+// holds its niche, and keeps an object of its own, which takes no space.
+template<typename... Ts>
+class niche_storage {
+    static constexpr std::size_t carrier = niche_carrier<at<0, Ts...>> ? 0 : 1;
+    static constexpr std::size_t unit = 1 - carrier;
+
+    using carrier_type = at<carrier, Ts...>;
+    using unit_type = at<unit, Ts...>;
+    using niche = niche_traits<carrier_type>;
+
+public:
+    static constexpr bool may_be_valueless = false;
+
+    niche_storage() noexcept : carrier_(niche::make_empty()) { }
+
+    std::size_t index() const noexcept {
+        return niche::is_empty(carrier_) ? unit : carrier;
+    }
+
+    template<std::size_t I>
+    at<I, Ts...>* get() noexcept {
+        if constexpr (I == carrier)
+            return std::addressof(carrier_);
+        else
+            return std::addressof(unit_);
+    }
+
+    template<std::size_t I>
+    at<I, Ts...> const* get() const noexcept {
+        if constexpr (I == carrier)
+            return std::addressof(carrier_);
+        else
+            return std::addressof(unit_);
+    }
+
+    template<std::size_t I, typename... Args>
+    void construct(Args&&... args) {
+        if constexpr (I == carrier) {
+            std::construct_at(std::addressof(carrier_), std::forward<Args>(args)...);
+            TSL_HARDENING_ASSERT(!niche::is_empty(carrier_));
+        } else {
+            std::construct_at(std::addressof(unit_), std::forward<Args>(args)...);
+            carrier_ = niche::make_empty();
+        }
+    }
+
+    void set_valueless() noexcept {
+        TSL_UNREACHABLE();
+    }
+
+private:
+    carrier_type carrier_;
+    [[no_unique_address]] unit_type unit_;
+};
+
+template<typename... Ts>
+using storage = std::conditional_t<use_niche<Ts...>, niche_storage<Ts...>, tagged_storage<Ts...>>;
+
+template<typename V>
+struct alternatives;
+
+template<typename... Ts>
+struct alternatives<variant<Ts...>> {
+    static constexpr std::size_t size = sizeof...(Ts);
+};
+
+template<typename V>
+inline constexpr std::size_t size_of = alternatives<std::remove_cvref_t<V>>::size;
+
+// Forwards the value category of the variant to the alternative.
+template<std::size_t I, typename V>
+decltype(auto) unchecked_get(V&& v) noexcept {
+    auto* p = access::storage(v).template get<I>();
+    using alternative = std::remove_pointer_t<decltype(p)>;
+    if constexpr (std::is_lvalue_reference_v<V>)
+        return static_cast<alternative&>(*p);
+    else
+        return static_cast<alternative&&>(*p);
+}
+
+template<typename F, typename V>
+using visit_result = std::invoke_result_t<F, decltype(unchecked_get<0>(std::declval<V>()))>;
+
+// Calls `f(alternative)`, or `f(std::integral_constant<std::size_t, I>(), alternative)`
+// when WithIndex, for visitors that must tell repeated alternatives apart.
+template<bool WithIndex, std::size_t I, typename R, typename F, typename V>
+R visit_one(F&& f, V&& v) {
+    if constexpr (WithIndex)
+        return std::invoke(std::forward<F>(f), std::integral_constant<std::size_t, I>(),
+                           unchecked_get<I>(std::forward<V>(v)));
+    else
+        return std::invoke(std::forward<F>(f), unchecked_get<I>(std::forward<V>(v)));
+}
+
+template<bool WithIndex, typename R, typename F, typename V, std::size_t... Is>
+R visit_table(F&& f, V&& v, std::size_t index, std::index_sequence<Is...>) {
+    static constexpr R (*table[])(F&&, V&&) = {&visit_one<WithIndex, Is, R, F, V>...};
+    return table[index](std::forward<F>(f), std::forward<V>(v));
+}
+
+// Variants with more alternatives than cases use the table.
+inline constexpr std::size_t visit_switch_cases = 16;
+
+#define TSL_INTERNAL_VISIT_CASE(i) \
+    case i: \
+        if constexpr (i < N) \
+            return visit_one<WithIndex, i, R>(std::forward<F>(f), std::forward<V>(v)); \
+        else \
+            TSL_INTERNAL_UNREACHABLE();
+
+template<typename R, bool WithIndex = false, typename F, typename V>
+R visit_index(F&& f, V&& v, std::size_t index) {
+    constexpr std::size_t N = size_of<V>;
+    if constexpr (N > visit_switch_cases) {
+        return visit_table<WithIndex, R>(std::forward<F>(f), std::forward<V>(v), index,
+                                         std::make_index_sequence<N>());
+    } else {
+        switch (index) {
+            TSL_INTERNAL_VISIT_CASE(0)
+            TSL_INTERNAL_VISIT_CASE(1)
+            TSL_INTERNAL_VISIT_CASE(2)
+            TSL_INTERNAL_VISIT_CASE(3)
+            TSL_INTERNAL_VISIT_CASE(4)
+            TSL_INTERNAL_VISIT_CASE(5)
+            TSL_INTERNAL_VISIT_CASE(6)
+            TSL_INTERNAL_VISIT_CASE(7)
+            TSL_INTERNAL_VISIT_CASE(8)
+            TSL_INTERNAL_VISIT_CASE(9)
+            TSL_INTERNAL_VISIT_CASE(10)
+            TSL_INTERNAL_VISIT_CASE(11)
+            TSL_INTERNAL_VISIT_CASE(12)
+            TSL_INTERNAL_VISIT_CASE(13)
+            TSL_INTERNAL_VISIT_CASE(14)
+            TSL_INTERNAL_VISIT_CASE(15)
+        }
+        TSL_INTERNAL_UNREACHABLE();
+    }
+}
+
+#undef TSL_INTERNAL_VISIT_CASE
+
+template<typename R, typename F, typename V>
+R visit_with_index(F&& f, V&& v, std::size_t index) {
+    return visit_index<R, true>(std::forward<F>(f), std::forward<V>(v), index);
+}
+
+}
+
+template<typename... Ts>
+class variant {
+    static_assert(sizeof...(Ts) > 0, "variant must have at least one alternative");
+    static_assert(((std::is_object_v<Ts> && !std::is_array_v<Ts>) && ...),
+                  "variant alternatives must be non-array object types");
+
+    using storage_type = internal_variant::storage<Ts...>;
+
+    template<std::size_t I>
+    using alternative = internal_variant::at<I, Ts...>;
+
+    template<typename T>
+    static constexpr std::size_t index_of = internal_variant::index_of<T, Ts...>;
+
+    static constexpr bool nothrow_movable = (std::is_nothrow_move_constructible_v<Ts> && ...);
+
+public:
+    using types = type_list<Ts...>;
+
+    // True when the discriminant is stored in an alternative's niche.
+    static constexpr bool uses_niche = internal_variant::use_niche<Ts...>;
+
+    variant() noexcept(std::is_nothrow_default_constructible_v<alternative<0>>)
+        requires(std::default_initializable<alternative<0>>)
+    {
+        storage_.template construct<0>();
+    }
+
+    template<typename U,
+             std::size_t I = internal_variant::select_index<U, Ts...>()>
+        requires(!std::same_as<std::remove_cvref_t<U>, variant> && I != variant_npos)
+    variant(U&& value) noexcept(std::is_nothrow_constructible_v<alternative<I>, U>) {
+        storage_.template construct<I>(std::forward<U>(value));
+    }
+
+    template<typename T, typename... Args, std::size_t I = index_of<T>>
+        requires(I != variant_npos && std::constructible_from<T, Args...>)
+    explicit variant(std::in_place_type_t<T>, Args&&... args) {
+        storage_.template construct<I>(std::forward<Args>(args)...);
+    }
+
+    template<std::size_t I, typename... Args>
+        requires(I < sizeof...(Ts) && std::constructible_from<alternative<I>, Args...>)
+    explicit variant(std::in_place_index_t<I>, Args&&... args) {
+        storage_.template construct<I>(std::forward<Args>(args)...);
+    }
+
+    // Copies and moves are trivial when every alternative's are.
+
+    variant(variant const&) requires(std::is_trivially_copy_constructible_v<Ts> && ...) = default;
+
+    variant(variant const& other)
+        requires((std::copy_constructible<Ts> && ...)
+                 && !(std::is_trivially_copy_constructible_v<Ts> && ...))
+    {
+        construct_from(other);
+    }
+
+    variant(variant&&) requires(std::is_trivially_move_constructible_v<Ts> && ...) = default;
+
+    variant(variant&& other) noexcept(nothrow_movable)
+        requires((std::move_constructible<Ts> && ...)
+                 && !(std::is_trivially_move_constructible_v<Ts> && ...))
+    {
+        construct_from(std::move(other));
+    }
+
+    variant& operator=(variant const&)
+        requires((std::is_trivially_copy_constructible_v<Ts> && std::is_trivially_copy_assignable_v<Ts>
+                  && std::is_trivially_destructible_v<Ts>) && ...) = default;
+
+    variant& operator=(variant const& other)
+        requires(((std::copy_constructible<Ts> && copy_assignable<Ts>) && ...)
+                 && !((std::is_trivially_copy_constructible_v<Ts> && std::is_trivially_copy_assignable_v<Ts>
+                       && std::is_trivially_destructible_v<Ts>) && ...))
+    {
+        assign_from(other);
+        return *this;
+    }
+
+    variant& operator=(variant&&)
+        requires((std::is_trivially_move_constructible_v<Ts> && std::is_trivially_move_assignable_v<Ts>
+                  && std::is_trivially_destructible_v<Ts>) && ...) = default;
+
+    variant& operator=(variant&& other)
+        noexcept(((std::is_nothrow_move_constructible_v<Ts> && std::is_nothrow_move_assignable_v<Ts>) && ...))
+        requires(((std::move_constructible<Ts> && move_assignable<Ts>) && ...)
+                 && !((std::is_trivially_move_constructible_v<Ts> && std::is_trivially_move_assignable_v<Ts>
+                       && std::is_trivially_destructible_v<Ts>) && ...))
+    {
+        assign_from(std::move(other));
+        return *this;
+    }
+
+    template<typename U,
+             std::size_t I = internal_variant::select_index<U, Ts...>()>
+        requires(!std::same_as<std::remove_cvref_t<U>, variant> && I != variant_npos
+                 && std::assignable_from<alternative<I>&, U>)
+    variant& operator=(U&& value) {
+        if (index() == I)
+            *storage_.template get<I>() = std::forward<U>(value);
+        else
+            emplace<I>(std::forward<U>(value));
+        return *this;
+    }
+
+    ~variant() requires(std::is_trivially_destructible_v<Ts> && ...) = default;
+
+    ~variant() {
+        destroy();
+    }
+
+    [[nodiscard]] std::size_t index() const noexcept {
+        std::size_t i = storage_.index();
+        TSL_ASSUME(i < sizeof...(Ts) || i == variant_npos);
+        return i;
+    }
+
+    // Only possible when an alternative has a throwing move constructor.
+    [[nodiscard]] bool valueless_by_exception() const noexcept {
+        if constexpr (storage_type::may_be_valueless)
+            return index() == variant_npos;
+        else
+            return false;
+    }
+
+    template<std::size_t I, typename... Args>
+        requires(I < sizeof...(Ts) && std::constructible_from<alternative<I>, Args...>)
+    alternative<I>& emplace(Args&&... args) {
+        using T = alternative<I>;
+        if constexpr (std::is_nothrow_constructible_v<T, Args...>) {
+            destroy();
+            storage_.template construct<I>(std::forward<Args>(args)...);
+        } else if constexpr (nothrow_movable) {
+            T tmp(std::forward<Args>(args)...);
+            destroy();
+            storage_.template construct<I>(std::move(tmp));
+        } else {
+            destroy();
+            storage_.set_valueless();
+            storage_.template construct<I>(std::forward<Args>(args)...);
+        }
+        return *storage_.template get<I>();
+    }
+
+    template<typename T, typename... Args, std::size_t I = index_of<T>>
+        requires(I != variant_npos && std::constructible_from<T, Args...>)
+    T& emplace(Args&&... args) {
+        return emplace<I>(std::forward<Args>(args)...);
+    }
+
+    // Calls `f` with the active alternative.
+    template<typename F>
+    decltype(auto) visit(F&& f) & {
+        return tsl::visit(std::forward<F>(f), *this);
+    }
+
+    template<typename F>
+    decltype(auto) visit(F&& f) const& {
+        return tsl::visit(std::forward<F>(f), *this);
+    }
+
+    template<typename F>
+    decltype(auto) visit(F&& f) && {
+        return tsl::visit(std::forward<F>(f), std::move(*this));
+    }
+
+    void swap(variant& other)
+        noexcept(((std::is_nothrow_move_constructible_v<Ts> && std::is_nothrow_swappable_v<Ts>) && ...))
+    {
+        if (index() == other.index() && !valueless_by_exception()) {
+            internal_variant::visit_with_index<void>([&](auto i, auto& a) {
+                using std::swap;
+                swap(a, *other.storage_.template get<decltype(i)::value>());
+            }, *this, index());
+        } else {
+            variant tmp(std::move(other));
+            other = std::move(*this);
+            *this = std::move(tmp);
+        }
+    }
+
+    friend void swap(variant& a, variant& b) noexcept(noexcept(a.swap(b))) {
+        a.swap(b);
+    }
+
+    friend bool operator==(variant const& a, variant const& b)
+        requires(std::equality_comparable<Ts> && ...)
+    {
+        if (a.index() != b.index())
+            return false;
+        if (a.valueless_by_exception())
+            return true;
+        return internal_variant::visit_with_index<bool>([&](auto i, auto const& x) {
+            return x == *b.storage_.template get<decltype(i)::value>();
+        }, a, a.index());
+    }
+
+    // Ordered by index first, like std::variant. Valueless variants come first.
+    friend auto operator<=>(variant const& a, variant const& b)
+        requires(std::three_way_comparable<Ts> && ...)
+    {
+        using result = std::common_comparison_category_t<std::compare_three_way_result_t<Ts>...>;
+        if (a.index() != b.index())
+            return static_cast<result>(a.index() + 1 <=> b.index() + 1);
+        if (a.valueless_by_exception())
+            return static_cast<result>(std::strong_ordering::equal);
+        return internal_variant::visit_with_index<result>([&](auto i, auto const& x) -> result {
+            return x <=> *b.storage_.template get<decltype(i)::value>();
+        }, a, a.index());
+    }
+
+private:
+    friend struct internal_variant::access;
+
+    void destroy() noexcept {
+        if constexpr (!(std::is_trivially_destructible_v<Ts> && ...)) {
+            if (valueless_by_exception())
+                return;
+            internal_variant::visit_index<void>([]<typename T>(T& value) {
+                std::destroy_at(std::addressof(value));
+            }, *this, index());
+        }
+    }
+
+    template<typename V>
+    void construct_from(V&& other) {
+        if (other.valueless_by_exception()) {
+            storage_.set_valueless();
+            return;
+        }
+        internal_variant::visit_with_index<void>([&](auto i, auto&& value) {
+            storage_.template construct<decltype(i)::value>(std::forward<decltype(value)>(value));
+        }, std::forward<V>(other), other.index());
+    }
+
+    template<typename V>
+    void assign_from(V&& other) {
+        if (other.valueless_by_exception()) {
+            destroy();
+            storage_.set_valueless();
+            return;
+        }
+        internal_variant::visit_with_index<void>([&](auto i, auto&& value) {
+            constexpr std::size_t I = decltype(i)::value;
+            using T = decltype(value);
+            if (index() == I)
+                *storage_.template get<I>() = std::forward<T>(value);
+            else
+                emplace<I>(std::forward<T>(value));
+        }, std::forward<V>(other), other.index());
+    }
+
+    storage_type storage_;
+};
+
+// variant_of
+//
+// The variant of the alternatives in a type_list.
+template<typename List>
+struct variant_of : type_list_apply<variant, List> { };
+
+template<typename List>
+using variant_of_t = typename variant_of<List>::type;
+
+template<typename V>
+struct variant_size;
+
+template<typename... Ts>
+struct variant_size<variant<Ts...>> : std::integral_constant<std::size_t, sizeof...(Ts)> { };
+
+template<typename V>
+struct variant_size<V const> : variant_size<V> { };
+
+template<typename V>
+inline constexpr std::size_t variant_size_v = variant_size<V>::value;
+
+template<std::size_t I, typename V>
+struct variant_alternative;
+
+template<std::size_t I, typename... Ts>
+struct variant_alternative<I, variant<Ts...>> {
+    using type = internal_variant::at<I, Ts...>;
+};
+
+template<std::size_t I, typename V>
+struct variant_alternative<I, V const> {
+    using type = typename variant_alternative<I, V>::type const;
+};
+
+template<std::size_t I, typename V>
+using variant_alternative_t = typename variant_alternative<I, V>::type;
+
+template<typename T, typename... Ts>
+[[nodiscard]] bool holds_alternative(variant<Ts...> const& v) noexcept {
+    static_assert(internal_variant::index_of<T, Ts...> != variant_npos,
+                  "T must appear exactly once in the alternatives");
+    return v.index() == internal_variant::index_of<T, Ts...>;
+}
+
+template<std::size_t I, typename V>
+    requires(I < internal_variant::size_of<V>)
+[[nodiscard]] decltype(auto) get(V&& v) {
+    if (v.index() != I)
+        TSL_THROW(bad_variant_access());
+    return internal_variant::unchecked_get<I>(std::forward<V>(v));
+}
+
+template<typename T, typename V>
+[[nodiscard]] decltype(auto) get(V&& v) {
+    constexpr std::size_t I = []<typename... Ts>(type_list<Ts...>) {
+        return internal_variant::index_of<T, Ts...>;
+    }(typename std::remove_cvref_t<V>::types());
+    static_assert(I != variant_npos, "T must appear exactly once in the alternatives");
+    return get<I>(std::forward<V>(v));
+}
+
+template<std::size_t I, typename... Ts>
+[[nodiscard]] auto* get_if(variant<Ts...>* v) noexcept {
+    return v != nullptr && v->index() == I
+        ? std::addressof(internal_variant::unchecked_get<I>(*v)) : nullptr;
+}
+
+template<std::size_t I, typename... Ts>
+[[nodiscard]] auto* get_if(variant<Ts...> const* v) noexcept {
+    return v != nullptr && v->index() == I
+        ? std::addressof(internal_variant::unchecked_get<I>(*v)) : nullptr;
+}
+
+template<typename T, typename... Ts>
+[[nodiscard]] T* get_if(variant<Ts...>* v) noexcept {
+    return get_if<internal_variant::index_of<T, Ts...>>(v);
+}
+
+template<typename T, typename... Ts>
+[[nodiscard]] T const* get_if(variant<Ts...> const* v) noexcept {
+    return get_if<internal_variant::index_of<T, Ts...>>(v);
+}
+
+// visit()
+//
+// Calls `f` with the active alternatives of every variant. All the calls must return
+// the same type. Throws bad_variant_access if a variant is valueless.
+template<typename F, typename V>
+decltype(auto) visit(F&& f, V&& v) {
+    using R = internal_variant::visit_result<F, V>;
+    if (v.valueless_by_exception())
+        TSL_THROW(bad_variant_access());
+    return internal_variant::visit_index<R>(std::forward<F>(f), std::forward<V>(v), v.index());
+}
+
+template<typename F, typename V, typename... Vs>
+    requires(sizeof...(Vs) > 0)
+decltype(auto) visit(F&& f, V&& v, Vs&&... vs) {
+    return tsl::visit([&](auto&& a) -> decltype(auto) {
+        return tsl::visit([&](auto&&... rest) -> decltype(auto) {
+            return std::invoke(std::forward<F>(f), std::forward<decltype(a)>(a),
+                               std::forward<decltype(rest)>(rest)...);
+        }, std::forward<Vs>(vs)...);
+    }, std::forward<V>(v));
+}
+
+}
+
+#endif // _TSL_VARIANT_HPP
@@ -0,0 +1,340 @@
+#include "tsl/concurrency/thread_pool.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+#include "tsl/internal/chase_lev_deque.hpp"
+#include "tsl/macros.hpp"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#define TSL_HAS_THREAD_AFFINITY 1
+#else
+#define TSL_HAS_THREAD_AFFINITY 0
+#endif
+
+namespace tsl {
+
+namespace internal_thread_pool {
+
+struct worker {
+    thread_pool* pool;
+    std::size_t index;
+    int cpu = -1;
+    int node = 0;
+    std::uint64_t rng;
+    internal::chase_lev_deque deque;
+    std::thread thread;
+};
+
+namespace {
+
+thread_local worker* current_worker = nullptr;
+
+// Work items are either a `task*` or the address of a coroutine frame tagged
+// with the lowest bit. Both are at least 2-byte aligned.
+constexpr std::uintptr_t coroutine_tag = 1;
+
+void run_item(std::uintptr_t item) {
+    if (item & coroutine_tag) {
+        void* address = reinterpret_cast<void*>(item & ~coroutine_tag);
+        std::coroutine_handle<>::from_address(address).resume();
+    } else {
+        task* t = reinterpret_cast<task*>(item);
+        t->invoke(t);
+    }
+}
+
+std::uint64_t next_random(std::uint64_t& state) {
+    // xorshift64
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+struct cpu_slot {
+    int cpu;
+    int node;
+};
+
+#if TSL_HAS_THREAD_AFFINITY
+// Parses a sysfs cpulist, such as "0-3,8,10-11".
+std::vector<int> parse_cpu_list(const char* path) {
+    std::vector<int> cpus;
+    std::FILE* f = std::fopen(path, "r");
+    if (f == nullptr)
+        return cpus;
+
+    int first, last;
+    while (std::fscanf(f, "%d", &first) == 1) {
+        last = first;
+        int c = std::fgetc(f);
+        if (c == '-') {
+            if (std::fscanf(f, "%d", &last) != 1)
+                break;
+            c = std::fgetc(f);
+        }
+        for (int cpu = first; cpu <= last; ++cpu)
+            cpus.push_back(cpu);
+        if (c != ',')
+            break;
+    }
+    std::fclose(f);
+    return cpus;
+}
+
+std::vector<cpu_slot> available_cpus(bool numa_aware) {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+        return {};
+
+    std::vector<cpu_slot> slots;
+    if (numa_aware) {
+        char path[64];
+        for (int node = 0; ; ++node) {
+            std::snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+            std::vector<int> cpus = parse_cpu_list(path);
+            if (cpus.empty())
+                break;
+            for (int cpu : cpus) {
+                if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed))
+                    slots.push_back({cpu, node});
+            }
+        }
+    }
+
+    // Without topology information every CPU is in node zero.
+    if (slots.empty()) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &allowed))
+                slots.push_back({cpu, 0});
+        }
+    }
+    return slots;
+}
+
+void pin_current_thread(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    // Best effort, the pool works the same if pinning fails.
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+#else
+std::vector<cpu_slot> available_cpus(bool) {
+    return {};
+}
+
+void pin_current_thread(int) { }
+#endif
+
+}
+
+}
+
+using internal_thread_pool::worker;
+
+thread_pool::thread_pool()
+    : thread_pool(thread_pool_options{}) { }
+
+thread_pool::thread_pool(thread_pool_options const& options) {
+    std::size_t n = options.threads;
+    if (n == 0)
+        n = std::max(1u, std::thread::hardware_concurrency());
+
+    bool pin = options.pin_threads || options.numa_aware;
+    std::vector<internal_thread_pool::cpu_slot> slots;
+    if (pin)
+        slots = internal_thread_pool::available_cpus(options.numa_aware);
+
+    workers_.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        auto w = std::make_unique<worker>();
+        w->pool = this;
+        w->index = i;
+        w->rng = 0x9e3779b97f4a7c15ull * (i + 1);
+        if (!slots.empty()) {
+            // Slots are ordered by node, so workers fill one node before the next.
+            auto const& slot = slots[i % slots.size()];
+            w->cpu = slot.cpu;
+            w->node = slot.node;
+        }
+        workers_.push_back(std::move(w));
+    }
+
+    // Threads are only started after every worker exists, since they steal from each other.
+    for (auto& w : workers_)
+        w->thread = std::thread([this, p = w.get()] { worker_loop(*p); });
+}
+
+thread_pool::~thread_pool() {
+    stopping_.store(true, std::memory_order_release);
+    epoch_.fetch_add(1, std::memory_order_release);
+    epoch_.notify_all();
+
+    for (auto& w : workers_)
+        w->thread.join();
+}
+
+void thread_pool::submit(std::coroutine_handle<> handle) {
+    auto item = reinterpret_cast<std::uintptr_t>(handle.address());
+    TSL_ASSERT((item & internal_thread_pool::coroutine_tag) == 0);
+    push(item | internal_thread_pool::coroutine_tag);
+}
+
+void thread_pool::submit_task(internal_thread_pool::task* t) {
+    push(reinterpret_cast<std::uintptr_t>(TSL_ASSERT_NONNULL(t)));
+}
+
+thread_pool* thread_pool::current() noexcept {
+    worker* w = internal_thread_pool::current_worker;
+    return w != nullptr ? w->pool : nullptr;
+}
+
+void thread_pool::notify_completion() noexcept {
+    completions_.fetch_add(1, std::memory_order_release);
+    completions_.notify_all();
+}
+
+bool thread_pool::try_run_one() {
+    worker* w = internal_thread_pool::current_worker;
+    std::uintptr_t item;
+    if (w != nullptr && w->pool == this) {
+        item = find_work(*w);
+    } else {
+        item = pop_injection(nullptr);
+        if (item == 0)
+            item = steal(nullptr);
+    }
+
+    if (item == 0)
+        return false;
+    internal_thread_pool::run_item(item);
+    return true;
+}
+
+void thread_pool::push(std::uintptr_t item) {
+    worker* w = internal_thread_pool::current_worker;
+    if (w != nullptr && w->pool == this) {
+        w->deque.push(item);
+    } else {
+        std::lock_guard lock(injection_mutex_);
+        injection_.push_back(item);
+        injection_size_.fetch_add(1, std::memory_order_relaxed);
+    }
+    wake_one();
+}
+
+void thread_pool::wake_one() noexcept {
+    // Pairs with the fence in `worker_loop()`: either the worker sees the new
+    // item when it checks again, or we see it registered as a sleeper.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_relaxed) == 0)
+        return;
+    epoch_.fetch_add(1, std::memory_order_release);
+    epoch_.notify_one();
+}
+
+std::uintptr_t thread_pool::pop_injection(worker* w) {
+    if (injection_size_.load(std::memory_order_relaxed) == 0)
+        return 0;
+
+    std::lock_guard lock(injection_mutex_);
+    if (injection_.empty())
+        return 0;
+
+    std::uintptr_t item = injection_.front();
+    injection_.pop_front();
+    std::size_t taken = 1;
+
+    // Workers grab a fair share of the queue at once, so external producers
+    // don't make every worker contend on this lock for each item.
+    if (w != nullptr) {
+        std::size_t batch = std::min<std::size_t>(injection_.size() / workers_.size(), 32);
+        for (std::size_t i = 0; i < batch; ++i) {
+            w->deque.push(injection_.front());
+            injection_.pop_front();
+        }
+        taken += batch;
+    }
+    injection_size_.fetch_sub(taken, std::memory_order_relaxed);
+    return item;
+}
+
+std::uintptr_t thread_pool::steal(worker* w) {
+    std::size_t n = workers_.size();
+    std::uint64_t r;
+    if (w != nullptr) {
+        r = internal_thread_pool::next_random(w->rng);
+    } else {
+        static thread_local std::uint64_t external_rng = 0x2545f4914f6cdd1dull;
+        r = internal_thread_pool::next_random(external_rng);
+    }
+
+    // Two passes over the victims, the first one restricted to the worker's own node.
+    std::size_t start = r % n;
+    for (int pass = (w != nullptr ? 0 : 1); pass < 2; ++pass) {
+        for (std::size_t k = 0; k < n; ++k) {
+            worker& victim = *workers_[(start + k) % n];
+            if (&victim == w)
+                continue;
+            if (pass == 0 && victim.node != w->node)
+                continue;
+            if (std::uintptr_t item = victim.deque.steal())
+                return item;
+        }
+    }
+    return 0;
+}
+
+std::uintptr_t thread_pool::find_work(worker& w) {
+    if (std::uintptr_t item = w.deque.pop())
+        return item;
+    if (std::uintptr_t item = pop_injection(&w))
+        return item;
+    return steal(&w);
+}
+
+void thread_pool::worker_loop(worker& w) {
+    internal_thread_pool::current_worker = &w;
+    if (w.cpu >= 0)
+        internal_thread_pool::pin_current_thread(w.cpu);
+
+    // Number of failed searches before parking. Keeps latency low for bursts
+    // of small tasks without burning idle cores.
+    constexpr int spin_rounds = 32;
+
+    for (;;) {
+        std::uintptr_t item = find_work(w);
+        for (int i = 0; item == 0 && i < spin_rounds; ++i) {
+            std::this_thread::yield();
+            item = find_work(w);
+        }
+
+        if (item == 0) {
+            std::uint32_t epoch = epoch_.load(std::memory_order_acquire);
+            sleepers_.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            item = find_work(w);
+            if (item == 0) {
+                if (stopping_.load(std::memory_order_acquire)) {
+                    sleepers_.fetch_sub(1, std::memory_order_relaxed);
+                    break;
+                }
+                epoch_.wait(epoch, std::memory_order_acquire);
+            }
+            sleepers_.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        if (item != 0)
+            internal_thread_pool::run_item(item);
+    }
+
+    internal_thread_pool::current_worker = nullptr;
+}
+
+}
@@ -0,0 +1,19 @@
+#include "tsl/internal/json.hpp"
+
+namespace tsl {
+namespace internal {
+
+void write_json_string(std::FILE* out, std::string_view s) {
+    std::fputc('"', out);
+    for (char c : s) {
+        if (c == '"' || c == '\\')
+            std::fprintf(out, "\\%c", c);
+        else if (static_cast<unsigned char>(c) < 0x20)
+            std::fprintf(out, "\\u%04x", static_cast<unsigned>(c));
+        else
+            std::fputc(c, out);
+    }
+    std::fputc('"', out);
+}
+
+}}
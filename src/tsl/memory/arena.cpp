@@ -0,0 +1,123 @@
+#include "tsl/memory/arena.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace tsl {
+
+struct arena::chunk_header {
+    chunk_header* next;
+    std::size_t size;
+
+    std::byte* begin() noexcept {
+        return reinterpret_cast<std::byte*>(this + 1);
+    }
+
+    std::byte* end() noexcept {
+        return begin() + size;
+    }
+};
+
+namespace {
+
+// Chunk sizes stop doubling here, larger requests get a chunk of their own size.
+constexpr std::size_t max_growth_chunk_size = std::size_t(16) << 20;
+
+// Smaller sizes are raised to it, so that chunk sizes grow from zero too.
+constexpr std::size_t min_chunk_size = 256;
+
+}
+
+arena::arena(std::size_t first_chunk_size) noexcept
+    : next_chunk_size_(std::max(first_chunk_size, min_chunk_size)) { }
+
+arena::arena(std::span<std::byte> initial, std::size_t next_chunk_size) noexcept
+    : ptr_(initial.data()),
+      end_(initial.data() + initial.size()),
+      initial_begin_(initial.data()),
+      initial_end_(initial.data() + initial.size())
+{
+    if (next_chunk_size != 0)
+        next_chunk_size_ = std::max(next_chunk_size, min_chunk_size);
+    else
+        next_chunk_size_ = std::max(next_chunk_size_, initial.size() * 2);
+}
+
+arena::~arena() {
+    free_chunks(head_);
+}
+
+void* arena::allocate_slow(std::size_t bytes, std::size_t align) {
+    // Worst case padding to align the start of the chunk's data.
+    std::size_t padding = align > alignof(std::max_align_t) ? align - 1 : 0;
+    if (bytes > SIZE_MAX - padding - sizeof(chunk_header))
+        TSL_THROW(std::bad_alloc());
+    std::size_t needed = bytes + padding;
+
+    chunk_header* prev = current_;
+    chunk_header* next = prev != nullptr ? prev->next : head_;
+
+    // Reuse spare chunks left by a rewind, dropping the ones that are too small.
+    while (next != nullptr && next->size < needed) {
+        chunk_header* small = next;
+        next = next->next;
+        std::free(small);
+    }
+
+    if (next == nullptr) {
+        std::size_t size = std::max(needed, next_chunk_size_);
+        next = static_cast<chunk_header*>(std::malloc(sizeof(chunk_header) + size));
+        if (next == nullptr) {
+            // Keep the list consistent before throwing.
+            (prev != nullptr ? prev->next : head_) = nullptr;
+            TSL_THROW(std::bad_alloc());
+        }
+        next->next = nullptr;
+        next->size = size;
+
+        if (next_chunk_size_ < max_growth_chunk_size)
+            next_chunk_size_ *= 2;
+    }
+
+    (prev != nullptr ? prev->next : head_) = next;
+    current_ = next;
+    ptr_ = next->begin();
+    end_ = next->end();
+
+    void* p = allocate(bytes, align);
+    TSL_ASSERT(p != nullptr);
+    return p;
+}
+
+void arena::rewind(marker m) noexcept {
+    current_ = m.chunk_;
+    ptr_ = m.ptr_;
+    end_ = current_ != nullptr ? current_->end() : initial_end_;
+}
+
+void arena::reset() noexcept {
+    rewind(marker(nullptr, initial_begin_));
+}
+
+void arena::release() noexcept {
+    free_chunks(head_);
+    head_ = nullptr;
+    reset();
+}
+
+std::size_t arena::reserved() const noexcept {
+    std::size_t total = 0;
+    for (chunk_header* c = head_; c != nullptr; c = c->next)
+        total += sizeof(chunk_header) + c->size;
+    return total;
+}
+
+void arena::free_chunks(chunk_header* first) noexcept {
+    while (first != nullptr) {
+        chunk_header* next = first->next;
+        std::free(first);
+        first = next;
+    }
+}
+
+}
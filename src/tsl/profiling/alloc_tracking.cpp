@@ -0,0 +1,314 @@
+#include "tsl/profiling/alloc_tracking.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+#include "tsl/config.hpp"
+#include "tsl/macros.hpp"
+
+#if TSL_ALLOC_TRACKING && defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+#define TSL_INTERNAL_ALLOC_SANITIZED 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(thread_sanitizer) || __has_feature(memory_sanitizer)
+#define TSL_INTERNAL_ALLOC_SANITIZED 1
+#endif
+#endif
+#ifndef TSL_INTERNAL_ALLOC_SANITIZED
+#define TSL_INTERNAL_ALLOC_SANITIZED 0
+#endif
+
+// glibc exports its allocator under these names too, so malloc can be replaced
+// and still forward to it.
+#if TSL_ALLOC_TRACKING && defined(__GLIBC__) && !TSL_INTERNAL_ALLOC_SANITIZED
+#define TSL_INTERNAL_ALLOC_HOOK_MALLOC 1
+extern "C" {
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t n, std::size_t size);
+void* __libc_realloc(void* p, std::size_t size);
+void* __libc_memalign(std::size_t alignment, std::size_t size);
+void __libc_free(void* p);
+}
+#else
+#define TSL_INTERNAL_ALLOC_HOOK_MALLOC 0
+#endif
+
+namespace tsl {
+
+namespace internal_alloc {
+
+namespace {
+
+// Trivial, so accessing it needs no initialization check, even from malloc.
+struct thread_state {
+    std::uint64_t allocations;
+    std::uint64_t deallocations;
+    std::uint64_t bytes;
+    std::uint32_t forbidden;
+    bool reporting;
+    tag* scope;
+};
+
+constinit thread_local thread_state current {};
+
+std::atomic<alloc::violation_action> action {alloc::violation_action::abort};
+std::atomic<std::uint64_t> violation_count {0};
+
+// Every tag a profile scope was entered with, pushed on first use.
+std::atomic<tag*> tags {nullptr};
+
+[[maybe_unused]] void violation(std::size_t size) {
+    thread_state& t = current;
+    // Reporting may allocate.
+    t.reporting = true;
+    if (action.load(std::memory_order_relaxed) == alloc::violation_action::abort)
+        TSL_ABORT("heap allocation inside a TSL_ASSERT_NO_ALLOC scope");
+    violation_count.fetch_add(1, std::memory_order_relaxed);
+    std::fprintf(stderr, "tsl: %zu-byte heap allocation inside a TSL_ASSERT_NO_ALLOC scope\n", size);
+    t.reporting = false;
+}
+
+[[maybe_unused]] inline void on_allocate(std::size_t size) noexcept {
+    thread_state& t = current;
+    ++t.allocations;
+    t.bytes += size;
+    if (t.scope != nullptr) {
+        t.scope->allocations.fetch_add(1, std::memory_order_relaxed);
+        t.scope->bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+    if (TSL_EXPECT_FALSE(t.forbidden != 0 && !t.reporting))
+        violation(size);
+}
+
+[[maybe_unused]] inline void on_deallocate(void* p) noexcept {
+    if (p != nullptr)
+        ++current.deallocations;
+}
+
+}
+
+}
+
+namespace alloc {
+
+counters thread_counters() noexcept {
+    auto const& t = internal_alloc::current;
+    return counters{t.allocations, t.deallocations, t.bytes};
+}
+
+void set_violation_action(violation_action a) noexcept {
+    internal_alloc::action.store(a, std::memory_order_relaxed);
+}
+
+std::uint64_t violations() noexcept {
+    return internal_alloc::violation_count.load(std::memory_order_relaxed);
+}
+
+std::vector<profile_entry> profile() {
+    std::vector<profile_entry> entries;
+    for (auto* t = internal_alloc::tags.load(std::memory_order_acquire); t != nullptr; t = t->next) {
+        entries.push_back(profile_entry{t->name, t->allocations.load(std::memory_order_relaxed),
+                                        t->bytes.load(std::memory_order_relaxed)});
+    }
+    std::sort(entries.begin(), entries.end(), [](profile_entry const& a, profile_entry const& b) {
+        return a.bytes > b.bytes;
+    });
+    return entries;
+}
+
+void reset_profile() noexcept {
+    for (auto* t = internal_alloc::tags.load(std::memory_order_acquire); t != nullptr; t = t->next) {
+        t->allocations.store(0, std::memory_order_relaxed);
+        t->bytes.store(0, std::memory_order_relaxed);
+    }
+}
+
+void write_profile(std::FILE* out) {
+    std::fprintf(out, "%-32s %14s %16s\n", "scope", "allocations", "bytes");
+    for (auto const& e : profile()) {
+        std::fprintf(out, "%-32s %14llu %16llu\n", e.name,
+                     static_cast<unsigned long long>(e.allocations),
+                     static_cast<unsigned long long>(e.bytes));
+    }
+}
+
+no_alloc_scope::no_alloc_scope() noexcept {
+    ++internal_alloc::current.forbidden;
+}
+
+no_alloc_scope::~no_alloc_scope() {
+    --internal_alloc::current.forbidden;
+}
+
+profile_scope::profile_scope(internal_alloc::tag& t) noexcept
+    : previous_(internal_alloc::current.scope)
+{
+    if (TSL_EXPECT_FALSE(!t.registered.load(std::memory_order_acquire))
+        && !t.registered.exchange(true, std::memory_order_acq_rel)) {
+        t.next = internal_alloc::tags.load(std::memory_order_relaxed);
+        while (!internal_alloc::tags.compare_exchange_weak(t.next, &t, std::memory_order_release,
+                                                           std::memory_order_relaxed)) { }
+    }
+    internal_alloc::current.scope = &t;
+}
+
+profile_scope::~profile_scope() {
+    internal_alloc::current.scope = previous_;
+}
+
+}}
+
+#if TSL_ALLOC_TRACKING
+
+namespace {
+
+using tsl::internal_alloc::on_allocate;
+using tsl::internal_alloc::on_deallocate;
+
+// With malloc replaced, operator new goes straight to glibc, so it's counted once.
+void* raw_allocate(std::size_t size) noexcept {
+#if TSL_INTERNAL_ALLOC_HOOK_MALLOC
+    return __libc_malloc(size);
+#else
+    return std::malloc(size);
+#endif
+}
+
+void* raw_allocate(std::size_t size, std::align_val_t alignment) noexcept {
+    auto a = static_cast<std::size_t>(alignment);
+#if TSL_INTERNAL_ALLOC_HOOK_MALLOC
+    return __libc_memalign(a, size);
+#else
+    return std::aligned_alloc(a, (size + a - 1) / a * a);
+#endif
+}
+
+void raw_free(void* p) noexcept {
+#if TSL_INTERNAL_ALLOC_HOOK_MALLOC
+    __libc_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+template<typename... Alignment>
+void* tracked_new(std::size_t size, Alignment... alignment) {
+    on_allocate(size);
+    for (;;) {
+        if (void* p = raw_allocate(size != 0 ? size : 1, alignment...))
+            return p;
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) {
+#if TSL_HAS_EXCEPTIONS
+            throw std::bad_alloc();
+#else
+            TSL_ABORT("out of memory");
+#endif
+        }
+        handler();
+    }
+}
+
+template<typename... Alignment>
+void* tracked_new_nothrow(std::size_t size, Alignment... alignment) noexcept {
+#if TSL_HAS_EXCEPTIONS
+    try {
+        return tracked_new(size, alignment...);
+    } catch (...) {
+        return nullptr;
+    }
+#else
+    on_allocate(size);
+    return raw_allocate(size != 0 ? size : 1, alignment...);
+#endif
+}
+
+void tracked_delete(void* p) noexcept {
+    on_deallocate(p);
+    raw_free(p);
+}
+
+}
+
+void* operator new(std::size_t size) { return tracked_new(size); }
+void* operator new[](std::size_t size) { return tracked_new(size); }
+void* operator new(std::size_t size, std::align_val_t a) { return tracked_new(size, a); }
+void* operator new[](std::size_t size, std::align_val_t a) { return tracked_new(size, a); }
+void* operator new(std::size_t size, std::nothrow_t const&) noexcept { return tracked_new_nothrow(size); }
+void* operator new[](std::size_t size, std::nothrow_t const&) noexcept { return tracked_new_nothrow(size); }
+void* operator new(std::size_t size, std::align_val_t a, std::nothrow_t const&) noexcept {
+    return tracked_new_nothrow(size, a);
+}
+void* operator new[](std::size_t size, std::align_val_t a, std::nothrow_t const&) noexcept {
+    return tracked_new_nothrow(size, a);
+}
+
+void operator delete(void* p) noexcept { tracked_delete(p); }
+void operator delete[](void* p) noexcept { tracked_delete(p); }
+void operator delete(void* p, std::size_t) noexcept { tracked_delete(p); }
+void operator delete[](void* p, std::size_t) noexcept { tracked_delete(p); }
+void operator delete(void* p, std::align_val_t) noexcept { tracked_delete(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { tracked_delete(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { tracked_delete(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { tracked_delete(p); }
+void operator delete(void* p, std::nothrow_t const&) noexcept { tracked_delete(p); }
+void operator delete[](void* p, std::nothrow_t const&) noexcept { tracked_delete(p); }
+void operator delete(void* p, std::align_val_t, std::nothrow_t const&) noexcept { tracked_delete(p); }
+void operator delete[](void* p, std::align_val_t, std::nothrow_t const&) noexcept { tracked_delete(p); }
+
+#if TSL_INTERNAL_ALLOC_HOOK_MALLOC
+
+extern "C" {
+
+void* malloc(std::size_t size) noexcept {
+    on_allocate(size);
+    return __libc_malloc(size);
+}
+
+void* calloc(std::size_t n, std::size_t size) noexcept {
+    on_allocate(n * size);
+    return __libc_calloc(n, size);
+}
+
+void* realloc(void* p, std::size_t size) noexcept {
+    on_deallocate(p);
+    if (size != 0 || p == nullptr)
+        on_allocate(size);
+    return __libc_realloc(p, size);
+}
+
+void free(void* p) noexcept {
+    on_deallocate(p);
+    __libc_free(p);
+}
+
+void* memalign(std::size_t alignment, std::size_t size) noexcept {
+    on_allocate(size);
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(std::size_t alignment, std::size_t size) noexcept {
+    on_allocate(size);
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** out, std::size_t alignment, std::size_t size) noexcept {
+    if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0)
+        return EINVAL;
+    on_allocate(size);
+    void* p = __libc_memalign(alignment, size);
+    if (p == nullptr)
+        return ENOMEM;
+    *out = p;
+    return 0;
+}
+
+}
+
+#endif
+
+#endif
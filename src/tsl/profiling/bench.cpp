@@ -0,0 +1,246 @@
+#include "tsl/profiling/bench.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <string>
+#include <utility>
+#include "tsl/internal/json.hpp"
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace tsl {
+
+namespace internal_bench {
+
+void const* volatile escape_sink = nullptr;
+
+void escape(void const* p) noexcept {
+    escape_sink = p;
+}
+
+namespace {
+
+// Sorted `v` at quantile q, interpolating between neighbours.
+double quantile(std::span<double const> v, double q) {
+    if (v.empty())
+        return 0;
+    double pos = q * static_cast<double>(v.size() - 1);
+    auto lo = static_cast<std::size_t>(pos);
+    std::size_t hi = std::min(lo + 1, v.size() - 1);
+    double frac = pos - static_cast<double>(lo);
+    return v[lo] + (v[hi] - v[lo]) * frac;
+}
+
+template<typename T>
+bool parse_number(std::string_view s, T& out) {
+    auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), out);
+    return ec == std::errc() && ptr == s.data() + s.size();
+}
+
+bool pin_to(int cpu) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return ::sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    static_cast<void>(cpu);
+    return false;
+#endif
+}
+
+maybe<int> current_cpu() {
+#if defined(__linux__)
+    int cpu = ::sched_getcpu();
+    if (cpu >= 0)
+        return cpu;
+#endif
+    return {};
+}
+
+// The cpufreq governor of `cpu`, if the kernel exposes it.
+maybe<std::string> governor(int cpu) {
+    std::ifstream in("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/cpufreq/scaling_governor");
+    std::string g;
+    if (!(in >> g))
+        return {};
+    return g;
+}
+
+}
+
+}
+
+namespace bench {
+
+result summarize(std::string name, std::uint64_t iterations, std::span<double> times) {
+    result r;
+    r.name = std::move(name);
+    r.iterations = iterations;
+    r.samples = times.size();
+    if (times.empty())
+        return r;
+
+    std::sort(times.begin(), times.end());
+    r.min = times.front();
+    r.max = times.back();
+    r.mean = std::accumulate(times.begin(), times.end(), 0.0) / static_cast<double>(times.size());
+    r.median = internal_bench::quantile(times, 0.5);
+    r.p5 = internal_bench::quantile(times, 0.05);
+    r.p25 = internal_bench::quantile(times, 0.25);
+    r.p75 = internal_bench::quantile(times, 0.75);
+    r.p95 = internal_bench::quantile(times, 0.95);
+    r.p99 = internal_bench::quantile(times, 0.99);
+
+    double iqr = r.p75 - r.p25;
+    r.outliers = static_cast<std::size_t>(std::count_if(times.begin(), times.end(), [&](double t) {
+        return t < r.p25 - 1.5 * iqr || t > r.p75 + 1.5 * iqr;
+    }));
+
+    std::vector<double> deviations(times.size());
+    std::transform(times.begin(), times.end(), deviations.begin(),
+                   [&](double t) { return std::abs(t - r.median); });
+    std::sort(deviations.begin(), deviations.end());
+    r.mad = internal_bench::quantile(deviations, 0.5);
+    return r;
+}
+
+runner::runner(options opts)
+    : opts_(std::move(opts)) { }
+
+runner::runner(int argc, char** argv, options defaults)
+    : opts_(std::move(defaults))
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        std::size_t eq = arg.find('=');
+        std::string_view flag = arg.substr(0, eq);
+        std::string_view v = eq == std::string_view::npos ? std::string_view() : arg.substr(eq + 1);
+
+        bool ok = true;
+        if (eq == std::string_view::npos) {
+            ok = false;
+        } else if (flag == "--filter") {
+            opts_.filter = v;
+        } else if (flag == "--json") {
+            opts_.json_path = v;
+        } else if (flag == "--cpu") {
+            int cpu;
+            ok = internal_bench::parse_number(v, cpu) && cpu >= 0;
+            if (ok)
+                opts_.cpu = cpu;
+        } else if (flag == "--pin") {
+            ok = v == "0" || v == "1";
+            opts_.pin = v == "1";
+        } else if (flag == "--samples") {
+            ok = internal_bench::parse_number(v, opts_.samples) && opts_.samples > 0;
+        } else if (flag == "--min-time-ms") {
+            // Positive, and small enough to fit in nanoseconds.
+            constexpr std::int64_t max_ms =
+                std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::nanoseconds::max()).count();
+            std::int64_t ms;
+            ok = internal_bench::parse_number(v, ms) && ms > 0 && ms <= max_ms;
+            if (ok)
+                opts_.min_sample_time = std::chrono::milliseconds(ms);
+        } else {
+            ok = false;
+        }
+
+        if (!ok) {
+            std::fprintf(stderr, "%s: invalid argument '%s'\n"
+                         "usage: %s [--filter=<substring>] [--json=<path>] [--cpu=<n>]"
+                         " [--pin=<0|1>] [--samples=<n>] [--min-time-ms=<n>]\n",
+                         argv[0], argv[i], argv[0]);
+            failed_ = true;
+        }
+    }
+}
+
+// Pins the thread and checks the environment before the first benchmark.
+void runner::prepare() {
+    prepared_ = true;
+
+    maybe<int> cpu = opts_.cpu.has_value() ? opts_.cpu : internal_bench::current_cpu();
+    if (opts_.pin && cpu.has_value() && !internal_bench::pin_to(*cpu))
+        std::fprintf(stderr, "warning: could not pin to CPU %d, results will be noisier\n", *cpu);
+
+    if (auto g = internal_bench::governor(cpu.value_or(0)); g.has_value() && *g != "performance") {
+        std::fprintf(stderr, "warning: CPU frequency scaling is enabled (governor '%s'),"
+                     " results may vary with the clock\n", g->c_str());
+    }
+}
+
+void runner::run_impl(std::string_view name, std::int64_t (*measure)(void*, std::uint64_t), void* body) {
+    if (failed_ || name.find(opts_.filter) == std::string_view::npos)
+        return;
+    if (!prepared_)
+        prepare();
+
+    // Doubling at least, jumping straight to the estimate once a sample is measurable.
+    // Calibration also serves as warm-up.
+    auto min_time = std::max<std::int64_t>(opts_.min_sample_time.count(), 1);
+    std::uint64_t iterations = 1;
+    for (;;) {
+        std::int64_t t = measure(body, iterations);
+        if (t >= min_time || iterations >= (std::uint64_t(1) << 40))
+            break;
+        double estimate = static_cast<double>(iterations) * 1.2 * static_cast<double>(min_time)
+                        / static_cast<double>(std::max<std::int64_t>(t, 1));
+        iterations = std::clamp(static_cast<std::uint64_t>(estimate), iterations * 2, iterations * 100);
+    }
+
+    std::vector<double> times(opts_.samples);
+    for (double& t : times)
+        t = static_cast<double>(measure(body, iterations)) / static_cast<double>(iterations);
+
+    results_.push_back(summarize(std::string(name), iterations, times));
+}
+
+int runner::finish(std::FILE* out) {
+    std::fprintf(out, "%-40s %14s %12s %10s %12s %12s %9s\n",
+                 "benchmark", "iterations", "median ns", "mad ns", "p5 ns", "p95 ns", "outliers");
+    for (result const& r : results_) {
+        std::fprintf(out, "%-40s %14llu %12.2f %10.2f %12.2f %12.2f %5zu/%-3zu\n",
+                     r.name.c_str(), static_cast<unsigned long long>(r.iterations),
+                     r.median, r.mad, r.p5, r.p95, r.outliers, r.samples);
+    }
+
+    if (!opts_.json_path.empty() && !write_json(opts_.json_path, results_)) {
+        std::fprintf(stderr, "error: could not write %s\n", opts_.json_path.c_str());
+        failed_ = true;
+    }
+    return failed_ ? 1 : 0;
+}
+
+bool write_json(std::FILE* out, std::span<result const> results) {
+    std::fputs("{\"unit\":\"ns\",\"benchmarks\":[", out);
+    bool first = true;
+    for (result const& r : results) {
+        std::fputs(first ? "\n" : ",\n", out);
+        first = false;
+        std::fputs("{\"name\":", out);
+        internal::write_json_string(out, r.name);
+        std::fprintf(out, ",\"iterations\":%llu,\"samples\":%zu,\"median\":%.3f,\"mad\":%.3f,"
+                     "\"mean\":%.3f,\"min\":%.3f,\"max\":%.3f,\"p5\":%.3f,\"p25\":%.3f,"
+                     "\"p75\":%.3f,\"p95\":%.3f,\"p99\":%.3f,\"outliers\":%zu}",
+                     static_cast<unsigned long long>(r.iterations), r.samples, r.median, r.mad,
+                     r.mean, r.min, r.max, r.p5, r.p25, r.p75, r.p95, r.p99, r.outliers);
+    }
+    std::fputs("\n]}\n", out);
+    return std::ferror(out) == 0;
+}
+
+bool write_json(cstring_ref path, std::span<result const> results) {
+    std::FILE* out = std::fopen(path.get(), "w");
+    if (out == nullptr)
+        return false;
+    bool ok = write_json(out, results);
+    return std::fclose(out) == 0 && ok;
+}
+
+}}
@@ -0,0 +1,226 @@
+#include "tsl/profiling/perf_counters.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define TSL_INTERNAL_PERF_EVENTS 1
+#else
+#define TSL_INTERNAL_PERF_EVENTS 0
+#endif
+
+#if TSL_INTERNAL_PERF_EVENTS && (defined(__x86_64__) || defined(__i386__))
+#define TSL_INTERNAL_PERF_RDPMC 1
+#else
+#define TSL_INTERNAL_PERF_RDPMC 0
+#endif
+
+namespace tsl {
+
+namespace internal_perf {
+
+namespace {
+
+constexpr perf_event default_events[] = {
+    perf_event::cycles(),
+    perf_event::instructions(),
+    perf_event::cache_misses(),
+    perf_event::branch_misses(),
+};
+
+#if TSL_INTERNAL_PERF_EVENTS
+long page_size() noexcept {
+    static long size = ::sysconf(_SC_PAGESIZE);
+    return size;
+}
+
+int open_event(perf_event e, int group_fd) noexcept {
+    perf_event_attr attr {};
+    attr.size = sizeof(attr);
+    attr.type = e.type;
+    attr.config = e.config;
+    attr.read_format = PERF_FORMAT_GROUP
+                     | PERF_FORMAT_TOTAL_TIME_ENABLED
+                     | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // The leader starts disabled, the whole group is enabled at once.
+    attr.disabled = group_fd == -1;
+    // Kernel and hypervisor events need privileges that user code rarely has.
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, group_fd,
+                                      PERF_FLAG_FD_CLOEXEC));
+}
+#endif
+
+#if TSL_INTERNAL_PERF_RDPMC
+std::uint64_t rdpmc(std::uint32_t counter) noexcept {
+    std::uint32_t lo, hi;
+    asm volatile("rdpmc" : "=a"(lo), "=d"(hi) : "c"(counter));
+    return (static_cast<std::uint64_t>(hi) << 32) | lo;
+}
+#endif
+
+}
+
+}
+
+perf_counters::perf_counters() noexcept
+    : perf_counters(std::span<perf_event const>(internal_perf::default_events)) { }
+
+perf_counters::perf_counters(std::span<perf_event const> events) noexcept {
+    fds_.fill(-1);
+#if TSL_INTERNAL_PERF_EVENTS
+    if (events.empty() || events.size() > perf_max_events)
+        return;
+
+    for (std::size_t i = 0; i < events.size(); ++i) {
+        int fd = internal_perf::open_event(events[i], i == 0 ? -1 : fds_[0]);
+        if (fd == -1) {
+            // The group is all or nothing, so scopes always report the same events.
+            close();
+            return;
+        }
+        events_[i] = events[i];
+        fds_[i] = fd;
+        count_ = i + 1;
+    }
+
+    for (std::size_t i = 0; i < count_; ++i) {
+        void* page = ::mmap(nullptr, static_cast<std::size_t>(internal_perf::page_size()),
+                            PROT_READ, MAP_SHARED, fds_[i], 0);
+        pages_[i] = page == MAP_FAILED ? nullptr : page;
+    }
+
+    if (::ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP) == -1)
+        close();
+#else
+    static_cast<void>(events);
+#endif
+}
+
+perf_counters::perf_counters(perf_counters&& rhs) noexcept
+    : events_(rhs.events_), fds_(rhs.fds_), pages_(rhs.pages_), count_(rhs.count_)
+{
+    rhs.fds_.fill(-1);
+    rhs.pages_.fill(nullptr);
+    rhs.count_ = 0;
+}
+
+perf_counters& perf_counters::operator=(perf_counters&& rhs) noexcept {
+    if (this != &rhs) {
+        close();
+        events_ = rhs.events_;
+        fds_ = rhs.fds_;
+        pages_ = rhs.pages_;
+        count_ = std::exchange(rhs.count_, 0);
+        rhs.fds_.fill(-1);
+        rhs.pages_.fill(nullptr);
+    }
+    return *this;
+}
+
+perf_counters::~perf_counters() {
+    close();
+}
+
+void perf_counters::close() noexcept {
+#if TSL_INTERNAL_PERF_EVENTS
+    for (std::size_t i = 0; i < perf_max_events; ++i) {
+        if (pages_[i] != nullptr)
+            ::munmap(pages_[i], static_cast<std::size_t>(internal_perf::page_size()));
+        // Members first, the leader last.
+        std::size_t j = perf_max_events - 1 - i;
+        if (fds_[j] != -1)
+            ::close(fds_[j]);
+    }
+#endif
+    fds_.fill(-1);
+    pages_.fill(nullptr);
+    count_ = 0;
+}
+
+bool perf_counters::uses_rdpmc() const noexcept {
+#if TSL_INTERNAL_PERF_RDPMC
+    if (count_ == 0)
+        return false;
+    for (std::size_t i = 0; i < count_; ++i) {
+        auto const* pc = static_cast<perf_event_mmap_page const*>(pages_[i]);
+        if (pc == nullptr || !pc->cap_user_rdpmc)
+            return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+maybe<perf_sample> perf_counters::read() const noexcept {
+    if (count_ == 0)
+        return {};
+    if (auto s = read_rdpmc(); s.has_value())
+        return s;
+    return read_syscall();
+}
+
+maybe<perf_sample> perf_counters::read_rdpmc() const noexcept {
+#if TSL_INTERNAL_PERF_RDPMC
+    perf_sample s;
+    s.events = events_;
+    s.count = count_;
+    for (std::size_t i = 0; i < count_; ++i) {
+        auto const* pc = static_cast<perf_event_mmap_page const volatile*>(pages_[i]);
+        if (pc == nullptr)
+            return {};
+
+        // The kernel bumps `lock` around every update of the page.
+        std::uint32_t seq;
+        std::uint64_t value;
+        do {
+            seq = pc->lock;
+            std::atomic_signal_fence(std::memory_order_acquire);
+            std::uint32_t index = pc->index;
+            // Zero when the event isn't on a counter right now.
+            if (!pc->cap_user_rdpmc || index == 0)
+                return {};
+            std::uint64_t pmc = internal_perf::rdpmc(index - 1);
+            unsigned shift = 64 - pc->pmc_width;
+            // The counter is pmc_width bits wide, sign-extended.
+            pmc = static_cast<std::uint64_t>(static_cast<std::int64_t>(pmc << shift) >> shift);
+            value = static_cast<std::uint64_t>(pc->offset) + pmc;
+            s.multiplexed |= pc->time_enabled != pc->time_running;
+            std::atomic_signal_fence(std::memory_order_acquire);
+        } while (pc->lock != seq);
+        s.values[i] = value;
+    }
+    return s;
+#else
+    return {};
+#endif
+}
+
+maybe<perf_sample> perf_counters::read_syscall() const noexcept {
+#if TSL_INTERNAL_PERF_EVENTS
+    // PERF_FORMAT_GROUP layout: nr, time_enabled, time_running, then the values.
+    std::uint64_t buffer[3 + perf_max_events];
+    ssize_t n = ::read(fds_[0], buffer, sizeof(buffer));
+    if (n < static_cast<ssize_t>(sizeof(std::uint64_t) * 3) || buffer[0] != count_)
+        return {};
+
+    perf_sample s;
+    s.events = events_;
+    s.count = count_;
+    s.multiplexed = buffer[1] != buffer[2];
+    std::copy_n(buffer + 3, count_, s.values.begin());
+    return s;
+#else
+    return {};
+#endif
+}
+
+}
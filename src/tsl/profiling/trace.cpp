@@ -0,0 +1,301 @@
+#include "tsl/profiling/trace.hpp"
+
+#include <cmath>
+#include <condition_variable>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <unistd.h>
+#include "tsl/concurrency/spsc_queue.hpp"
+#include "tsl/internal/json.hpp"
+
+namespace tsl {
+
+namespace internal_trace {
+
+std::atomic<bool> enabled {false};
+
+namespace {
+
+struct thread_buffer {
+    thread_buffer(std::size_t capacity, std::uint32_t id)
+        : events(capacity), tid(id) { }
+
+    spsc_queue<event> events;
+    std::uint32_t tid;
+
+    // Set when the thread exits, the buffer is freed once drained.
+    std::atomic<bool> retired {false};
+};
+
+struct collected_event {
+    event e;
+    std::uint32_t tid;
+};
+
+struct state {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<thread_buffer>> buffers;
+    std::vector<collected_event> collected;
+    std::vector<std::pair<std::uint32_t, std::string>> thread_names;
+    std::uint32_t next_tid = 1;
+    std::size_t buffer_events = trace::options().buffer_events;
+    std::atomic<std::uint64_t> dropped {0};
+
+    // Clock readings at the first start, to convert ticks to time.
+    std::uint64_t start_ticks = 0;
+    std::chrono::steady_clock::time_point start_time;
+
+    std::thread drainer;
+    std::condition_variable drainer_cv;
+    bool drainer_stop = false;
+};
+
+// Never destroyed, threads may still record while static objects are destroyed.
+state& global() {
+    static state* s = new state;
+    return *s;
+}
+
+// The calling thread's buffer. Trivially destructible, like `exited`, so both stay
+// readable while other thread_local destructors record events, after `handle` is
+// destroyed. Those events are dropped rather than registering a buffer nobody would
+// retire.
+constinit thread_local thread_buffer* current = nullptr;
+constinit thread_local bool exited = false;
+
+// Retires the buffer when the thread exits.
+struct thread_handle {
+    ~thread_handle() {
+        exited = true;
+        if (current != nullptr) {
+            current->retired.store(true, std::memory_order_release);
+            current = nullptr;
+        }
+    }
+};
+
+thread_local thread_handle handle;
+
+// Null if the buffer can't be allocated.
+thread_buffer* register_thread() noexcept {
+    state& s = global();
+#if TSL_HAS_EXCEPTIONS
+    try {
+#endif
+        std::lock_guard lock(s.mutex);
+        s.buffers.push_back(std::make_unique<thread_buffer>(s.buffer_events, s.next_tid++));
+#if TSL_HAS_EXCEPTIONS
+    } catch (...) {
+        return nullptr;
+    }
+#endif
+    current = s.buffers.back().get();
+    // Constructs the handle, so that its destructor runs at thread exit.
+    static_cast<void>(&handle);
+    return current;
+}
+
+// Called with the lock held, the lock makes the drainer the only consumer.
+void drain_locked(state& s) {
+    std::vector<event> scratch;
+    for (auto it = s.buffers.begin(); it != s.buffers.end(); ) {
+        thread_buffer& b = **it;
+        bool retired = b.retired.load(std::memory_order_acquire);
+
+        scratch.clear();
+        while (b.events.try_pop_batch(std::back_inserter(scratch), SIZE_MAX) != 0) { }
+        for (event const& e : scratch)
+            s.collected.push_back(collected_event{e, b.tid});
+
+        // Nothing is pushed after the thread retired.
+        if (retired)
+            it = s.buffers.erase(it);
+        else
+            ++it;
+    }
+}
+
+// JSON has no representation for infinities and NaN.
+double finite_or_zero(double d) {
+    return std::isfinite(d) ? d : 0.0;
+}
+
+}
+
+void record(event const& e) noexcept {
+    thread_buffer* b = current;
+    if (TSL_EXPECT_FALSE(b == nullptr)) {
+        if (exited) {
+            global().dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        b = register_thread();
+        if (b == nullptr) {
+            global().dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    if (!b->events.try_push(e))
+        global().dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+}
+
+namespace trace {
+
+using internal_trace::global;
+
+void start(options const& opts) {
+    auto& s = global();
+    {
+        std::lock_guard lock(s.mutex);
+        s.buffer_events = opts.buffer_events;
+        if (s.start_ticks == 0) {
+            s.start_ticks = internal_trace::now();
+            s.start_time = std::chrono::steady_clock::now();
+        }
+        if (opts.drain_period.count() > 0 && !s.drainer.joinable()) {
+            s.drainer_stop = false;
+            s.drainer = std::thread([&s, period = opts.drain_period] {
+                std::unique_lock lock(s.mutex);
+                while (!s.drainer_stop) {
+                    s.drainer_cv.wait_for(lock, period);
+                    internal_trace::drain_locked(s);
+                }
+            });
+        }
+    }
+    internal_trace::enabled.store(true, std::memory_order_relaxed);
+}
+
+void stop() {
+    auto& s = global();
+    internal_trace::enabled.store(false, std::memory_order_relaxed);
+    std::thread drainer;
+    {
+        std::lock_guard lock(s.mutex);
+        s.drainer_stop = true;
+        drainer = std::move(s.drainer);
+    }
+    s.drainer_cv.notify_all();
+    if (drainer.joinable())
+        drainer.join();
+    drain();
+}
+
+bool enabled() noexcept {
+    return internal_trace::enabled.load(std::memory_order_relaxed);
+}
+
+void drain() {
+    auto& s = global();
+    std::lock_guard lock(s.mutex);
+    internal_trace::drain_locked(s);
+}
+
+void clear() {
+    auto& s = global();
+    std::lock_guard lock(s.mutex);
+    s.collected.clear();
+}
+
+void set_thread_name(cstring_ref name) {
+    auto* b = internal_trace::current;
+    if (b == nullptr) {
+        if (internal_trace::exited)
+            return;
+        b = internal_trace::register_thread();
+        if (b == nullptr)
+            TSL_THROW(std::bad_alloc());
+    }
+
+    auto& s = global();
+    std::lock_guard lock(s.mutex);
+    for (auto& [tid, n] : s.thread_names) {
+        if (tid == b->tid) {
+            n = name.get();
+            return;
+        }
+    }
+    s.thread_names.emplace_back(b->tid, name.get());
+}
+
+std::uint64_t dropped() noexcept {
+    return global().dropped.load(std::memory_order_relaxed);
+}
+
+bool write_chrome_json(std::FILE* out) {
+    auto& s = global();
+    std::lock_guard lock(s.mutex);
+    internal_trace::drain_locked(s);
+
+    // Ticks per microsecond, measured over the whole session.
+    double ticks_per_us = 1000.0;
+#if TSL_INTERNAL_TRACE_TSC
+    std::uint64_t ticks = internal_trace::now() - s.start_ticks;
+    auto elapsed = std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - s.start_time).count();
+    if (elapsed > 0 && ticks > 0)
+        ticks_per_us = static_cast<double>(ticks) / elapsed;
+#endif
+    auto to_us = [&](std::uint64_t t) {
+        return static_cast<double>(static_cast<std::int64_t>(t - s.start_ticks)) / ticks_per_us;
+    };
+
+    long pid = static_cast<long>(::getpid());
+    std::fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", out);
+    bool first = true;
+    auto separator = [&] {
+        std::fputs(first ? "\n" : ",\n", out);
+        first = false;
+    };
+
+    for (auto const& [tid, name] : s.thread_names) {
+        separator();
+        std::fprintf(out, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%ld,\"tid\":%u,\"args\":{\"name\":",
+                     pid, tid);
+        internal::write_json_string(out, name);
+        std::fputs("}}", out);
+    }
+
+    for (auto const& [e, tid] : s.collected) {
+        separator();
+        std::fputs("{\"name\":", out);
+        internal::write_json_string(out, e.name);
+        switch (e.kind) {
+        case internal_trace::event_kind::complete:
+            std::fprintf(out, ",\"ph\":\"X\",\"pid\":%ld,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                         pid, tid, to_us(e.start), static_cast<double>(e.payload) / ticks_per_us);
+            break;
+        case internal_trace::event_kind::counter:
+            std::fprintf(out, ",\"ph\":\"C\",\"pid\":%ld,\"tid\":%u,\"ts\":%.3f,\"args\":{\"value\":%lld}}",
+                         pid, tid, to_us(e.start),
+                         static_cast<long long>(static_cast<std::int64_t>(e.payload)));
+            break;
+        case internal_trace::event_kind::counter_double:
+            std::fprintf(out, ",\"ph\":\"C\",\"pid\":%ld,\"tid\":%u,\"ts\":%.3f,\"args\":{\"value\":%.17g}}",
+                         pid, tid, to_us(e.start), internal_trace::finite_or_zero(std::bit_cast<double>(e.payload)));
+            break;
+        }
+    }
+
+    std::fputs("\n]}\n", out);
+    return std::ferror(out) == 0;
+}
+
+bool write_chrome_json(cstring_ref path) {
+    std::FILE* out = std::fopen(path.get(), "w");
+    if (out == nullptr)
+        return false;
+    bool ok = write_chrome_json(out);
+    return std::fclose(out) == 0 && ok;
+}
+
+}}
@@ -0,0 +1,114 @@
+#include "tsl/util/cpu_features.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#define TSL_INTERNAL_CPU_X86 1
+#else
+#define TSL_INTERNAL_CPU_X86 0
+#endif
+
+#if defined(__aarch64__) && defined(__linux__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+namespace tsl {
+
+namespace internal_cpu {
+
+namespace {
+
+#if TSL_INTERNAL_CPU_X86
+struct cpuid_regs {
+    unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+};
+
+cpuid_regs cpuid(unsigned leaf, unsigned subleaf = 0) noexcept {
+    cpuid_regs r;
+    if (!__get_cpuid_count(leaf, subleaf, &r.eax, &r.ebx, &r.ecx, &r.edx))
+        return {};
+    return r;
+}
+
+// Register state the OS saves on context switches, XCR0.
+std::uint64_t xgetbv() noexcept {
+    std::uint32_t lo, hi;
+    asm volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return (std::uint64_t(hi) << 32) | lo;
+}
+
+bool bit(unsigned reg, unsigned n) noexcept {
+    return (reg >> n) & 1;
+}
+
+cpu_feature detect() noexcept {
+    std::uint64_t f = 0;
+    auto set = [&](cpu_feature feature, bool supported) {
+        if (supported)
+            f |= static_cast<std::uint64_t>(feature);
+    };
+
+    cpuid_regs l1 = cpuid(1);
+    cpuid_regs l7 = cpuid(7);
+    cpuid_regs l81 = cpuid(0x80000001);
+
+    set(cpu_feature::sse2, bit(l1.edx, 26));
+    set(cpu_feature::sse3, bit(l1.ecx, 0));
+    set(cpu_feature::pclmul, bit(l1.ecx, 1));
+    set(cpu_feature::ssse3, bit(l1.ecx, 9));
+    set(cpu_feature::sse4_1, bit(l1.ecx, 19));
+    set(cpu_feature::sse4_2, bit(l1.ecx, 20));
+    set(cpu_feature::popcnt, bit(l1.ecx, 23));
+    set(cpu_feature::aes, bit(l1.ecx, 25));
+    set(cpu_feature::bmi1, bit(l7.ebx, 3));
+    set(cpu_feature::bmi2, bit(l7.ebx, 8));
+    set(cpu_feature::sha, bit(l7.ebx, 29));
+    set(cpu_feature::lzcnt, bit(l81.ecx, 5));
+
+    // AVX registers are only usable if the OS enabled XSAVE and saves them.
+    std::uint64_t xcr0 = bit(l1.ecx, 27) ? xgetbv() : 0;
+    bool ymm = (xcr0 & 0x6) == 0x6;
+    bool zmm = ymm && (xcr0 & 0xE0) == 0xE0;
+
+    set(cpu_feature::avx, ymm && bit(l1.ecx, 28));
+    set(cpu_feature::fma, ymm && bit(l1.ecx, 12));
+    set(cpu_feature::avx2, ymm && bit(l7.ebx, 5));
+    set(cpu_feature::avx512f, zmm && bit(l7.ebx, 16));
+    set(cpu_feature::avx512dq, zmm && bit(l7.ebx, 17));
+    set(cpu_feature::avx512cd, zmm && bit(l7.ebx, 28));
+    set(cpu_feature::avx512bw, zmm && bit(l7.ebx, 30));
+    set(cpu_feature::avx512vl, zmm && bit(l7.ebx, 31));
+    set(cpu_feature::avx512vbmi, zmm && bit(l7.ecx, 1));
+    set(cpu_feature::avx512vbmi2, zmm && bit(l7.ecx, 6));
+    set(cpu_feature::avx512vpopcntdq, zmm && bit(l7.ecx, 14));
+
+    return static_cast<cpu_feature>(f);
+}
+#elif defined(__aarch64__)
+cpu_feature detect() noexcept {
+    // Advanced SIMD is mandatory on AArch64.
+    cpu_feature f = cpu_feature::neon;
+#if defined(__linux__) && defined(HWCAP_CRC32)
+    if (::getauxval(AT_HWCAP) & HWCAP_CRC32)
+        f = f | cpu_feature::crc32;
+#elif defined(__ARM_FEATURE_CRC32)
+    f = f | cpu_feature::crc32;
+#endif
+    return f;
+}
+#else
+cpu_feature detect() noexcept {
+    return cpu_feature::none;
+}
+#endif
+
+}
+
+}
+
+cpu_features const& cpu_features::current() noexcept {
+    static cpu_features const features(internal_cpu::detect());
+    return features;
+}
+
+}
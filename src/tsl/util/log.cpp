@@ -0,0 +1,566 @@
+#include "tsl/util/log.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <condition_variable>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "tsl/internal/cache_line.hpp"
+
+namespace tsl {
+
+namespace internal_log {
+
+std::atomic<std::uint8_t> min_level {static_cast<std::uint8_t>(log::level::off)};
+
+namespace {
+
+// A single-producer single-consumer ring of variable-sized records. A record is
+// contiguous: when it doesn't fit before the end, the rest is skipped.
+struct thread_buffer {
+    thread_buffer(std::size_t capacity, std::uint32_t id)
+        : data(new std::byte[capacity]), capacity(capacity), tid(id) { }
+
+    std::unique_ptr<std::byte[]> data;
+    std::size_t capacity;
+    std::uint32_t tid;
+
+    alignas(internal::cache_line_size) std::atomic<std::uint64_t> head {0};
+    std::uint64_t cached_tail = 0;
+    // Bytes of the record being written, including the skipped end.
+    std::uint64_t pending = 0;
+
+    alignas(internal::cache_line_size) std::atomic<std::uint64_t> tail {0};
+
+    // Set when the thread exits, the buffer is freed once drained.
+    std::atomic<bool> retired {false};
+    // Retired and drained, only used by the drainer.
+    bool drained = false;
+};
+
+// A format as stored in a binary log.
+struct decoded_format {
+    std::string format;
+    std::vector<arg_type> types;
+    log::level level;
+};
+
+// The date and time of the last second formatted, most messages share it.
+struct time_cache {
+    std::uint64_t seconds = UINT64_MAX;
+    char text[32] = {};
+    std::size_t size = 0;
+};
+
+struct state {
+    // Held while draining, and while starting or stopping.
+    std::mutex mutex;
+
+    // Guards the list of buffers only, so that registering a thread doesn't wait
+    // for the drainer to format and write.
+    std::mutex registry_mutex;
+    std::vector<std::unique_ptr<thread_buffer>> buffers;
+    std::uint32_t next_tid = 1;
+
+    // The buffers being drained, copied from `buffers`.
+    std::vector<thread_buffer*> draining;
+
+    std::atomic<std::size_t> buffer_bytes {log::options().buffer_bytes};
+    std::atomic<log::overflow> on_full {log::overflow::drop};
+    std::atomic<std::uint64_t> dropped {0};
+
+    std::FILE* text = nullptr;
+    std::FILE* binary = nullptr;
+    // Formats already written to the binary file, and their ids.
+    std::unordered_map<format_info const*, std::uint32_t> format_ids;
+    std::string line;
+    time_cache times;
+
+    std::thread drainer;
+    std::condition_variable drainer_cv;
+    bool drainer_stop = false;
+    // Set by call sites waiting for space, checked before the drainer sleeps.
+    std::atomic<bool> wake {false};
+};
+
+// Never destroyed, threads may still log while static objects are destroyed.
+state& global() {
+    static state* s = new state;
+    return *s;
+}
+
+// The calling thread's buffer. Trivially destructible, like `exited`, so both stay
+// readable while other thread_local destructors log, after `handle` is destroyed.
+// Those events are dropped rather than registering a buffer nobody would retire.
+constinit thread_local thread_buffer* current = nullptr;
+constinit thread_local bool exited = false;
+
+// Retires the buffer when the thread exits.
+struct thread_handle {
+    ~thread_handle() {
+        exited = true;
+        if (current != nullptr) {
+            current->retired.store(true, std::memory_order_release);
+            current = nullptr;
+        }
+    }
+};
+
+thread_local thread_handle handle;
+
+// Null if the buffer can't be allocated.
+thread_buffer* register_thread() noexcept {
+    state& s = global();
+    std::size_t capacity = std::bit_ceil(std::max(s.buffer_bytes.load(std::memory_order_relaxed), std::size_t(4096)));
+#if TSL_HAS_EXCEPTIONS
+    try {
+#endif
+        std::lock_guard lock(s.registry_mutex);
+        s.buffers.push_back(std::make_unique<thread_buffer>(capacity, s.next_tid++));
+#if TSL_HAS_EXCEPTIONS
+    } catch (...) {
+        return nullptr;
+    }
+#endif
+    current = s.buffers.back().get();
+    // Constructs the handle, so that its destructor runs at thread exit.
+    static_cast<void>(&handle);
+    return current;
+}
+
+// Binary log layout, in native byte order: the magic, then records starting with
+// a kind byte. A format record precedes the first message using it.
+constexpr char magic[8] = {'T', 'S', 'L', 'L', 'O', 'G', '\0', '\1'};
+constexpr std::uint8_t format_record = 'F';
+constexpr std::uint8_t message_record = 'M';
+
+char level_letter(log::level l) {
+    switch (l) {
+    case log::level::debug: return 'D';
+    case log::level::info: return 'I';
+    case log::level::warning: return 'W';
+    case log::level::error: return 'E';
+    default: return '?';
+    }
+}
+
+template<typename T>
+bool take(std::byte const*& p, std::byte const* end, T& v) {
+    if (static_cast<std::size_t>(end - p) < sizeof(T))
+        return false;
+    std::memcpy(&v, p, sizeof(T));
+    p += sizeof(T);
+    return true;
+}
+
+bool format_value(std::string& out, arg_type type, std::byte const*& p, std::byte const* end) {
+    auto flags = static_cast<std::uint8_t>(type);
+    if (flags & static_cast<std::uint8_t>(arg_type::maybe_flag)) {
+        std::uint8_t engaged;
+        if (!take(p, end, engaged))
+            return false;
+        if (!engaged) {
+            out += "none";
+            return true;
+        }
+        return format_value(out, static_cast<arg_type>(flags & 0x3F), p, end);
+    }
+
+    char buf[64];
+    std::ptrdiff_t n = 0;
+    switch (static_cast<arg_type>(flags & 0x3F)) {
+    case arg_type::boolean: {
+        std::uint8_t v;
+        if (!take(p, end, v))
+            return false;
+        out += v ? "true" : "false";
+        return true;
+    }
+    case arg_type::character: {
+        char v;
+        if (!take(p, end, v))
+            return false;
+        out += v;
+        return true;
+    }
+    case arg_type::int64: {
+        std::int64_t v;
+        if (!take(p, end, v))
+            return false;
+        if ((flags & static_cast<std::uint8_t>(arg_type::niche_flag)) && v < 0) {
+            out += "none";
+            return true;
+        }
+        n = std::to_chars(buf, buf + sizeof(buf), v).ptr - buf;
+        break;
+    }
+    case arg_type::uint64: {
+        std::uint64_t v;
+        if (!take(p, end, v))
+            return false;
+        n = std::to_chars(buf, buf + sizeof(buf), v).ptr - buf;
+        break;
+    }
+    case arg_type::float64: {
+        double v;
+        if (!take(p, end, v))
+            return false;
+        n = std::to_chars(buf, buf + sizeof(buf), v).ptr - buf;
+        break;
+    }
+    case arg_type::string: {
+        std::uint32_t len;
+        if (!take(p, end, len) || static_cast<std::size_t>(end - p) < len)
+            return false;
+        out.append(reinterpret_cast<char const*>(p), len);
+        p += len;
+        return true;
+    }
+    default:
+        return false;
+    }
+    out.append(buf, static_cast<std::size_t>(n));
+    return true;
+}
+
+// Appends a line for a message to `out`. Returns false if the arguments are malformed.
+bool format_line(std::string& out, time_cache& cache, std::string_view format,
+                 arg_type const* types, std::size_t arg_count, log::level l,
+                 std::uint64_t time, std::uint32_t tid, std::byte const* args, std::byte const* end) {
+    std::uint64_t seconds = time / 1000000000;
+    if (seconds != cache.seconds) {
+        auto t = static_cast<std::time_t>(seconds);
+        std::tm tm;
+        ::gmtime_r(&t, &tm);
+        cache.seconds = seconds;
+        cache.size = std::strftime(cache.text, sizeof(cache.text), "%Y-%m-%d %H:%M:%S", &tm);
+    }
+    // Nanoseconds, zero-padded to nine digits, without printf which is slow here.
+    char prefix[32];
+    prefix[0] = '.';
+    auto ns = static_cast<std::uint32_t>(time % 1000000000);
+    for (int i = 9; i >= 1; --i, ns /= 10)
+        prefix[i] = static_cast<char>('0' + ns % 10);
+    prefix[10] = ' ';
+    prefix[11] = level_letter(l);
+    prefix[12] = ' ';
+    prefix[13] = '[';
+    char* p = std::to_chars(prefix + 14, prefix + sizeof(prefix) - 2, tid).ptr;
+    *p++ = ']';
+    *p++ = ' ';
+    out.append(cache.text, cache.size);
+    out.append(prefix, static_cast<std::size_t>(p - prefix));
+
+    std::size_t arg = 0;
+    for (std::size_t i = 0; i < format.size(); ++i) {
+        char c = format[i];
+        char next = i + 1 < format.size() ? format[i + 1] : '\0';
+        if (c == '{' && next == '}') {
+            if (arg == arg_count || !format_value(out, types[arg++], args, end))
+                return false;
+            ++i;
+        } else if ((c == '{' || c == '}') && next == c) {
+            out += c;
+            ++i;
+        } else {
+            out += c;
+        }
+    }
+    out += '\n';
+    return arg == arg_count;
+}
+
+template<typename T>
+void write_raw(std::FILE* out, T const& v) {
+    std::fwrite(&v, sizeof(T), 1, out);
+}
+
+void write_binary(state& s, record_header const& h, std::uint32_t tid, std::byte const* args, std::size_t size) {
+    auto [it, inserted] = s.format_ids.try_emplace(h.format, static_cast<std::uint32_t>(s.format_ids.size()));
+    format_info const& f = *h.format;
+    if (inserted) {
+        auto len = static_cast<std::uint32_t>(std::strlen(f.format));
+        write_raw(s.binary, format_record);
+        write_raw(s.binary, it->second);
+        write_raw(s.binary, static_cast<std::uint8_t>(f.level));
+        write_raw(s.binary, f.arg_count);
+        std::fwrite(f.types, 1, f.arg_count, s.binary);
+        write_raw(s.binary, len);
+        std::fwrite(f.format, 1, len, s.binary);
+    }
+    write_raw(s.binary, message_record);
+    write_raw(s.binary, it->second);
+    write_raw(s.binary, tid);
+    write_raw(s.binary, h.time);
+    write_raw(s.binary, static_cast<std::uint32_t>(size));
+    std::fwrite(args, 1, size, s.binary);
+}
+
+// Called with `mutex` held, which makes the drainer the only consumer. Buffers are
+// only freed here, so the copied pointers stay valid while `registry_mutex` is free.
+void drain_locked(state& s) {
+    {
+        std::lock_guard lock(s.registry_mutex);
+        s.draining.clear();
+        for (auto const& b : s.buffers)
+            s.draining.push_back(b.get());
+    }
+
+    bool any_drained = false;
+    for (thread_buffer* buffer : s.draining) {
+        thread_buffer& b = *buffer;
+        bool retired = b.retired.load(std::memory_order_acquire);
+
+        std::uint64_t tail = b.tail.load(std::memory_order_relaxed);
+        std::uint64_t head = b.head.load(std::memory_order_acquire);
+        while (tail != head) {
+            std::size_t pos = tail & (b.capacity - 1);
+            std::byte const* p = b.data.get() + pos;
+            format_info const* format;
+            std::memcpy(&format, p, sizeof(format));
+            if (format == nullptr) {
+                tail += b.capacity - pos;
+                continue;
+            }
+
+            record_header h;
+            std::memcpy(&h, p, sizeof(h));
+            std::byte const* args = p + sizeof(h);
+            std::byte const* end = p + h.size;
+            if (s.text != nullptr) {
+                s.line.clear();
+                format_line(s.line, s.times, h.format->format, h.format->types, h.format->arg_count,
+                            h.format->level, h.time, b.tid, args, end);
+                std::fwrite(s.line.data(), 1, s.line.size(), s.text);
+            }
+            if (s.binary != nullptr)
+                write_binary(s, h, b.tid, args, static_cast<std::size_t>(end - args));
+
+            tail += h.size;
+            // Released record by record, for the call sites blocked on a full buffer.
+            b.tail.store(tail, std::memory_order_release);
+        }
+
+        // Nothing is pushed after the thread retired.
+        b.drained = retired;
+        any_drained |= retired;
+    }
+
+    if (any_drained) {
+        std::lock_guard lock(s.registry_mutex);
+        std::erase_if(s.buffers, [](auto const& b) { return b->drained; });
+    }
+}
+
+void flush_outputs(state& s) {
+    if (s.text != nullptr)
+        std::fflush(s.text);
+    if (s.binary != nullptr)
+        std::fflush(s.binary);
+}
+
+}
+
+std::byte* begin_record(std::size_t size) noexcept {
+    thread_buffer* b = current;
+    if (TSL_EXPECT_FALSE(b == nullptr)) {
+        if (exited) {
+            global().dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        b = register_thread();
+        if (b == nullptr) {
+            global().dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+    }
+
+    state& s = global();
+    if (TSL_EXPECT_FALSE(size > b->capacity / 2)) {
+        s.dropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    std::uint64_t head = b->head.load(std::memory_order_relaxed);
+    std::size_t pos = head & (b->capacity - 1);
+    std::size_t skip = pos + size > b->capacity ? b->capacity - pos : 0;
+    std::uint64_t needed = skip + size;
+
+    while (head + needed - b->cached_tail > b->capacity) {
+        b->cached_tail = b->tail.load(std::memory_order_acquire);
+        if (head + needed - b->cached_tail <= b->capacity)
+            break;
+        if (s.on_full.load(std::memory_order_relaxed) == log::overflow::drop
+            || min_level.load(std::memory_order_relaxed) == static_cast<std::uint8_t>(log::level::off)) {
+            s.dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        s.wake.store(true, std::memory_order_relaxed);
+        s.drainer_cv.notify_one();
+        std::this_thread::yield();
+    }
+
+    if (skip != 0) {
+        format_info const* none = nullptr;
+        std::memcpy(b->data.get() + pos, &none, sizeof(none));
+    }
+    b->pending = needed;
+    return b->data.get() + ((head + skip) & (b->capacity - 1));
+}
+
+void end_record() noexcept {
+    thread_buffer* b = current;
+    b->head.store(b->head.load(std::memory_order_relaxed) + b->pending, std::memory_order_release);
+}
+
+}
+
+namespace log {
+
+using internal_log::global;
+
+bool start(options const& opts) {
+    auto& s = global();
+    std::lock_guard lock(s.mutex);
+    if (s.drainer.joinable())
+        return true;
+
+    if (!opts.binary_path.empty()) {
+        s.binary = std::fopen(opts.binary_path.c_str(), "wb");
+        if (s.binary == nullptr)
+            return false;
+        std::fwrite(internal_log::magic, 1, sizeof(internal_log::magic), s.binary);
+        s.format_ids.clear();
+    }
+    s.text = opts.text;
+    s.buffer_bytes.store(opts.buffer_bytes, std::memory_order_relaxed);
+    s.on_full.store(opts.on_full, std::memory_order_relaxed);
+    s.drainer_stop = false;
+    s.drainer = std::thread([&s, period = opts.drain_period] {
+        std::unique_lock lock(s.mutex);
+        while (!s.drainer_stop) {
+            s.drainer_cv.wait_for(lock, period, [&s] {
+                return s.drainer_stop || s.wake.exchange(false, std::memory_order_relaxed);
+            });
+            internal_log::drain_locked(s);
+        }
+    });
+    internal_log::min_level.store(static_cast<std::uint8_t>(opts.min_level), std::memory_order_relaxed);
+    return true;
+}
+
+void stop() {
+    auto& s = global();
+    internal_log::min_level.store(static_cast<std::uint8_t>(level::off), std::memory_order_relaxed);
+    std::thread drainer;
+    {
+        std::lock_guard lock(s.mutex);
+        s.drainer_stop = true;
+        drainer = std::move(s.drainer);
+    }
+    s.drainer_cv.notify_all();
+    if (drainer.joinable())
+        drainer.join();
+
+    std::lock_guard lock(s.mutex);
+    internal_log::drain_locked(s);
+    internal_log::flush_outputs(s);
+    if (s.binary != nullptr) {
+        std::fclose(s.binary);
+        s.binary = nullptr;
+    }
+    s.text = nullptr;
+}
+
+void flush() {
+    auto& s = global();
+    std::lock_guard lock(s.mutex);
+    internal_log::drain_locked(s);
+    internal_log::flush_outputs(s);
+}
+
+void set_min_level(level l) noexcept {
+    auto& s = global();
+    std::lock_guard lock(s.mutex);
+    // Stays off while stopped.
+    if (s.drainer.joinable())
+        internal_log::min_level.store(static_cast<std::uint8_t>(l), std::memory_order_relaxed);
+}
+
+std::uint64_t dropped() noexcept {
+    return global().dropped.load(std::memory_order_relaxed);
+}
+
+bool decode(std::FILE* binary, std::FILE* text) {
+    using namespace internal_log;
+
+    auto read = [&](void* p, std::size_t n) {
+        return std::fread(p, 1, n, binary) == n;
+    };
+
+    char header[sizeof(magic)];
+    if (!read(header, sizeof(header)) || std::memcmp(header, magic, sizeof(magic)) != 0)
+        return false;
+
+    std::vector<decoded_format> formats;
+    std::vector<std::byte> args;
+    std::string line;
+    time_cache times;
+    std::uint8_t kind;
+    while (read(&kind, 1)) {
+        std::uint32_t id;
+        if (!read(&id, sizeof(id)))
+            return false;
+
+        if (kind == format_record) {
+            std::uint8_t l;
+            std::uint32_t arg_count, len;
+            if (id != formats.size() || !read(&l, 1) || !read(&arg_count, sizeof(arg_count)) || arg_count > 256)
+                return false;
+            decoded_format f;
+            f.level = static_cast<level>(l);
+            f.types.resize(arg_count);
+            if (!read(f.types.data(), arg_count) || !read(&len, sizeof(len)))
+                return false;
+            f.format.resize(len);
+            if (!read(f.format.data(), len))
+                return false;
+            formats.push_back(std::move(f));
+        } else if (kind == message_record) {
+            std::uint32_t tid, size;
+            std::uint64_t time;
+            if (id >= formats.size() || !read(&tid, sizeof(tid)) || !read(&time, sizeof(time))
+                || !read(&size, sizeof(size)))
+                return false;
+            args.resize(size);
+            if (!read(args.data(), size))
+                return false;
+            decoded_format const& f = formats[id];
+            line.clear();
+            if (!format_line(line, times, f.format, f.types.data(), f.types.size(), f.level, time, tid,
+                             args.data(), args.data() + args.size()))
+                return false;
+            std::fwrite(line.data(), 1, line.size(), text);
+        } else {
+            return false;
+        }
+    }
+    return std::feof(binary) != 0 && std::ferror(text) == 0;
+}
+
+bool decode(cstring_ref path, std::FILE* text) {
+    std::FILE* in = std::fopen(path.get(), "rb");
+    if (in == nullptr)
+        return false;
+    bool ok = decode(in, text);
+    std::fclose(in);
+    return ok;
+}
+
+}}
@@ -0,0 +1,79 @@
+// arena: huge requests throw instead of wrapping around, and chunk sizes grow even
+// from a zero first chunk size.
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include "check.hpp"
+#include "tsl/memory/arena.hpp"
+
+namespace {
+
+bool throws_bad_alloc(tsl::arena& a, std::size_t bytes, std::size_t align = alignof(std::max_align_t)) {
+    try {
+        static_cast<void>(a.allocate(bytes, align));
+    } catch (std::bad_alloc const&) {
+        return true;
+    }
+    return false;
+}
+
+void test_huge_requests() {
+    tsl::arena a(4096);
+    void* first = a.allocate(16);
+    CHECK(throws_bad_alloc(a, SIZE_MAX - 8));
+    CHECK(throws_bad_alloc(a, SIZE_MAX));
+    CHECK(throws_bad_alloc(a, SIZE_MAX / 2, 64));
+    // The arena is untouched, the next allocations don't overlap.
+    void* second = a.allocate(16);
+    void* third = a.allocate(16);
+    CHECK(second != first && third != second);
+    CHECK(static_cast<std::byte*>(third) >= static_cast<std::byte*>(second) + 16);
+
+    alignas(16) std::byte buffer[64];
+    tsl::arena b(buffer);
+    CHECK(throws_bad_alloc(b, SIZE_MAX - 8));
+    void* in_buffer = b.allocate(16);
+    CHECK(in_buffer >= static_cast<void*>(buffer) && in_buffer < static_cast<void*>(buffer + 64));
+}
+
+// Allocations not following the previous one, each one starts a chunk.
+int chunks_used(tsl::arena& a, int allocations) {
+    int chunks = 0;
+    std::uintptr_t previous = 0;
+    for (int i = 0; i < allocations; ++i) {
+        void* p = a.allocate(16, 16);
+        std::memset(p, 0, 16);
+        if (reinterpret_cast<std::uintptr_t>(p) != previous + 16)
+            ++chunks;
+        previous = reinterpret_cast<std::uintptr_t>(p);
+    }
+    return chunks;
+}
+
+void test_zero_chunk_size() {
+    tsl::arena a(0);
+    CHECK(chunks_used(a, 1000) < 16);
+    tsl::arena b(std::span<std::byte>(), 1);
+    CHECK(chunks_used(b, 1000) < 16);
+}
+
+void test_rewind() {
+    tsl::arena a(256);
+    auto m = a.mark();
+    void* p = a.allocate(100);
+    static_cast<void>(a.allocate(1000));
+    a.rewind(m);
+    CHECK(a.allocate(100) == p);
+    a.reset();
+    CHECK(a.allocate(100) == p);
+}
+
+}
+
+int main() {
+    test_huge_requests();
+    test_zero_chunk_size();
+    test_rewind();
+    return tsl_test::result();
+}
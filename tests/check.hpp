@@ -0,0 +1,30 @@
+// Checks for tsl's tests. A failed check reports its location and the test carries
+// on, so one run shows every failure; main returns `tsl_test::result()`.
+#ifndef _TSL_TESTS_CHECK_HPP
+#define _TSL_TESTS_CHECK_HPP
+
+#include <cstdio>
+#include <source_location>
+
+namespace tsl_test {
+
+inline int failures = 0;
+
+inline void fail(char const* expr, std::source_location const& location) {
+    std::fprintf(stderr, "%s:%u: check failed: %s\n", location.file_name(),
+                 static_cast<unsigned>(location.line()), expr);
+    ++failures;
+}
+
+inline int result() {
+    if (failures != 0)
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+    return failures != 0 ? 1 : 0;
+}
+
+}
+
+#define CHECK(expr) \
+    ((expr) ? static_cast<void>(0) : ::tsl_test::fail(#expr, std::source_location::current()))
+
+#endif // _TSL_TESTS_CHECK_HPP
@@ -0,0 +1,73 @@
+// cpu_features and dispatcher: feature tests, the choice of kernel for a given CPU,
+// and calls made before the dispatcher is bound.
+#include "check.hpp"
+#include "tsl/util/cpu_features.hpp"
+
+namespace {
+
+int avx512(int x) { return x + 512; }
+int avx2_fma(int x) { return x + 3; }
+int avx2(int x) { return x + 2; }
+int scalar(int x) { return x; }
+
+using dispatch = tsl::dispatcher<int(int),
+                                 tsl::kernel<tsl::cpu_feature::avx512f | tsl::cpu_feature::avx512bw, avx512>,
+                                 tsl::kernel<tsl::cpu_feature::avx2 | tsl::cpu_feature::fma, avx2_fma>,
+                                 tsl::kernel<tsl::cpu_feature::avx2, avx2>,
+                                 tsl::kernel<tsl::cpu_feature::none, scalar>>;
+
+inline constexpr dispatch add;
+
+// Initialized before dispatch's static members with GCC, so it goes through the
+// trampoline; with any order, it must call the kernel resolve() picks.
+int const early = add(10);
+
+static_assert(tsl::cpu_features().has(tsl::cpu_feature::none));
+static_assert(!tsl::cpu_features().has(tsl::cpu_feature::sse2));
+
+void test_has() {
+    tsl::cpu_features cpu(tsl::cpu_feature::avx | tsl::cpu_feature::avx2 | tsl::cpu_feature::neon);
+    CHECK(cpu.has(tsl::cpu_feature::none));
+    CHECK(cpu.has(tsl::cpu_feature::avx2));
+    CHECK(cpu.has(tsl::cpu_feature::neon));
+    CHECK(cpu.has(tsl::cpu_feature::avx | tsl::cpu_feature::avx2));
+    // Every feature is needed, not one of them.
+    CHECK(!cpu.has(tsl::cpu_feature::avx2 | tsl::cpu_feature::fma));
+    CHECK(!cpu.has(tsl::cpu_feature::crc32));
+
+    auto const& current = tsl::cpu_features::current();
+    CHECK(&current == &tsl::cpu_features::current());
+    CHECK(current.has(tsl::cpu_feature::none));
+#if defined(__x86_64__)
+    CHECK(current.has(tsl::cpu_feature::sse2));
+#endif
+#if defined(__AVX2__)
+    CHECK(current.has(tsl::cpu_feature::avx2));
+#endif
+}
+
+void test_resolve() {
+    using f = tsl::cpu_feature;
+    CHECK(dispatch::resolve(tsl::cpu_features()) == &scalar);
+    CHECK(dispatch::resolve(tsl::cpu_features(f::sse2 | f::fma)) == &scalar);
+    CHECK(dispatch::resolve(tsl::cpu_features(f::avx2)) == &avx2);
+    CHECK(dispatch::resolve(tsl::cpu_features(f::avx2 | f::fma)) == &avx2_fma);
+    CHECK(dispatch::resolve(tsl::cpu_features(f::avx2 | f::fma | f::avx512f)) == &avx2_fma);
+    CHECK(dispatch::resolve(tsl::cpu_features(f::avx2 | f::avx512f | f::avx512bw)) == &avx512);
+    CHECK(dispatch::resolve() == dispatch::resolve(tsl::cpu_features::current()));
+}
+
+void test_call() {
+    int expected = dispatch::resolve()(10);
+    CHECK(early == expected);
+    CHECK(add(10) == expected);
+}
+
+}
+
+int main() {
+    test_has();
+    test_resolve();
+    test_call();
+    return tsl_test::result();
+}
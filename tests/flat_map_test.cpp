@@ -0,0 +1,274 @@
+// flat_map and flat_set against std::unordered_map and std::unordered_set, under random
+// operation sequences, in both the control-byte and the niche layouts.
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include "check.hpp"
+#include "tsl/containers/flat_map.hpp"
+#include "tsl/containers/flat_set.hpp"
+#include "tsl/cstring_ref.hpp"
+#include "tsl/types/non_negative.hpp"
+
+namespace {
+
+template<typename Map, typename Ref>
+bool same_contents(Map const& map, Ref const& ref) {
+    if (map.size() != ref.size())
+        return false;
+    std::size_t n = 0;
+    for (auto const& [k, v] : map) {
+        auto it = ref.find(k);
+        if (it == ref.end() || it->second != v)
+            return false;
+        ++n;
+    }
+    return n == ref.size();
+}
+
+// Random inserts, assignments, erasures and lookups over `keys` distinct keys.
+template<typename Map, typename MakeKey>
+void random_ops(MakeKey make_key, std::size_t keys, std::size_t ops, std::uint64_t seed) {
+    using key_type = typename Map::key_type;
+    Map map;
+    std::unordered_map<key_type, int, typename Map::hasher, typename Map::key_equal> ref;
+    std::mt19937_64 rng(seed);
+
+    for (std::size_t i = 0; i < ops; ++i) {
+        key_type k = make_key(rng() % keys);
+        int v = static_cast<int>(rng() % 1000);
+        switch (rng() % 6) {
+        case 0: {
+            bool inserted = map.insert({k, v}).second;
+            CHECK(inserted == ref.insert({k, v}).second);
+            break;
+        }
+        case 1:
+            map[k] = v;
+            ref[k] = v;
+            break;
+        case 2:
+            CHECK(map.erase(k) == ref.erase(k));
+            break;
+        case 3: {
+            auto it = map.find(k);
+            auto rit = ref.find(k);
+            CHECK((it == map.end()) == (rit == ref.end()));
+            if (it != map.end() && rit != ref.end())
+                CHECK(it->second == rit->second);
+            break;
+        }
+        case 4: {
+            auto m = map.get(k);
+            CHECK(m.has_value() == ref.contains(k));
+            break;
+        }
+        default:
+            map.try_emplace(k, v);
+            ref.try_emplace(k, v);
+            break;
+        }
+    }
+    CHECK(same_contents(map, ref));
+
+    // Erasing every element while iterating visits each one once. Erasing only some
+    // may not with niche keys, see test_erase_if.
+    std::size_t visited = 0;
+    for (auto it = map.begin(); it != map.end();) {
+        ++visited;
+        CHECK(ref.erase(it->first) == 1);
+        it = map.erase(it);
+    }
+    CHECK(ref.empty());
+    CHECK(map.empty());
+    CHECK(visited > 0);
+}
+
+// erase_if sees every element once, also with niche keys whose clusters wrap around
+// the end of the table, where an `it = pred ? erase(it) : ++it` loop revisits some.
+template<typename Map, typename MakeKey>
+void test_erase_if(MakeKey make_key) {
+    std::mt19937_64 rng(7);
+    for (int round = 0; round < 200; ++round) {
+        Map map;
+        std::unordered_map<std::int64_t, int> ref;
+        std::size_t n = 1 + rng() % 200;
+        while (ref.size() < n) {
+            auto k = static_cast<std::int64_t>(rng() % 100000);
+            map[make_key(k)] = static_cast<int>(k % 7);
+            ref[k] = static_cast<int>(k % 7);
+        }
+
+        std::unordered_map<std::int64_t, int> seen;
+        auto erased = erase_if(map, [&](auto const& item) {
+            ++seen[static_cast<std::int64_t>(item.first)];
+            return item.second < 3;
+        });
+        auto ref_erased = std::erase_if(ref, [](auto const& item) { return item.second < 3; });
+        CHECK(erased == ref_erased);
+        CHECK(seen.size() == n);
+        for (auto const& [k, count] : seen)
+            CHECK(count == 1);
+        CHECK(map.size() == ref.size());
+        for (auto const& [k, v] : ref)
+            CHECK(map.contains(make_key(k)) && map.at(make_key(k)) == v);
+    }
+}
+
+void test_heterogeneous_lookup() {
+    tsl::flat_map<std::string, int> map;
+    for (int i = 0; i < 100; ++i)
+        map["key" + std::to_string(i)] = i;
+    CHECK(map.find(std::string_view("key42"))->second == 42);
+    CHECK(map.find(tsl::cstring_ref("key7"))->second == 7);
+    CHECK(map.contains("key99"));
+    CHECK(!map.contains(std::string_view("key100")));
+    CHECK(map.erase(std::string_view("key1")) == 1);
+    CHECK(map.size() == 99);
+}
+
+void test_copy_and_move() {
+    tsl::flat_map<int, std::string> a;
+    for (int i = 0; i < 1000; ++i)
+        a[i] = std::to_string(i);
+
+    tsl::flat_map<int, std::string> b(a);
+    CHECK(b.size() == 1000 && b.at(500) == "500");
+    tsl::flat_map<int, std::string> c;
+    c[1] = "x";
+    c = b;
+    CHECK(c.size() == 1000 && c.at(1) == "1");
+    tsl::flat_map<int, std::string> d(std::move(c));
+    CHECK(d.size() == 1000 && c.empty());
+    c = std::move(d);
+    CHECK(c.size() == 1000 && d.empty());
+}
+
+void test_rehash() {
+    tsl::flat_map<int, int> map;
+    map.rehash(0);
+    CHECK(map.capacity() == 0);
+    map.reserve(100);
+    CHECK(map.capacity() >= 100);
+    map.rehash(0);
+    CHECK(map.capacity() == 0);
+    for (int i = 0; i < 100; ++i)
+        map[i] = i;
+    map.rehash(0);
+    CHECK(map.size() == 100 && map.at(99) == 99);
+}
+
+// An allocator that doesn't propagate, with unequal instances.
+template<typename T>
+struct tagged_allocator {
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::false_type;
+    using propagate_on_container_swap = std::false_type;
+    using is_always_equal = std::false_type;
+
+    int tag = 0;
+
+    tagged_allocator() = default;
+    explicit tagged_allocator(int t) : tag(t) { }
+    template<typename U>
+    tagged_allocator(tagged_allocator<U> const& other) : tag(other.tag) { }
+
+    T* allocate(std::size_t n) { return std::allocator<T>().allocate(n); }
+    void deallocate(T* p, std::size_t n) { std::allocator<T>().deallocate(p, n); }
+
+    template<typename U>
+    bool operator==(tagged_allocator<U> const& other) const { return tag == other.tag; }
+};
+
+// Allocators that propagate on copy and move assignment.
+template<typename T>
+struct propagating_allocator : tagged_allocator<T> {
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using tagged_allocator<T>::tagged_allocator;
+
+    template<typename U>
+    struct rebind { using other = propagating_allocator<U>; };
+};
+
+void test_allocator_propagation() {
+    using pair = std::pair<const int, int>;
+    using fixed_map = tsl::flat_map<int, int, tsl::hash<int>, tsl::equal_to<int>, tagged_allocator<pair>>;
+    fixed_map a(0, {}, {}, tagged_allocator<pair>(1));
+    fixed_map b(0, {}, {}, tagged_allocator<pair>(2));
+    for (int i = 0; i < 100; ++i)
+        a[i] = i;
+    b = a;
+    CHECK(b.get_allocator().tag == 2 && b.size() == 100);
+    b = std::move(a);
+    CHECK(b.get_allocator().tag == 2 && b.size() == 100 && b.at(42) == 42);
+
+    using moving_map = tsl::flat_map<int, int, tsl::hash<int>, tsl::equal_to<int>, propagating_allocator<pair>>;
+    moving_map c(0, {}, {}, propagating_allocator<pair>(3));
+    moving_map d(0, {}, {}, propagating_allocator<pair>(4));
+    c[1] = 1;
+    d = c;
+    CHECK(d.get_allocator().tag == 3);
+    moving_map e(0, {}, {}, propagating_allocator<pair>(5));
+    e = std::move(d);
+    CHECK(e.get_allocator().tag == 3 && e.at(1) == 1);
+}
+
+void test_set() {
+    tsl::flat_set<tsl::non_negative<long>> set;
+    std::unordered_set<long> ref;
+    std::mt19937_64 rng(3);
+    for (int i = 0; i < 20000; ++i) {
+        long k = static_cast<long>(rng() % 500);
+        if (rng() % 3 == 0) {
+            CHECK(set.erase(tsl::non_negative<long>(tsl::unchecked, long(k))) == ref.erase(k));
+        } else {
+            bool inserted = set.insert(tsl::non_negative<long>(tsl::unchecked, long(k))).second;
+            CHECK(inserted == ref.insert(k).second);
+        }
+    }
+    CHECK(set.size() == ref.size());
+    for (auto k : set)
+        CHECK(ref.contains(k.raw()));
+
+    std::unordered_set<long> seen;
+    auto odd = [](long k) { return k % 2 != 0; };
+    auto erased = erase_if(set, [&](tsl::non_negative<long> const& k) {
+        CHECK(seen.insert(k.raw()).second);
+        return odd(k.raw());
+    });
+    CHECK(erased == std::erase_if(ref, odd) && seen.size() == set.size() + erased);
+    CHECK(set.size() == ref.size());
+    for (auto k : set)
+        CHECK(ref.contains(k.raw()));
+}
+
+}
+
+int main() {
+    static_assert(!tsl::flat_map<int, int>::uses_niche);
+    static_assert(tsl::flat_map<tsl::non_negative<int>, int>::uses_niche);
+
+    random_ops<tsl::flat_map<int, int>>([](std::uint64_t i) { return static_cast<int>(i); }, 5000, 200000, 1);
+    random_ops<tsl::flat_map<int, int>>([](std::uint64_t i) { return static_cast<int>(i); }, 20, 5000, 2);
+    random_ops<tsl::flat_map<std::string, int>>([](std::uint64_t i) { return std::to_string(i); }, 3000, 100000, 3);
+    random_ops<tsl::flat_map<tsl::non_negative<int>, int>>(
+        [](std::uint64_t i) { return tsl::non_negative<int>(tsl::unchecked, static_cast<int>(i)); },
+        5000, 200000, 4);
+
+    test_erase_if<tsl::flat_map<int, int>>([](std::int64_t k) { return static_cast<int>(k); });
+    test_erase_if<tsl::flat_map<tsl::non_negative<int>, int>>(
+        [](std::int64_t k) { return tsl::non_negative<int>(tsl::unchecked, static_cast<int>(k)); });
+    test_heterogeneous_lookup();
+    test_copy_and_move();
+    test_rehash();
+    test_allocator_propagation();
+    test_set();
+    return tsl_test::result();
+}
@@ -0,0 +1,190 @@
+// intrusive_list, intrusive_stack and intrusive_hash_table: insertion and removal,
+// iteration, heterogeneous lookup, rehash and moves, with an element in all three.
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "check.hpp"
+#include "tsl/containers/intrusive_hash_table.hpp"
+#include "tsl/containers/intrusive_list.hpp"
+#include "tsl/containers/intrusive_stack.hpp"
+
+namespace {
+
+struct by_order;
+struct by_age;
+
+struct item : tsl::list_hook<by_order>, tsl::list_hook<by_age>, tsl::stack_hook<>, tsl::hash_hook<> {
+    explicit item(std::string k) : key(std::move(k)) { }
+
+    std::string key;
+};
+
+struct key_of {
+    std::string const& operator()(item const& i) const noexcept {
+        return i.key;
+    }
+};
+
+using table = tsl::intrusive_hash_table<item, key_of>;
+
+template<typename R>
+std::vector<std::string> keys(R const& r) {
+    std::vector<std::string> out;
+    for (item const& i : r)
+        out.push_back(i.key);
+    return out;
+}
+
+void test_list() {
+    item a("a"), b("b"), c("c");
+    tsl::intrusive_list<item, by_order> order;
+    tsl::intrusive_list<item, by_age> age;
+    order.push_back(b);
+    order.push_front(a);
+    order.push_back(c);
+    age.push_back(c);
+    age.push_back(a);
+    CHECK((keys(order) == std::vector<std::string>{"a", "b", "c"}));
+    CHECK((keys(age) == std::vector<std::string>{"c", "a"}));
+    CHECK(&order.front() == &a && &order.back() == &c);
+
+    order.erase(b);
+    CHECK(!b.tsl::list_hook<by_order>::is_linked());
+    CHECK((keys(order) == std::vector<std::string>{"a", "c"}));
+    order.insert(tsl::intrusive_list<item, by_order>::iterator_to(c), b);
+    order.move_to_back(a);
+    CHECK((keys(order) == std::vector<std::string>{"b", "c", "a"}));
+
+    // Reverse iteration.
+    std::vector<std::string> reversed;
+    for (auto it = order.end(); it != order.begin();)
+        reversed.push_back((--it)->key);
+    CHECK((reversed == std::vector<std::string>{"a", "c", "b"}));
+
+    auto it = order.erase(tsl::intrusive_list<item, by_order>::iterator_to(c));
+    CHECK(&*it == &a);
+
+    // The moved-from list is empty, the elements link to the new head.
+    tsl::intrusive_list<item, by_order> moved(std::move(order));
+    CHECK(order.empty() && keys(order).empty());
+    CHECK(moved.size() == 2 && (keys(moved) == std::vector<std::string>{"b", "a"}));
+    order = std::move(moved);
+    CHECK(moved.empty() && order.size() == 2);
+    CHECK(&*order.pop_back() == &a && &*order.pop_front() == &b);
+    CHECK(!order.pop_front().has_value());
+
+    age.clear();
+    CHECK(!a.tsl::list_hook<by_age>::is_linked() && !c.tsl::list_hook<by_age>::is_linked());
+}
+
+void test_stack() {
+    item a("a"), b("b"), c("c");
+    tsl::intrusive_stack<item> stack;
+    CHECK(!stack.top().has_value() && !stack.pop().has_value());
+    stack.push(a);
+    stack.push(b);
+    stack.push(c);
+    CHECK((keys(stack) == std::vector<std::string>{"c", "b", "a"}));
+    CHECK(&*stack.top() == &c);
+
+    tsl::intrusive_stack<item> moved(std::move(stack));
+    CHECK(stack.empty() && keys(stack).empty() && moved.size() == 3);
+    CHECK(&*moved.pop() == &c);
+    stack = std::move(moved);
+    CHECK(moved.empty() && stack.size() == 2);
+    CHECK(&*stack.pop() == &b && &*stack.pop() == &a);
+    CHECK(stack.empty());
+    // Popped elements can be pushed again.
+    stack.push(a);
+    stack.clear();
+    stack.push(a);
+    CHECK(stack.size() == 1);
+    stack.clear();
+}
+
+void test_hash_table() {
+    std::vector<item> items;
+    items.reserve(100);
+    for (int i = 0; i < 100; ++i)
+        items.emplace_back("key " + std::to_string(i));
+
+    table t(8);
+    for (item& i : items)
+        CHECK(t.insert(i));
+    CHECK(t.size() == 100 && t.bucket_count() == 8);
+    item duplicate("key 5");
+    CHECK(!t.insert(duplicate) && !duplicate.tsl::hash_hook<>::is_linked());
+
+    auto all = keys(t);
+    std::ranges::sort(all);
+    auto expected = keys(items);
+    std::ranges::sort(expected);
+    CHECK(all == expected);
+
+    // std::string_view and char const* find std::string keys.
+    CHECK(&*t.find(std::string_view("key 42")) == &items[42]);
+    CHECK(&*t.find("key 7") == &items[7]);
+    CHECK(t.contains(std::string_view("key 99")));
+    CHECK(!t.find(std::string_view("key 100")).has_value());
+
+    t.rehash(256);
+    CHECK(t.bucket_count() == 256 && t.size() == 100);
+    for (item& i : items)
+        CHECK(&*t.find(i.key) == &i);
+    auto after = keys(t);
+    std::ranges::sort(after);
+    CHECK(after == expected);
+
+    // A failed rehash leaves the table as it was.
+    bool thrown = false;
+    try {
+        t.rehash(std::size_t(1) << (sizeof(std::size_t) * 8 - 2));
+    } catch (std::bad_alloc const&) {
+        thrown = true;
+    }
+    CHECK(thrown && t.bucket_count() == 256 && t.size() == 100);
+    CHECK(&*t.find(std::string_view("key 64")) == &items[64]);
+
+    t.erase(items[0]);
+    CHECK(&*t.erase(std::string_view("key 1")) == &items[1]);
+    CHECK(!t.erase(std::string_view("key 1")).has_value());
+    CHECK(t.size() == 98 && !t.contains(std::string_view("key 0")));
+    CHECK(!items[1].tsl::hash_hook<>::is_linked());
+
+    table moved(std::move(t));
+    CHECK(t.empty() && moved.size() == 98);
+    CHECK(!t.find(std::string_view("key 2")).has_value());
+    CHECK(&*moved.find(std::string_view("key 2")) == &items[2]);
+    t = std::move(moved);
+    CHECK(t.size() == 98 && &*t.find(std::string_view("key 50")) == &items[50]);
+    t.clear();
+    CHECK(t.empty() && !items[50].tsl::hash_hook<>::is_linked());
+}
+
+// An element in a list, a stack and a table at once.
+void test_all_hooks() {
+    item x("x");
+    tsl::intrusive_list<item, by_order> list;
+    tsl::intrusive_stack<item> stack;
+    table t;
+    list.push_back(x);
+    stack.push(x);
+    CHECK(t.insert(x));
+    list.erase(x);
+    CHECK(stack.size() == 1 && t.contains(std::string_view("x")));
+    t.erase(x);
+    CHECK(&*stack.pop() == &x);
+}
+
+}
+
+int main() {
+    test_list();
+    test_stack();
+    test_hash_table();
+    test_all_hooks();
+    return tsl_test::result();
+}
@@ -0,0 +1,243 @@
+// log: formatting of every argument type and of brace escapes, binary logs decoding
+// to the same text, dropped records when a buffer is full, and call sites waiting
+// with overflow::block.
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "check.hpp"
+#include "tsl/maybe.hpp"
+#include "tsl/types/non_negative.hpp"
+#include "tsl/util/log.hpp"
+
+namespace {
+
+using tsl::log::level;
+
+std::string contents(std::FILE* f) {
+    std::fflush(f);
+    std::rewind(f);
+    std::string s;
+    char buffer[4096];
+    std::size_t n;
+    while ((n = std::fread(buffer, 1, sizeof(buffer), f)) > 0)
+        s.append(buffer, n);
+    return s;
+}
+
+struct line {
+    char level;
+    std::string message;
+};
+
+// "2024-01-02 03:04:05.123456789 I [1] message"
+std::vector<line> lines(std::string const& text) {
+    std::vector<line> r;
+    std::size_t start = 0;
+    for (std::size_t end; (end = text.find('\n', start)) != std::string::npos; start = end + 1) {
+        std::string l = text.substr(start, end - start);
+        std::size_t message = l.find("] ");
+        CHECK(l.size() > 30 && l[29] == ' ' && message != std::string::npos);
+        if (l.size() > 30 && message != std::string::npos)
+            r.push_back({l[30], l.substr(message + 2)});
+    }
+    CHECK(start == text.size());
+    return r;
+}
+
+std::filesystem::path temp_path(char const* name) {
+    return std::filesystem::temp_directory_path() / (name + std::to_string(::getpid()));
+}
+
+// The records of a non_negative are plain integers, and a maybe of one is stored in
+// its breach value.
+using tsl::internal_log::arg_type;
+using tsl::internal_log::traits_of;
+static_assert(traits_of<tsl::non_negative<int>>::type == arg_type::int64);
+static_assert(traits_of<tsl::maybe<int>>::type == (arg_type::int64 | arg_type::maybe_flag));
+static_assert(traits_of<tsl::maybe<tsl::non_negative<short>>>::type == (arg_type::int64 | arg_type::niche_flag));
+static_assert(traits_of<tsl::maybe<tsl::non_negative<int>> const&>::size({}) == 8);
+
+void log_everything() {
+    TSL_LOG_DEBUG("hidden {}", 1);
+    TSL_LOG_INFO("accepted {} from {}", 3, "peer");
+    TSL_LOG_WARNING("{} {} {} {} {}", true, 'c', -2.5, std::string("str"), std::uint64_t(1) << 63);
+    TSL_LOG_ERROR("{{}} {{{}}} }}", 5u);
+    TSL_LOG_INFO("no arguments");
+
+    tsl::maybe<int> none;
+    tsl::maybe<int> four(4);
+    tsl::maybe<std::string> text("text");
+    tsl::non_negative<int> six(6);
+    tsl::maybe<tsl::non_negative<int>> no_count;
+    tsl::maybe<tsl::non_negative<int>> count(tsl::non_negative<int>(7));
+    TSL_LOG_INFO("{} {} {} {} {} {}", none, four, text, six, no_count, count);
+
+    tsl::log::set_min_level(level::debug);
+    TSL_LOG_DEBUG("shown");
+}
+
+void check_everything(std::vector<line> const& l) {
+    CHECK(l.size() >= 6);
+    if (l.size() < 6)
+        return;
+    CHECK(l[0].level == 'I' && l[0].message == "accepted 3 from peer");
+    CHECK(l[1].level == 'W' && l[1].message == "true c -2.5 str 9223372036854775808");
+    CHECK(l[2].level == 'E' && l[2].message == "{} {5} }");
+    CHECK(l[3].message == "no arguments");
+    CHECK(l[4].message == "none 4 text 6 none 7");
+    CHECK(l[5].level == 'D' && l[5].message == "shown");
+}
+
+void test_text() {
+    std::FILE* out = std::tmpfile();
+    tsl::log::options opts;
+    opts.text = out;
+    CHECK(tsl::log::start(opts));
+    log_everything();
+    TSL_LOG_INFO("last");
+    tsl::log::stop();
+    // Nothing is written while stopped.
+    TSL_LOG_ERROR("stopped");
+
+    auto l = lines(contents(out));
+    check_everything(l);
+    CHECK(!l.empty() && l.back().message == "last");
+    std::fclose(out);
+}
+
+void test_decode() {
+    auto path = temp_path("tsl_log_test_");
+    std::FILE* out = std::tmpfile();
+    tsl::log::options opts;
+    opts.text = out;
+    opts.binary_path = path.string();
+    CHECK(tsl::log::start(opts));
+    log_everything();
+    // Formats are written once, messages every time.
+    for (int i = 0; i < 3; ++i)
+        TSL_LOG_INFO("last {}", i);
+    tsl::log::stop();
+    std::string text = contents(out);
+
+    std::FILE* decoded = std::tmpfile();
+    CHECK(tsl::log::decode(path.c_str(), decoded));
+    CHECK(contents(decoded) == text);
+    check_everything(lines(text));
+
+    // A truncated log decodes up to the last complete message.
+    auto size = std::filesystem::file_size(path);
+    std::filesystem::resize_file(path, size - 3);
+    std::FILE* partial = std::tmpfile();
+    CHECK(!tsl::log::decode(path.c_str(), partial));
+    std::string partial_text = contents(partial);
+    CHECK(partial_text == text.substr(0, text.rfind('\n', text.size() - 2) + 1));
+
+    std::filesystem::remove(path);
+    CHECK(!tsl::log::decode(path.c_str(), partial));
+
+    std::fclose(out);
+    std::fclose(decoded);
+    std::fclose(partial);
+}
+
+// A 4096-byte buffer, 32-byte records, and a drainer that only wakes when asked to.
+// Logging from a new thread, as buffers are sized when a thread first logs.
+std::vector<line> fill_buffer(tsl::log::overflow on_full, std::uint64_t& lost) {
+    std::FILE* out = std::tmpfile();
+    tsl::log::options opts;
+    opts.text = out;
+    opts.buffer_bytes = 4096;
+    opts.on_full = on_full;
+    opts.drain_period = std::chrono::hours(1);
+    CHECK(tsl::log::start(opts));
+    std::uint64_t before = tsl::log::dropped();
+    std::thread([] {
+        for (int i = 0; i < 1000; ++i)
+            TSL_LOG_INFO("message {}", i);
+    }).join();
+    lost = tsl::log::dropped() - before;
+    tsl::log::stop();
+    auto l = lines(contents(out));
+    std::fclose(out);
+    return l;
+}
+
+void test_dropped() {
+    std::uint64_t lost;
+    auto l = fill_buffer(tsl::log::overflow::drop, lost);
+    CHECK(lost > 0 && l.size() + lost == 1000);
+    // The oldest records are kept.
+    for (std::size_t i = 0; i < l.size(); ++i)
+        CHECK(l[i].message == "message " + std::to_string(i));
+
+    // Records larger than half the buffer never fit.
+    std::FILE* out = std::tmpfile();
+    tsl::log::options opts;
+    opts.text = out;
+    CHECK(tsl::log::start(opts));
+    std::uint64_t before = tsl::log::dropped();
+    std::thread([] { TSL_LOG_INFO("{}", std::string(std::size_t(1) << 20, 'x')); }).join();
+    CHECK(tsl::log::dropped() == before + 1);
+    tsl::log::stop();
+    std::fclose(out);
+}
+
+void test_block() {
+    std::uint64_t lost;
+    auto l = fill_buffer(tsl::log::overflow::block, lost);
+    CHECK(lost == 0 && l.size() == 1000);
+    for (std::size_t i = 0; i < l.size(); ++i)
+        CHECK(l[i].message == "message " + std::to_string(i));
+}
+
+// Threads register and log while the buffers are drained and flushed.
+void test_threads() {
+    std::FILE* out = std::tmpfile();
+    tsl::log::options opts;
+    opts.text = out;
+    opts.on_full = tsl::log::overflow::block;
+    opts.buffer_bytes = 4096;
+    CHECK(tsl::log::start(opts));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([t] {
+            for (int i = 0; i < 500; ++i)
+                TSL_LOG_INFO("thread {} message {}", t, i);
+        });
+        tsl::log::flush();
+    }
+    for (int i = 0; i < 10; ++i) {
+        tsl::log::set_min_level(level::info);
+        tsl::log::flush();
+    }
+    for (auto& t : threads)
+        t.join();
+    tsl::log::stop();
+
+    auto l = lines(contents(out));
+    CHECK(l.size() == 2000);
+    int next[4] = {};
+    for (auto const& x : l) {
+        int t, i;
+        if (std::sscanf(x.message.c_str(), "thread %d message %d", &t, &i) == 2 && t >= 0 && t < 4)
+            CHECK(i == next[t]++);
+    }
+    CHECK(next[0] == 500 && next[1] == 500 && next[2] == 500 && next[3] == 500);
+    std::fclose(out);
+}
+
+}
+
+int main() {
+    test_text();
+    test_decode();
+    test_dropped();
+    test_block();
+    test_threads();
+    return tsl_test::result();
+}
@@ -0,0 +1,132 @@
+// lru_cache: the shard count of small caches, the capacity, CLOCK's second chance
+// for fresh entries, and concurrent misses computing a value once.
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "check.hpp"
+#include "tsl/containers/lru_cache.hpp"
+
+namespace {
+
+void test_small_capacity() {
+    // One shard of 4, not 16 shards of at most one entry.
+    tsl::lru_cache<int, int> cache(4);
+    for (int i = 0; i < 4; ++i)
+        cache.put(i, i);
+    CHECK(cache.size() == 4);
+    for (int i = 0; i < 4; ++i)
+        CHECK(cache.contains(i));
+    cache.put(4, 4);
+    CHECK(cache.size() == 4);
+    CHECK(cache.stats().evictions == 1);
+}
+
+void test_fresh_entry_survives() {
+    tsl::lru_cache<int, int> cache(8, 1);
+    for (int i = 0; i < 100; ++i) {
+        cache.put(i, i);
+        CHECK(cache.contains(i));
+        CHECK(cache.size() <= 8);
+    }
+    // A hit entry outlives entries inserted after it and never hit.
+    cache.put(1000, 0);
+    for (int i = 0; i < 16; ++i) {
+        CHECK(cache.get(1000).has_value());
+        cache.put(2000 + i, i);
+    }
+    CHECK(cache.contains(1000));
+}
+
+struct length_weight {
+    std::size_t operator()(int, std::string const& s) const noexcept {
+        return s.size();
+    }
+};
+
+void test_heavy_entry() {
+    tsl::lru_cache<int, std::string, tsl::hash<int>, tsl::equal_to<int>, length_weight> cache(
+        16, 1);
+    cache.put(1, "abcd");
+    cache.put(2, "efgh");
+    cache.put(3, std::string(17, 'x'));
+    CHECK(!cache.contains(3));
+    CHECK(cache.contains(1) && cache.contains(2));
+    CHECK(cache.weight() == 8);
+}
+
+void test_get_or_compute() {
+    tsl::lru_cache<int, int> cache(16);
+    int calls = 0;
+    auto square = [&](int k) {
+        ++calls;
+        return k * k;
+    };
+    CHECK(cache.get_or_compute(3, square) == 9);
+    CHECK(cache.get_or_compute(3, square) == 9);
+    CHECK(calls == 1);
+    auto s = cache.stats();
+    CHECK(s.hits == 1 && s.misses == 1);
+}
+
+// Threads missing the same key at once. The first computation is held until every
+// thread has missed, which the others do right before waiting, with the lock held.
+void test_single_flight(bool first_throws) {
+    constexpr int threads = 6;
+    tsl::lru_cache<int, int> cache(16);
+    std::atomic<int> calls {0};
+    std::atomic<bool> release {false};
+    auto compute = [&](int k) {
+        if (calls.fetch_add(1) == 0) {
+            while (!release.load())
+                std::this_thread::yield();
+            if (first_throws)
+                throw std::runtime_error("first");
+        }
+        return k * 10;
+    };
+
+    std::atomic<int> values {0};
+    std::atomic<int> failures {0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&] {
+            try {
+                if (cache.get_or_compute(7, compute) == 70)
+                    ++values;
+            } catch (std::runtime_error const&) {
+                ++failures;
+            }
+        });
+    }
+    while (cache.stats().misses < threads)
+        std::this_thread::yield();
+    release = true;
+    for (auto& w : workers)
+        w.join();
+
+    auto s = cache.stats();
+    if (first_throws) {
+        // One of the waiters computes again. The others wait for it, or find the
+        // value if it's already there.
+        CHECK(calls == 2 && failures == 1 && values == threads - 1);
+        CHECK(s.misses + s.hits == threads && s.coalesced + s.hits == threads - 2);
+    } else {
+        CHECK(calls == 1 && failures == 0 && values == threads);
+        CHECK(s.misses == threads && s.hits == 0 && s.coalesced == threads - 1);
+    }
+    CHECK(cache.get_or_compute(7, compute) == 70 && calls == (first_throws ? 2 : 1));
+}
+
+}
+
+int main() {
+    test_small_capacity();
+    test_fresh_entry_survives();
+    test_heavy_entry();
+    test_get_or_compute();
+    test_single_flight(false);
+    test_single_flight(true);
+    return tsl_test::result();
+}
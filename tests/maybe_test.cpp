@@ -0,0 +1,147 @@
+// maybe: maybe<T&> is a trivially copyable pointer that rebinds on assignment and
+// never binds to a temporary, and transform keeps references but moves rvalue ones.
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include "check.hpp"
+#include "tsl/maybe.hpp"
+
+namespace {
+
+struct base {
+    int id = 0;
+};
+
+struct derived : base {
+    int extra = 0;
+};
+
+using maybe_ref = tsl::maybe<int&>;
+
+static_assert(std::is_trivially_copyable_v<maybe_ref>);
+static_assert(sizeof(maybe_ref) == sizeof(int*));
+static_assert(sizeof(tsl::maybe<std::string const&>) == sizeof(void*));
+
+// Only lvalues bind.
+static_assert(std::is_constructible_v<maybe_ref, int&>);
+static_assert(!std::is_constructible_v<maybe_ref, int&&>);
+static_assert(!std::is_constructible_v<tsl::maybe<int const&>, int&&>);
+static_assert(!std::is_constructible_v<tsl::maybe<int const&>, int const&&>);
+static_assert(!std::is_assignable_v<maybe_ref&, int&&>);
+static_assert(!std::is_constructible_v<maybe_ref, long&>);
+
+// Derived to base and adding const, not the other way around.
+static_assert(std::is_constructible_v<tsl::maybe<base&>, derived&>);
+static_assert(std::is_constructible_v<tsl::maybe<base&>, tsl::maybe<derived&>>);
+static_assert(std::is_constructible_v<tsl::maybe<int const&>, maybe_ref>);
+static_assert(!std::is_constructible_v<tsl::maybe<derived&>, tsl::maybe<base&>>);
+static_assert(!std::is_constructible_v<maybe_ref, tsl::maybe<int const&>>);
+
+void test_rebind() {
+    int a = 1;
+    int b = 2;
+    maybe_ref r;
+    CHECK(!r.has_value());
+    r = a;
+    CHECK(r.has_value() && &*r == &a);
+
+    // Assignment rebinds, a and b keep their values.
+    r = b;
+    CHECK(&*r == &b && a == 1 && b == 2);
+    maybe_ref other(a);
+    r = other;
+    CHECK(&*r == &a && b == 2);
+
+    // Writes go through to the referred value.
+    *r = 10;
+    CHECK(a == 10);
+    CHECK(&r.emplace(b) == &b);
+
+    std::swap(r, other);
+    CHECK(&*r == &a && &*other == &b);
+    r.reset();
+    CHECK(!r.has_value() && r.value_or(5) == 5);
+    CHECK(other.value_or(5) == 2);
+}
+
+void test_conversion() {
+    derived d;
+    d.id = 7;
+    tsl::maybe<derived&> md(d);
+    tsl::maybe<base&> mb = md;
+    CHECK(mb.has_value() && &*mb == static_cast<base*>(&d) && mb->id == 7);
+    CHECK(!tsl::maybe<base&>(tsl::maybe<derived&>()).has_value());
+
+    tsl::maybe<base&> direct(d);
+    CHECK(&*direct == static_cast<base*>(&d));
+    direct = d;
+    CHECK(&direct.value() == static_cast<base*>(&d));
+}
+
+void test_monadic() {
+    std::string s = "text";
+    tsl::maybe<std::string&> r(s);
+    tsl::maybe<std::string&> none;
+
+    // A returned reference stays a reference, to the same object.
+    auto same = r.transform([](std::string& v) -> std::string& { return v; });
+    static_assert(std::is_same_v<decltype(same), tsl::maybe<std::string&>>);
+    CHECK(same.has_value() && &*same == &s);
+    auto size = r.transform([](std::string const& v) { return v.size(); });
+    static_assert(std::is_same_v<decltype(size), tsl::maybe<std::size_t>>);
+    CHECK(size == tsl::maybe<std::size_t>(4));
+    CHECK(!none.transform([](std::string const& v) { return v.size(); }).has_value());
+
+    // A returned rvalue reference is moved into a value.
+    auto moved = r.transform([](std::string& v) -> std::string&& { return std::move(v); });
+    static_assert(std::is_same_v<decltype(moved), tsl::maybe<std::string>>);
+    CHECK(moved == tsl::maybe<std::string>("text") && s.empty());
+    s = "text";
+
+    auto first = [](std::string& v) -> tsl::maybe<char&> {
+        if (v.empty())
+            return {};
+        return tsl::maybe<char&>(v[0]);
+    };
+    auto c = r.and_then(first);
+    CHECK(c.has_value() && &*c == &s[0]);
+    CHECK(!none.and_then(first).has_value());
+
+    std::string fallback = "fallback";
+    CHECK(&*none.or_else([&] { return tsl::maybe<std::string&>(fallback); }) == &fallback);
+    CHECK(&*r.or_else([&] { return tsl::maybe<std::string&>(fallback); }) == &s);
+}
+
+// transform on maybe<T> of a callable returning T&&, from each value category.
+void test_transform_rvalue() {
+    tsl::maybe<std::unique_ptr<int>> p(std::make_unique<int>(3));
+    auto take = [](std::unique_ptr<int>& v) -> std::unique_ptr<int>&& { return std::move(v); };
+    auto taken = p.transform(take);
+    static_assert(std::is_same_v<decltype(taken), tsl::maybe<std::unique_ptr<int>>>);
+    CHECK(taken.has_value() && **taken == 3);
+    CHECK(p.has_value() && *p == nullptr);
+
+    tsl::maybe<std::string> s("moved");
+    auto forward = [](std::string&& v) -> std::string&& { return std::move(v); };
+    auto out = std::move(s).transform(forward);
+    static_assert(std::is_same_v<decltype(out), tsl::maybe<std::string>>);
+    CHECK(out == tsl::maybe<std::string>("moved"));
+    CHECK(!tsl::maybe<std::string>().transform(forward).has_value());
+
+    // Lvalue references are still kept.
+    tsl::maybe<int> i(1);
+    auto ref = i.transform([](int& v) -> int& { return v; });
+    static_assert(std::is_same_v<decltype(ref), tsl::maybe<int&>>);
+    CHECK(&*ref == &*i);
+}
+
+}
+
+int main() {
+    test_rebind();
+    test_conversion();
+    test_monadic();
+    test_transform_rvalue();
+    return tsl_test::result();
+}
@@ -0,0 +1,149 @@
+// The paths documented as allocation-free, each inside TSL_ASSERT_NO_ALLOC. Built
+// against a copy of tsl with allocation tracking, see CMakeLists.txt.
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "check.hpp"
+#include "tsl/concurrency/mpmc_queue.hpp"
+#include "tsl/concurrency/spsc_queue.hpp"
+#include "tsl/containers/intrusive_hash_table.hpp"
+#include "tsl/containers/intrusive_list.hpp"
+#include "tsl/containers/intrusive_stack.hpp"
+#include "tsl/containers/small_vector.hpp"
+#include "tsl/memory/arena.hpp"
+#include "tsl/profiling/alloc_tracking.hpp"
+#include "tsl/profiling/trace.hpp"
+#include "tsl/util/log.hpp"
+
+namespace {
+
+static_assert(tsl::alloc::enabled, "built without TSL_ALLOC_TRACKING");
+
+// Violations are logged rather than aborting, so every section is checked.
+bool allocation_free(auto f) {
+    std::uint64_t before = tsl::alloc::violations();
+    {
+        TSL_ASSERT_NO_ALLOC();
+        f();
+    }
+    return tsl::alloc::violations() == before;
+}
+
+void test_tracking_works() {
+    std::vector<int> v;
+    CHECK(!allocation_free([&] { v.reserve(16); }));
+}
+
+void test_small_vector() {
+    tsl::small_vector<int, 8> v;
+    CHECK(allocation_free([&] {
+        for (int i = 0; i < 8; ++i)
+            v.push_back(i);
+        v.pop_back();
+        v.erase(v.begin());
+        v.clear();
+    }));
+}
+
+void test_queues() {
+    tsl::spsc_queue<std::uint64_t> spsc(64);
+    tsl::mpmc_queue<std::uint64_t> mpmc(64);
+    CHECK(allocation_free([&] {
+        for (std::uint64_t i = 0; i < 64; ++i) {
+            static_cast<void>(spsc.try_push(i));
+            static_cast<void>(mpmc.try_push(i));
+        }
+        for (int i = 0; i < 64; ++i) {
+            static_cast<void>(spsc.try_pop());
+            static_cast<void>(mpmc.try_pop());
+        }
+    }));
+}
+
+void test_arena() {
+    tsl::arena a(4096);
+    // The first chunk is allocated on first use.
+    static_cast<void>(a.allocate(1));
+    a.reset();
+    CHECK(allocation_free([&] {
+        for (int i = 0; i < 64; ++i)
+            static_cast<void>(a.create<std::uint64_t>(i));
+        static_cast<void>(a.allocate_array<char>(256));
+    }));
+}
+
+struct item : tsl::list_hook<>, tsl::stack_hook<>, tsl::hash_hook<> {
+    std::string key;
+};
+
+struct key_of {
+    std::string const& operator()(item const& i) const noexcept {
+        return i.key;
+    }
+};
+
+void test_intrusive() {
+    // Long keys, so that creating them would allocate.
+    std::vector<item> items(16);
+    for (std::size_t i = 0; i < items.size(); ++i)
+        items[i].key = std::string(32, 'a') + std::to_string(i);
+    tsl::intrusive_list<item> list;
+    tsl::intrusive_stack<item> stack;
+    tsl::intrusive_hash_table<item, key_of> table(64);
+    std::string_view missing = "not a key, and longer than the small string buffer";
+    CHECK(allocation_free([&] {
+        for (item& i : items) {
+            list.push_back(i);
+            stack.push(i);
+            table.insert(i);
+        }
+        static_cast<void>(table.find(missing));
+        static_cast<void>(table.find(items[3].key));
+        for (item& i : items) {
+            list.erase(i);
+            static_cast<void>(stack.pop());
+            table.erase(i);
+        }
+    }));
+}
+
+void test_trace() {
+    tsl::trace::start();
+    // Registers the thread's buffer.
+    { TSL_TRACE_SCOPE("warm up"); }
+    CHECK(allocation_free([] {
+        TSL_TRACE_SCOPE("scope");
+        TSL_TRACE_COUNTER("counter", 1);
+    }));
+    tsl::trace::stop();
+}
+
+void test_log() {
+    tsl::log::options opts;
+    opts.text = nullptr;
+    tsl::log::start(opts);
+    // Registers the thread's buffer.
+    TSL_LOG_INFO("warm up");
+    std::string long_string(100, 'x');
+    CHECK(allocation_free([&] {
+        TSL_LOG_INFO("{} {} {}", 1, 2.5, long_string);
+        TSL_LOG_WARNING("{}", tsl::maybe<int>(3));
+        TSL_LOG_DEBUG("below the minimum level");
+    }));
+    tsl::log::stop();
+}
+
+}
+
+int main() {
+    tsl::alloc::set_violation_action(tsl::alloc::violation_action::log);
+    test_tracking_works();
+    test_small_vector();
+    test_queues();
+    test_arena();
+    test_intrusive();
+    test_trace();
+    test_log();
+    return tsl_test::result();
+}
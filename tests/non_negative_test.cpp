@@ -0,0 +1,110 @@
+// non_negative's bulk checks: a negative value at every position around the block
+// boundaries, const and mutable views, and rvalue arrays, which the view would
+// outlive.
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "check.hpp"
+#include "tsl/types/non_negative.hpp"
+
+namespace {
+
+template<typename T>
+void test_positions() {
+    // Blocks hold 256 bytes, cover four of them and a tail.
+    constexpr std::size_t n = 4 * 256 / sizeof(T) + 7;
+    std::vector<T> values(n);
+    for (std::size_t i = 0; i < n; ++i)
+        values[i] = static_cast<T>(i % 100);
+    std::vector<tsl::non_negative<T>> out(n);
+
+    CHECK(!tsl::find_negative(values).has_value());
+    CHECK(tsl::validate_non_negative(values).has_value());
+    CHECK(!tsl::copy_non_negative(values, out).has_value());
+    CHECK(out[n - 1].raw() == values[n - 1]);
+
+    for (std::size_t bad = 0; bad < n; ++bad) {
+        for (T negative : {T(-1), std::numeric_limits<T>::min()}) {
+            T saved = std::exchange(values[bad], negative);
+            // And a later one, which mustn't be reported instead.
+            T later = n - bad > 3 ? std::exchange(values[bad + 3], T(-2)) : T(0);
+
+            auto found = tsl::find_negative(values);
+            CHECK(found.has_value() && *found == bad);
+            CHECK(!tsl::validate_non_negative(values).has_value());
+            auto copied = tsl::copy_non_negative(values, out);
+            CHECK(copied.has_value() && *copied == bad);
+
+            // Only the prefix before it is clean.
+            CHECK(!tsl::find_negative(std::span(values).first(bad)).has_value());
+
+            values[bad] = saved;
+            if (n - bad > 3)
+                values[bad + 3] = later;
+        }
+    }
+}
+
+void test_views() {
+    std::vector<int> values {0, 1, 2, 3};
+
+    auto mutable_view = tsl::validate_non_negative(values);
+    static_assert(std::is_same_v<decltype(mutable_view)::value_type, std::span<tsl::non_negative<int>>>);
+    CHECK(mutable_view.has_value() && mutable_view->size() == 4);
+    // The view aliases the array.
+    (*mutable_view)[2] = tsl::non_negative<int>(7);
+    CHECK(values[2] == 7);
+    CHECK(static_cast<void*>(mutable_view->data()) == static_cast<void*>(values.data()));
+
+    std::vector<int> const& const_values = values;
+    auto const_view = tsl::validate_non_negative(const_values);
+    static_assert(std::is_same_v<decltype(const_view)::value_type, std::span<tsl::non_negative<int> const>>);
+    CHECK(const_view.has_value() && (*const_view)[2].raw() == 7);
+
+    auto span_view = tsl::validate_non_negative(std::span<int const>(values));
+    static_assert(std::is_same_v<decltype(span_view)::value_type, std::span<tsl::non_negative<int> const>>);
+    CHECK(span_view.has_value() && span_view->size() == 4);
+
+    // A span is borrowed, so a temporary one is fine.
+    CHECK(tsl::validate_non_negative(std::span(values)).has_value());
+
+    std::array<std::int64_t, 3> array {1, -5, 2};
+    CHECK(!tsl::validate_non_negative(array).has_value());
+    array[1] = 5;
+    auto array_view = tsl::validate_non_negative(array);
+    CHECK(array_view.has_value() && (*array_view)[1].raw() == 5);
+}
+
+template<typename R>
+constexpr bool validates = requires(R&& r) { tsl::validate_non_negative(std::forward<R>(r)); };
+
+static_assert(validates<std::vector<int>&>);
+static_assert(validates<std::vector<int> const&>);
+static_assert(validates<std::span<int>>);
+static_assert(!validates<std::vector<int>>);
+static_assert(!validates<std::array<int, 4>>);
+static_assert(!validates<std::vector<unsigned>&>);
+
+constexpr bool find_at_compile_time() {
+    std::array<short, 300> values {};
+    values[257] = -3;
+    return tsl::find_negative(values) == tsl::maybe<std::size_t>(257);
+}
+
+static_assert(find_at_compile_time());
+
+}
+
+int main() {
+    test_positions<std::int8_t>();
+    test_positions<std::int16_t>();
+    test_positions<int>();
+    test_positions<std::int64_t>();
+    test_views();
+    return tsl_test::result();
+}
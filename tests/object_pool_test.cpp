@@ -0,0 +1,160 @@
+// object_pool: handles and pointers convert both ways and stay valid as slabs are
+// added, freed slots are reused, and thread caches give every slot back.
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <thread>
+#include <vector>
+#include "check.hpp"
+#include "tsl/memory/object_pool.hpp"
+
+namespace {
+
+struct item {
+    static inline std::atomic<int> live {0};
+
+    std::uint64_t value;
+    char padding[40];
+
+    explicit item(std::uint64_t v) : value(v) { ++live; }
+    ~item() { --live; }
+};
+
+// Two slots per slab, so that slabs and the directory of slabs grow quickly.
+using small_pool = tsl::object_pool<item, 2>;
+
+void test_handles() {
+    tsl::object_pool<item> pool;
+    item* p = pool.create(1);
+    auto h = pool.create_handle(2);
+    CHECK(pool.get(h).value == 2);
+    CHECK(pool.handle_of(&pool.get(h)) == h);
+    CHECK(&pool.get(pool.handle_of(p)) == p);
+    CHECK(pool.handle_of(p) != h);
+    CHECK(tsl::object_pool<item>::handle().index() == UINT32_MAX);
+    pool.destroy(h);
+    pool.destroy(p);
+    CHECK(item::live == 0);
+}
+
+void test_growth() {
+    small_pool pool;
+    CHECK(pool.capacity() == 0);
+    std::vector<item*> items;
+    std::vector<small_pool::handle> handles;
+    for (std::uint64_t i = 0; i < 200; ++i) {
+        items.push_back(pool.create(i));
+        handles.push_back(pool.handle_of(items.back()));
+        if (i == 0)
+            CHECK(pool.capacity() == small_pool::slots_per_slab);
+    }
+    CHECK(pool.capacity() >= 200 && pool.capacity() < 200 + small_pool::slots_per_slab);
+
+    // Objects created before slabs were added haven't moved.
+    std::set<std::uint32_t> indices;
+    for (std::uint64_t i = 0; i < 200; ++i) {
+        CHECK(items[i]->value == i);
+        CHECK(&pool.get(handles[i]) == items[i]);
+        CHECK(pool.handle_of(items[i]) == handles[i]);
+        indices.insert(handles[i].index());
+    }
+    CHECK(indices.size() == 200);
+    CHECK(*indices.rbegin() < pool.capacity());
+
+    for (item* p : items)
+        pool.destroy(p);
+    CHECK(item::live == 0);
+}
+
+void test_reuse() {
+    small_pool pool;
+    std::vector<item*> items;
+    for (std::uint64_t i = 0; i < 10; ++i)
+        items.push_back(pool.create(i));
+    std::size_t capacity = pool.capacity();
+
+    // The last slot freed is the first one reused.
+    pool.destroy(items[3]);
+    item* again = pool.create(33);
+    CHECK(again == items[3] && again->value == 33);
+
+    // Churn within the capacity adds no slab.
+    for (int round = 0; round < 100; ++round) {
+        for (item*& p : items) {
+            pool.destroy(p);
+            p = pool.create(round);
+        }
+    }
+    CHECK(pool.capacity() == capacity);
+
+    for (item* p : items)
+        pool.destroy(p);
+    std::set<item*> reused;
+    for (std::size_t i = 0; i < capacity; ++i)
+        reused.insert(pool.create(i));
+    CHECK(reused.size() == capacity && pool.capacity() == capacity);
+    for (item* p : reused)
+        pool.destroy(p);
+    CHECK(item::live == 0);
+}
+
+// Threads churn through caches, which pass slots back and forth in batches. Once
+// the caches are gone, every slot is back in the pool.
+void test_caches() {
+    constexpr int threads = 4;
+    constexpr std::size_t batch = 8;
+    constexpr std::uint64_t per_thread = 300;
+    tsl::object_pool<item, 16> pool;
+    std::atomic<int> corrupted {0};
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            tsl::object_pool<item, 16>::cache cache(pool, batch);
+            std::vector<item*> mine;
+            for (int round = 0; round < 20; ++round) {
+                std::uint64_t tag = static_cast<std::uint64_t>(t) << 32 | static_cast<std::uint64_t>(round) << 16;
+                for (std::uint64_t i = 0; i < per_thread; ++i)
+                    mine.push_back(cache.create(tag | i));
+                for (std::uint64_t i = 0; i < per_thread; ++i) {
+                    if (mine[i]->value != (tag | i))
+                        ++corrupted;
+                }
+                // Half through handles, in an order unlike creation's.
+                for (std::size_t i = mine.size(); i-- > 0; ) {
+                    if (i % 2 == 0)
+                        cache.destroy(pool.handle_of(mine[i]));
+                    else
+                        cache.destroy(mine[i]);
+                }
+                mine.clear();
+            }
+        });
+    }
+    for (auto& w : workers)
+        w.join();
+    CHECK(corrupted == 0);
+    CHECK(item::live == 0);
+
+    // Each thread held at most its objects and two batches.
+    std::size_t capacity = pool.capacity();
+    CHECK(capacity <= threads * (per_thread + 2 * batch + pool.slots_per_slab));
+
+    std::set<item*> all;
+    for (std::size_t i = 0; i < capacity; ++i)
+        all.insert(pool.create(i));
+    CHECK(all.size() == capacity && pool.capacity() == capacity);
+    for (item* p : all)
+        pool.destroy(p);
+}
+
+}
+
+int main() {
+    test_handles();
+    test_growth();
+    test_reuse();
+    test_caches();
+    return tsl_test::result();
+}
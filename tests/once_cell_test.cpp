@@ -0,0 +1,95 @@
+// once_cell and lazy: a throwing initializer leaves the cell empty, and the next
+// caller, or a caller waiting on it, initializes the cell.
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include "check.hpp"
+#include "tsl/concurrency/once_cell.hpp"
+
+namespace {
+
+struct failure : std::runtime_error {
+    failure() : std::runtime_error("initializer failed") { }
+};
+
+void test_throwing_initializer() {
+    tsl::once_cell<std::string> cell;
+    bool thrown = false;
+    try {
+        static_cast<void>(cell.get_or_init([]() -> std::string { throw failure(); }));
+    } catch (failure const&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+    CHECK(!cell.has_value());
+    CHECK(!cell.get().has_value());
+
+    CHECK(cell.get_or_init([] { return std::string("second"); }) == "second");
+    CHECK(!cell.set("third"));
+    CHECK(*cell.get() == "second");
+}
+
+void test_throwing_lazy() {
+    int calls = 0;
+    auto init = [&calls] {
+        if (++calls == 1)
+            throw failure();
+        return calls;
+    };
+    tsl::lazy<int, decltype(init)> value(init);
+    bool thrown = false;
+    try {
+        static_cast<void>(*value);
+    } catch (failure const&) {
+        thrown = true;
+    }
+    CHECK(thrown && !value.is_initialized());
+    CHECK(*value == 2);
+    CHECK(*value == 2 && calls == 2);
+}
+
+// The first initializer throws while another caller waits: the waiter runs its own.
+void test_waiter_initializes() {
+    tsl::once_cell<int> cell;
+    std::atomic<bool> first_running {false};
+    std::atomic<bool> waiter_started {false};
+    std::atomic<int> waiter_calls {0};
+    std::thread first([&] {
+        try {
+            static_cast<void>(cell.get_or_init([&]() -> int {
+                first_running.store(true);
+                while (!waiter_started.load())
+                    std::this_thread::yield();
+                // Let the waiter reach the cell.
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                throw failure();
+            }));
+        } catch (failure const&) {
+        }
+    });
+    std::thread waiter([&] {
+        while (!first_running.load())
+            std::this_thread::yield();
+        waiter_started.store(true);
+        int v = cell.get_or_init([&] {
+            ++waiter_calls;
+            return 7;
+        });
+        CHECK(v == 7);
+    });
+    first.join();
+    waiter.join();
+    CHECK(waiter_calls.load() == 1);
+    CHECK(cell.get().has_value() && *cell.get() == 7);
+}
+
+}
+
+int main() {
+    test_throwing_initializer();
+    test_throwing_lazy();
+    test_waiter_initializes();
+    return tsl_test::result();
+}
@@ -0,0 +1,131 @@
+// packed_array against a std::vector of the same values: set, get, push_back, resize
+// and unpack at every alignment, for widths that do and don't divide 64.
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "check.hpp"
+#include "tsl/containers/packed_array.hpp"
+#include "tsl/maybe.hpp"
+#include "tsl/types/non_negative.hpp"
+
+namespace {
+
+template<unsigned Bits>
+void test_values(std::uint64_t seed) {
+    using array = tsl::packed_array<Bits>;
+    using value = tsl::non_negative<std::int64_t>;
+    auto make = [](std::uint64_t v) { return value(tsl::unchecked, static_cast<std::int64_t>(v)); };
+
+    std::mt19937_64 rng(seed);
+    array a(300);
+    std::vector<std::uint64_t> ref(300, 0);
+    for (int i = 0; i < 20000; ++i) {
+        std::uint64_t v = rng() & array::max_value;
+        switch (rng() % 8) {
+        case 0:
+            a.push_back(make(v));
+            ref.push_back(v);
+            break;
+        case 1: {
+            std::size_t n = rng() % 400;
+            a.resize(n);
+            ref.resize(n, 0);
+            break;
+        }
+        default:
+            if (!ref.empty()) {
+                std::size_t k = rng() % ref.size();
+                a.set(k, make(v));
+                ref[k] = v;
+            }
+            break;
+        }
+    }
+    CHECK(a.size() == ref.size());
+    for (std::size_t k = 0; k < ref.size(); ++k)
+        CHECK(static_cast<std::uint64_t>(a[k].raw()) == ref[k]);
+
+    // Neighbours are untouched by writes of the extremes.
+    if (ref.size() >= 3) {
+        a.set(1, make(array::max_value));
+        a.set(1, make(0));
+        CHECK(static_cast<std::uint64_t>(a[0].raw()) == ref[0]);
+        CHECK(static_cast<std::uint64_t>(a[2].raw()) == ref[2]);
+        a.set(1, make(ref[1]));
+    }
+
+    std::vector<value> out(ref.size());
+    for (int i = 0; i < 200; ++i) {
+        std::size_t first = rng() % (ref.size() + 1);
+        std::size_t n = rng() % (ref.size() - first + 1);
+        a.unpack(first, std::span(out.data(), n));
+        for (std::size_t k = 0; k < n; ++k)
+            CHECK(static_cast<std::uint64_t>(out[k].raw()) == ref[first + k]);
+    }
+}
+
+template<unsigned Bits>
+void test_maybe(std::uint64_t seed) {
+    using value = tsl::maybe<tsl::non_negative<int>>;
+    using array = tsl::packed_array<Bits, value>;
+
+    std::mt19937_64 rng(seed);
+    array a(500);
+    std::vector<value> ref(500);
+    for (std::size_t k = 0; k < ref.size(); ++k)
+        CHECK(!a[k].has_value());
+    for (int i = 0; i < 5000; ++i) {
+        std::size_t k = rng() % ref.size();
+        value v;
+        if (rng() % 3 != 0)
+            v = tsl::non_negative<int>(tsl::unchecked, static_cast<int>(rng() % (array::max_value + 1)));
+        a.set(k, v);
+        ref[k] = v;
+    }
+    a.resize(700);
+    ref.resize(700);
+
+    std::vector<value> out(ref.size());
+    a.unpack(0, out);
+    for (std::size_t k = 0; k < ref.size(); ++k) {
+        CHECK(a[k].has_value() == ref[k].has_value());
+        CHECK(out[k].has_value() == ref[k].has_value());
+        if (ref[k].has_value() && a[k].has_value() && out[k].has_value())
+            CHECK(a[k]->raw() == ref[k]->raw() && out[k]->raw() == ref[k]->raw());
+    }
+}
+
+void test_layout() {
+    // 64 elements of 20 bits take 20 words, and one padding word.
+    tsl::packed_array<20> a(64);
+    CHECK(a.memory_size() == 21 * sizeof(std::uint64_t));
+    static_assert(tsl::packed_array<20>::max_value == (1 << 20) - 1);
+    static_assert(tsl::packed_array<20, tsl::maybe<tsl::non_negative<int>>>::max_value == (1 << 20) - 2);
+
+    tsl::packed_array<5> b(10);
+    tsl::packed_array<5> c(10);
+    CHECK(b == c);
+    b.set(3, tsl::non_negative<std::int64_t>(tsl::unchecked, 7));
+    CHECK(!(b == c));
+    // Shrinking zeroes the dropped elements, so growing again reads zeros.
+    b.resize(2);
+    b.resize(10);
+    CHECK(b == c);
+}
+
+}
+
+int main() {
+    test_values<1>(1);
+    test_values<3>(2);
+    test_values<7>(3);
+    test_values<20>(4);
+    test_values<32>(5);
+    test_values<63>(6);
+    test_maybe<1>(7);
+    test_maybe<13>(8);
+    test_maybe<31>(9);
+    test_layout();
+    return tsl_test::result();
+}
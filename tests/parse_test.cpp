@@ -0,0 +1,120 @@
+// parse_uint, parse_int and parse_non_negative against std::from_chars, which must
+// consume the whole input to agree.
+#include <charconv>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include "check.hpp"
+#include "tsl/util/parse.hpp"
+
+namespace {
+
+template<typename T>
+tsl::maybe<T> reference(std::string_view s, int base) {
+    T v {};
+    auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), v, base);
+    if (ec != std::errc() || ptr != s.data() + s.size())
+        return {};
+    return v;
+}
+
+template<typename T>
+void check_one(std::string_view s, int base) {
+    auto expected = reference<T>(s, base);
+    if constexpr (std::unsigned_integral<T>) {
+        CHECK(tsl::parse_uint<T>(s, base) == expected);
+    } else {
+        CHECK(tsl::parse_int<T>(s, base) == expected);
+        // No sign at all, not even "-0".
+        auto n = tsl::parse_non_negative<T>(s, base);
+        bool valid = expected.has_value() && *expected >= 0 && s.front() != '-';
+        CHECK(n.has_value() == valid);
+        if (n.has_value() && valid)
+            CHECK(n->raw() == *expected);
+    }
+}
+
+// Strings near the edges: digits of every length, some invalid characters, signs.
+std::string random_input(std::mt19937_64& rng, int base) {
+    static constexpr std::string_view decimal = "0123456789";
+    static constexpr std::string_view hex = "0123456789abcdefABCDEF";
+    static constexpr std::string_view noise = " +-x:/g\xff";
+    std::string_view digits = base == 10 ? decimal : hex;
+
+    std::string s;
+    if (rng() % 4 == 0)
+        s += '-';
+    std::size_t len = rng() % 26;
+    for (std::size_t i = 0; i < len; ++i) {
+        if (rng() % 64 == 0)
+            s += noise[rng() % noise.size()];
+        else
+            s += digits[rng() % digits.size()];
+    }
+    return s;
+}
+
+template<typename T>
+void random_inputs(std::uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    for (int base : {10, 16}) {
+        for (int i = 0; i < 50000; ++i)
+            check_one<T>(random_input(rng, base), base);
+    }
+}
+
+template<typename T>
+void limits() {
+    for (T v : {std::numeric_limits<T>::min(), std::numeric_limits<T>::max(), T(0), T(1)}) {
+        for (int base : {10, 16}) {
+            char buf[80];
+            auto end = std::to_chars(buf, buf + sizeof(buf), v, base).ptr;
+            std::string s(buf, end);
+            check_one<T>(s, base);
+            // One past the limit, and leading zeros.
+            s.back() = static_cast<char>(s.back() + 1);
+            check_one<T>(s, base);
+            check_one<T>("0000000000000000000000" + std::string(buf, end), base);
+        }
+    }
+}
+
+template<typename M>
+bool holds(M const& m, typename M::value_type expected) {
+    return m.has_value() && *m == expected;
+}
+
+void test_overloads() {
+    // String literals, std::string and string_view all go through one entry point.
+    CHECK(holds(tsl::parse_int<int>("12"), 12));
+    std::string text = "34";
+    CHECK(holds(tsl::parse_uint<unsigned>(text), 34));
+    CHECK(tsl::parse_non_negative<long>(std::string_view("56"))->raw() == 56);
+    char const* p = "ff";
+    CHECK(holds(tsl::parse_uint<std::uint8_t>(p, 16), 255));
+
+    std::uint32_t out[4];
+    CHECK(holds(tsl::parse_list<std::uint32_t>("1,22,333,", ',', out), 3));
+    CHECK(out[2] == 333);
+    CHECK(!tsl::parse_list<std::uint32_t>("1,2,3,4,5", ',', out).has_value());
+    CHECK(!tsl::parse_list<std::uint32_t>("1,,3", ',', out).has_value());
+}
+
+}
+
+int main() {
+    random_inputs<std::uint8_t>(1);
+    random_inputs<std::uint32_t>(2);
+    random_inputs<std::uint64_t>(3);
+    random_inputs<std::int8_t>(4);
+    random_inputs<std::int32_t>(5);
+    random_inputs<std::int64_t>(6);
+    limits<std::uint16_t>();
+    limits<std::uint64_t>();
+    limits<std::int16_t>();
+    limits<std::int64_t>();
+    test_overloads();
+    return tsl_test::result();
+}
@@ -0,0 +1,102 @@
+// perf_counters: reads are empty when the counters can't be opened, which is the
+// usual case in containers, and otherwise count a known amount of work plausibly.
+#include <cstdint>
+#include <cstdio>
+#include <utility>
+#include "check.hpp"
+#include "tsl/profiling/bench.hpp"
+#include "tsl/profiling/perf_counters.hpp"
+
+namespace {
+
+constexpr std::uint64_t loop_iterations = 1'000'000;
+
+void work() {
+    std::uint64_t x = 0;
+    for (std::uint64_t i = 0; i < loop_iterations; ++i) {
+        x += i;
+        tsl::bench::do_not_optimize(x);
+    }
+}
+
+void test_unavailable(tsl::perf_counters const& counters) {
+    CHECK(!counters.read().has_value());
+    CHECK(!counters.uses_rdpmc());
+    auto scope = counters.scope();
+    work();
+    CHECK(!scope.stop().has_value());
+}
+
+void test_counts(tsl::perf_counters const& counters) {
+    auto before = counters.read();
+    CHECK(before.has_value());
+    auto scope = counters.scope();
+    work();
+    auto s = scope.stop();
+    CHECK(s.has_value());
+    if (!s.has_value())
+        return;
+
+    CHECK(s->count == 4);
+    auto cycles = s->get(tsl::perf_event::cycles());
+    auto instructions = s->get(tsl::perf_event::instructions());
+    CHECK(cycles.has_value() && instructions.has_value());
+    CHECK(s->get(tsl::perf_event::cache_misses()).has_value());
+    CHECK(s->get(tsl::perf_event::branch_misses()).has_value());
+    CHECK(!s->get(tsl::perf_event::cache_references()).has_value());
+    // Counts only cover the time the group was scheduled when it is multiplexed.
+    if (!s->multiplexed) {
+        CHECK(*cycles > 0);
+        CHECK(*instructions >= loop_iterations);
+        // The loop takes a few instructions per iteration.
+        CHECK(*instructions < 100 * loop_iterations);
+        auto ipc = s->ipc();
+        CHECK(ipc.has_value() && *ipc > 0.05 && *ipc < 16);
+    }
+
+    // Counters only go up.
+    auto after = counters.read();
+    CHECK(after.has_value() && (*after)[1] >= (*before)[1] + *instructions);
+}
+
+void test_sample() {
+    constexpr auto cycles = tsl::perf_event::cycles();
+    constexpr auto instructions = tsl::perf_event::instructions();
+    tsl::perf_sample earlier;
+    earlier.events[0] = cycles;
+    earlier.events[1] = instructions;
+    earlier.count = 2;
+    earlier.values[0] = 100;
+    earlier.values[1] = 50;
+    tsl::perf_sample later = earlier;
+    later.values[0] = 300;
+    later.values[1] = 450;
+
+    auto d = later - earlier;
+    CHECK(d[0] == 200 && d[1] == 400);
+    CHECK(d.ipc().has_value() && *d.ipc() == 2.0);
+    CHECK(!d.get(tsl::perf_event::branch_misses()).has_value());
+    CHECK(!(earlier - earlier).ipc().has_value());
+}
+
+}
+
+int main() {
+    test_sample();
+
+    // Too many events, never opened.
+    tsl::perf_event nine[9] = {};
+    test_unavailable(tsl::perf_counters(nine));
+
+    tsl::perf_counters counters;
+    if (counters.available()) {
+        test_counts(counters);
+        tsl::perf_counters moved(std::move(counters));
+        CHECK(moved.available() && !counters.available());
+        test_unavailable(counters);
+    } else {
+        std::printf("perf counters unavailable, only the empty reads are checked\n");
+        test_unavailable(counters);
+    }
+    return tsl_test::result();
+}
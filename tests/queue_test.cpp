@@ -0,0 +1,172 @@
+// spsc_queue, mpmc_queue and blocking_queue: order, full and empty queues, batches,
+// and no element lost or duplicated between threads.
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "check.hpp"
+#include "tsl/concurrency/blocking_queue.hpp"
+#include "tsl/concurrency/mpmc_queue.hpp"
+#include "tsl/concurrency/spsc_queue.hpp"
+
+namespace {
+
+// A claimed cell can't be released, so constructors that may throw are rejected.
+struct throwing {
+    throwing(int) { }
+};
+
+template<typename Q, typename... Args>
+concept can_emplace = requires(Q& q, Args&&... args) { q.try_emplace(std::forward<Args>(args)...); };
+
+static_assert(!can_emplace<tsl::mpmc_queue<throwing>, int>);
+static_assert(can_emplace<tsl::spsc_queue<throwing>, int>);
+static_assert(can_emplace<tsl::mpmc_queue<std::unique_ptr<int>>, std::unique_ptr<int>>);
+
+template<typename Q>
+void test_order_and_bounds() {
+    Q q(8);
+    CHECK(q.capacity() == 8);
+    CHECK(q.empty() && !q.try_pop().has_value());
+    for (std::uint64_t i = 0; i < 8; ++i)
+        CHECK(q.try_push(i));
+    CHECK(!q.try_push(std::uint64_t(8)));
+    CHECK(q.size() == 8);
+    for (std::uint64_t i = 0; i < 4; ++i)
+        CHECK(*q.try_pop() == i);
+    // Wraps around the buffer.
+    for (std::uint64_t i = 8; i < 12; ++i)
+        CHECK(q.try_push(i));
+    for (std::uint64_t i = 4; i < 12; ++i)
+        CHECK(*q.try_pop() == i);
+    CHECK(q.empty() && !q.try_pop().has_value());
+}
+
+template<typename Q>
+void test_batches() {
+    Q q(16);
+    std::vector<std::uint64_t> in(20);
+    std::iota(in.begin(), in.end(), 0);
+    CHECK(q.try_push_batch(in.begin(), in.begin() + 10) == 10);
+    // Only the free cells are filled.
+    CHECK(q.try_push_batch(in.begin() + 10, in.end()) == 6);
+    CHECK(q.size() == 16);
+
+    std::vector<std::uint64_t> out(20);
+    CHECK(q.try_pop_batch(out.data(), 5) == 5);
+    CHECK(q.try_pop_batch(out.data() + 5, 20) == 11);
+    CHECK(q.try_pop_batch(out.data(), 20) == 0);
+    out.resize(16);
+    CHECK((out == std::vector<std::uint64_t>(in.begin(), in.begin() + 16)));
+}
+
+void test_move_only() {
+    tsl::mpmc_queue<std::unique_ptr<int>> q(4);
+    CHECK(q.try_push(std::make_unique<int>(1)));
+    auto p = std::make_unique<int>(2);
+    CHECK(q.try_push(std::move(p)) && p == nullptr);
+    CHECK(**q.try_pop() == 1);
+    CHECK(**q.try_pop() == 2);
+    // Remaining elements are destroyed with the queue.
+    CHECK(q.try_push(std::make_unique<int>(3)));
+}
+
+// Every producer pushes distinct values, every value comes out once.
+template<typename Q>
+void test_conservation(std::size_t producers, std::size_t consumers) {
+    constexpr std::uint64_t per_producer = 20000;
+    Q q(64);
+    std::vector<std::vector<std::uint64_t>> received(consumers);
+    std::atomic<std::uint64_t> remaining {producers * per_producer};
+    std::vector<std::thread> threads;
+    for (std::size_t c = 0; c < consumers; ++c) {
+        threads.emplace_back([&, c] {
+            while (remaining.load() != 0) {
+                if (auto v = q.try_pop()) {
+                    received[c].push_back(*v);
+                    remaining.fetch_sub(1);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (std::size_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            for (std::uint64_t i = 0; i < per_producer; ++i) {
+                while (!q.try_push(p * per_producer + i))
+                    std::this_thread::yield();
+            }
+        });
+    }
+    for (auto& t : threads)
+        t.join();
+
+    std::vector<int> seen(producers * per_producer);
+    for (auto const& r : received) {
+        // Each producer's values come out in order.
+        std::vector<std::uint64_t> last(producers, 0);
+        std::vector<bool> any(producers, false);
+        for (std::uint64_t v : r) {
+            ++seen[v];
+            std::size_t p = v / per_producer;
+            CHECK(!any[p] || v > last[p]);
+            last[p] = v;
+            any[p] = true;
+        }
+    }
+    CHECK(std::ranges::all_of(seen, [](int n) { return n == 1; }));
+}
+
+void test_blocking() {
+    constexpr std::uint64_t count = 50000;
+    tsl::blocking_mpmc_queue<std::uint64_t> q(16);
+    std::uint64_t sum = 0;
+    std::thread consumer([&] {
+        for (std::uint64_t i = 0; i < count * 2; ++i)
+            sum += q.pop();
+    });
+    std::vector<std::thread> producers;
+    for (int p = 0; p < 2; ++p) {
+        producers.emplace_back([&] {
+            for (std::uint64_t i = 0; i < count; ++i)
+                q.push(i);
+        });
+    }
+    for (auto& t : producers)
+        t.join();
+    consumer.join();
+    CHECK(sum == count * (count - 1));
+    CHECK(q.empty());
+
+    tsl::blocking_spsc_queue<std::uint64_t> s(4);
+    std::thread echo([&] {
+        for (std::uint64_t i = 0; i < count; ++i)
+            CHECK(s.pop() == i);
+    });
+    for (std::uint64_t i = 0; i < count; ++i)
+        s.push(i);
+    echo.join();
+}
+
+}
+
+int main() {
+    test_order_and_bounds<tsl::spsc_queue<std::uint64_t>>();
+    test_order_and_bounds<tsl::mpmc_queue<std::uint64_t>>();
+    test_order_and_bounds<tsl::blocking_spsc_queue<std::uint64_t>>();
+    test_order_and_bounds<tsl::blocking_mpmc_queue<std::uint64_t>>();
+    test_batches<tsl::spsc_queue<std::uint64_t>>();
+    test_batches<tsl::mpmc_queue<std::uint64_t>>();
+    test_move_only();
+    test_conservation<tsl::spsc_queue<std::uint64_t>>(1, 1);
+    test_conservation<tsl::mpmc_queue<std::uint64_t>>(1, 1);
+    test_conservation<tsl::mpmc_queue<std::uint64_t>>(4, 4);
+    test_conservation<tsl::blocking_mpmc_queue<std::uint64_t>>(3, 2);
+    test_blocking();
+    return tsl_test::result();
+}
@@ -0,0 +1,138 @@
+// radix_sort against std::stable_sort: keys of every width, maybe keys, records with
+// equal keys to check stability, and the parallel passes.
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <span>
+#include <utility>
+#include <vector>
+#include "check.hpp"
+#include "tsl/concurrency/thread_pool.hpp"
+#include "tsl/maybe.hpp"
+#include "tsl/types/non_negative.hpp"
+#include "tsl/util/radix_sort.hpp"
+
+namespace {
+
+template<typename T>
+std::vector<tsl::non_negative<T>> random_keys(std::size_t n, std::uint64_t max, std::uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<tsl::non_negative<T>> keys;
+    keys.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+        keys.emplace_back(tsl::unchecked, static_cast<T>(rng() % (max + 1)));
+    return keys;
+}
+
+template<typename T>
+bool same_keys(std::vector<tsl::non_negative<T>> const& a, std::vector<tsl::non_negative<T>> const& b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                      [](auto const& x, auto const& y) { return x.raw() == y.raw(); });
+}
+
+template<typename T>
+void test_keys(tsl::thread_pool& pool) {
+    constexpr auto max = static_cast<std::uint64_t>(std::numeric_limits<T>::max());
+    std::uint64_t seed = sizeof(T);
+    // Sizes below and above the small-size cutoff and the parallel grain; ranges with
+    // one distinct high byte, and the full range.
+    for (std::size_t n : {0, 1, 100, 255, 256, 1000, 70000, 200000}) {
+        for (std::uint64_t range : {std::uint64_t(0), std::uint64_t(255), std::uint64_t(65535), max}) {
+            auto keys = random_keys<T>(n, std::min(range, max), ++seed);
+            auto expected = keys;
+            std::stable_sort(expected.begin(), expected.end(),
+                             [](auto const& a, auto const& b) { return a.raw() < b.raw(); });
+
+            auto sorted = keys;
+            tsl::radix_sort(sorted);
+            CHECK(same_keys(sorted, expected));
+
+            sorted = keys;
+            tsl::radix_sort(pool, sorted);
+            CHECK(same_keys(sorted, expected));
+        }
+    }
+}
+
+void test_maybe_keys() {
+    using key = tsl::maybe<tsl::non_negative<int>>;
+    std::mt19937_64 rng(11);
+    std::vector<key> keys(5000);
+    for (auto& k : keys) {
+        if (rng() % 4 != 0)
+            k = tsl::non_negative<int>(tsl::unchecked, static_cast<int>(rng() % 100000));
+    }
+    tsl::radix_sort(keys);
+    // Empty values first, then ascending.
+    auto first_value = std::find_if(keys.begin(), keys.end(), [](key const& k) { return k.has_value(); });
+    CHECK(std::none_of(first_value, keys.end(), [](key const& k) { return !k.has_value(); }));
+    CHECK(std::is_sorted(first_value, keys.end(),
+                         [](key const& a, key const& b) { return a->raw() < b->raw(); }));
+}
+
+// Any mutable contiguous array sorts in place, and only its own elements.
+template<typename R>
+concept sorts = requires(R&& r) { tsl::radix_sort(std::forward<R>(r)); };
+static_assert(sorts<std::vector<tsl::non_negative<int>>&> && sorts<std::span<tsl::non_negative<int>>>);
+static_assert(!sorts<std::vector<tsl::non_negative<int>> const&> && !sorts<std::span<tsl::non_negative<int> const>>);
+static_assert(!sorts<std::vector<int>&>);
+
+void test_arrays() {
+    auto keys = random_keys<int>(1000, 5000, 3);
+    std::array<tsl::non_negative<int>, 1000> array;
+    std::copy(keys.begin(), keys.end(), array.begin());
+    tsl::radix_sort(array);
+    CHECK(std::is_sorted(array.begin(), array.end(),
+                         [](auto const& a, auto const& b) { return a.raw() < b.raw(); }));
+
+    auto expected = keys;
+    std::stable_sort(expected.begin() + 300, expected.end(),
+                     [](auto const& a, auto const& b) { return a.raw() < b.raw(); });
+    tsl::radix_sort(std::span(keys).subspan(300));
+    CHECK(same_keys(keys, expected));
+}
+
+struct record {
+    tsl::non_negative<long> key;
+    std::size_t order = 0;
+};
+
+void test_stability(tsl::thread_pool& pool) {
+    for (std::size_t n : {200, 5000, 150000}) {
+        std::mt19937_64 rng(n);
+        std::vector<record> records(n);
+        for (std::size_t i = 0; i < n; ++i)
+            records[i] = record{tsl::non_negative<long>(tsl::unchecked, static_cast<long>(rng() % 50) << 20), i};
+        auto expected = records;
+        std::stable_sort(expected.begin(), expected.end(),
+                         [](record const& a, record const& b) { return a.key.raw() < b.key.raw(); });
+
+        auto by_key = [](record const& r) { return r.key; };
+        auto sorted = records;
+        tsl::radix_sort_by_key(sorted, by_key);
+        CHECK(std::equal(sorted.begin(), sorted.end(), expected.begin(),
+                         [](record const& a, record const& b) { return a.order == b.order; }));
+
+        sorted = records;
+        tsl::radix_sort_by_key(pool, sorted, by_key);
+        CHECK(std::equal(sorted.begin(), sorted.end(), expected.begin(),
+                         [](record const& a, record const& b) { return a.order == b.order; }));
+    }
+}
+
+}
+
+int main() {
+    tsl::thread_pool pool(tsl::thread_pool_options{.threads = 4});
+    test_keys<std::int8_t>(pool);
+    test_keys<std::int16_t>(pool);
+    test_keys<int>(pool);
+    test_keys<long>(pool);
+    test_maybe_keys();
+    test_arrays();
+    test_stability(pool);
+    return tsl_test::result();
+}
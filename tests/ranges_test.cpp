@@ -0,0 +1,113 @@
+// views::engaged and actions::collect_engaged: every element of the base is
+// dereferenced once, and rvalue containers are moved from.
+#include <array>
+#include <memory>
+#include <ranges>
+#include <string>
+#include <vector>
+#include "check.hpp"
+#include "tsl/ranges.hpp"
+
+namespace {
+
+std::vector<tsl::maybe<int>> sample() {
+    return {tsl::maybe<int>(), tsl::maybe<int>(1), tsl::maybe<int>(), tsl::maybe<int>(2),
+            tsl::maybe<int>(3), tsl::maybe<int>()};
+}
+
+void test_engaged_lvalues() {
+    auto v = sample();
+    std::vector<int> seen;
+    for (int& x : v | tsl::views::engaged) {
+        seen.push_back(x);
+        x *= 10;
+    }
+    CHECK((seen == std::vector<int>{1, 2, 3}));
+    CHECK(*v[1] == 10 && *v[4] == 30);
+}
+
+void test_engaged_prvalues_dereference_once() {
+    auto v = sample();
+    int calls = 0;
+    auto copies = v | std::views::transform([&](tsl::maybe<int> const& m) {
+        ++calls;
+        return m;
+    });
+    std::vector<int> seen;
+    auto engaged = copies | tsl::views::engaged;
+    for (auto it = engaged.begin(); it != engaged.end(); ++it) {
+        seen.push_back(*it);
+        CHECK(*it == seen.back());
+    }
+    CHECK((seen == std::vector<int>{1, 2, 3}));
+    CHECK(calls == static_cast<int>(v.size()));
+
+    // begin() is cached with its value.
+    calls = 0;
+    CHECK(*engaged.begin() == 1 && *engaged.begin() == 1);
+    CHECK(calls == 0);
+}
+
+// The cached begin() points into the base, moving the view drops it.
+void test_owning_base_cache() {
+    using array = std::array<tsl::maybe<int>, 3>;
+    auto make = [](int v) {
+        return std::ranges::owning_view(array{tsl::maybe<int>(), tsl::maybe<int>(v), tsl::maybe<int>()})
+             | tsl::views::engaged;
+    };
+    using view = decltype(make(0));
+
+    auto source = std::make_unique<view>(make(4));
+    CHECK(*source->begin() == 4);
+    view moved(std::move(*source));
+    source.reset();
+    CHECK(*moved.begin() == 4 && std::ranges::distance(moved) == 1);
+
+    source = std::make_unique<view>(make(5));
+    CHECK(*source->begin() == 5);
+    moved = std::move(*source);
+    source.reset();
+    CHECK(*moved.begin() == 5 && std::ranges::distance(moved) == 1);
+}
+
+void test_collect_engaged() {
+    auto v = sample();
+    CHECK((v | tsl::actions::collect_engaged) == (std::vector<int>{1, 2, 3}));
+
+    int calls = 0;
+    auto copies = v | std::views::transform([&](tsl::maybe<int> const& m) {
+        ++calls;
+        return m;
+    });
+    CHECK((copies | tsl::actions::collect_engaged) == (std::vector<int>{1, 2, 3}));
+    CHECK(calls == static_cast<int>(v.size()));
+}
+
+void test_collect_engaged_moves() {
+    std::vector<tsl::maybe<std::unique_ptr<int>>> v;
+    v.emplace_back(std::make_unique<int>(1));
+    v.emplace_back();
+    v.emplace_back(std::make_unique<int>(2));
+    std::vector<std::unique_ptr<int>> out = std::move(v) | tsl::actions::collect_engaged;
+    CHECK(out.size() == 2 && *out[0] == 1 && *out[1] == 2);
+
+    std::vector<tsl::maybe<std::string>> strings;
+    strings.emplace_back(std::string(64, 'a'));
+    strings.emplace_back();
+    auto copied = strings | tsl::actions::collect_engaged;
+    CHECK(copied.size() == 1 && *strings[0] == std::string(64, 'a'));
+    auto moved = std::move(strings) | tsl::actions::collect_engaged;
+    CHECK(moved.size() == 1 && moved[0] == std::string(64, 'a'));
+    CHECK(strings[0]->empty());
+}
+
+}
+
+int main() {
+    test_engaged_lvalues();
+    test_engaged_prvalues_dereference_once();
+    test_owning_base_cache();
+    test_collect_engaged();
+    test_collect_engaged_moves();
+    return tsl_test::result();
+}
@@ -0,0 +1,265 @@
+// serialize: round trips, and rejection of truncated input and of values that break
+// a contract, at the top level and inside aggregates, containers and maybe. Views into
+// the input, literal_string, and the niche encoding of maybe.
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "check.hpp"
+#include "tsl/containers/flat_map.hpp"
+#include "tsl/maybe.hpp"
+#include "tsl/serialize.hpp"
+#include "tsl/literal_string.hpp"
+#include "tsl/types/contracts.hpp"
+#include "tsl/types/non_negative.hpp"
+
+namespace {
+
+struct point {
+    std::int32_t x;
+    std::int32_t y;
+
+    friend bool operator==(point const&, point const&) = default;
+};
+
+struct sample {
+    tsl::non_negative<int> count;
+    int delta;
+};
+
+struct flagged {
+    bool on;
+    std::uint8_t level;
+};
+
+struct message {
+    std::string name;
+    tsl::non_negative<long> id;
+    tsl::maybe<int> code;
+    std::vector<point> path;
+    tsl::flat_map<std::string, int> tags;
+    std::array<std::uint16_t, 3> version;
+    std::array<tsl::non_negative<int>, 2> limits;
+};
+
+// Written as bytes: no padding, every pattern valid.
+struct rgba {
+    std::uint8_t r, g, b, a;
+};
+
+}
+
+template<>
+struct tsl::serialize_as_bytes<rgba> : std::true_type { };
+
+namespace {
+
+// A contract type without a serializer of its own: written as its underlying int.
+class even : public tsl::contract_base {
+public:
+    using type = int;
+
+    constexpr even(tsl::contract_breach_t) noexcept : value_(1) { }
+    constexpr even(int v) : value_(v) { TSL_ASSERT(is_valid()); }
+    constexpr even(tsl::unchecked_t, int v) noexcept : value_(v) { }
+
+    constexpr even& operator=(tsl::contract_breach_t) noexcept {
+        value_ = 1;
+        return *this;
+    }
+
+    [[nodiscard]] constexpr bool is_valid() const noexcept { return value_ % 2 == 0; }
+
+    constexpr int& raw() & noexcept { return value_; }
+    constexpr int const& raw() const& noexcept { return value_; }
+    constexpr int&& raw() && noexcept { return std::move(value_); }
+    constexpr int const&& raw() const&& noexcept { return std::move(value_); }
+
+private:
+    int value_;
+};
+
+static_assert(tsl::ContractType<even>);
+
+std::vector<std::byte> written(auto const&... values) {
+    std::vector<std::byte> out;
+    tsl::writer w(out);
+    (w.write(values), ...);
+    return out;
+}
+
+void test_round_trip() {
+    message m;
+    m.name = "probe";
+    m.id = tsl::non_negative<long>(tsl::unchecked, 1234567);
+    m.code = 42;
+    m.path = {{1, 2}, {-3, 4}};
+    m.tags["a"] = 1;
+    m.tags["bc"] = -2;
+    m.version = {1, 2, 3};
+    m.limits = {tsl::non_negative<int>(tsl::unchecked, 5), tsl::non_negative<int>(tsl::unchecked, 0)};
+
+    auto bytes = tsl::serialize(m);
+    auto back = tsl::deserialize<message>(bytes);
+    CHECK(back.has_value());
+    if (back.has_value()) {
+        CHECK(back->name == "probe");
+        CHECK(back->id.raw() == 1234567);
+        CHECK(back->code.has_value() && *back->code == 42);
+        CHECK(back->path == m.path);
+        CHECK(back->tags.size() == 2 && back->tags.at("bc") == -2);
+        CHECK(back->version == m.version);
+        CHECK(back->limits[0].raw() == 5 && back->limits[1].raw() == 0);
+    }
+
+    // Every strict prefix is truncated.
+    for (std::size_t n = 0; n < bytes.size(); ++n)
+        CHECK(!tsl::deserialize<message>(std::span(bytes.data(), n)).has_value());
+
+    auto color = tsl::deserialize<rgba>(tsl::serialize(rgba{1, 2, 3, 4}));
+    CHECK(color.has_value() && color->a == 4);
+}
+
+// Aggregates are read member by member, so their contract members are checked.
+void test_invalid_members() {
+    static_assert(!tsl::internal_serialize::raw<sample>);
+
+    std::vector<std::byte> valid = tsl::serialize(sample{tsl::non_negative<int>(tsl::unchecked, 5), -5});
+    auto s = tsl::deserialize<sample>(valid);
+    CHECK(s.has_value() && s->count.raw() == 5 && s->delta == -5);
+
+    // The count of {-5, 1} reinterpreted as unsigned, a complete varint past INT_MAX.
+    std::vector<std::byte> forged;
+    tsl::writer(forged).varint(static_cast<std::uint32_t>(-5));
+    tsl::writer(forged).write(1);
+    CHECK(!tsl::deserialize<sample>(forged).has_value());
+    std::vector<std::byte> honest;
+    tsl::writer(honest).varint(5);
+    tsl::writer(honest).write(1);
+    CHECK(tsl::deserialize<sample>(honest).has_value());
+
+    // A varint past INT_MAX.
+    std::vector<std::byte> big;
+    tsl::writer(big).varint(std::uint64_t(1) << 40);
+    CHECK(!tsl::deserialize<tsl::non_negative<int>>(big).has_value());
+    CHECK(tsl::deserialize<tsl::non_negative<long>>(big).has_value());
+
+    std::vector<std::byte> flag = tsl::serialize(flagged{true, 7});
+    CHECK(tsl::deserialize<flagged>(flag).has_value());
+    flag[0] = std::byte{2};
+    CHECK(!tsl::deserialize<flagged>(flag).has_value());
+
+    // Invalid elements inside a vector and a std::array.
+    std::vector<sample> many(3, sample{tsl::non_negative<int>(tsl::unchecked, 1), 0});
+    auto vec_bytes = tsl::serialize(many);
+    CHECK(tsl::deserialize<std::vector<sample>>(vec_bytes).has_value());
+    auto two_samples = [](std::uint64_t second_count) {
+        std::vector<std::byte> out;
+        tsl::writer w(out);
+        w.varint(2);
+        w.varint(1);
+        w.write(0);
+        w.varint(second_count);
+        w.write(0);
+        return out;
+    };
+    CHECK(tsl::deserialize<std::vector<sample>>(two_samples(3)).has_value());
+    CHECK(!tsl::deserialize<std::vector<sample>>(two_samples(std::uint64_t(1) << 31)).has_value());
+
+    auto arr = tsl::deserialize<std::array<flagged, 1>>(std::vector<std::byte>{std::byte{3}, std::byte{0}});
+    CHECK(!arr.has_value());
+}
+
+void test_contract_type() {
+    auto four = tsl::deserialize<even>(tsl::serialize(even(4)));
+    CHECK(four.has_value() && four->raw() == 4);
+    // A complete int that breaks the contract.
+    CHECK(!tsl::deserialize<even>(written(3)).has_value());
+    CHECK(!tsl::deserialize<even>(written(-7)).has_value());
+    CHECK(tsl::deserialize<even>(written(-8)).has_value());
+
+    // maybe<even> has no presence byte, the breach value is the empty state.
+    using opt = tsl::maybe<even>;
+    static_assert(sizeof(opt) == sizeof(int));
+    auto empty = tsl::serialize(opt());
+    CHECK(empty == written(1));
+    auto e = tsl::deserialize<opt>(empty);
+    CHECK(e.has_value() && !e->has_value());
+    auto full = tsl::serialize(opt(even(6)));
+    CHECK(full == written(6));
+    auto f = tsl::deserialize<opt>(full);
+    CHECK(f.has_value() && f->has_value() && (*f)->raw() == 6);
+    CHECK(!tsl::deserialize<opt>(std::vector<std::byte>(3)).has_value());
+}
+
+void test_view() {
+    auto bytes = tsl::serialize(std::string("in place"));
+    auto name = tsl::deserialize_view<std::string>(bytes);
+    CHECK(name.has_value() && *name == "in place");
+    CHECK(name.has_value() && static_cast<void const*>(name->data()) == bytes.data() + 1);
+
+    std::vector<std::uint32_t> numbers {1, 2, 3, 0xdeadbeef};
+    auto encoded = tsl::serialize(numbers);
+    // A byte of size, padded to the alignment of the elements.
+    CHECK(encoded.size() == 4 + numbers.size() * 4);
+    auto span = tsl::deserialize_view<std::vector<std::uint32_t>>(encoded);
+    CHECK(span.has_value() && span->size() == 4 && (*span)[3] == 0xdeadbeef);
+    CHECK(span.has_value() && static_cast<void const*>(span->data()) == encoded.data() + 4);
+
+    // The same message one byte off: the view is rejected, a copy isn't.
+    alignas(8) std::byte shifted[64];
+    std::memcpy(shifted + 1, encoded.data(), encoded.size());
+    std::span<std::byte const> misaligned(shifted + 1, encoded.size());
+    CHECK(!tsl::deserialize_view<std::vector<std::uint32_t>>(misaligned).has_value());
+    auto copy = tsl::deserialize<std::vector<std::uint32_t>>(misaligned);
+    CHECK(copy.has_value() && *copy == numbers);
+
+    // Truncated or followed by extra bytes.
+    CHECK(!tsl::deserialize_view<std::string>(std::span(bytes.data(), bytes.size() - 1)).has_value());
+    bytes.push_back(std::byte{0});
+    CHECK(!tsl::deserialize_view<std::string>(bytes).has_value());
+}
+
+void test_literal_string() {
+    tsl::literal_string<8> word("abc", 3);
+    auto bytes = tsl::serialize(word);
+    CHECK(bytes.size() == 4);
+    auto back = tsl::deserialize<tsl::literal_string<8>>(bytes);
+    CHECK(back.has_value() && std::string_view(back->data) == "abc");
+
+    auto empty = tsl::deserialize<tsl::literal_string<8>>(tsl::serialize(tsl::literal_string<8>()));
+    CHECK(empty.has_value() && empty->data[0] == '\0');
+
+    // Seven characters and the terminator fit in 8, eight don't.
+    CHECK(tsl::deserialize<tsl::literal_string<8>>(tsl::serialize(std::string("1234567"))).has_value());
+    CHECK(!tsl::deserialize<tsl::literal_string<8>>(tsl::serialize(std::string("12345678"))).has_value());
+}
+
+void test_maybe() {
+    using opt = tsl::maybe<tsl::non_negative<int>>;
+    auto empty = tsl::serialize(opt());
+    CHECK(empty.size() == 1);
+    auto e = tsl::deserialize<opt>(empty);
+    CHECK(e.has_value() && !e->has_value());
+    auto seven = tsl::deserialize<opt>(tsl::serialize(opt(tsl::non_negative<int>(tsl::unchecked, 7))));
+    CHECK(seven.has_value() && seven->has_value() && (*seven)->raw() == 7);
+
+    auto bad_presence = tsl::deserialize<tsl::maybe<int>>(std::vector<std::byte>{std::byte{2}, {}, {}, {}, {}});
+    CHECK(!bad_presence.has_value());
+}
+
+}
+
+int main() {
+    test_round_trip();
+    test_invalid_members();
+    test_contract_type();
+    test_view();
+    test_literal_string();
+    test_maybe();
+    return tsl_test::result();
+}
@@ -0,0 +1,271 @@
+// small_vector: insertions and erasures, including of its own elements, against
+// std::vector; growth, swap and shrink_to_fit across inline and heap storage; and
+// arena_allocator staying with the vector that uses it.
+#include <algorithm>
+#include <cstddef>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "check.hpp"
+#include "tsl/containers/small_vector.hpp"
+#include "tsl/memory/arena.hpp"
+
+namespace {
+
+template<typename V>
+bool same(V const& v, std::vector<typename V::value_type> const& expected) {
+    return v.size() == expected.size() && std::equal(v.begin(), v.end(), expected.begin());
+}
+
+// Not trivially relocatable: it points to itself, and counts live instances.
+struct tracked {
+    static inline int live = 0;
+
+    int value;
+    tracked const* self;
+
+    tracked(int v = 0) : value(v), self(this) { ++live; }
+    tracked(tracked const& other) : value(other.value), self(this) { ++live; }
+    tracked(tracked&& other) noexcept : value(std::exchange(other.value, -1)), self(this) { ++live; }
+    ~tracked() { --live; }
+
+    tracked& operator=(tracked const& other) {
+        value = other.value;
+        return *this;
+    }
+
+    tracked& operator=(tracked&& other) noexcept {
+        value = std::exchange(other.value, -1);
+        return *this;
+    }
+
+    bool intact() const { return self == this; }
+
+    friend bool operator==(tracked const& a, tracked const& b) { return a.value == b.value; }
+};
+
+static_assert(!tsl::is_trivially_relocatable_v<tracked>);
+
+template<typename V>
+bool intact(V const& v) {
+    return std::all_of(v.begin(), v.end(), [](tracked const& t) { return t.intact(); });
+}
+
+void test_random_edits() {
+    std::mt19937 rng(42);
+    tsl::small_vector<std::string, 4> v;
+    std::vector<std::string> expected;
+    for (int step = 0; step < 2000; ++step) {
+        auto pick = [&](std::size_t n) { return static_cast<std::size_t>(rng() % (n + 1)); };
+        std::string s = std::to_string(step) + std::string(step % 20, 'x');
+        switch (rng() % 6) {
+        case 0:
+            v.push_back(s);
+            expected.push_back(s);
+            break;
+        case 1: {
+            std::size_t i = pick(v.size());
+            v.insert(v.begin() + i, s);
+            expected.insert(expected.begin() + i, s);
+            break;
+        }
+        case 2: {
+            std::size_t i = pick(v.size());
+            std::size_t n = pick(3);
+            v.insert(v.begin() + i, n, s);
+            expected.insert(expected.begin() + i, n, s);
+            break;
+        }
+        case 3:
+            if (!v.empty()) {
+                std::size_t i = pick(v.size() - 1);
+                v.erase(v.begin() + i);
+                expected.erase(expected.begin() + i);
+            }
+            break;
+        case 4: {
+            std::size_t i = pick(v.size());
+            std::size_t j = i + pick(v.size() - i);
+            v.erase(v.begin() + i, v.begin() + j);
+            expected.erase(expected.begin() + i, expected.begin() + j);
+            break;
+        }
+        case 5: {
+            std::string more[] = {s, s + "!"};
+            std::size_t i = pick(v.size());
+            v.insert(v.begin() + i, std::begin(more), std::end(more));
+            expected.insert(expected.begin() + i, std::begin(more), std::end(more));
+            break;
+        }
+        }
+        CHECK(same(v, expected));
+        if (v.size() > 40) {
+            v.clear();
+            expected.clear();
+        }
+    }
+}
+
+// Inserting a copy of an element, while there is room and when the insertion grows.
+void test_self_insert() {
+    for (std::size_t size = 1; size <= 8; ++size) {
+        for (std::size_t i = 0; i < size; ++i) {
+            for (std::size_t pos = 0; pos <= size; ++pos) {
+                tsl::small_vector<std::string, 4> v;
+                std::vector<std::string> expected;
+                for (std::size_t k = 0; k < size; ++k) {
+                    v.push_back("element " + std::to_string(k));
+                    expected.push_back("element " + std::to_string(k));
+                }
+                v.insert(v.begin() + pos, v[i]);
+                expected.insert(expected.begin() + pos, expected[i]);
+                CHECK(same(v, expected));
+
+                v.insert(v.begin() + pos, 3, v[i]);
+                expected.insert(expected.begin() + pos, 3, expected[i]);
+                CHECK(same(v, expected));
+
+                v.emplace_back(v.front());
+                expected.emplace_back(expected.front());
+                CHECK(same(v, expected));
+            }
+        }
+    }
+}
+
+void test_growth() {
+    {
+        tsl::small_vector<tracked, 3> v;
+        CHECK(v.is_inline() && v.capacity() == 3);
+        for (int i = 0; i < 3; ++i)
+            v.emplace_back(i);
+        CHECK(v.is_inline());
+        v.emplace_back(3);
+        CHECK(!v.is_inline() && v.capacity() >= 4);
+        for (int i = 4; i < 100; ++i)
+            v.emplace_back(i);
+        CHECK(v.size() == 100 && intact(v));
+        for (int i = 0; i < 100; ++i)
+            CHECK(v[static_cast<std::size_t>(i)].value == i);
+        CHECK(tracked::live == 100);
+
+        v.insert(v.begin() + 1, v[50]);
+        CHECK(v[1].value == 50 && v.size() == 101 && intact(v));
+        v.erase(v.begin(), v.begin() + 90);
+        CHECK(v.size() == 11 && tracked::live == 11 && intact(v));
+        v.resize(2);
+        CHECK(tracked::live == 2);
+    }
+    CHECK(tracked::live == 0);
+}
+
+void test_swap() {
+    auto make = [](int first, int n) {
+        tsl::small_vector<tracked, 4> v;
+        for (int i = 0; i < n; ++i)
+            v.emplace_back(first + i);
+        return v;
+    };
+    auto values = [](int first, int n) {
+        std::vector<tracked> v;
+        for (int i = 0; i < n; ++i)
+            v.emplace_back(first + i);
+        return v;
+    };
+    for (int n : {0, 2, 4, 9}) {
+        for (int m : {0, 3, 4, 12}) {
+            auto a = make(0, n);
+            auto b = make(100, m);
+            tracked const* a_data = a.data();
+            tracked const* b_data = b.data();
+            bool both_heap = !a.is_inline() && !b.is_inline();
+            a.swap(b);
+            CHECK(same(a, values(100, m)) && same(b, values(0, n)));
+            CHECK(intact(a) && intact(b));
+            CHECK(a.is_inline() == (m <= 4) && b.is_inline() == (n <= 4));
+            // Heap buffers change hands, inline elements can't.
+            if (both_heap)
+                CHECK(a.data() == b_data && b.data() == a_data);
+            swap(a, b);
+            CHECK(same(a, values(0, n)) && same(b, values(100, m)));
+        }
+    }
+    CHECK(tracked::live == 0);
+}
+
+void test_shrink_to_fit() {
+    {
+        tsl::small_vector<tracked, 4> v;
+        for (int i = 0; i < 20; ++i)
+            v.emplace_back(i);
+        v.erase(v.begin() + 10, v.end());
+        v.shrink_to_fit();
+        CHECK(!v.is_inline() && v.capacity() == 10);
+        CHECK(same(v, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9}) && intact(v));
+
+        v.erase(v.begin(), v.begin() + 7);
+        v.shrink_to_fit();
+        CHECK(v.is_inline() && v.capacity() == 4);
+        CHECK(same(v, {7, 8, 9}) && intact(v));
+        CHECK(tracked::live == 3);
+
+        v.shrink_to_fit();
+        CHECK(v.is_inline() && same(v, {7, 8, 9}));
+    }
+    CHECK(tracked::live == 0);
+}
+
+template<typename V>
+tsl::arena const* arena_of(V const& v) {
+    return &v.get_allocator().get_arena();
+}
+
+// arena_allocator doesn't propagate on assignment or swap, and copies select the source's arena.
+void test_arena_allocator() {
+    using alloc = tsl::arena_allocator<int>;
+    using vector = tsl::small_vector<int, 2, alloc>;
+    tsl::arena a1;
+    tsl::arena a2;
+
+    vector v{{1, 2, 3, 4, 5}, alloc(a1)};
+    CHECK(!v.is_inline() && arena_of(v) == &a1);
+    CHECK(a1.reserved() != 0 && a2.reserved() == 0);
+
+    vector copy(v);
+    CHECK(arena_of(copy) == &a1 && copy == v);
+
+    vector moved(std::move(copy));
+    CHECK(arena_of(moved) == &a1 && moved == v && copy.empty());
+
+    // Another arena: the elements are moved one by one into memory from a2.
+    vector other(std::move(moved), alloc(a2));
+    CHECK(arena_of(other) == &a2 && other == v && moved.empty());
+    CHECK(a2.reserved() != 0);
+
+    vector assigned{alloc(a2)};
+    assigned = v;
+    CHECK(arena_of(assigned) == &a2 && assigned == v);
+    vector from_a1{{7, 8, 9}, alloc(a1)};
+    assigned = std::move(from_a1);
+    CHECK(arena_of(assigned) == &a2 && same(assigned, {7, 8, 9}));
+
+    // Heap buffers from different arenas stay where they are.
+    int const* v_data = v.data();
+    v.swap(assigned);
+    CHECK(arena_of(v) == &a1 && arena_of(assigned) == &a2);
+    CHECK(same(v, {7, 8, 9}) && same(assigned, {1, 2, 3, 4, 5}));
+    CHECK(assigned.data() != v_data);
+}
+
+}
+
+int main() {
+    test_random_edits();
+    test_self_insert();
+    test_growth();
+    test_swap();
+    test_shrink_to_fit();
+    test_arena_allocator();
+    return tsl_test::result();
+}
@@ -0,0 +1,163 @@
+// string_builder: long pieces borrowed and short ones copied and merged, integer
+// formatting, copy_to with a small buffer, and clear() reusing the builder's arena.
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+#include "check.hpp"
+#include "tsl/memory/arena.hpp"
+#include "tsl/util/string_builder.hpp"
+
+namespace {
+
+char const* base(tsl::string_builder::iovec const& v) {
+    return static_cast<char const*>(v.iov_base);
+}
+
+std::size_t total(tsl::string_builder const& b) {
+    std::size_t n = 0;
+    for (auto const& v : b.iovecs())
+        n += v.iov_len;
+    return n;
+}
+
+void test_pieces() {
+    std::string long_piece(100, 'L');
+    std::string short_piece = "short";
+
+    tsl::string_builder b;
+    b.append(short_piece).append('+').append(42);
+    // Adjacent copies share a piece, which doesn't point into the source.
+    CHECK(b.piece_count() == 1 && b.size() == 8);
+    CHECK(base(b.iovecs()[0]) != short_piece.data());
+
+    b.append(long_piece);
+    CHECK(b.piece_count() == 2);
+    CHECK(base(b.iovecs()[1]) == long_piece.data() && b.iovecs()[1].iov_len == 100);
+
+    b.append("x").append(std::string_view("yz"));
+    CHECK(b.piece_count() == 3 && b.iovecs()[2].iov_len == 3);
+
+    // Exactly the threshold is copied, one more is borrowed.
+    std::string at_threshold(tsl::string_builder::inline_threshold, 'T');
+    std::string over_threshold(tsl::string_builder::inline_threshold + 1, 'O');
+    b.append(at_threshold);
+    CHECK(b.piece_count() == 3);
+    b.append(over_threshold);
+    CHECK(b.piece_count() == 4 && base(b.iovecs()[3]) == over_threshold.data());
+
+    // Temporaries are copied whatever their size.
+    b.append(std::string(50, 't'));
+    CHECK(b.piece_count() == 5 && b.iovecs()[4].iov_len == 50);
+    b.append_copy(long_piece);
+    CHECK(b.piece_count() == 5 && base(b.iovecs()[4]) != long_piece.data());
+
+    std::string expected = "short+42" + long_piece + "xyz" + at_threshold + over_threshold
+        + std::string(50, 't') + long_piece;
+    CHECK(b.size() == expected.size() && total(b) == expected.size());
+    CHECK(b.str() == expected);
+
+    b += "!";
+    b += 7;
+    CHECK(b.str() == expected + "!7");
+}
+
+// Copies spill over several arena blocks.
+void test_many_copies() {
+    tsl::string_builder b;
+    std::string expected;
+    for (int i = 0; i < 500; ++i) {
+        b.append(i).append(',');
+        expected += std::to_string(i) + ",";
+    }
+    CHECK(b.str() == expected && b.size() == expected.size());
+    CHECK(b.piece_count() > 1 && b.piece_count() < expected.size() / 100);
+}
+
+void test_integers() {
+    tsl::string_builder b;
+    b.append(0).append(' ').append(-1).append(' ');
+    b.append(std::numeric_limits<std::int64_t>::min()).append(' ');
+    b.append(std::numeric_limits<std::uint64_t>::max()).append(' ');
+    b.append(std::int8_t(-128)).append(' ').append(static_cast<unsigned char>(200)).append(' ');
+    b.append(static_cast<unsigned short>(65535)).append(' ').append(123456789L);
+    CHECK(b.str() == "0 -1 -9223372036854775808 18446744073709551615 -128 200 65535 123456789");
+}
+
+void test_copy_to() {
+    std::string long_piece(40, 'L');
+    tsl::string_builder b;
+    b.append("head ").append(long_piece).append(" tail");
+    std::string expected = "head " + long_piece + " tail";
+
+    char small[49];
+    std::memset(small, '#', sizeof(small));
+    CHECK(!b.copy_to(small).has_value());
+    // Nothing is written.
+    CHECK(std::string_view(small, sizeof(small)) == std::string(sizeof(small), '#'));
+
+    char exact[50];
+    auto n = b.copy_to(exact);
+    CHECK(n.has_value() && *n == 50 && std::string_view(exact, 50) == expected);
+
+    char large[64];
+    n = b.copy_to(large);
+    CHECK(n.has_value() && *n == 50 && std::string_view(large, 50) == expected);
+
+    tsl::string_builder empty;
+    CHECK(empty.copy_to(std::span<char>()) == tsl::maybe<std::size_t>(0));
+    CHECK(empty.str().empty() && empty.empty());
+}
+
+void test_clear() {
+    tsl::string_builder b;
+    b.append("first");
+    char const* first = base(b.iovecs()[0]);
+    b.clear();
+    CHECK(b.empty() && b.piece_count() == 0 && b.str().empty());
+    // The builder's own arena starts over.
+    b.append("again");
+    CHECK(b.piece_count() == 1 && base(b.iovecs()[0]) == first && b.str() == "again");
+
+    // Copies to a caller's arena stay, the next ones go after them.
+    tsl::arena a;
+    tsl::string_builder c(a);
+    c.append("kept");
+    char const* kept = base(c.iovecs()[0]);
+    c.clear();
+    c.append("next");
+    CHECK(base(c.iovecs()[0]) != kept);
+    CHECK(std::string_view(kept, 4) == "kept" && c.str() == "next");
+}
+
+void test_writev() {
+#if TSL_INTERNAL_HAS_IOVEC
+    std::string long_piece(64, 'w');
+    tsl::string_builder b;
+    b.append("status ").append(200).append('\n').append(long_piece).append("\nend");
+    std::FILE* f = std::tmpfile();
+    auto written = ::writev(::fileno(f), b.iovecs().data(), static_cast<int>(b.iovecs().size()));
+    CHECK(written == static_cast<ssize_t>(b.size()));
+    std::string read(b.size(), '\0');
+    std::rewind(f);
+    CHECK(std::fread(read.data(), 1, read.size(), f) == read.size());
+    CHECK(read == b.str());
+    std::fclose(f);
+#endif
+}
+
+}
+
+int main() {
+    test_pieces();
+    test_many_copies();
+    test_integers();
+    test_copy_to();
+    test_clear();
+    test_writev();
+    return tsl_test::result();
+}
@@ -0,0 +1,199 @@
+// thread_pool and the parallel loops: submitted tasks all run, from any thread and
+// from workers, parallel_for covers every index once, parallel_reduce matches a
+// serial loop, and destroying the pool runs the tasks still queued.
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "check.hpp"
+#include "tsl/concurrency/parallel.hpp"
+#include "tsl/concurrency/thread_pool.hpp"
+#include "tsl/config.hpp"
+
+namespace {
+
+tsl::thread_pool_options with_threads(std::size_t n) {
+    tsl::thread_pool_options options;
+    options.threads = n;
+    return options;
+}
+
+// Waits for `count` to reach `n`, tasks notify the pool as they finish.
+void wait_until(tsl::thread_pool& pool, std::atomic<int>& count, int n) {
+    pool.wait_for([&] { return count.load(std::memory_order_acquire) == n; });
+}
+
+void test_submit() {
+    tsl::thread_pool pool(with_threads(4));
+    CHECK(pool.size() == 4);
+    CHECK(tsl::thread_pool::current() == nullptr);
+
+    std::atomic<int> done {0};
+    std::atomic<int> on_workers {0};
+    constexpr int tasks = 1000;
+    for (int i = 0; i < tasks; ++i) {
+        pool.submit([&] {
+            if (tsl::thread_pool::current() == &pool)
+                ++on_workers;
+            done.fetch_add(1, std::memory_order_release);
+            pool.notify_completion();
+        });
+    }
+    wait_until(pool, done, tasks);
+    CHECK(done == tasks && on_workers == tasks);
+
+    // From several threads at once.
+    done = 0;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < tasks; ++i) {
+                pool.submit([&] {
+                    done.fetch_add(1, std::memory_order_release);
+                    pool.notify_completion();
+                });
+            }
+        });
+    }
+    for (auto& t : threads)
+        t.join();
+    wait_until(pool, done, 4 * tasks);
+    CHECK(done == 4 * tasks);
+}
+
+// Tasks submitting tasks go through the workers' own deques.
+void test_nested() {
+    tsl::thread_pool pool(with_threads(4));
+    std::atomic<int> done {0};
+    constexpr int outer = 50;
+    constexpr int inner = 20;
+    for (int i = 0; i < outer; ++i) {
+        pool.submit([&] {
+            for (int j = 0; j < inner; ++j) {
+                pool.submit([&] {
+                    done.fetch_add(1, std::memory_order_release);
+                    pool.notify_completion();
+                });
+            }
+        });
+    }
+    wait_until(pool, done, outer * inner);
+    CHECK(done == outer * inner);
+
+    // A loop inside a task runs on the same pool, helped by the waiting worker.
+    std::atomic<std::uint64_t> sum {0};
+    std::atomic<int> loops {0};
+    for (int i = 0; i < 8; ++i) {
+        pool.submit([&] {
+            tsl::parallel_for(pool, 0, 1000, [&](std::size_t k) { sum += k; });
+            loops.fetch_add(1, std::memory_order_release);
+            pool.notify_completion();
+        });
+    }
+    wait_until(pool, loops, 8);
+    CHECK(sum == 8 * (999 * 1000 / 2));
+}
+
+void test_parallel_for() {
+    tsl::thread_pool pool(with_threads(4));
+    for (std::size_t n : {0, 1, 7, 1000, 100000}) {
+        for (std::size_t grain : {0, 1, 3, 64, 1000000}) {
+            std::vector<std::atomic<int>> hits(n + 20);
+            tsl::parallel_for(pool, 10, n + 10, [&](std::size_t i) { ++hits[i]; }, grain);
+            bool once = true;
+            for (std::size_t i = 0; i < hits.size(); ++i)
+                once = once && hits[i] == (i >= 10 && i < n + 10 ? 1 : 0);
+            CHECK(once);
+        }
+    }
+
+    // Subranges are disjoint and no longer than the grain.
+    std::atomic<std::size_t> covered {0};
+    std::atomic<bool> too_long {false};
+    tsl::parallel_for_range(pool, 0, 5000, [&](std::size_t first, std::size_t last) {
+        if (last - first > 16)
+            too_long = true;
+        covered += last - first;
+    }, 16);
+    CHECK(covered == 5000 && !too_long);
+
+#if TSL_HAS_EXCEPTIONS
+    bool thrown = false;
+    try {
+        tsl::parallel_for(pool, 0, 1000, [](std::size_t i) {
+            if (i == 500)
+                throw std::runtime_error("index 500");
+        }, 10);
+    } catch (std::runtime_error const& e) {
+        thrown = std::string(e.what()) == "index 500";
+    }
+    CHECK(thrown);
+#endif
+}
+
+void test_parallel_reduce() {
+    tsl::thread_pool pool(with_threads(4));
+    for (std::size_t n : {0, 1, 999, 100000}) {
+        std::uint64_t serial = 5;
+        for (std::size_t i = 0; i < n; ++i)
+            serial += i * i % 1009;
+        auto square = [](std::size_t i) { return std::uint64_t(i * i % 1009); };
+        auto plus = [](std::uint64_t a, std::uint64_t b) { return a + b; };
+        CHECK(tsl::parallel_reduce(pool, 0, n, std::uint64_t(5), square, plus) == serial);
+        CHECK(tsl::parallel_reduce(pool, 0, n, std::uint64_t(5), square, plus, 7) == serial);
+    }
+
+    // Associative but not commutative: chunks are combined in index order.
+    std::string expected;
+    for (std::size_t i = 0; i < 300; ++i)
+        expected += static_cast<char>('a' + i % 26);
+    auto letter = [](std::size_t i) { return std::string(1, static_cast<char>('a' + i % 26)); };
+    auto concat = [](std::string a, std::string const& b) { return a + b; };
+    CHECK(tsl::parallel_reduce(pool, 0, 300, std::string(), letter, concat, 4) == expected);
+}
+
+// The destructor runs what is still queued, including tasks those tasks submit.
+void test_shutdown() {
+    std::atomic<int> done {0};
+    std::atomic<bool> release {false};
+    std::thread releaser;
+    {
+        tsl::thread_pool pool(with_threads(2));
+        // Keep both workers busy so that the rest stays queued.
+        for (int i = 0; i < 2; ++i) {
+            pool.submit([&] {
+                while (!release.load(std::memory_order_acquire))
+                    std::this_thread::yield();
+                ++done;
+            });
+        }
+        for (int i = 0; i < 100; ++i) {
+            pool.submit([&] {
+                ++done;
+                pool.submit([&] { ++done; });
+            });
+        }
+        // Released once the destructor is likely waiting.
+        releaser = std::thread([&] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            release.store(true, std::memory_order_release);
+        });
+    }
+    releaser.join();
+    CHECK(done == 202);
+}
+
+}
+
+int main() {
+    test_submit();
+    test_nested();
+    test_parallel_for();
+    test_parallel_reduce();
+    test_shutdown();
+    return tsl_test::result();
+}
@@ -0,0 +1,147 @@
+// trace: events of several threads drained to Chrome trace JSON, thread names,
+// escaped names, counters, and events dropped by a full buffer.
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <thread>
+#include "check.hpp"
+#include "tsl/profiling/trace.hpp"
+
+namespace {
+
+std::string contents(std::FILE* f) {
+    std::fflush(f);
+    std::rewind(f);
+    std::string s;
+    char buffer[4096];
+    std::size_t n;
+    while ((n = std::fread(buffer, 1, sizeof(buffer), f)) > 0)
+        s.append(buffer, n);
+    return s;
+}
+
+std::string chrome_json() {
+    std::FILE* out = std::tmpfile();
+    CHECK(tsl::trace::write_chrome_json(out));
+    std::string json = contents(out);
+    std::fclose(out);
+    return json;
+}
+
+std::size_t count(std::string_view text, std::string_view what) {
+    std::size_t n = 0;
+    for (std::size_t i = text.find(what); i != std::string_view::npos; i = text.find(what, i + 1))
+        ++n;
+    return n;
+}
+
+// The number after `"key":` in the first event named `name`, NaN if there is none.
+double field(std::string_view json, std::string_view name, std::string_view key) {
+    std::size_t event = json.find("{\"name\":\"" + std::string(name) + "\"");
+    if (event == std::string_view::npos)
+        return NAN;
+    std::size_t end = json.find('\n', event);
+    std::size_t at = json.substr(0, end).find("\"" + std::string(key) + "\":", event);
+    if (at == std::string_view::npos)
+        return NAN;
+    double v;
+    std::string number(json.substr(at + key.size() + 3, 32));
+    return std::sscanf(number.c_str(), "%lf", &v) == 1 ? v : NAN;
+}
+
+void work() {
+    TSL_TRACE_SCOPE("inner");
+    volatile unsigned x = 0;
+    for (unsigned i = 0; i < 100000; ++i)
+        x = x + i;
+}
+
+void test_json() {
+    tsl::trace::clear();
+    TSL_TRACE_SCOPE("before start");
+    tsl::trace::start();
+    CHECK(tsl::trace::enabled());
+    tsl::trace::set_thread_name("main \"thread\"");
+    {
+        TSL_TRACE_SCOPE("outer");
+        work();
+        TSL_TRACE_COUNTER("depth", 42);
+        TSL_TRACE_COUNTER("negative", -7);
+        TSL_TRACE_COUNTER("ratio", 0.5);
+        TSL_TRACE_COUNTER("not a number", NAN);
+    }
+    std::thread([] {
+        tsl::trace::set_thread_name("worker");
+        TSL_TRACE_SCOPE("on worker");
+    }).join();
+    tsl::trace::stop();
+    CHECK(!tsl::trace::enabled());
+    {
+        TSL_TRACE_SCOPE("after stop");
+    }
+
+    std::string json = chrome_json();
+    CHECK(json.starts_with("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n"));
+    CHECK(json.ends_with("\n]}\n"));
+    CHECK(count(json, "{") == count(json, "}"));
+
+    CHECK(count(json, "\"ph\":\"M\"") == 2);
+    CHECK(count(json, "\"args\":{\"name\":\"main \\\"thread\\\"\"}") == 1);
+    CHECK(count(json, "\"args\":{\"name\":\"worker\"}") == 1);
+
+    // Scopes that were open at start, or closed after stop, aren't recorded.
+    CHECK(count(json, "\"ph\":\"X\"") == 3);
+    CHECK(count(json, "before start") == 0 && count(json, "after stop") == 0);
+    double outer = field(json, "outer", "dur");
+    double inner = field(json, "inner", "dur");
+    CHECK(inner > 0 && outer >= inner);
+    CHECK(field(json, "inner", "ts") >= field(json, "outer", "ts"));
+    CHECK(field(json, "on worker", "tid") != field(json, "outer", "tid"));
+
+    CHECK(count(json, "\"ph\":\"C\"") == 4);
+    CHECK(field(json, "depth", "value") == 42);
+    CHECK(field(json, "negative", "value") == -7);
+    CHECK(field(json, "ratio", "value") == 0.5);
+    CHECK(field(json, "not a number", "value") == 0);
+
+    // Collected events stay until cleared, across restarts.
+    tsl::trace::start();
+    {
+        TSL_TRACE_SCOPE("restarted");
+    }
+    tsl::trace::stop();
+    json = chrome_json();
+    CHECK(count(json, "\"ph\":\"X\"") == 4 && count(json, "restarted") == 1);
+
+    tsl::trace::clear();
+    json = chrome_json();
+    CHECK(count(json, "\"ph\":\"X\"") == 0 && count(json, "\"ph\":\"M\"") == 2);
+}
+
+// A thread registering with 16-event buffers, while nothing drains them.
+void test_dropped() {
+    tsl::trace::clear();
+    tsl::trace::options opts;
+    opts.buffer_events = 16;
+    tsl::trace::start(opts);
+    std::uint64_t before = tsl::trace::dropped();
+    std::thread([] {
+        for (int i = 0; i < 100; ++i)
+            TSL_TRACE_COUNTER("i", i);
+    }).join();
+    tsl::trace::stop();
+    CHECK(tsl::trace::dropped() - before == 84);
+
+    std::string json = chrome_json();
+    CHECK(count(json, "\"ph\":\"C\"") == 16);
+    CHECK(count(json, "\"value\":15}") == 1 && count(json, "\"value\":16}") == 0);
+}
+
+}
+
+int main() {
+    test_json();
+    test_dropped();
+    return tsl_test::result();
+}
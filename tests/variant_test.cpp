@@ -0,0 +1,106 @@
+// variant: repeated alternatives, the converting constructor's choice of alternative,
+// comparisons, and the niche layout.
+#include <compare>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include "check.hpp"
+#include "tsl/types/non_negative.hpp"
+#include "tsl/variant.hpp"
+
+namespace {
+
+// The converting constructor picks the alternative F(T_i) overload resolution picks.
+template<typename V, typename U>
+constexpr std::size_t chosen = tsl::internal_variant::select_index<U, tsl::variant_alternative_t<0, V>,
+                                                                    tsl::variant_alternative_t<1, V>>();
+
+static_assert(chosen<tsl::variant<int, double>, float> == 1);
+static_assert(chosen<tsl::variant<int, double>, int> == 0);
+static_assert(chosen<tsl::variant<int, double>, long> == tsl::variant_npos);
+static_assert(chosen<tsl::variant<std::string, bool>, char const (&)[4]> == 0);
+static_assert(chosen<tsl::variant<std::string, bool>, bool> == 1);
+static_assert(chosen<tsl::variant<std::string, std::string>, std::string> == tsl::variant_npos);
+static_assert(chosen<tsl::variant<long, long>, int> == tsl::variant_npos);
+static_assert(!std::is_constructible_v<tsl::variant<std::string, std::string>, std::string>);
+static_assert(std::is_constructible_v<tsl::variant<std::string, bool>, char const*>);
+
+void test_repeated_alternatives() {
+    using twice = tsl::variant<std::string, std::string>;
+    twice a(std::in_place_index<1>, "second");
+    twice b(a);
+    CHECK(b.index() == 1 && tsl::get<1>(b) == "second");
+
+    twice c(std::in_place_index<0>, "first");
+    CHECK(a != c);
+    CHECK(c < a);
+    c = b;
+    CHECK(c.index() == 1 && c == a);
+
+    twice d(std::move(b));
+    CHECK(d.index() == 1 && tsl::get<1>(d) == "second");
+    twice e(std::in_place_index<0>, "other");
+    e = std::move(d);
+    CHECK(e.index() == 1 && tsl::get<1>(e) == "second");
+
+    twice f(std::in_place_index<1>, "x");
+    swap(e, f);
+    CHECK(tsl::get<1>(e) == "x" && tsl::get<1>(f) == "second");
+    twice g(std::in_place_index<0>, "y");
+    swap(f, g);
+    CHECK(f.index() == 0 && tsl::get<0>(f) == "y");
+    CHECK(g.index() == 1 && tsl::get<1>(g) == "second");
+
+    tsl::variant<int, int> h(std::in_place_index<1>, 3);
+    tsl::variant<int, int> i = h;
+    CHECK(i.index() == 1 && tsl::get<1>(i) == 3);
+}
+
+void test_converting_constructor() {
+    tsl::variant<int, double> a = 1.5f;
+    CHECK(a.index() == 1 && tsl::get<double>(a) == 1.5);
+    a = 2;
+    CHECK(a.index() == 0 && tsl::get<int>(a) == 2);
+
+    tsl::variant<std::string, bool> b = "abc";
+    CHECK(b.index() == 0 && tsl::get<std::string>(b) == "abc");
+    b = true;
+    CHECK(b.index() == 1 && tsl::get<bool>(b));
+}
+
+void test_comparisons() {
+    using v = tsl::variant<int, std::string>;
+    CHECK(v(1) == v(1));
+    CHECK(v(1) != v(2));
+    CHECK(v(1) < v(2));
+    CHECK(v(100) < v(std::string("a")));
+    CHECK((v(std::string("a")) <=> v(std::string("b"))) == std::strong_ordering::less);
+}
+
+struct none {
+    friend bool operator==(none, none) = default;
+};
+
+void test_niche() {
+    using v = tsl::variant<none, tsl::non_negative<int>>;
+    static_assert(v::uses_niche);
+    static_assert(sizeof(v) == sizeof(int));
+    v a;
+    CHECK(a.index() == 0);
+    a = tsl::non_negative<int>(tsl::unchecked, 7);
+    CHECK(a.index() == 1 && tsl::get<1>(a).raw() == 7);
+    v b = a;
+    CHECK(b == a);
+    b.emplace<none>();
+    CHECK(b.index() == 0 && a != b);
+}
+
+}
+
+int main() {
+    test_repeated_alternatives();
+    test_converting_constructor();
+    test_comparisons();
+    test_niche();
+    return tsl_test::result();
+}